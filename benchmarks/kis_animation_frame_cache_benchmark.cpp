@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QTest>
+
+#include "kis_animation_frame_cache_benchmark.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_image.h>
+#include <kis_paint_layer.h>
+#include <kis_paint_device.h>
+#include <kis_sequential_iterator.h>
+#include <kis_keyframe_channel.h>
+#include <kis_image_animation_interface.h>
+#include <kis_time_range.h>
+#include <kundo2command.h>
+
+#include "kis_animation_frame_cache.h"
+#include "canvas/kis_update_info.h"
+#include "opengl/kis_texture_tile_info_pool.h"
+#include "opengl/kis_opengl_image_textures.h"
+#include "tiles3/swap/kis_lzf_compression.h"
+
+/**
+ * A 4K frame, split into the same tiles the openGL canvas uses
+ */
+const int FRAME_WIDTH = 3840;
+const int FRAME_HEIGHT = 2160;
+const int TEXTURE_TILE_SIZE = 256;
+const int NUM_FRAMES = 24;
+
+
+KisOpenGLUpdateInfoSP createFrameInfo(KisImageSP image, KisTextureTileInfoPoolSP pool)
+{
+    KisOpenGLUpdateInfoSP info = new KisOpenGLUpdateInfo(ConversionOptions());
+    const QRect bounds = image->bounds();
+
+    info->assignDirtyImageRect(bounds);
+    info->assignLevelOfDetail(0);
+
+    for (int row = 0; row * TEXTURE_TILE_SIZE < bounds.height(); row++) {
+        for (int col = 0; col * TEXTURE_TILE_SIZE < bounds.width(); col++) {
+            const QRect tileRect(col * TEXTURE_TILE_SIZE, row * TEXTURE_TILE_SIZE,
+                                 TEXTURE_TILE_SIZE, TEXTURE_TILE_SIZE);
+
+            KisTextureTileUpdateInfoSP tileInfo(
+                new KisTextureTileUpdateInfo(col, row, tileRect, bounds, bounds, 0, pool));
+
+            tileInfo->retrieveData(image->projection(), QBitArray(), false, 0);
+            info->tileList.append(tileInfo);
+        }
+    }
+
+    return info;
+}
+
+void KisAnimationFrameCacheBenchmark::initTestCase()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    m_image = new KisImage(0, FRAME_WIDTH, FRAME_HEIGHT, cs, "frame cache benchmark");
+
+    KisPaintLayerSP layer = new KisPaintLayer(m_image, "layer", OPACITY_OPAQUE_U8);
+    m_image->addNode(layer);
+
+    /**
+     * Animation frames usually consist of large flat areas and
+     * smooth gradients, so generate something alike instead of
+     * a pure noise, which would be incompressible
+     */
+    KoColor color(cs);
+    KisSequentialIterator it(layer->paintDevice(), m_image->bounds());
+    do {
+        const int x = it.x();
+        const int y = it.y();
+
+        if ((x / 300 + y / 200) % 3) {
+            color.fromQColor(QColor(x % 256, y % 256, (x + y) % 256));
+        } else {
+            color.fromQColor(Qt::white);
+        }
+
+        memcpy(it.rawData(), color.data(), cs->pixelSize());
+    } while (it.nextPixel());
+
+    /**
+     * Every frame has its own keyframe, so that each of them gets
+     * its own entry in the cache
+     */
+    KUndo2Command parentCommand;
+    KisKeyframeChannel *rasterChannel = layer->getKeyframeChannel(KisKeyframeChannel::Content.id());
+    for (int time = 1; time < NUM_FRAMES; time++) {
+        rasterChannel->addKeyframe(time, &parentCommand);
+    }
+    m_image->animationInterface()->setFullClipRange(KisTimeRange::fromTime(0, NUM_FRAMES - 1));
+
+    m_image->refreshGraph();
+}
+
+void KisAnimationFrameCacheBenchmark::cleanupTestCase()
+{
+    m_image = 0;
+}
+
+void KisAnimationFrameCacheBenchmark::benchmarkFillUncompressed()
+{
+    KisTextureTileInfoPoolSP pool(new KisTextureTileInfoPool(TEXTURE_TILE_SIZE, TEXTURE_TILE_SIZE));
+
+    QBENCHMARK {
+        KisOpenGLUpdateInfoSP info = createFrameInfo(m_image, pool);
+        Q_UNUSED(info);
+    }
+}
+
+void KisAnimationFrameCacheBenchmark::benchmarkFillCompressed()
+{
+    KisTextureTileInfoPoolSP pool(new KisTextureTileInfoPool(TEXTURE_TILE_SIZE, TEXTURE_TILE_SIZE));
+
+    qint64 compressedSize = 0;
+    qint64 uncompressedSize = 0;
+
+    QBENCHMARK {
+        KisOpenGLUpdateInfoSP info = createFrameInfo(m_image, pool);
+        KisAnimationFrameCache::compressFrameData(info);
+
+        compressedSize = 0;
+        uncompressedSize = 0;
+
+        Q_FOREACH (KisTextureTileUpdateInfoSP tile, info->tileList) {
+            compressedSize += tile->memoryFootprint();
+            uncompressedSize += tile->uncompressedMemoryFootprint();
+        }
+    }
+
+    qDebug() << "Frame size:" << uncompressedSize << "compressed:" << compressedSize
+             << "ratio:" << qreal(uncompressedSize) / qMax(compressedSize, qint64(1));
+}
+
+void KisAnimationFrameCacheBenchmark::benchmarkUploadCompressed()
+{
+    KisTextureTileInfoPoolSP pool(new KisTextureTileInfoPool(TEXTURE_TILE_SIZE, TEXTURE_TILE_SIZE));
+
+    KisOpenGLUpdateInfoSP info = createFrameInfo(m_image, pool);
+    KisAnimationFrameCache::compressFrameData(info);
+
+    KisLzfCompression compression;
+
+    QBENCHMARK {
+        Q_FOREACH (KisTextureTileUpdateInfoSP tile, info->tileList) {
+            KisTextureTileUpdateInfoSP uploadableTile = tile->decompressedCopy(&compression);
+            Q_UNUSED(uploadableTile);
+        }
+    }
+}
+
+void KisAnimationFrameCacheBenchmark::benchmarkPopulateCache()
+{
+    KisOpenGLImageTexturesSP textures =
+        KisOpenGLImageTextures::getImageTextures(m_image, 0,
+                                                 KoColorConversionTransformation::IntentPerceptual,
+                                                 KoColorConversionTransformation::Empty);
+
+    qint64 memoryUsage = 0;
+
+    /**
+     * Does the same as the cache populator does for every
+     * regenerated frame: fetch the pixels, convert and compress
+     * them, then put them into the cache
+     */
+    QBENCHMARK {
+        KisAnimationFrameCacheSP cache = new KisAnimationFrameCache(textures);
+
+        for (int time = 0; time < NUM_FRAMES; time++) {
+            KisOpenGLUpdateInfoSP info = cache->fetchFrameData(time, m_image->projection());
+
+            if (info->needsConversion()) {
+                info->convertColorSpace();
+            }
+            KisAnimationFrameCache::compressFrameData(info);
+
+            cache->addConvertedFrameData(info, time);
+        }
+
+        memoryUsage = cache->memoryUsage();
+    }
+
+    qDebug() << "Cached" << NUM_FRAMES << "frames in" << memoryUsage << "bytes";
+}
+
+QTEST_MAIN(KisAnimationFrameCacheBenchmark)
@@ -0,0 +1,223 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_hsv_adjustment_benchmark.h"
+#include "kis_benchmark_values.h"
+
+#include <QTest>
+#include <QScopedPointer>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorAdjustmentKernels.h>
+#include <KoColor.h>
+
+#include "filter/kis_filter_registry.h"
+#include "filter/kis_filter_configuration.h"
+#include "filter/kis_filter.h"
+
+#include <kis_paint_device.h>
+#include <kis_iterator_ng.h>
+#include "krita_utils.h"
+
+enum KernelMode {
+    HSV,
+    HSL,
+    ColorBalance
+};
+
+void KisHSVAdjustmentBenchmark::benchmarkKernels(KoColorAdjustmentKernels *kernels, int mode)
+{
+    QScopedPointer<KoColorAdjustmentKernels> kernelsHolder(kernels);
+
+    /**
+     * The color transformations feed the kernels with chunks
+     * of 256 pixels, so do the same here
+     */
+    const int chunkSize = 256;
+    const int numChunks = GMP_IMAGE_WIDTH * GMP_IMAGE_HEIGHT / chunkSize;
+
+    QVector<float> srcR(chunkSize), srcG(chunkSize), srcB(chunkSize);
+    QVector<float> r(chunkSize), g(chunkSize), b(chunkSize);
+
+    srand(31524744);
+    for (int i = 0; i < chunkSize; i++) {
+        srcR[i] = (rand() % 256) / 255.0f;
+        srcG[i] = (rand() % 256) / 255.0f;
+        srcB[i] = (rand() % 256) / 255.0f;
+    }
+
+    KoColorAdjustmentKernels::ColorBalance params;
+    for (int ch = 0; ch < 3; ch++) {
+        params.shadows[ch] = 0.1f * ch;
+        params.midtones[ch] = -0.2f;
+        params.highlights[ch] = 0.3f - 0.1f * ch;
+    }
+    params.preserveLuminosity = true;
+
+    QBENCHMARK {
+        for (int i = 0; i < numChunks; i++) {
+            r = srcR;
+            g = srcG;
+            b = srcB;
+
+            if (mode == HSV) {
+                kernels->adjustHSV(r.data(), g.data(), b.data(), chunkSize, 54.0f, 0.2f, 0.1f);
+            } else if (mode == HSL) {
+                kernels->adjustHSL(r.data(), g.data(), b.data(), chunkSize, 54.0f, 1.2f, 0.1f);
+            } else {
+                kernels->colorBalance(r.data(), g.data(), b.data(), chunkSize, params);
+            }
+        }
+    }
+}
+
+KisFilterConfigurationSP KisHSVAdjustmentBenchmark::hsvConfiguration(int type)
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("hsvadjustment");
+    KisFilterConfigurationSP config = filter->defaultConfiguration(0);
+
+    config->setProperty("h", 30);
+    config->setProperty("s", 20);
+    config->setProperty("v", 10);
+    config->setProperty("type", type);
+
+    return config;
+}
+
+KisFilterConfigurationSP KisHSVAdjustmentBenchmark::colorBalanceConfiguration()
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("colorbalance");
+    KisFilterConfigurationSP config = filter->defaultConfiguration(0);
+
+    config->setProperty("cyan_red_shadows", 20);
+    config->setProperty("magenta_green_midtones", -30);
+    config->setProperty("yellow_blue_highlights", 40);
+    config->setProperty("preserve_luminosity", true);
+
+    return config;
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkFilter(const KoColorSpace *cs, KisFilterConfigurationSP config)
+{
+    KisPaintDeviceSP device = new KisPaintDevice(cs);
+    KoColor color(cs);
+
+    srand(31524744);
+
+    KisSequentialIterator it(device, QRect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT));
+    do {
+        color.fromQColor(QColor(rand() % 256, rand() % 256, rand() % 256));
+        memcpy(it.rawData(), color.data(), cs->pixelSize());
+    } while (it.nextPixel());
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value(config->name());
+
+    QSize size = KritaUtils::optimalPatchSize();
+    QVector<QRect> rects = KritaUtils::splitRectIntoPatches(QRect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT), size);
+
+    QBENCHMARK {
+        Q_FOREACH (const QRect &rc, rects) {
+            filter->process(device, rc, config);
+        }
+    }
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSVKernelScalar()
+{
+    benchmarkKernels(KoColorAdjustmentKernels::createScalar(), HSV);
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSVKernelOptimized()
+{
+    benchmarkKernels(KoColorAdjustmentKernels::create(), HSV);
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSLKernelScalar()
+{
+    benchmarkKernels(KoColorAdjustmentKernels::createScalar(), HSL);
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSLKernelOptimized()
+{
+    benchmarkKernels(KoColorAdjustmentKernels::create(), HSL);
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkColorBalanceKernelScalar()
+{
+    benchmarkKernels(KoColorAdjustmentKernels::createScalar(), ColorBalance);
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkColorBalanceKernelOptimized()
+{
+    benchmarkKernels(KoColorAdjustmentKernels::create(), ColorBalance);
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSVFilter8bit()
+{
+    benchmarkFilter(KoColorSpaceRegistry::instance()->rgb8(), hsvConfiguration(0));
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSVFilter16bit()
+{
+    benchmarkFilter(KoColorSpaceRegistry::instance()->rgb16(), hsvConfiguration(0));
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSVFilter32bitFloat()
+{
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), 0);
+    benchmarkFilter(cs, hsvConfiguration(0));
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSLFilter8bit()
+{
+    benchmarkFilter(KoColorSpaceRegistry::instance()->rgb8(), hsvConfiguration(1));
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSLFilter16bit()
+{
+    benchmarkFilter(KoColorSpaceRegistry::instance()->rgb16(), hsvConfiguration(1));
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkHSLFilter32bitFloat()
+{
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), 0);
+    benchmarkFilter(cs, hsvConfiguration(1));
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkColorBalanceFilter8bit()
+{
+    benchmarkFilter(KoColorSpaceRegistry::instance()->rgb8(), colorBalanceConfiguration());
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkColorBalanceFilter16bit()
+{
+    benchmarkFilter(KoColorSpaceRegistry::instance()->rgb16(), colorBalanceConfiguration());
+}
+
+void KisHSVAdjustmentBenchmark::benchmarkColorBalanceFilter32bitFloat()
+{
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), 0);
+    benchmarkFilter(cs, colorBalanceConfiguration());
+}
+
+QTEST_MAIN(KisHSVAdjustmentBenchmark)
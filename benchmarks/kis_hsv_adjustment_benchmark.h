@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_HSV_ADJUSTMENT_BENCHMARK_H
+#define __KIS_HSV_ADJUSTMENT_BENCHMARK_H
+
+#include <QtTest>
+
+#include <kis_types.h>
+
+class KoColorSpace;
+class KoColorAdjustmentKernels;
+
+class KisHSVAdjustmentBenchmark : public QObject
+{
+    Q_OBJECT
+private:
+    void benchmarkKernels(KoColorAdjustmentKernels *kernels, int mode);
+    void benchmarkFilter(const KoColorSpace *cs, KisFilterConfigurationSP config);
+
+    KisFilterConfigurationSP hsvConfiguration(int type);
+    KisFilterConfigurationSP colorBalanceConfiguration();
+
+private Q_SLOTS:
+    void benchmarkHSVKernelScalar();
+    void benchmarkHSVKernelOptimized();
+    void benchmarkHSLKernelScalar();
+    void benchmarkHSLKernelOptimized();
+    void benchmarkColorBalanceKernelScalar();
+    void benchmarkColorBalanceKernelOptimized();
+
+    void benchmarkHSVFilter8bit();
+    void benchmarkHSVFilter16bit();
+    void benchmarkHSVFilter32bitFloat();
+    void benchmarkHSLFilter8bit();
+    void benchmarkHSLFilter16bit();
+    void benchmarkHSLFilter32bitFloat();
+    void benchmarkColorBalanceFilter8bit();
+    void benchmarkColorBalanceFilter16bit();
+    void benchmarkColorBalanceFilter32bitFloat();
+};
+
+#endif /* __KIS_HSV_ADJUSTMENT_BENCHMARK_H */
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <QTest>
+
+#include "kis_image_pyramid_benchmark.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_image.h>
+#include <kis_paint_device.h>
+
+#include "canvas/kis_image_pyramid.h"
+#include "canvas/kis_image_pyramid_downsampler.h"
+#include "canvas/kis_update_info.h"
+
+const int IMAGE_WIDTH = 8192;
+const int IMAGE_HEIGHT = 8192;
+const int ROW_WIDTH = 4096;
+const int NUM_ROWS = 1024;
+
+
+void KisImagePyramidBenchmark::initTestCase()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    m_image = new KisImage(0, IMAGE_WIDTH, IMAGE_HEIGHT, cs, "pyramid benchmark");
+
+    /**
+     * The speed of the box filter doesn't depend on the content,
+     * so just split the image into a few colored areas
+     */
+    KisPaintDeviceSP projection = m_image->projection();
+    projection->fill(QRect(0, 0, IMAGE_WIDTH / 2, IMAGE_HEIGHT), KoColor(Qt::red, cs));
+    projection->fill(QRect(IMAGE_WIDTH / 2, 0, IMAGE_WIDTH / 2, IMAGE_HEIGHT / 2), KoColor(Qt::green, cs));
+    projection->fill(QRect(IMAGE_WIDTH / 2, IMAGE_HEIGHT / 2, IMAGE_WIDTH / 2, IMAGE_HEIGHT / 2), KoColor(Qt::transparent, cs));
+}
+
+void KisImagePyramidBenchmark::cleanupTestCase()
+{
+    m_image = 0;
+}
+
+void KisImagePyramidBenchmark::benchmarkDownsamplePixels_data()
+{
+    QTest::addColumn<bool>("useScalar");
+
+    QTest::newRow("scalar") << true;
+    QTest::newRow("optimized") << false;
+}
+
+void KisImagePyramidBenchmark::benchmarkDownsamplePixels()
+{
+    QFETCH(bool, useScalar);
+
+    QScopedPointer<KisImagePyramidDownsampler> downsampler(
+        useScalar ?
+        KisImagePyramidDownsampler::createScalar() :
+        KisImagePyramidDownsampler::create());
+
+    const int pixelSize = 4;
+    QVector<quint8> srcRow0(ROW_WIDTH * pixelSize);
+    QVector<quint8> srcRow1(ROW_WIDTH * pixelSize);
+    QVector<quint8> dstRow(ROW_WIDTH / 2 * pixelSize);
+
+    for (int i = 0; i < srcRow0.size(); i++) {
+        srcRow0[i] = i & 0xff;
+        srcRow1[i] = (i * 7) & 0xff;
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < NUM_ROWS; i++) {
+            downsampler->downsamplePixels(srcRow0.constData(), srcRow1.constData(),
+                                          dstRow.data(), ROW_WIDTH);
+        }
+    }
+}
+
+void KisImagePyramidBenchmark::benchmarkRebuild_data()
+{
+    QTest::addColumn<int>("pyramidHeight");
+
+    for (int height = 2; height <= 6; height++) {
+        QTest::newRow(QString("zoom 1:%1").arg(1 << (height - 1)).toLatin1()) << height;
+    }
+}
+
+void KisImagePyramidBenchmark::benchmarkRebuild()
+{
+    QFETCH(int, pyramidHeight);
+
+    const KoColorSpace *cs = m_image->colorSpace();
+
+    KisImagePyramid pyramid(pyramidHeight);
+    pyramid.setMonitorProfile(cs->profile(),
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags());
+    pyramid.setImage(m_image);
+
+    KisPPUpdateInfoSP info = new KisPPUpdateInfo();
+    info->dirtyImageRectVar = m_image->bounds();
+
+    QBENCHMARK {
+        pyramid.recalculateCache(info);
+    }
+}
+
+QTEST_MAIN(KisImagePyramidBenchmark)
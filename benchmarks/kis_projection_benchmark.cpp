@@ -20,13 +20,20 @@
 #include "kis_projection_benchmark.h"
 #include "kis_benchmark_values.h"
 
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegion>
+
 #include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
 
 #include <kis_group_layer.h>
 #include <kis_paint_device.h>
 #include <KisDocument.h>
 #include <kis_image.h>
 #include <KisPart.h>
+#include <kis_paint_layer.h>
 
 void KisProjectionBenchmark::initTestCase()
 {
@@ -58,5 +65,79 @@ void KisProjectionBenchmark::benchmarkLoading()
     }
 }
 
+void KisProjectionBenchmark::benchmarkVisibleAreaLatency_data()
+{
+    QTest::addColumn<bool>("usePriorityHint");
+
+    QTest::newRow("fifo") << false;
+    QTest::newRow("viewport-first") << true;
+}
+
+/**
+ * Measures the time between starting a full refresh of a big image
+ * and the moment when the area the user looks at is fully updated
+ */
+void KisProjectionBenchmark::benchmarkVisibleAreaLatency()
+{
+    QFETCH(bool, usePriorityHint);
+
+    const QRect imageRect(0, 0, 6000, 6000);
+    const QRect visibleRect(4500, 4500, 1200, 800);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "latency benchmark");
+
+    for (int i = 0; i < 5; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer %1").arg(i), OPACITY_OPAQUE_U8 / 2);
+        layer->paintDevice()->fill(imageRect, KoColor(QColor(50 * i, 100, 255 - 50 * i), cs));
+        image->addNode(layer, image->root());
+    }
+    image->refreshGraph();
+
+    if (usePriorityHint) {
+        image->setUpdatePriorityHint(visibleRect, QRectF(visibleRect).center());
+    }
+
+    QMutex mutex;
+    QRegion pendingRegion;
+    QElapsedTimer timer;
+    qint64 visibleAreaTime = -1;
+
+    QMetaObject::Connection connection =
+        QObject::connect(image.data(), &KisImage::sigImageUpdated,
+                         [&] (const QRect &rc) {
+                             QMutexLocker locker(&mutex);
+                             if (pendingRegion.isEmpty()) return;
+
+                             pendingRegion -= rc;
+                             if (pendingRegion.isEmpty()) {
+                                 visibleAreaTime = timer.nsecsElapsed();
+                             }
+                         });
+
+    qint64 totalVisibleAreaTime = 0;
+    int numRuns = 0;
+
+    QBENCHMARK {
+        {
+            QMutexLocker locker(&mutex);
+            pendingRegion = visibleRect;
+            visibleAreaTime = -1;
+            timer.start();
+        }
+
+        image->refreshGraphAsync();
+        image->waitForDone();
+
+        QVERIFY(visibleAreaTime >= 0);
+        totalVisibleAreaTime += visibleAreaTime;
+        numRuns++;
+    }
+
+    QObject::disconnect(connection);
+
+    qDebug() << "Visible area updated in" << totalVisibleAreaTime / numRuns / 1000000.0 << "ms (average)";
+}
+
 
 QTEST_MAIN(KisProjectionBenchmark)
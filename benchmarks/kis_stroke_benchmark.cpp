@@ -40,6 +40,7 @@ inline double drand48()
 #include <kis_image.h>
 #include <kis_layer.h>
 #include <kis_paint_layer.h>
+#include <kis_image_config.h>
 
 #include <brushengine/kis_paint_information.h>
 #include <brushengine/kis_paintop_preset.h>
@@ -229,6 +230,43 @@ void KisStrokeBenchmark::softbrushFullFeatures30RL()
     benchmarkRandomLines(presetFileName);
 }
 
+void KisStrokeBenchmark::benchmarkDabGeneration(bool parallel, bool randomLines)
+{
+    QString presetFileName = "autobrush_300px.kpp";
+
+    KisImageConfig cfg;
+    const bool oldValue = cfg.parallelDabGeneration();
+    cfg.setParallelDabGeneration(parallel);
+
+    if (randomLines) {
+        benchmarkRandomLines(presetFileName);
+    } else {
+        benchmarkStroke(presetFileName);
+    }
+
+    cfg.setParallelDabGeneration(oldValue);
+}
+
+void KisStrokeBenchmark::autobrush300pxSequentialDabs()
+{
+    benchmarkDabGeneration(false, false);
+}
+
+void KisStrokeBenchmark::autobrush300pxParallelDabs()
+{
+    benchmarkDabGeneration(true, false);
+}
+
+void KisStrokeBenchmark::autobrush300pxSequentialDabsRL()
+{
+    benchmarkDabGeneration(false, true);
+}
+
+void KisStrokeBenchmark::autobrush300pxParallelDabsRL()
+{
+    benchmarkDabGeneration(true, true);
+}
+
 void KisStrokeBenchmark::hairy30pxDefault()
 {
     QString presetFileName = "hairybrush_thesis30px1.kpp";
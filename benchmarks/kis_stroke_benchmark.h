@@ -62,6 +62,7 @@ private:
         inline void benchmarkStroke(QString presetFileName);
         inline void benchmarkLine(QString presetFileName);
         inline void benchmarkCircle(QString presetFileName);
+        inline void benchmarkDabGeneration(bool parallel, bool randomLines);
 
 private Q_SLOTS:
     void initTestCase();
@@ -83,6 +84,12 @@ private Q_SLOTS:
     void softbrushSoftness();
     void softbrushOpacity();
 
+    // Big autobrush with and without parallel dab generation
+    void autobrush300pxSequentialDabs();
+    void autobrush300pxParallelDabs();
+    void autobrush300pxSequentialDabsRL();
+    void autobrush300pxParallelDabsRL();
+
     // Hairy brush benchmarks
     void hairy30pxDefault();
     void hairy30pxDefaultRL();
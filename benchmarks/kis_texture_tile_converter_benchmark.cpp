@@ -0,0 +1,141 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <QTest>
+#include <QThreadPool>
+
+#include "kis_texture_tile_converter_benchmark.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+
+#include <kis_paint_device.h>
+#include <kis_sequential_iterator.h>
+
+#include "opengl/kis_texture_tile_converter.h"
+#include "opengl/kis_texture_tile_info_pool.h"
+
+const int IMAGE_WIDTH = 4096;
+const int IMAGE_HEIGHT = 4096;
+const int TEXTURE_TILE_SIZE = 256;
+
+
+KisPaintDeviceSP createProjection(const KoColorSpace *cs)
+{
+    /**
+     * LCMS caches the last converted pixel, so flat areas would be
+     * converted unrealistically fast. Fill the device with some noise.
+     */
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(rgb8);
+    const QRect rc(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT);
+
+    qsrand(1);
+    KisSequentialIterator it(dev, rc);
+    do {
+        quint8 *pixel = it.rawData();
+        pixel[0] = qrand() & 0xff;
+        pixel[1] = qrand() & 0xff;
+        pixel[2] = qrand() & 0xff;
+        pixel[3] = 128 + (qrand() & 0x7f);
+    } while (it.nextPixel());
+
+    dev->convertTo(cs);
+    return dev;
+}
+
+KisTextureTileUpdateInfoSPList createTiles(KisTextureTileInfoPoolSP pool)
+{
+    KisTextureTileUpdateInfoSPList tiles;
+    const QRect bounds(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT);
+
+    for (int row = 0; row * TEXTURE_TILE_SIZE < IMAGE_HEIGHT; row++) {
+        for (int col = 0; col * TEXTURE_TILE_SIZE < IMAGE_WIDTH; col++) {
+            const QRect tileRect(col * TEXTURE_TILE_SIZE, row * TEXTURE_TILE_SIZE,
+                                 TEXTURE_TILE_SIZE, TEXTURE_TILE_SIZE);
+
+            tiles.append(KisTextureTileUpdateInfoSP(
+                new KisTextureTileUpdateInfo(col, row, tileRect, bounds, bounds, 0, pool)));
+        }
+    }
+
+    return tiles;
+}
+
+void KisTextureTileConverterBenchmark::benchmarkConversion_data()
+{
+    QTest::addColumn<QString>("colorModelId");
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<bool>("singleThreaded");
+
+    QList<QPair<KoID, KoID> > colorSpaces;
+    colorSpaces << qMakePair(RGBAColorModelID, Integer8BitsColorDepthID);
+    colorSpaces << qMakePair(RGBAColorModelID, Integer16BitsColorDepthID);
+    colorSpaces << qMakePair(RGBAColorModelID, Float32BitsColorDepthID);
+    colorSpaces << qMakePair(LABAColorModelID, Integer16BitsColorDepthID);
+    colorSpaces << qMakePair(CMYKAColorModelID, Integer8BitsColorDepthID);
+
+    typedef QPair<KoID, KoID> ColorSpaceId;
+    Q_FOREACH (const ColorSpaceId &id, colorSpaces) {
+        const QString name = QString("%1-%2").arg(id.first.id()).arg(id.second.id());
+
+        QTest::newRow((name + "-single-thread").toLatin1())
+            << id.first.id() << id.second.id() << true;
+
+        QTest::newRow((name + "-multi-thread").toLatin1())
+            << id.first.id() << id.second.id() << false;
+    }
+}
+
+void KisTextureTileConverterBenchmark::benchmarkConversion()
+{
+    QFETCH(QString, colorModelId);
+    QFETCH(QString, colorDepthId);
+    QFETCH(bool, singleThreaded);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(colorModelId, colorDepthId, 0);
+    QVERIFY(cs);
+
+    KisPaintDeviceSP projection = createProjection(cs);
+    KisTextureTileInfoPoolSP pool(new KisTextureTileInfoPool(TEXTURE_TILE_SIZE, TEXTURE_TILE_SIZE));
+
+    const KoColorSpace *dstCS = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisTextureTileConverter converter;
+    converter.setConversionOptions(
+        ConversionOptions(dstCS,
+                          KoColorConversionTransformation::internalRenderingIntent(),
+                          KoColorConversionTransformation::internalConversionFlags()));
+
+    const int oldMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+    if (singleThreaded) {
+        QThreadPool::globalInstance()->setMaxThreadCount(1);
+    }
+
+    QBENCHMARK {
+        KisTextureTileUpdateInfoSPList tiles = createTiles(pool);
+        converter.convertTiles(tiles, projection);
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(oldMaxThreadCount);
+}
+
+QTEST_MAIN(KisTextureTileConverterBenchmark)
@@ -180,7 +180,7 @@ extern "C" int main(int argc, char **argv)
     if (app.isRunning()) {
         // only pass arguments to main instance if they are not for batch processing
         // any batch processing would be done in this separate instance
-        const bool batchRun = (args.print() || args.exportAs() || args.exportAsPdf());
+        const bool batchRun = (args.print() || args.exportAs() || args.exportAsPdf() || args.batchExport());
 
         if (!batchRun) {
             QByteArray ba = args.serialize();
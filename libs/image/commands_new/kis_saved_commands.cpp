@@ -146,6 +146,11 @@ bool KisSavedCommand::isMerged()
     return m_command->isMerged();
 }
 
+qint64 KisSavedCommand::memoryUsage() const
+{
+    return m_command->memoryUsage();
+}
+
 
 
 struct KisSavedMacroCommand::Private
@@ -177,6 +182,17 @@ void KisSavedMacroCommand::setMacroId(int value)
     m_d->macroId = value;
 }
 
+qint64 KisSavedMacroCommand::memoryUsage() const
+{
+    qint64 result = KUndo2Command::memoryUsage();
+
+    Q_FOREACH (const Private::SavedCommand &cmd, m_d->commands) {
+        result += cmd.command->memoryUsage();
+    }
+
+    return result;
+}
+
 int KisSavedMacroCommand::id() const
 {
     return m_d->macroId;
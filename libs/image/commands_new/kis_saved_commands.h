@@ -66,6 +66,8 @@ public:
     virtual QTime endTime();
     virtual bool isMerged();
 
+    qint64 memoryUsage() const;
+
 protected:
     void addCommands(KisStrokeId id, bool undo);
 
@@ -90,6 +92,8 @@ public:
 
     void performCancel(KisStrokeId id, bool strokeUndo);
 
+    qint64 memoryUsage() const;
+
 protected:
     void addCommands(KisStrokeId id, bool undo);
 
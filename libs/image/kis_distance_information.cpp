@@ -26,6 +26,7 @@
 #include "kis_algebra_2d.h"
 
 #include "kis_lod_transform.h"
+#include "kis_trace_recorder.h"
 
 
 struct Q_DECL_HIDDEN KisDistanceInformation::Private {
@@ -155,6 +156,11 @@ void KisDistanceInformation::registerPaintedDab(const KisPaintInformation &info,
     m_d->lastTime = info.currentTime();
     m_d->lastDabInfoValid = true;
 
+    KisTraceRecorder *trace = KisTraceRecorder::instance();
+    if (trace->isEnabled()) {
+        trace->addDabs(1);
+    }
+
     m_d->spacing = spacing;
 }
 
@@ -20,12 +20,15 @@
 #include <KoIcon.h>
 #include <kis_icon.h>
 #include <KoCompositeOpRegistry.h>
+#include <KoColorSpace.h>
 
 #include "kis_layer.h"
 #include "kis_filter_mask.h"
 #include "filter/kis_filter.h"
 #include "filter/kis_filter_configuration.h"
 #include "filter/kis_filter_registry.h"
+#include "filter/kis_color_transformation_filter.h"
+#include "filter/kis_color_transformation_configuration.h"
 #include "kis_selection.h"
 #include "kis_processing_information.h"
 #include "kis_node.h"
@@ -34,6 +37,7 @@
 #include "kis_busy_progress_indicator.h"
 #include "kis_transaction.h"
 #include "kis_painter.h"
+#include "kis_paint_device.h"
 
 KisFilterMask::KisFilterMask()
     : KisEffectMask(),
@@ -100,6 +104,53 @@ QRect KisFilterMask::decorateRect(KisPaintDeviceSP &src,
     return r;
 }
 
+/**
+ * The masks created from the GUI get a selection with a white default
+ * pixel and no data at all. Such a selection selects everything, so
+ * applying the mask with it is the same as applying it without one.
+ */
+static bool isTriviallyFullySelected(KisSelectionSP selection)
+{
+    if (selection->hasShapeSelection()) return false;
+
+    KisPixelSelectionSP pixelSelection = selection->pixelSelection();
+
+    return *pixelSelection->defaultPixel().data() == MAX_SELECTED &&
+        pixelSelection->nonDefaultPixelArea().isEmpty();
+}
+
+KoColorTransformation* KisFilterMask::inplaceColorTransformation(KisPaintDeviceSP device) const
+{
+    KisSelectionSP maskSelection = selection();
+    if (maskSelection && !isTriviallyFullySelected(maskSelection)) return 0;
+
+    const KoColorSpace *cs = device->colorSpace();
+
+    /**
+     * KisFilter::process() uses a temporary device for such color
+     * spaces, so we cannot write into them directly
+     */
+    if (cs != device->compositionSourceColorSpace() &&
+        *cs != *device->compositionSourceColorSpace()) {
+
+        return 0;
+    }
+
+    KisFilterConfigurationSP filterConfig = filter();
+    if (!filterConfig) return 0;
+
+    KisColorTransformationConfiguration *transformationConfig =
+        dynamic_cast<KisColorTransformationConfiguration*>(filterConfig.data());
+    if (!transformationConfig) return 0;
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value(filterConfig->name());
+    const KisColorTransformationFilter *transformationFilter =
+        dynamic_cast<const KisColorTransformationFilter*>(filter.data());
+    if (!transformationFilter) return 0;
+
+    return transformationConfig->colorTransformation(cs, transformationFilter);
+}
+
 bool KisFilterMask::accept(KisNodeVisitor &v)
 {
     return v.visit(this);
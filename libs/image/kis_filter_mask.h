@@ -24,6 +24,7 @@
 #include "kis_node_filter_interface.h"
 
 class KisFilterConfiguration;
+class KoColorTransformation;
 
 /**
    An filter mask is a single channel mask that applies a particular
@@ -65,6 +66,19 @@ public:
 
     QRect changeRect(const QRect &rect, PositionToFilthy pos = N_FILTHY) const;
     QRect needRect(const QRect &rect, PositionToFilthy pos = N_FILTHY) const;
+
+    /**
+     * If the mask selects everything (it has no selection or its
+     * selection is a white default pixel without any data) and its
+     * filter is a pure per-pixel color transformation, returns the
+     * transformation that can be applied in-place onto \p device
+     * instead of calling apply().
+     * Otherwise returns null.
+     *
+     * The transformation is owned by the filter configuration and is
+     * cached per-thread, so the caller must not delete it.
+     */
+    KoColorTransformation* inplaceColorTransformation(KisPaintDeviceSP device) const;
 };
 
 #endif //_KIS_FILTER_MASK_
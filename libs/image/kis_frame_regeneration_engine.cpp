@@ -0,0 +1,337 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_frame_regeneration_engine.h"
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QVector>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoCompositeOpRegistry.h>
+
+#include "kis_assert.h"
+#include "kis_image.h"
+#include "kis_layer.h"
+#include "kis_group_layer.h"
+#include "kis_paint_layer.h"
+#include "kis_paint_device.h"
+#include "kis_paint_device_frames_interface.h"
+#include "kis_raster_keyframe_channel.h"
+#include "kis_keyframe_channel.h"
+#include "kis_painter.h"
+#include "kis_image_barrier_locker.h"
+
+
+struct KisFrameRegenerationEngine::Private
+{
+    /**
+     * A copy of the properties of a node, taken in the GUI thread,
+     * so that the worker threads would never access the node itself
+     */
+    struct NodeSnapshot {
+        NodeSnapshot()
+            : isGroup(false),
+              opacity(OPACITY_OPAQUE_U8)
+        {
+        }
+
+        bool isGroup;
+        KoColor defaultPixel;
+
+        /**
+         * Private copies of the layer's content, one per requested
+         * frame. The copies share tiles with the layer, so they are
+         * cheap, but they can safely be read from the worker threads
+         * while the user keeps painting on the layer.
+         */
+        QVector<KisPaintDeviceSP> frameDevices;
+
+        QString compositeOpId;
+        quint8 opacity;
+
+        QVector<NodeSnapshot> children;
+    };
+
+    KisImageSP image;
+    QRect bounds;
+    const KoColorSpace *colorSpace;
+
+    QList<int> frames;
+    NodeSnapshot root;
+
+    int maxConcurrentFrames;
+    QAtomicInt isCancelled;
+
+    static bool canRegenerateNode(KisNodeSP node);
+
+    NodeSnapshot createSnapshot(KisNodeSP node) const;
+    void compositeNode(const NodeSnapshot &node, int frameIndex, KisPaintDeviceSP dst) const;
+    KisPaintDeviceSP renderGroup(const NodeSnapshot &node, int frameIndex) const;
+
+    static int groupsDepth(const NodeSnapshot &node);
+
+    class FrameJob;
+};
+
+class KisFrameRegenerationEngine::Private::FrameJob : public QRunnable
+{
+public:
+    FrameJob(const Private *d, int time, FrameReadyCallback callback)
+        : m_d(d), m_time(time), m_callback(callback)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() {
+        if (m_d->isCancelled) return;
+
+        const int frameIndex = m_d->frames.indexOf(m_time);
+        m_callback(m_time, m_d->renderGroup(m_d->root, frameIndex));
+    }
+
+private:
+    const Private *m_d;
+    int m_time;
+    FrameReadyCallback m_callback;
+};
+
+bool KisFrameRegenerationEngine::Private::canRegenerateNode(KisNodeSP node)
+{
+    KisLayer *layer = dynamic_cast<KisLayer*>(node.data());
+    if (!layer) return false;
+
+    if (layer->hasEffectMasks() || layer->layerStyle()) return false;
+    if (layer->alphaChannelDisabled()) return false;
+
+    const QBitArray &channelFlags = layer->channelFlags();
+    if (!channelFlags.isEmpty() && channelFlags.count(false) > 0) return false;
+
+    /**
+     * Animated opacity and other scalar channels are not supported yet
+     */
+    Q_FOREACH (KisKeyframeChannel *channel, node->keyframeChannels()) {
+        if (channel->id() != KisKeyframeChannel::Content.id()) return false;
+    }
+
+    if (KisGroupLayer *group = dynamic_cast<KisGroupLayer*>(layer)) {
+        if (group->passThroughMode()) return false;
+
+        KisNodeSP child = node->firstChild();
+        while (child) {
+            if (child->visible() && !canRegenerateNode(child)) return false;
+            child = child->nextSibling();
+        }
+
+        return true;
+    }
+
+    return dynamic_cast<KisPaintLayer*>(layer);
+}
+
+KisFrameRegenerationEngine::Private::NodeSnapshot
+KisFrameRegenerationEngine::Private::createSnapshot(KisNodeSP node) const
+{
+    NodeSnapshot snapshot;
+
+    snapshot.compositeOpId = node->compositeOpId();
+    snapshot.opacity = node->opacity();
+
+    if (KisGroupLayer *group = dynamic_cast<KisGroupLayer*>(node.data())) {
+        snapshot.isGroup = true;
+        snapshot.defaultPixel = group->defaultProjectionColor();
+
+        KisNodeSP child = node->firstChild();
+        while (child) {
+            if (child->visible()) {
+                snapshot.children.append(createSnapshot(child));
+            }
+            child = child->nextSibling();
+        }
+    } else {
+        KisPaintDeviceSP device = node->paintDevice();
+
+        KisRasterKeyframeChannel *channel = device->keyframeChannel();
+        const int numberOfFrames = channel ? channel->keyframeCount() : 0;
+
+        KisPaintDeviceSP staticCopy;
+        QHash<int, KisPaintDeviceSP> frameCopies;
+
+        /**
+         * The same logic as in KisPaintDevice::Private::currentFrameData()
+         */
+        Q_FOREACH (int time, frames) {
+            int frameId = -1;
+
+            if (numberOfFrames > 1) {
+                frameId = channel->frameIdAt(time);
+            } else if (numberOfFrames == 1) {
+                frameId = device->framesInterface()->frames().first();
+            }
+
+            KisPaintDeviceSP copy;
+
+            if (frameId >= 0) {
+                copy = frameCopies.value(frameId);
+                if (!copy) {
+                    copy = new KisPaintDevice(device->colorSpace());
+                    device->framesInterface()->fetchFrame(frameId, copy);
+                    frameCopies.insert(frameId, copy);
+                }
+            } else {
+                if (!staticCopy) {
+                    staticCopy = new KisPaintDevice(*device);
+                }
+                copy = staticCopy;
+            }
+
+            snapshot.frameDevices.append(copy);
+        }
+    }
+
+    return snapshot;
+}
+
+void KisFrameRegenerationEngine::Private::compositeNode(const NodeSnapshot &node, int frameIndex, KisPaintDeviceSP dst) const
+{
+    KisPaintDeviceSP src;
+
+    if (node.isGroup) {
+        src = renderGroup(node, frameIndex);
+    } else {
+        src = node.frameDevices[frameIndex];
+    }
+
+    QRect needRect = bounds;
+
+    if (node.compositeOpId != COMPOSITE_COPY) {
+        needRect &= src->extent();
+    }
+
+    if (needRect.isEmpty()) return;
+
+    KisPainter gc(dst);
+    gc.setCompositeOp(node.compositeOpId);
+    gc.setOpacity(node.opacity);
+    gc.bitBlt(needRect.topLeft(), src, needRect);
+}
+
+KisPaintDeviceSP KisFrameRegenerationEngine::Private::renderGroup(const NodeSnapshot &node, int frameIndex) const
+{
+    KisPaintDeviceSP projection = new KisPaintDevice(colorSpace);
+    projection->setDefaultPixel(node.defaultPixel);
+
+    Q_FOREACH (const NodeSnapshot &child, node.children) {
+        if (isCancelled) break;
+        compositeNode(child, frameIndex, projection);
+    }
+
+    return projection;
+}
+
+int KisFrameRegenerationEngine::Private::groupsDepth(const NodeSnapshot &node)
+{
+    if (!node.isGroup) return 0;
+
+    int childrenDepth = 0;
+    Q_FOREACH (const NodeSnapshot &child, node.children) {
+        childrenDepth = qMax(childrenDepth, groupsDepth(child));
+    }
+
+    return childrenDepth + 1;
+}
+
+
+KisFrameRegenerationEngine::KisFrameRegenerationEngine(KisImageSP image, const QList<int> &frames,
+                                                       int maxThreads, qint64 memoryLimit)
+    : m_d(new Private)
+{
+    m_d->image = image;
+    m_d->bounds = image->bounds();
+    m_d->colorSpace = image->colorSpace();
+    m_d->frames = frames;
+
+    {
+        /**
+         * The workers never touch the nodes or their devices, they
+         * read only the copies made here, while no stroke can modify
+         * the image.
+         */
+        KisImageBarrierLocker locker(image);
+        m_d->root = m_d->createSnapshot(image->root());
+    }
+
+    /**
+     * Every frame in flight keeps a projection for the root and for
+     * every nesting level of the groups, plus the fetched frame of
+     * the layer being merged. The deepest branch of the whole tree
+     * defines the worst case.
+     */
+    const int depth = Private::groupsDepth(m_d->root) + 1;
+
+    const qint64 frameMemory =
+        qint64(m_d->bounds.width()) * m_d->bounds.height() *
+        m_d->colorSpace->pixelSize() * (depth + 1);
+
+    m_d->maxConcurrentFrames =
+        qBound(1, int(memoryLimit / qMax(frameMemory, qint64(1))), qMax(1, maxThreads));
+}
+
+KisFrameRegenerationEngine::~KisFrameRegenerationEngine()
+{
+}
+
+bool KisFrameRegenerationEngine::canRegenerateFrames(KisImageSP image)
+{
+    if (image->isolatedModeRoot()) return false;
+
+    return Private::canRegenerateNode(image->root());
+}
+
+int KisFrameRegenerationEngine::maxConcurrentFrames() const
+{
+    return m_d->maxConcurrentFrames;
+}
+
+void KisFrameRegenerationEngine::regenerateFrames(FrameReadyCallback callback)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_d->maxConcurrentFrames);
+
+    Q_FOREACH (int time, m_d->frames) {
+        pool.start(new Private::FrameJob(m_d.data(), time, callback));
+    }
+
+    pool.waitForDone();
+}
+
+KisPaintDeviceSP KisFrameRegenerationEngine::regenerateFrame(int time) const
+{
+    const int frameIndex = m_d->frames.indexOf(time);
+    KIS_ASSERT_RECOVER_RETURN_VALUE(frameIndex >= 0, 0);
+
+    return m_d->renderGroup(m_d->root, frameIndex);
+}
+
+void KisFrameRegenerationEngine::cancel()
+{
+    m_d->isCancelled.store(1);
+}
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_FRAME_REGENERATION_ENGINE_H
+#define __KIS_FRAME_REGENERATION_ENGINE_H
+
+#include <functional>
+
+#include <QList>
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+
+/**
+ * Renders several animation frames of an image concurrently, without
+ * switching the current time of the image.
+ *
+ * The usual way of getting a frame, KisRegenerateFrameStrokeStrategy,
+ * switches the image into the "external frame" mode and recalculates
+ * the whole projection in a stroke, so the frames can be generated only
+ * one at a time. The engine, instead, takes a snapshot of the layer
+ * stack in its constructor, copying the content of every layer for
+ * every requested frame under the barrier lock of the image. Then it
+ * merges every frame into its own private projection device, reading
+ * only these copies, so the user may keep editing the image while the
+ * frames are being rendered.
+ *
+ * Only simple layer stacks can be rendered this way: paint and group
+ * layers without masks, layer styles, channel flags or animated
+ * properties. Use canRegenerateFrames() to check if the image can be
+ * handled by the engine, and fall back to the stroke-based
+ * regeneration otherwise.
+ *
+ * The number of frames rendered at the same time is limited both by
+ * the number of threads and by the memory budget passed to the
+ * constructor.
+ */
+class KRITAIMAGE_EXPORT KisFrameRegenerationEngine
+{
+public:
+    /**
+     * The callback is called from the worker threads as soon as a frame
+     * is ready, so it must be thread-safe. The frames come in
+     * arbitrary order.
+     */
+    typedef std::function<void (int /*time*/, KisPaintDeviceSP /*projection*/)> FrameReadyCallback;
+
+public:
+    /**
+     * Takes a snapshot of the layer stack of \p image needed to
+     * render \p frames. Must be called from the GUI thread. The
+     * constructor takes the barrier lock of the image, so it waits
+     * for all the running strokes to finish.
+     *
+     * \param maxThreads the maximum number of frames rendered at once
+     * \param memoryLimit the memory budget for the projections of the
+     *        frames rendered at once, in bytes
+     */
+    KisFrameRegenerationEngine(KisImageSP image, const QList<int> &frames,
+                               int maxThreads, qint64 memoryLimit);
+    ~KisFrameRegenerationEngine();
+
+    /**
+     * \return true if all the nodes of the image can be merged by
+     * the engine
+     */
+    static bool canRegenerateFrames(KisImageSP image);
+
+    /**
+     * \return the number of frames that will be rendered concurrently
+     */
+    int maxConcurrentFrames() const;
+
+    /**
+     * Renders all the frames passed to the constructor, calling
+     * \p callback for every rendered frame. Blocks until all the
+     * frames are ready or the rendering is cancelled.
+     */
+    void regenerateFrames(FrameReadyCallback callback);
+
+    /**
+     * Renders a single frame into a new device. The frame must be one
+     * of the frames passed to the constructor. Thread-safe.
+     */
+    KisPaintDeviceSP regenerateFrame(int time) const;
+
+    /**
+     * Stops rendering of the frames that have not been started yet.
+     * Can be called from any thread.
+     */
+    void cancel();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_FRAME_REGENERATION_ENGINE_H */
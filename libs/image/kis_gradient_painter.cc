@@ -519,6 +519,21 @@ struct Q_DECL_HIDDEN KisGradientPainter::Private
     QVector<ProcessRegion> processRegions;
 };
 
+struct KisGradientPainter::PreparedGradient
+{
+    struct Region {
+        QSharedPointer<KisGradientShapeStrategy> shapeStrategy;
+        QSharedPointer<CachedGradient> cachedGradient;
+        QRect processRect;
+    };
+
+    QVector<Region> regions;
+    QRect bounds;
+    const GradientRepeatStrategy *repeatStrategy;
+    bool reverseGradient;
+    const KoColorSpace *colorSpace;
+};
+
 KisGradientPainter::KisGradientPainter()
     : m_d(new Private())
 {
@@ -622,10 +637,28 @@ bool KisGradientPainter::paintGradient(const QPointF& gradientVectorStart,
                                        double antiAliasThreshold,
                                        bool reverseGradient,
                                        const QRect &applyRect)
+{
+    PreparedGradientSP prepared =
+        prepareGradient(gradientVectorStart, gradientVectorEnd,
+                        repeat, antiAliasThreshold, reverseGradient,
+                        applyRect);
+
+    if (!prepared) return false;
+
+    return paintGradientPatch(prepared, prepared->bounds);
+}
+
+KisGradientPainter::PreparedGradientSP
+KisGradientPainter::prepareGradient(const QPointF& gradientVectorStart,
+                                    const QPointF& gradientVectorEnd,
+                                    enumGradientRepeat repeat,
+                                    double antiAliasThreshold,
+                                    bool reverseGradient,
+                                    const QRect &applyRect)
 {
     Q_UNUSED(antiAliasThreshold);
 
-    if (!gradient()) return false;
+    if (!gradient()) return PreparedGradientSP();
 
     QRect requestedRect = applyRect;
 
@@ -634,8 +667,6 @@ bool KisGradientPainter::paintGradient(const QPointF& gradientVectorStart,
         requestedRect &= selection()->selectedExactRect();
     }
 
-    QSharedPointer<KisGradientShapeStrategy> shapeStrategy;
-
     switch (m_d->shape) {
     case GradientShapeLinear: {
         Private::ProcessRegion r(toQShared(new LinearGradientStrategy(gradientVectorStart, gradientVectorEnd)),
@@ -700,17 +731,52 @@ bool KisGradientPainter::paintGradient(const QPointF& gradientVectorStart,
     }
     Q_ASSERT(repeatStrategy != 0);
 
+    PreparedGradient *prepared = new PreparedGradient();
+    prepared->repeatStrategy = repeatStrategy;
+    prepared->reverseGradient = reverseGradient;
+    prepared->colorSpace = device()->compositionSourceColorSpace();
+
+    Q_FOREACH (const Private::ProcessRegion &r, m_d->processRegions) {
+        PreparedGradient::Region region;
+        region.shapeStrategy = r.precalculatedShapeStrategy;
+        region.processRect = r.processRect;
+
+        /**
+         * The lookup table is built once for the whole region, so all
+         * the patches share the same color steps
+         */
+        region.cachedGradient =
+            toQShared(new CachedGradient(gradient(),
+                                         qMax(r.processRect.width(), r.processRect.height()),
+                                         prepared->colorSpace));
+
+        prepared->regions << region;
+        prepared->bounds |= r.processRect;
+    }
+
+    return PreparedGradientSP(prepared);
+}
+
+bool KisGradientPainter::paintGradientPatch(PreparedGradientSP prepared, const QRect &patchRect)
+{
+    KIS_ASSERT_RECOVER_RETURN_VALUE(prepared, false);
 
     KisPaintDeviceSP dev = device()->createCompositionSourceDevice();
 
     const KoColorSpace * colorSpace = dev->colorSpace();
     const qint32 pixelSize = colorSpace->pixelSize();
 
-    Q_FOREACH (const Private::ProcessRegion &r, m_d->processRegions) {
-        QRect processRect = r.processRect;
-        QSharedPointer<KisGradientShapeStrategy> shapeStrategy = r.precalculatedShapeStrategy;
+    KIS_ASSERT_RECOVER_RETURN_VALUE(*colorSpace == *prepared->colorSpace, false);
+
+    const GradientRepeatStrategy *repeatStrategy = prepared->repeatStrategy;
+    const bool reverseGradient = prepared->reverseGradient;
+
+    Q_FOREACH (const PreparedGradient::Region &r, prepared->regions) {
+        QRect processRect = r.processRect & patchRect;
+        if (processRect.isEmpty()) continue;
 
-        CachedGradient cachedGradient(gradient(), qMax(processRect.width(), processRect.height()), colorSpace);
+        QSharedPointer<KisGradientShapeStrategy> shapeStrategy = r.shapeStrategy;
+        QSharedPointer<CachedGradient> cachedGradient = r.cachedGradient;
 
         KisSequentialIterator it(dev, processRect);
         const int rightCol = processRect.right();
@@ -724,7 +790,7 @@ bool KisGradientPainter::paintGradient(const QPointF& gradientVectorStart,
                 t = 1 - t;
             }
 
-            memcpy(it.rawData(), cachedGradient.cachedAt(t), pixelSize);
+            memcpy(it.rawData(), cachedGradient->cachedAt(t), pixelSize);
 
             if (it.x() == rightCol) {
                 progressHelper.step();
@@ -19,6 +19,7 @@
 #define KIS_GRADIENT_PAINTER_H_
 
 #include <QScopedPointer>
+#include <QSharedPointer>
 
 #include <KoColor.h>
 
@@ -83,6 +84,34 @@ public:
                        bool reverseGradient,
                        const QRect &applyRect);
 
+    /**
+     * The shape strategies and the color lookup tables precalculated
+     * for a gradient. The object is immutable, so it can be shared by
+     * several painters rendering separate patches of the same gradient
+     * concurrently.
+     */
+    struct PreparedGradient;
+    typedef QSharedPointer<const PreparedGradient> PreparedGradientSP;
+
+    /**
+     * Does all the preparations paintGradient() would do for \p
+     * applyRect without painting anything. Returns a null pointer if
+     * the painter has no gradient set.
+     */
+    PreparedGradientSP prepareGradient(const QPointF& gradientVectorStart,
+                                       const QPointF& gradientVectorEnd,
+                                       enumGradientRepeat repeat,
+                                       double antiAliasThreshold,
+                                       bool reverseGradient,
+                                       const QRect &applyRect);
+
+    /**
+     * Paints the part of a \p prepared gradient that falls into \p
+     * patchRect. The painter must paint on the same device the
+     * gradient has been prepared for.
+     */
+    bool paintGradientPatch(PreparedGradientSP prepared, const QRect &patchRect);
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
@@ -1561,6 +1561,11 @@ void KisImage::setDesiredLevelOfDetail(int lod)
     m_d->scheduler.setDesiredLevelOfDetail(lod);
 }
 
+void KisImage::setUpdatePriorityHint(const QRect &visibleRect, const QPointF &focusPoint)
+{
+    m_d->scheduler.setUpdatePriorityHint(visibleRect, focusPoint);
+}
+
 int KisImage::currentLevelOfDetail() const
 {
     if (m_d->blockLevelOfDetail) {
@@ -534,6 +534,13 @@ public:
      */
     void setDesiredLevelOfDetail(int lod);
 
+    /**
+     * Notify KisImage which part of it is visible to the user and
+     * where the cursor is. The projection updates of these areas are
+     * processed first. An empty \p visibleRect removes the hint.
+     */
+    void setUpdatePriorityHint(const QRect &visibleRect, const QPointF &focusPoint);
+
 public Q_SLOTS:
 
     /**
@@ -79,6 +79,22 @@ void KisImageConfig::setEnablePerfLog(bool value)
     m_config.writeEntry("enablePerfLog", value);
 }
 
+bool KisImageConfig::enableTracing(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("enableTracing", false) : false;
+}
+
+void KisImageConfig::setEnableTracing(bool value)
+{
+    m_config.writeEntry("enableTracing", value);
+}
+
+int KisImageConfig::traceBufferSize() const
+{
+    return m_config.readEntry("traceBufferSize", 65536);
+}
+
 qreal KisImageConfig::transformMaskOffBoundsReadArea() const
 {
     return m_config.readEntry("transformMaskOffBoundsReadArea", 0.5);
@@ -178,6 +194,35 @@ int KisImageConfig::tilesSoftLimit() const
     return tilesHardLimit() * sp;
 }
 
+int KisImageConfig::undoMemoryLimit() const
+{
+    qreal up = qreal(undoMemoryLimitPercent()) / 100.0;
+
+    return tilesHardLimit() * up;
+}
+
+qreal KisImageConfig::undoMemoryLimitPercent(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("undoMemoryLimitPercent", 50.) : 50.;
+}
+
+void KisImageConfig::setUndoMemoryLimitPercent(qreal value)
+{
+    m_config.writeEntry("undoMemoryLimitPercent", value);
+}
+
+bool KisImageConfig::compressUndoHistory(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("compressUndoHistory", true) : true;
+}
+
+void KisImageConfig::setCompressUndoHistory(bool value)
+{
+    m_config.writeEntry("compressUndoHistory", value);
+}
+
 int KisImageConfig::poolLimit() const
 {
     qreal hp = qreal(memoryHardLimitPercent()) / 100.0;
@@ -453,3 +498,14 @@ void KisImageConfig::setUseLodForColorizeMask(bool value)
 {
     m_config.writeEntry("useLodForColorizeMask", value);
 }
+
+bool KisImageConfig::parallelDabGeneration(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("parallelDabGeneration", true) : true;
+}
+
+void KisImageConfig::setParallelDabGeneration(bool value)
+{
+    m_config.writeEntry("parallelDabGeneration", value);
+}
@@ -36,6 +36,11 @@ public:
     bool enablePerfLog(bool requestDefault = false) const;
     void setEnablePerfLog(bool value);
 
+    bool enableTracing(bool requestDefault = false) const;
+    void setEnableTracing(bool value);
+
+    int traceBufferSize() const; // events per thread
+
     qreal transformMaskOffBoundsReadArea() const;
 
     int updatePatchHeight() const;
@@ -69,6 +74,18 @@ public:
     void setMemorySoftLimitPercent(qreal value);
     void setMemoryPoolLimitPercent(qreal value);
 
+    int undoMemoryLimit() const; // MiB, 0 means no limit
+    qreal undoMemoryLimitPercent(bool requestDefault = false) const; // % of tilesHardLimit()
+    void setUndoMemoryLimitPercent(qreal value);
+
+    /**
+     * When the soft memory limit is exceeded, swap out (and thus
+     * compress) all the undo tiles that have not been accessed for
+     * a while, not only the amount needed to get below the limit
+     */
+    bool compressUndoHistory(bool requestDefault = false) const;
+    void setCompressUndoHistory(bool value);
+
     static int totalRAM(); // MiB
 
     /**
@@ -111,6 +128,9 @@ public:
     bool useLodForColorizeMask(bool requestDefault = false) const;
     void setUseLodForColorizeMask(bool value);
 
+    bool parallelDabGeneration(bool requestDefault = false) const;
+    void setParallelDabGeneration(bool value);
+
 
 private:
     Q_DISABLE_COPY(KisImageConfig)
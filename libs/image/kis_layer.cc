@@ -33,6 +33,7 @@
 #include <KoProperties.h>
 #include <KoCompositeOpRegistry.h>
 #include <KoColorSpace.h>
+#include <KoColorTransformation.h>
 
 #include "kis_debug.h"
 #include "kis_image.h"
@@ -41,6 +42,9 @@
 #include "kis_mask.h"
 #include "kis_effect_mask.h"
 #include "kis_selection_mask.h"
+#include "kis_filter_mask.h"
+#include "kis_sequential_iterator.h"
+#include "kis_busy_progress_indicator.h"
 #include "kis_meta_data_store.h"
 #include "kis_selection.h"
 #include "kis_paint_layer.h"
@@ -564,6 +568,31 @@ KisNode::PositionToFilthy calculatePositionToFilthy(KisNodeSP nodeInQuestion,
     return KisNode::N_BELOW_FILTHY;
 }
 
+/**
+ * Applies the color transformations of a run of consecutive filter
+ * masks in a single pass over \p rect, so every pixel is fetched from
+ * memory once for the whole run instead of once per mask
+ */
+void applyFusedColorTransformations(KisPaintDeviceSP device,
+                                    const QRect &rect,
+                                    const QVector<KoColorTransformation*> &transformations)
+{
+    if (transformations.isEmpty() || rect.isEmpty()) return;
+
+    const int numTransformations = transformations.size();
+
+    KisSequentialIterator it(device, rect);
+    int conseq;
+    do {
+        conseq = it.nConseqPixels();
+        quint8 *data = it.rawData();
+
+        for (int i = 0; i < numTransformations; i++) {
+            transformations[i]->transform(data, data, conseq);
+        }
+    } while (it.nextPixels(conseq));
+}
+
 QRect KisLayer::applyMasks(const KisPaintDeviceSP source,
                            KisPaintDeviceSP destination,
                            const QRect &requestedRect,
@@ -612,14 +641,48 @@ QRect KisLayer::applyMasks(const KisPaintDeviceSP source,
                 copyOriginalToProjection(source, destination, needRect);
             }
 
+            /**
+             * Consecutive filter masks doing pure per-pixel color
+             * transformations are fused: their transformations are
+             * applied one after another while the pixels are still
+             * in cache, without cloning the destination for every
+             * mask.
+             */
+            QVector<KoColorTransformation*> fusedTransformations;
+            QRect fusedRect;
+
             Q_FOREACH (const KisEffectMaskSP& mask, masks) {
                 const QRect maskApplyRect = applyRects.pop();
                 const QRect maskNeedRect =
                     applyRects.isEmpty() ? needRect : applyRects.top();
 
+                KisFilterMask *filterMask = dynamic_cast<KisFilterMask*>(mask.data());
+                KoColorTransformation *transformation =
+                    filterMask ? filterMask->inplaceColorTransformation(destination) : 0;
+
+                if (transformation) {
+                    if (fusedRect != maskApplyRect) {
+                        applyFusedColorTransformations(destination, fusedRect, fusedTransformations);
+                        fusedTransformations.clear();
+                        fusedRect = maskApplyRect;
+                    }
+
+                    fusedTransformations.append(transformation);
+
+                    KisBusyProgressIndicator *indicator = mask->busyProgressIndicator();
+                    if (indicator) {
+                        indicator->update();
+                    }
+                    continue;
+                }
+
+                applyFusedColorTransformations(destination, fusedRect, fusedTransformations);
+                fusedTransformations.clear();
+
                 PositionToFilthy maskPosition = calculatePositionToFilthy(mask, filthyNode, const_cast<KisLayer*>(this));
                 mask->apply(destination, maskApplyRect, maskNeedRect, maskPosition);
             }
+            applyFusedColorTransformations(destination, fusedRect, fusedTransformations);
             Q_ASSERT(applyRects.isEmpty());
         } else {
             /**
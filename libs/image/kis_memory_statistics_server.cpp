@@ -19,6 +19,8 @@
 #include "kis_memory_statistics_server.h"
 
 #include <QGlobalStatic>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "kis_image.h"
 #include "kis_image_config.h"
@@ -31,11 +33,19 @@ Q_GLOBAL_STATIC(KisMemoryStatisticsServer, s_instance)
 struct Q_DECL_HIDDEN KisMemoryStatisticsServer::Private
 {
     Private()
-        : updateCompressor(1000 /* ms */, KisSignalCompressor::POSTPONE)
+        : updateCompressor(1000 /* ms */, KisSignalCompressor::POSTPONE),
+          frameCacheSize(0),
+          frameCacheUncompressedSize(0),
+          frameCacheEvictions(0)
     {
     }
 
     KisSignalCompressor updateCompressor;
+
+    QMutex frameCacheLock;
+    qint64 frameCacheSize;
+    qint64 frameCacheUncompressedSize;
+    qint64 frameCacheEvictions;
 };
 
 
@@ -116,9 +126,37 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     stats.tilesPoolLimit = cfg.poolLimit() * MiB;
     stats.totalMemoryLimit = stats.tilesHardLimit + stats.tilesPoolLimit;
 
+    {
+        QMutexLocker l(&m_d->frameCacheLock);
+        stats.frameCacheSize = m_d->frameCacheSize;
+        stats.frameCacheUncompressedSize = m_d->frameCacheUncompressedSize;
+        stats.frameCacheEvictions = m_d->frameCacheEvictions;
+    }
+
     return stats;
 }
 
+void KisMemoryStatisticsServer::notifyFrameCacheMemoryChanged(qint64 memoryDelta, qint64 uncompressedDelta)
+{
+    {
+        QMutexLocker l(&m_d->frameCacheLock);
+        m_d->frameCacheSize += memoryDelta;
+        m_d->frameCacheUncompressedSize += uncompressedDelta;
+    }
+
+    notifyImageChanged();
+}
+
+void KisMemoryStatisticsServer::notifyFrameCacheEviction(int numFrames)
+{
+    {
+        QMutexLocker l(&m_d->frameCacheLock);
+        m_d->frameCacheEvictions += numFrames;
+    }
+
+    notifyImageChanged();
+}
+
 void KisMemoryStatisticsServer::notifyImageChanged()
 {
     m_d->updateCompressor.start();
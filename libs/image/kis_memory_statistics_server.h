@@ -46,7 +46,11 @@ public:
               totalMemoryLimit(0),
               tilesHardLimit(0),
               tilesSoftLimit(0),
-              tilesPoolLimit(0)
+              tilesPoolLimit(0),
+
+              frameCacheSize(0),
+              frameCacheUncompressedSize(0),
+              frameCacheEvictions(0)
         {
         }
 
@@ -63,6 +67,10 @@ public:
         qint64 tilesHardLimit;
         qint64 tilesSoftLimit;
         qint64 tilesPoolLimit;
+
+        qint64 frameCacheSize;
+        qint64 frameCacheUncompressedSize;
+        qint64 frameCacheEvictions;
     };
 
 
@@ -74,6 +82,21 @@ public:
 
     Statistics fetchMemoryStatistics(KisImageSP image) const;
 
+    /**
+     * Animation frame caches live in kritaui, so they report the
+     * changes of their memory consumption themselves. \p memoryDelta
+     * is the change of the real (compressed) size of the cached
+     * frames, \p uncompressedDelta is the change of the size the
+     * frames would occupy without compression.
+     */
+    void notifyFrameCacheMemoryChanged(qint64 memoryDelta, qint64 uncompressedDelta);
+
+    /**
+     * Called by the animation frame caches when \p numFrames frames
+     * have been dropped to fit the memory budget
+     */
+    void notifyFrameCacheEviction(int numFrames);
+
 public Q_SLOTS:
     void notifyImageChanged();
 
@@ -21,6 +21,7 @@
 #include <QReadWriteLock>
 #include <QReadLocker>
 #include <QWriteLocker>
+#include <QHash>
 
 
 #include "kis_paint_device.h"
@@ -29,37 +30,148 @@
 #include "kis_image.h"
 
 #include "kis_raster_keyframe_channel.h"
+#include "kis_paint_device_frames_interface.h"
 
 
 struct KisOnionSkinCache::Private
 {
+    /**
+     * A tinted copy of a keyframe. The frame is tinted only once and
+     * then reused until its content, offset or the tint options change.
+     */
+    struct CachedFrame {
+        KisPaintDeviceSP device;
+        int revision = -1;
+        QPoint offset;
+        int tintSeqNo = -1;
+        const KoColorSpace *colorSpace = 0;
+    };
+
+    /**
+     * The state of a skin used for generating the cached projection
+     */
+    struct SkinState {
+        int frameId;
+        int revision;
+        QPoint offset;
+        int opacity;
+        bool backward;
+
+        bool operator==(const SkinState &rhs) const {
+            return frameId == rhs.frameId &&
+                revision == rhs.revision &&
+                offset == rhs.offset &&
+                opacity == rhs.opacity &&
+                backward == rhs.backward;
+        }
+    };
+
+    typedef QPair<int, bool> FrameKey;
+
     KisPaintDeviceSP cachedProjection;
+    QHash<FrameKey, CachedFrame> tintedFrames;
 
-    int cacheTime = 0;
+    QVector<SkinState> cachedSkins;
     int cacheConfigSeqNo = 0;
-    int framesHash = 0;
-    QReadWriteLock lock;
+    int cacheTintSeqNo = 0;
+    mutable QReadWriteLock lock;
+
+    int regenerationCount = 0;
+    int tintCount = 0;
+
+    QVector<SkinState> calculateSkinStates(KisPaintDeviceSP source,
+                                           const QVector<KisOnionSkinCompositor::SkinFrame> &skins) {
+        KisRasterKeyframeChannel *keyframes = source->keyframeChannel();
+        QVector<SkinState> states;
+        states.reserve(skins.size());
+
+        Q_FOREACH (const KisOnionSkinCompositor::SkinFrame &skin, skins) {
+            const int frameId = keyframes->frameId(skin.keyframe);
+
+            SkinState state;
+            state.frameId = frameId;
+            state.revision = keyframes->frameRevision(skin.keyframe);
+            state.offset = source->framesInterface()->frameOffset(frameId);
+            state.opacity = skin.opacity;
+            state.backward = skin.offset < 0;
+            states << state;
+        }
+
+        return states;
+    }
 
     bool checkCacheValid(KisPaintDeviceSP source, KisOnionSkinCompositor *compositor) {
-        const KisRasterKeyframeChannel *keyframes = source->keyframeChannel();
+        if (!(*cachedProjection->colorSpace() == *source->colorSpace()) ||
+            cacheConfigSeqNo != compositor->configSeqNo() ||
+            cacheTintSeqNo != compositor->tintSeqNo()) {
+
+            return false;
+        }
+
+        return cachedSkins == calculateSkinStates(source, compositor->visibleSkins(source));
+    }
+
+    KisPaintDeviceSP tintedFrame(KisPaintDeviceSP source, KisOnionSkinCompositor *compositor,
+                                 const KisOnionSkinCompositor::SkinFrame &skin, const SkinState &state) {
+
+        const FrameKey key(state.frameId, state.backward);
+        CachedFrame &frame = tintedFrames[key];
+
+        const int tintSeqNo = compositor->tintSeqNo();
+
+        if (!frame.device ||
+            frame.revision != state.revision ||
+            frame.offset != state.offset ||
+            frame.tintSeqNo != tintSeqNo ||
+            frame.colorSpace != source->colorSpace()) {
 
-        const int time = source->defaultBounds()->currentTime();
-        const int seqNo = compositor->configSeqNo();
-        const int hash = keyframes->framesHash();
+            KisRasterKeyframeChannel *keyframes = source->keyframeChannel();
 
-        return time == cacheTime && cacheConfigSeqNo == seqNo && framesHash == hash;
+            tintCount++;
+
+            frame.device = new KisPaintDevice(source->colorSpace());
+            compositor->tintFrame(keyframes, skin.keyframe, state.backward,
+                                  frame.device, keyframes->frameExtents(skin.keyframe));
+
+            frame.revision = state.revision;
+            frame.offset = state.offset;
+            frame.tintSeqNo = tintSeqNo;
+            frame.colorSpace = source->colorSpace();
+        }
+
+        return frame.device;
     }
 
-    void updateCacheMetrics(KisPaintDeviceSP source, KisOnionSkinCompositor *compositor) {
-        const KisRasterKeyframeChannel *keyframes = source->keyframeChannel();
+    void compositeSkins(KisPaintDeviceSP source, KisOnionSkinCompositor *compositor,
+                        KisPaintDeviceSP dstDevice, const QRect &rect) {
+
+        const QVector<KisOnionSkinCompositor::SkinFrame> skins = compositor->visibleSkins(source);
+        const QVector<SkinState> states = calculateSkinStates(source, skins);
+
+        QHash<FrameKey, CachedFrame> usedFrames;
+        QVector<KisOnionSkinCompositor::TintedFrame> frames;
+
+        for (int i = 0; i < skins.size(); i++) {
+            KisOnionSkinCompositor::TintedFrame frame;
+            frame.device = tintedFrame(source, compositor, skins[i], states[i]);
+            frame.opacity = skins[i].opacity;
+            frames << frame;
+
+            const FrameKey key(states[i].frameId, states[i].backward);
+            usedFrames.insert(key, tintedFrames.value(key));
+        }
+
+        KisOnionSkinCompositor::compositeTintedFrames(frames, dstDevice, rect);
 
-        const int time = source->defaultBounds()->currentTime();
-        const int seqNo = compositor->configSeqNo();
-        const int hash = keyframes->framesHash();
+        /**
+         * Keep only the frames that are visible right now. When the user
+         * moves to the neighbouring frame, most of them will be reused.
+         */
+        tintedFrames = usedFrames;
 
-        cacheTime = time;
-        cacheConfigSeqNo = seqNo;
-        framesHash = hash;
+        cachedSkins = states;
+        cacheConfigSeqNo = compositor->configSeqNo();
+        cacheTintSeqNo = compositor->tintSeqNo();
     }
 };
 
@@ -88,15 +200,19 @@ KisPaintDeviceSP KisOnionSkinCache::projection(KisPaintDeviceSP source)
         cachedProjection = m_d->cachedProjection;
         if (!cachedProjection || !m_d->checkCacheValid(source, compositor)) {
 
-            if (!cachedProjection) {
+            if (!cachedProjection ||
+                !(*cachedProjection->colorSpace() == *source->colorSpace())) {
+
                 cachedProjection = new KisPaintDevice(source->colorSpace());
             } else {
                 cachedProjection->setDefaultBounds(new KisDefaultBounds());
                 cachedProjection->clear();
             }
 
+            m_d->regenerationCount++;
+
             const QRect extent = compositor->calculateExtent(source);
-            compositor->composite(source, cachedProjection, extent);
+            m_d->compositeSkins(source, compositor, cachedProjection, extent);
 
             cachedProjection->setDefaultBounds(source->defaultBounds());
 
@@ -112,7 +228,6 @@ KisPaintDeviceSP KisOnionSkinCache::projection(KisPaintDeviceSP source)
                 cachedProjection->uploadLodDataStruct(data);
             }
 
-            m_d->updateCacheMetrics(source, compositor);
             m_d->cachedProjection = cachedProjection;
         }
     }
@@ -124,9 +239,23 @@ void KisOnionSkinCache::reset()
 {
     QWriteLocker writeLocker(&m_d->lock);
     m_d->cachedProjection = 0;
+    m_d->tintedFrames.clear();
+    m_d->cachedSkins.clear();
 }
 
 KisPaintDeviceSP KisOnionSkinCache::lodCapableDevice() const
 {
     return m_d->cachedProjection;
 }
+
+int KisOnionSkinCache::regenerationCount() const
+{
+    QReadLocker readLocker(&m_d->lock);
+    return m_d->regenerationCount;
+}
+
+int KisOnionSkinCache::tintCount() const
+{
+    QReadLocker readLocker(&m_d->lock);
+    return m_d->tintCount;
+}
@@ -34,6 +34,18 @@ public:
 
     KisPaintDeviceSP lodCapableDevice() const;
 
+    /**
+     * The number of times the cached projection has been regenerated
+     * since the cache was created (for testing purposes)
+     */
+    int regenerationCount() const;
+
+    /**
+     * The number of times a skin frame has been tinted since the
+     * cache was created (for testing purposes)
+     */
+    int tintCount() const;
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
@@ -22,6 +22,7 @@
 #include "kis_painter.h"
 #include "KoColor.h"
 #include "KoColorSpace.h"
+#include "KoCompositeOp.h"
 #include "KoCompositeOpRegistry.h"
 #include "KoColorSpaceConstants.h"
 
@@ -30,6 +31,22 @@
 
 Q_GLOBAL_STATIC(KisOnionSkinCompositor, s_instance);
 
+namespace {
+
+/**
+ * The area of \p device that can affect the result of compositing. If the
+ * default pixel of the device is not transparent, it is the whole \p rect.
+ */
+QRect effectiveExtent(KisPaintDeviceSP device, const QRect &rect)
+{
+    const KoColor defaultPixel = device->defaultPixel();
+
+    return defaultPixel.opacityU8() == OPACITY_TRANSPARENT_U8 ?
+        device->extent() & rect : rect;
+}
+
+}
+
 struct KisOnionSkinCompositor::Private
 {
     int numberOfSkins = 0;
@@ -39,6 +56,7 @@ struct KisOnionSkinCompositor::Private
     QVector<int> backwardOpacities;
     QVector<int> forwardOpacities;
     int configSeqNo = 0;
+    int tintSeqNo = 0;
     QList<int> colorLabelFilter;
 
     int skinOpacity(int offset)
@@ -73,26 +91,26 @@ struct KisOnionSkinCompositor::Private
         return keyframe;
     }
 
-    void tryCompositeFrame(KisRasterKeyframeChannel *keyframes, KisKeyframeSP keyframe, KisPainter &gcFrame, KisPainter &gcDest, KisPaintDeviceSP tintSource, int opacity, const QRect &rect)
-    {
-        if (keyframe.isNull() || opacity == OPACITY_TRANSPARENT_U8) return;
-
-        keyframes->fetchFrame(keyframe, gcFrame.device());
-
-        gcFrame.bitBlt(rect.topLeft(), tintSource, rect);
-
-        gcDest.setOpacity(opacity);
-        gcDest.bitBlt(rect.topLeft(), gcFrame.device(), rect);
-    }
-
     void refreshConfig()
     {
         KisImageConfig config;
 
         numberOfSkins = config.numberOfOnionSkins();
-        tintFactor = config.onionSkinTintFactor();
-        backwardTintColor = config.onionSkinTintColorBackward();
-        forwardTintColor = config.onionSkinTintColorForward();
+
+        const int newTintFactor = config.onionSkinTintFactor();
+        const QColor newBackwardTintColor = config.onionSkinTintColorBackward();
+        const QColor newForwardTintColor = config.onionSkinTintColorForward();
+
+        if (!configSeqNo ||
+            newTintFactor != tintFactor ||
+            newBackwardTintColor != backwardTintColor ||
+            newForwardTintColor != forwardTintColor) {
+
+            tintFactor = newTintFactor;
+            backwardTintColor = newBackwardTintColor;
+            forwardTintColor = newForwardTintColor;
+            tintSeqNo++;
+        }
 
         backwardOpacities.resize(numberOfSkins);
         forwardOpacities.resize(numberOfSkins);
@@ -131,6 +149,11 @@ int KisOnionSkinCompositor::configSeqNo() const
     return m_d->configSeqNo;
 }
 
+int KisOnionSkinCompositor::tintSeqNo() const
+{
+    return m_d->tintSeqNo;
+}
+
 void KisOnionSkinCompositor::setColorLabelFilter(QList<int> colors)
 {
     m_d->colorLabelFilter = colors;
@@ -140,22 +163,31 @@ void KisOnionSkinCompositor::composite(const KisPaintDeviceSP sourceDevice, KisP
 {
     KisRasterKeyframeChannel *keyframes = sourceDevice->keyframeChannel();
 
-    KisPaintDeviceSP frameDevice = new KisPaintDevice(sourceDevice->colorSpace());
-    KisPainter gcFrame(frameDevice);
-    QBitArray channelFlags = targetDevice->colorSpace()->channelFlags(true, false);
-    gcFrame.setChannelFlags(channelFlags);
-    gcFrame.setOpacity(m_d->tintFactor);
+    QVector<TintedFrame> frames;
 
-    KisPaintDeviceSP backwardTintDevice = m_d->setUpTintDevice(m_d->backwardTintColor, sourceDevice->colorSpace());
-    KisPaintDeviceSP forwardTintDevice = m_d->setUpTintDevice(m_d->forwardTintColor, sourceDevice->colorSpace());
+    Q_FOREACH (const SkinFrame &skin, visibleSkins(sourceDevice)) {
+        TintedFrame frame;
+        frame.device = new KisPaintDevice(sourceDevice->colorSpace());
+        frame.opacity = skin.opacity;
 
-    KisPainter gcDest(targetDevice);
-    gcDest.setCompositeOp(sourceDevice->colorSpace()->compositeOp(COMPOSITE_BEHIND));
+        tintFrame(keyframes, skin.keyframe, skin.offset < 0, frame.device, rect);
+        frames << frame;
+    }
+
+    compositeTintedFrames(frames, targetDevice, rect);
+}
+
+QVector<KisOnionSkinCompositor::SkinFrame> KisOnionSkinCompositor::visibleSkins(const KisPaintDeviceSP device)
+{
+    QVector<SkinFrame> skins;
+
+    KisRasterKeyframeChannel *keyframes = device->keyframeChannel();
+    if (!keyframes) return skins;
 
     KisKeyframeSP keyframeBck;
     KisKeyframeSP keyframeFwd;
 
-    int time = sourceDevice->defaultBounds()->currentTime();
+    int time = device->defaultBounds()->currentTime();
     keyframeBck = keyframeFwd = keyframes->activeKeyframeAt(time);
 
     for (int offset = 1; offset <= m_d->numberOfSkins; offset++) {
@@ -163,14 +195,101 @@ void KisOnionSkinCompositor::composite(const KisPaintDeviceSP sourceDevice, KisP
         keyframeFwd = m_d->getNextFrameToComposite(keyframes, keyframeFwd, false);
 
         if (!keyframeBck.isNull()) {
-            m_d->tryCompositeFrame(keyframes, keyframeBck, gcFrame, gcDest, backwardTintDevice, m_d->skinOpacity(-offset), rect);
+            const SkinFrame skin = {keyframeBck, -offset, m_d->skinOpacity(-offset)};
+            if (skin.opacity != OPACITY_TRANSPARENT_U8) {
+                skins << skin;
+            }
         }
 
         if (!keyframeFwd.isNull()) {
-            m_d->tryCompositeFrame(keyframes, keyframeFwd, gcFrame, gcDest, forwardTintDevice, m_d->skinOpacity(offset), rect);
+            const SkinFrame skin = {keyframeFwd, offset, m_d->skinOpacity(offset)};
+            if (skin.opacity != OPACITY_TRANSPARENT_U8) {
+                skins << skin;
+            }
         }
     }
 
+    return skins;
+}
+
+void KisOnionSkinCompositor::tintFrame(KisRasterKeyframeChannel *keyframes, KisKeyframeSP keyframe, bool backward, KisPaintDeviceSP targetDevice, const QRect &rect)
+{
+    keyframes->fetchFrame(keyframe, targetDevice);
+
+    const QRect tintRect = effectiveExtent(targetDevice, rect);
+    if (tintRect.isEmpty()) return;
+
+    KisPaintDeviceSP tintDevice =
+        m_d->setUpTintDevice(backward ? m_d->backwardTintColor : m_d->forwardTintColor,
+                             targetDevice->colorSpace());
+
+    KisPainter gcFrame(targetDevice);
+    gcFrame.setChannelFlags(targetDevice->colorSpace()->channelFlags(true, false));
+    gcFrame.setOpacity(m_d->tintFactor);
+    gcFrame.bitBlt(tintRect.topLeft(), tintDevice, tintRect);
+}
+
+void KisOnionSkinCompositor::compositeTintedFrames(const QVector<TintedFrame> &frames, KisPaintDeviceSP targetDevice, const QRect &rect)
+{
+    if (frames.isEmpty() || rect.isEmpty()) return;
+
+    const KoColorSpace *colorSpace = targetDevice->colorSpace();
+    const KoCompositeOp *op = colorSpace->compositeOp(COMPOSITE_BEHIND);
+    const int pixelSize = colorSpace->pixelSize();
+
+    QVector<QRect> extents;
+    extents.reserve(frames.size());
+
+    Q_FOREACH (const TintedFrame &frame, frames) {
+        KIS_SAFE_ASSERT_RECOVER_RETURN(*frame.device->colorSpace() == *colorSpace);
+        extents << effectiveExtent(frame.device, rect);
+    }
+
+    /**
+     * Instead of blitting the skins one-by-one over the whole rect, we
+     * walk through the rect in strips of a tile height and apply all the
+     * skins to a strip while it is still hot in the cache. The strip of
+     * the target device is read and written only once.
+     */
+    const int stripHeight = 64;
+
+    QVector<quint8> dstBuffer;
+    QVector<quint8> srcBuffer;
+
+    for (int y = rect.top(); y <= rect.bottom(); y += stripHeight) {
+        QRect strip(rect.left(), y, rect.width(), qMin(stripHeight, rect.bottom() - y + 1));
+
+        QRect dirtyRect;
+        Q_FOREACH (const QRect &extent, extents) {
+            dirtyRect |= extent & strip;
+        }
+        if (dirtyRect.isEmpty()) continue;
+
+        strip = dirtyRect;
+
+        const int rowStride = strip.width() * pixelSize;
+        const int bufferSize = rowStride * strip.height();
+
+        if (dstBuffer.size() < bufferSize) {
+            dstBuffer.resize(bufferSize);
+            srcBuffer.resize(bufferSize);
+        }
+
+        targetDevice->readBytes(dstBuffer.data(), strip);
+
+        for (int i = 0; i < frames.size(); i++) {
+            if (!extents[i].intersects(strip)) continue;
+
+            frames[i].device->readBytes(srcBuffer.data(), strip);
+            op->composite(dstBuffer.data(), rowStride,
+                          srcBuffer.constData(), rowStride,
+                          0, 0,
+                          strip.height(), strip.width(),
+                          frames[i].opacity);
+        }
+
+        targetDevice->writeBytes(dstBuffer.constData(), strip);
+    }
 }
 
 QRect KisOnionSkinCompositor::calculateFullExtent(const KisPaintDeviceSP device)
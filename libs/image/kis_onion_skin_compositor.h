@@ -19,9 +19,13 @@
 #ifndef KIS_ONION_SKIN_COMPOSITOR_H
 #define KIS_ONION_SKIN_COMPOSITOR_H
 
+#include <QVector>
+
 #include "kis_types.h"
 #include "kritaimage_export.h"
 
+class KisRasterKeyframeChannel;
+
 class KRITAIMAGE_EXPORT KisOnionSkinCompositor : public QObject
 {
     Q_OBJECT
@@ -31,13 +35,58 @@ public:
     ~KisOnionSkinCompositor();
     static KisOnionSkinCompositor *instance();
 
+    /**
+     * A keyframe which is visible as an onion skin at the current
+     * time of the device
+     */
+    struct SkinFrame {
+        KisKeyframeSP keyframe;
+        int offset; ///< negative for the skins before the current frame
+        int opacity;
+    };
+
+    /**
+     * A prepared (tinted) onion skin frame, ready for compositing
+     */
+    struct TintedFrame {
+        KisPaintDeviceSP device;
+        int opacity;
+    };
+
     void composite(const KisPaintDeviceSP sourceDevice, KisPaintDeviceSP targetDevice, const QRect &rect);
 
+    /**
+     * @return the list of keyframes that should be shown as onion skins
+     * at the current time of \p device. The frames are sorted in the
+     * compositing order, the frames with zero opacity are skipped.
+     */
+    QVector<SkinFrame> visibleSkins(const KisPaintDeviceSP device);
+
+    /**
+     * Fetches \p keyframe into \p targetDevice and applies the backward
+     * or forward tint to it. Only \p rect of the frame is tinted.
+     */
+    void tintFrame(KisRasterKeyframeChannel *keyframes, KisKeyframeSP keyframe, bool backward, KisPaintDeviceSP targetDevice, const QRect &rect);
+
+    /**
+     * Composites all the \p frames behind the content of \p targetDevice
+     * in a single pass over \p rect. The frames must have the same color
+     * space as \p targetDevice.
+     */
+    static void compositeTintedFrames(const QVector<TintedFrame> &frames, KisPaintDeviceSP targetDevice, const QRect &rect);
+
     QRect calculateFullExtent(const KisPaintDeviceSP device);
     QRect calculateExtent(const KisPaintDeviceSP device);
 
     int configSeqNo() const;
 
+    /**
+     * The sequence number of the tint options. In contrast to
+     * configSeqNo(), it doesn't change when only the opacities or
+     * the number of skins are modified.
+     */
+    int tintSeqNo() const;
+
     void setColorLabelFilter(QList<int> colors);
 
 public Q_SLOTS:
@@ -215,6 +215,14 @@ public:
         return data->cache()->invalidate();
     }
 
+    int frameSequenceNumber(int frameId) const
+    {
+        DataSP data = m_frames.value(frameId);
+        KIS_ASSERT_RECOVER(data) { return -1; }
+
+        return data->cache()->sequenceNumber();
+    }
+
 private:
     typedef KisPaintDeviceData Data;
     typedef QSharedPointer<Data> DataSP;
@@ -746,6 +754,8 @@ void KisPaintDevice::Private::transferFromData(Data *data, KisPaintDeviceSP targ
 void KisPaintDevice::Private::fetchFrame(int frameId, KisPaintDeviceSP targetDevice)
 {
     DataSP data = m_frames[frameId];
+    KIS_ASSERT_RECOVER_RETURN(data);
+
     transferFromData(data.data(), targetDevice);
 }
 
@@ -2038,6 +2048,14 @@ void KisPaintDeviceFramesInterface::invalidateFrameCache(int frameId)
     return q->m_d->invalidateFrameCache(frameId);
 }
 
+int KisPaintDeviceFramesInterface::frameSequenceNumber(int frameId) const
+{
+    KIS_ASSERT_RECOVER(frameId >= 0) {
+        return -1;
+    }
+    return q->m_d->frameSequenceNumber(frameId);
+}
+
 void KisPaintDeviceFramesInterface::setFrameOffset(int frameId, const QPoint &offset)
 {
     KIS_ASSERT_RECOVER_RETURN(frameId >= 0);
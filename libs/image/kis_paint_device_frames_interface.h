@@ -83,6 +83,13 @@ public:
      */
     QPoint frameOffset(int frameId) const;
 
+    /**
+     * @return the sequence number of the content of \p frameId. The
+     * number is changed every time the frame is modified, so it can be
+     * used for checking validity of the data cached from this frame.
+     */
+    int frameSequenceNumber(int frameId) const;
+
     /**
      * Sets default pixel for \p frameId
      */
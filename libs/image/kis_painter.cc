@@ -2584,6 +2584,38 @@ quint8 KisPainter::opacity() const
     return quint8(d->paramInfo.opacity * 255.0f);
 }
 
+KisPainter::OpacityState::OpacityState()
+    : opacity(1.0f),
+      flow(1.0f),
+      averageOpacity(1.0f),
+      averageFollowsOpacity(true)
+{
+}
+
+KisPainter::OpacityState KisPainter::opacityState() const
+{
+    OpacityState state;
+    state.opacity = d->paramInfo.opacity;
+    state.flow = d->paramInfo.flow;
+    state.averageOpacity = *d->paramInfo.lastOpacity;
+    state.averageFollowsOpacity = d->paramInfo.lastOpacity == &d->paramInfo.opacity;
+    return state;
+}
+
+void KisPainter::setOpacityState(const OpacityState &state)
+{
+    d->isOpacityUnit = state.opacity == 1.0f;
+    d->paramInfo.opacity = state.opacity;
+    d->paramInfo.flow = state.flow;
+
+    if (state.averageFollowsOpacity) {
+        d->paramInfo.lastOpacity = &d->paramInfo.opacity;
+    } else {
+        d->paramInfo._lastOpacityData = state.averageOpacity;
+        d->paramInfo.lastOpacity = &d->paramInfo._lastOpacityData;
+    }
+}
+
 void KisPainter::setCompositeOp(const KoCompositeOp * op)
 {
     d->compositeOp = op;
@@ -711,6 +711,25 @@ public:
     /// Returns the opacity that is used in painting
     quint8 opacity() const;
 
+    /**
+     * The opacity, the flow and the mean opacity of the stroke
+     * calculated by setOpacityUpdateAverage(). Unlike opacity() and
+     * flow() it is not rounded, so the code that delays painting of
+     * the dabs can restore exactly the state each dab was requested
+     * with.
+     */
+    struct KRITAIMAGE_EXPORT OpacityState {
+        OpacityState();
+
+        float opacity;
+        float flow;
+        float averageOpacity;
+        bool averageFollowsOpacity;
+    };
+
+    OpacityState opacityState() const;
+    void setOpacityState(const OpacityState &state);
+
     /// Set the composite op for this painter
     void setCompositeOp(const KoCompositeOp * op);
     const KoCompositeOp * compositeOp();
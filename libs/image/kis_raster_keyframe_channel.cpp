@@ -101,6 +101,11 @@ QRect KisRasterKeyframeChannel::frameExtents(KisKeyframeSP keyframe)
     return m_d->paintDevice->framesInterface()->frameBounds(frameId(keyframe));
 }
 
+int KisRasterKeyframeChannel::frameRevision(KisKeyframeSP keyframe) const
+{
+    return m_d->paintDevice->framesInterface()->frameSequenceNumber(frameId(keyframe));
+}
+
 QString KisRasterKeyframeChannel::frameFilename(int frameId) const
 {
     return m_d->frameFilenames.value(frameId, QString());
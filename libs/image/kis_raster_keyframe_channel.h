@@ -54,6 +54,18 @@ public:
 
     QRect frameExtents(KisKeyframeSP keyframe);
 
+    /**
+     * @return the ID of the paint device frame associated with \p keyframe
+     */
+    int frameId(KisKeyframeSP keyframe) const;
+
+    /**
+     * @return the revision of the content of \p keyframe. The revision
+     * changes every time the frame is modified, so it can be used for
+     * checking validity of the data cached from the keyframe.
+     */
+    int frameRevision(KisKeyframeSP keyframe) const;
+
     QString frameFilename(int frameId) const;
 
     /**
@@ -82,7 +94,6 @@ protected:
 private:
     void setFrameFilename(int frameId, const QString &filename);
     QString chooseFrameFilename(int frameId, const QString &layerFilename);
-    int frameId(KisKeyframeSP keyframe) const;
 
     struct Private;
     QScopedPointer<Private> m_d;
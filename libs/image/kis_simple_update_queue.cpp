@@ -19,10 +19,15 @@
 #include "kis_simple_update_queue.h"
 
 #include <QMutexLocker>
+#include <QVector>
+#include <QtMath>
+
+#include <algorithm>
 
 #include "kis_image_config.h"
 #include "kis_full_refresh_walker.h"
 #include "kis_spontaneous_job.h"
+#include "kis_lod_transform.h"
 
 
 //#define ENABLE_DEBUG_JOIN
@@ -53,7 +58,8 @@
 
 
 KisSimpleUpdateQueue::KisSimpleUpdateQueue()
-    : m_overrideLevelOfDetail(-1)
+    : m_overrideLevelOfDetail(-1),
+      m_priorityOrderDirty(false)
 {
     updateSettings();
 }
@@ -98,6 +104,10 @@ bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
 {
     QMutexLocker locker(&m_lock);
 
+    if (m_priorityOrderDirty) {
+        sortByPriority();
+    }
+
     KisBaseRectsWalkerSP item;
     KisMutableWalkersListIterator iter(m_updatesList);
     bool jobAdded = false;
@@ -192,6 +202,7 @@ void KisSimpleUpdateQueue::addJob(KisNodeSP node, const QRect& rc,
 
     m_lock.lock();
     m_updatesList.append(walker);
+    m_priorityOrderDirty = !m_priorityVisibleRect.isEmpty();
     m_lock.unlock();
 }
 
@@ -216,6 +227,73 @@ void KisSimpleUpdateQueue::addSpontaneousJob(KisSpontaneousJob *spontaneousJob)
     m_spontaneousJobsList.append(spontaneousJob);
 }
 
+void KisSimpleUpdateQueue::setUpdatePriorityHint(const QRect &visibleRect, const QPointF &focusPoint)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_priorityVisibleRect = visibleRect;
+    m_priorityFocusPoint = focusPoint;
+    m_priorityOrderDirty = !m_priorityVisibleRect.isEmpty();
+}
+
+namespace {
+
+struct PriorityItem {
+    qreal visibleDistance;
+    qreal focusDistance;
+    KisBaseRectsWalkerSP walker;
+
+    bool operator<(const PriorityItem &rhs) const {
+        return visibleDistance < rhs.visibleDistance ||
+            (visibleDistance == rhs.visibleDistance &&
+             focusDistance < rhs.focusDistance);
+    }
+};
+
+inline qreal rectsDistance(const QRect &rc1, const QRect &rc2)
+{
+    const int dx = qMax(0, qMax(rc1.left() - rc2.right(), rc2.left() - rc1.right()));
+    const int dy = qMax(0, qMax(rc1.top() - rc2.bottom(), rc2.top() - rc1.bottom()));
+
+    return qSqrt(qreal(dx) * dx + qreal(dy) * dy);
+}
+
+}
+
+void KisSimpleUpdateQueue::sortByPriority()
+{
+    QVector<PriorityItem> items;
+    items.reserve(m_updatesList.size());
+
+    Q_FOREACH (KisBaseRectsWalkerSP walker, m_updatesList) {
+        QRect rc = walker->requestedRect();
+
+        if (walker->levelOfDetail() > 0) {
+            rc = KisLodTransform::upscaledRect(rc, walker->levelOfDetail());
+        }
+
+        const QPointF diff = QRectF(rc).center() - m_priorityFocusPoint;
+
+        PriorityItem item;
+        item.visibleDistance = rectsDistance(rc, m_priorityVisibleRect);
+        item.focusDistance = qSqrt(diff.x() * diff.x() + diff.y() * diff.y());
+        item.walker = walker;
+        items.append(item);
+    }
+
+    /**
+     * Stable sort keeps FIFO order for equally important walkers
+     */
+    std::stable_sort(items.begin(), items.end());
+
+    m_updatesList.clear();
+    Q_FOREACH (const PriorityItem &item, items) {
+        m_updatesList.append(item.walker);
+    }
+
+    m_priorityOrderDirty = false;
+}
+
 bool KisSimpleUpdateQueue::isEmpty() const
 {
     QMutexLocker locker(&m_lock);
@@ -233,8 +311,22 @@ bool KisSimpleUpdateQueue::trySplitJob(KisNodeSP node, const QRect& rc,
                                        int levelOfDetail,
                                        KisBaseRectsWalker::UpdateType type)
 {
-    if(rc.width() <= m_patchWidth || rc.height() <= m_patchHeight)
+    bool hasPriorityHint = false;
+    {
+        QMutexLocker locker(&m_lock);
+        hasPriorityHint = !m_priorityVisibleRect.isEmpty();
+    }
+
+    /**
+     * When we know what the user is looking at, split long strips
+     * as well, so that their visible part is not delayed by the rest
+     */
+    if (hasPriorityHint ?
+        rc.width() <= m_patchWidth && rc.height() <= m_patchHeight :
+        rc.width() <= m_patchWidth || rc.height() <= m_patchHeight) {
+
         return false;
+    }
 
     // a bit of recursive splitting...
 
@@ -330,6 +422,7 @@ void KisSimpleUpdateQueue::collectJobs(KisBaseRectsWalkerSP &baseWalker,
 
     if(baseWalker->requestedRect() != baseRect) {
         baseWalker->collectRects(baseWalker->startNode(), baseRect);
+        m_priorityOrderDirty = !m_priorityVisibleRect.isEmpty();
     }
 }
 
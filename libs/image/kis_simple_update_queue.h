@@ -44,6 +44,15 @@ public:
     void addFullRefreshJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail);
     void addSpontaneousJob(KisSpontaneousJob *spontaneousJob);
 
+    /**
+     * Tells the queue which part of the image the user is looking
+     * at. The walkers intersecting \p visibleRect are processed
+     * first, the closer to \p focusPoint the earlier, then all the
+     * others in order of distance from the visible rect. Both values
+     * are in LoD0 image coordinates. An empty \p visibleRect resets
+     * the queue back to FIFO order.
+     */
+    void setUpdatePriorityHint(const QRect &visibleRect, const QPointF &focusPoint);
 
     void optimize();
 
@@ -66,6 +75,8 @@ protected:
                      const qreal maxAlpha);
     bool joinRects(QRect& baseRect, const QRect& newRect, qreal maxAlpha);
 
+    void sortByPriority();
+
 protected:
 
     mutable QMutex m_lock;
@@ -102,6 +113,13 @@ protected:
     qreal m_maxMergeCollectAlpha;
 
     int m_overrideLevelOfDetail;
+
+    /**
+     * Viewport hint, \see setUpdatePriorityHint()
+     */
+    QRect m_priorityVisibleRect;
+    QPointF m_priorityFocusPoint;
+    bool m_priorityOrderDirty;
 };
 
 class KRITAIMAGE_EXPORT KisTestableSimpleUpdateQueue : public KisSimpleUpdateQueue
@@ -19,6 +19,7 @@
 #include "kis_stroke.h"
 
 #include "kis_stroke_strategy.h"
+#include "kis_update_time_monitor.h"
 
 
 KisStroke::KisStroke(KisStrokeStrategy *strokeStrategy, Type type, int levelOfDetail)
@@ -89,6 +90,8 @@ KisStrokeJob* KisStroke::popOneJob()
     KisStrokeJob *job = dequeue();
 
     if(job) {
+        mergeWaitingDabJobs(job);
+
         m_prevJobSequential = job->isSequential() || job->isBarrier();
 
         m_strokeInitialized = true;
@@ -282,6 +285,38 @@ KisStrokeJob* KisStroke::dequeue()
     return !m_jobsQueue.isEmpty() ? m_jobsQueue.dequeue() : 0;
 }
 
+/**
+ * When the input comes faster than the stroke can paint it, the
+ * queue fills with tiny dab jobs. Let the strategy fold the waiting
+ * ones into the job being started, so that the backlog is processed
+ * with less per-job overhead. Only plain sequential jobs are merged,
+ * so the order of execution is not changed.
+ */
+void KisStroke::mergeWaitingDabJobs(KisStrokeJob *job)
+{
+    if (job->dabStrategy() != m_dabStrategy.data() || !job->dabData() ||
+        !job->isSequential() || job->isExclusive()) {
+
+        return;
+    }
+
+    while (!m_jobsQueue.isEmpty()) {
+        KisStrokeJob *next = m_jobsQueue.head();
+
+        if (next->dabStrategy() != m_dabStrategy.data() || !next->dabData() ||
+            !next->isSequential() || next->isExclusive() ||
+            next->isCancellable() != job->isCancellable() ||
+            !m_strokeStrategy->tryMergeJobData(job->dabData(), next->dabData())) {
+
+            break;
+        }
+
+        KisStrokeJob *mergedJob = dequeue();
+        KisUpdateTimeMonitor::instance()->reportJobMerged(mergedJob->dabData(), job->dabData());
+        delete mergedJob;
+    }
+}
+
 void KisStroke::setLodBuddy(KisStrokeSP buddy)
 {
     m_lodBuddy = buddy;
@@ -88,6 +88,7 @@ private:
                  bool isCancellable);
 
     KisStrokeJob* dequeue();
+    void mergeWaitingDabJobs(KisStrokeJob *job);
 
     void clearQueueOnCancel();
     bool sanityCheckAllJobsAreCancellable() const;
@@ -67,6 +67,17 @@ public:
         return m_isCancellable;
     }
 
+private:
+    friend class KisStroke;
+
+    KisStrokeJobStrategy* dabStrategy() const {
+        return m_dabStrategy;
+    }
+
+    KisStrokeJobData* dabData() const {
+        return m_dabData;
+    }
+
 private:
     // for testing use only, do not use in real code
     friend QString getJobName(KisStrokeJob *job);
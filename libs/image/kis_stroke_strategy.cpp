@@ -115,6 +115,13 @@ KisStrokeStrategy* KisStrokeStrategy::createLodClone(int levelOfDetail)
     return 0;
 }
 
+bool KisStrokeStrategy::tryMergeJobData(KisStrokeJobData *target, const KisStrokeJobData *next)
+{
+    Q_UNUSED(target);
+    Q_UNUSED(next);
+    return false;
+}
+
 bool KisStrokeStrategy::isExclusive() const
 {
     return m_exclusive;
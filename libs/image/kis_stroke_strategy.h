@@ -48,6 +48,19 @@ public:
 
     virtual KisStrokeStrategy* createLodClone(int levelOfDetail);
 
+    /**
+     * Called by the stroke when a dab job is about to be started
+     * while more dab jobs are still waiting in the queue, that is,
+     * when the stroke cannot keep up with the incoming data. The
+     * strategy may fold the data of the next job into \p target.
+     * In such a case it should return true and the next job is
+     * dropped. Both jobs are guaranteed to be sequential and
+     * non-exclusive.
+     *
+     * The default implementation merges nothing.
+     */
+    virtual bool tryMergeJobData(KisStrokeJobData *target, const KisStrokeJobData *next);
+
     bool isExclusive() const;
     bool supportsWrapAroundMode() const;
     bool needsIndirectPainting() const;
@@ -25,10 +25,31 @@
 #include "kis_updater_context.h"
 #include "kis_stroke_job_strategy.h"
 #include "kis_stroke_strategy.h"
+#include "kis_trace_recorder.h"
 
 typedef QQueue<KisStrokeSP> StrokesQueue;
 typedef QQueue<KisStrokeSP>::iterator StrokesQueueIterator;
 
+namespace {
+
+inline void traceQueueState(const char *state)
+{
+    KisTraceRecorder *trace = KisTraceRecorder::instance();
+    if (trace->isEnabled()) {
+        trace->instantEvent("strokes", state);
+    }
+}
+
+inline void traceQueueSize(int size)
+{
+    KisTraceRecorder *trace = KisTraceRecorder::instance();
+    if (trace->isEnabled()) {
+        trace->counterEvent("strokes", "queued-strokes", size);
+    }
+}
+
+}
+
 struct Q_DECL_HIDDEN KisStrokesQueue::Private {
     Private()
         : openedStrokesCounter(0),
@@ -245,6 +266,9 @@ KisStrokeId KisStrokesQueue::startStroke(KisStrokeStrategy *strokeStrategy)
         m_d->lodNNeedsSynchronization = true;
     }
 
+    traceQueueState("stroke-started");
+    traceQueueSize(m_d->strokesQueue.size());
+
     return id;
 }
 
@@ -541,6 +565,9 @@ bool KisStrokesQueue::checkStrokeState(bool hasStrokeJobsRunning,
     }
     else if(stroke->isEnded() && !hasJobs && !hasStrokeJobsRunning) {
         m_d->strokesQueue.dequeue(); // deleted by shared pointer
+        traceQueueState("stroke-finished");
+        traceQueueSize(m_d->strokesQueue.size());
+
         m_d->needsExclusiveAccess = false;
         m_d->wrapAroundModeSupported = false;
         m_d->currentStrokeLoaded = false;
@@ -551,6 +578,9 @@ bool KisStrokesQueue::checkStrokeState(bool hasStrokeJobsRunning,
             result = checkStrokeState(false, runningLevelOfDetail);
         }
     }
+    else if(hasJobs && !hasLodCompatibility) {
+        traceQueueState("wait-lod");
+    }
 
     return result;
 }
@@ -562,7 +592,11 @@ bool KisStrokesQueue::checkExclusiveProperty(qint32 numMergeJobs,
     Q_UNUSED(numMergeJobs);
     Q_UNUSED(numStrokeJobs);
     Q_ASSERT(!(numMergeJobs && numStrokeJobs));
-    return numMergeJobs == 0;
+
+    const bool result = numMergeJobs == 0;
+    if (!result) traceQueueState("wait-exclusive");
+
+    return result;
 }
 
 bool KisStrokesQueue::checkSequentialProperty(qint32 numMergeJobs,
@@ -574,7 +608,11 @@ bool KisStrokesQueue::checkSequentialProperty(qint32 numMergeJobs,
     if(!stroke->prevJobSequential() && !stroke->nextJobSequential()) return true;
 
     Q_ASSERT(!stroke->prevJobSequential() || numStrokeJobs <= 1);
-    return numStrokeJobs == 0;
+
+    const bool result = numStrokeJobs == 0;
+    if (!result) traceQueueState("wait-sequential");
+
+    return result;
 }
 
 bool KisStrokesQueue::checkBarrierProperty(qint32 numMergeJobs,
@@ -584,7 +622,10 @@ bool KisStrokesQueue::checkBarrierProperty(qint32 numMergeJobs,
     KisStrokeSP stroke = m_d->strokesQueue.head();
     if(!stroke->nextJobBarrier()) return true;
 
-    return !numMergeJobs && !numStrokeJobs && !externalJobsPending;
+    const bool result = !numMergeJobs && !numStrokeJobs && !externalJobsPending;
+    if (!result) traceQueueState("wait-barrier");
+
+    return result;
 }
 
 bool KisStrokesQueue::checkLevelOfDetailProperty(int runningLevelOfDetail)
@@ -0,0 +1,448 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_trace_recorder.h"
+
+#include <QGlobalStatic>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRect>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThread>
+#include <QThreadStorage>
+#include <QVector>
+
+#include "kis_debug.h"
+#include "kis_image_config.h"
+
+Q_GLOBAL_STATIC(KisTraceRecorder, s_instance)
+
+
+namespace {
+
+struct TraceEvent {
+    const char *category;
+    const char *name;
+    const char *argName;
+    qint64 timestamp;
+    qint64 value;
+    int x;
+    int y;
+    int width;
+    int height;
+    char phase;
+    bool hasRect;
+};
+
+QByteArray escapeJsonString(const QString &str)
+{
+    QByteArray result = str.toUtf8();
+    result.replace('\\', "\\\\");
+    result.replace('"', "\\\"");
+    return result;
+}
+
+/**
+ * The ids of the recorders that are still alive. The thread-local
+ * buffer holders may outlive their recorder, so they check the
+ * registry before reporting to it.
+ */
+struct LiveRecorders {
+    LiveRecorders() : lastId(0) {}
+
+    QMutex lock;
+    QSet<int> ids;
+    int lastId;
+};
+
+Q_GLOBAL_STATIC(LiveRecorders, s_liveRecorders)
+
+}
+
+/**
+ * The buffer is written by its owner thread only, while the exporter
+ * may read it at any moment. Every slot is guarded by its own sequence
+ * number (a per-slot seqlock): it is odd while the slot is being
+ * written and equals 2 * (event number + 1) when the event is
+ * complete. The reader drops the slots that were being written or
+ * were overwritten while it copied them, so it never sees a torn
+ * event.
+ */
+struct KisTraceRecorder::ThreadBuffer
+{
+    struct Slot {
+        TraceEvent event;
+        mutable QAtomicInteger<qint64> sequence;
+    };
+
+    ThreadBuffer(int size, int _threadId, const QString &_threadName)
+        : eventSlots(size),
+          writeCount(0),
+          threadId(_threadId),
+          threadName(_threadName),
+          dabs(0)
+    {
+    }
+
+    inline void write(const TraceEvent &event) {
+        const qint64 eventNumber = writeCount.load();
+        Slot &slot = eventSlots[eventNumber % eventSlots.size()];
+
+        // the ordered store keeps the event writes after the odd sequence
+        slot.sequence.fetchAndStoreOrdered(2 * eventNumber + 1);
+        slot.event = event;
+        slot.sequence.storeRelease(2 * eventNumber + 2);
+
+        writeCount.storeRelease(eventNumber + 1);
+    }
+
+    QVector<TraceEvent> snapshot() const {
+        const qint64 count = writeCount.loadAcquire();
+        const qint64 first = qMax(qint64(0), count - eventSlots.size());
+
+        QVector<TraceEvent> result;
+        result.reserve(count - first);
+
+        for (qint64 i = first; i < count; i++) {
+            const Slot &slot = eventSlots[i % eventSlots.size()];
+            const qint64 expectedSequence = 2 * i + 2;
+
+            if (slot.sequence.loadAcquire() != expectedSequence) continue;
+
+            const TraceEvent event = slot.event;
+
+            // the ordered read keeps the copy before the sequence check
+            if (slot.sequence.fetchAndAddOrdered(0) != expectedSequence) continue;
+
+            result.append(event);
+        }
+
+        return result;
+    }
+
+    QVector<Slot> eventSlots;
+    QAtomicInteger<qint64> writeCount;
+
+    int threadId;
+    QString threadName;
+    qint64 dabs;
+};
+
+struct KisTraceRecorder::Private
+{
+    typedef QSharedPointer<ThreadBuffer> ThreadBufferSP;
+
+    /**
+     * Lives in the thread-local storage and tells the recorder when
+     * its thread has finished.
+     *
+     * QThreadStorage doesn't delete the per-thread data when it is
+     * destroyed and reuses its ids for the storages created later, so
+     * a new recorder may find the holder of a dead one in its storage.
+     * That is why the holder keeps the id of its recorder and doesn't
+     * touch the recorder when it is not alive anymore.
+     */
+    struct ThreadBufferHolder {
+        ThreadBufferHolder(Private *_recorder, ThreadBuffer *_buffer)
+            : recorder(_recorder),
+              recorderId(_recorder->recorderId),
+              buffer(_buffer) {}
+
+        ~ThreadBufferHolder() {
+            if (s_liveRecorders.isDestroyed()) return;
+
+            QMutexLocker l(&s_liveRecorders->lock);
+            if (s_liveRecorders->ids.contains(recorderId)) {
+                recorder->threadFinished(buffer);
+            }
+        }
+
+        Private *recorder;
+        int recorderId;
+        ThreadBuffer *buffer;
+    };
+
+    Private()
+        : bufferSize(65536),
+          maxFinishedBuffers(qMax(8, QThread::idealThreadCount())),
+          lastThreadId(0),
+          clearedAt(0)
+    {
+        QMutexLocker l(&s_liveRecorders->lock);
+        recorderId = ++s_liveRecorders->lastId;
+        s_liveRecorders->ids.insert(recorderId);
+    }
+
+    ~Private() {
+        if (s_liveRecorders.isDestroyed()) return;
+
+        QMutexLocker l(&s_liveRecorders->lock);
+        s_liveRecorders->ids.remove(recorderId);
+    }
+
+    void threadFinished(ThreadBuffer *buffer);
+
+    int recorderId;
+
+    QElapsedTimer timer;
+    int bufferSize;
+
+    QThreadStorage<ThreadBufferHolder*> currentBuffer;
+
+    /**
+     * The buffers of the finished threads are still a part of the
+     * history, so they are kept, but only the latest
+     * maxFinishedBuffers of them. The threads of QThreadPool expire
+     * and are recreated all the time, keeping all of them would make
+     * the recorder grow forever.
+     */
+    QList<ThreadBufferSP> buffers;
+    QList<ThreadBufferSP> finishedBuffers;
+    int maxFinishedBuffers;
+    int lastThreadId;
+    mutable QMutex buffersLock;
+
+    qint64 clearedAt;
+};
+
+void KisTraceRecorder::Private::threadFinished(ThreadBuffer *buffer)
+{
+    QMutexLocker l(&buffersLock);
+
+    Q_FOREACH (ThreadBufferSP sharedBuffer, buffers) {
+        if (sharedBuffer.data() == buffer) {
+            finishedBuffers.append(sharedBuffer);
+            break;
+        }
+    }
+
+    while (finishedBuffers.size() > maxFinishedBuffers) {
+        buffers.removeOne(finishedBuffers.takeFirst());
+    }
+}
+
+KisTraceRecorder::KisTraceRecorder()
+    : m_d(new Private)
+{
+    KisImageConfig cfg;
+    m_d->bufferSize = qMax(1024, cfg.traceBufferSize());
+    m_d->timer.start();
+
+    m_enabled.store(cfg.enableTracing());
+}
+
+KisTraceRecorder::~KisTraceRecorder()
+{
+}
+
+KisTraceRecorder* KisTraceRecorder::instance()
+{
+    return s_instance;
+}
+
+void KisTraceRecorder::setEnabled(bool value)
+{
+    m_enabled.store(value);
+}
+
+KisTraceRecorder::ThreadBuffer* KisTraceRecorder::currentThreadBuffer()
+{
+    if (!m_d->currentBuffer.hasLocalData() ||
+        m_d->currentBuffer.localData()->recorderId != m_d->recorderId) {
+
+        Private::ThreadBufferSP buffer;
+
+        {
+            QMutexLocker l(&m_d->buffersLock);
+
+            const int threadId = ++m_d->lastThreadId;
+
+            QString threadName = QThread::currentThread()->objectName();
+            if (QCoreApplication::instance() &&
+                QThread::currentThread() == QCoreApplication::instance()->thread()) {
+
+                threadName = "GUI thread";
+            } else if (threadName.isEmpty()) {
+                threadName = QString("Worker %1").arg(threadId);
+            }
+
+            buffer = Private::ThreadBufferSP(new ThreadBuffer(m_d->bufferSize, threadId, threadName));
+            m_d->buffers.append(buffer);
+        }
+
+        /**
+         * Deletes the stale holder of a dead recorder, if any. It takes
+         * the lock of the recorders registry, so it is done after
+         * releasing buffersLock.
+         */
+        m_d->currentBuffer.setLocalData(new Private::ThreadBufferHolder(m_d.data(), buffer.data()));
+    }
+
+    return m_d->currentBuffer.localData()->buffer;
+}
+
+void KisTraceRecorder::beginEvent(const char *category, const char *name)
+{
+    if (!isEnabled()) return;
+
+    TraceEvent event = {category, name, 0, currentTimestamp(), 0, 0, 0, 0, 0, 'B', false};
+    currentThreadBuffer()->write(event);
+}
+
+void KisTraceRecorder::endEvent(const char *category, const char *name,
+                                const char *argName, qint64 value)
+{
+    if (!isEnabled()) return;
+
+    TraceEvent event = {category, name, argName, currentTimestamp(), value, 0, 0, 0, 0, 'E', false};
+    currentThreadBuffer()->write(event);
+}
+
+void KisTraceRecorder::instantEvent(const char *category, const char *name)
+{
+    if (!isEnabled()) return;
+
+    TraceEvent event = {category, name, 0, currentTimestamp(), 0, 0, 0, 0, 0, 'i', false};
+    currentThreadBuffer()->write(event);
+}
+
+void KisTraceRecorder::rectEvent(const char *category, const char *name, const QRect &rect)
+{
+    if (!isEnabled()) return;
+
+    TraceEvent event = {category, name, 0, currentTimestamp(), 0,
+                        rect.x(), rect.y(), rect.width(), rect.height(),
+                        'i', true};
+    currentThreadBuffer()->write(event);
+}
+
+void KisTraceRecorder::counterEvent(const char *category, const char *name, qint64 value)
+{
+    if (!isEnabled()) return;
+
+    TraceEvent event = {category, name, name, currentTimestamp(), value, 0, 0, 0, 0, 'C', false};
+    currentThreadBuffer()->write(event);
+}
+
+void KisTraceRecorder::addDabs(int count)
+{
+    if (!isEnabled()) return;
+
+    currentThreadBuffer()->dabs += count;
+}
+
+qint64 KisTraceRecorder::takeDabs()
+{
+    if (!isEnabled()) return 0;
+
+    ThreadBuffer *buffer = currentThreadBuffer();
+    const qint64 dabs = buffer->dabs;
+    buffer->dabs = 0;
+    return dabs;
+}
+
+qint64 KisTraceRecorder::currentTimestamp() const
+{
+    return m_d->timer.nsecsElapsed();
+}
+
+QByteArray KisTraceRecorder::toChromeTrace(qint64 sinceTimestamp) const
+{
+    QList<Private::ThreadBufferSP> buffers;
+    {
+        QMutexLocker l(&m_d->buffersLock);
+        buffers = m_d->buffers;
+        sinceTimestamp = qMax(sinceTimestamp, m_d->clearedAt);
+    }
+
+    QByteArray result;
+    result += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool firstEvent = true;
+
+    Q_FOREACH (Private::ThreadBufferSP buffer, buffers) {
+        const QByteArray tid = QByteArray::number(buffer->threadId);
+
+        if (!firstEvent) result += ",\n";
+        firstEvent = false;
+
+        result += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid +
+            ",\"args\":{\"name\":\"" + escapeJsonString(buffer->threadName) + "\"}}";
+
+        Q_FOREACH (const TraceEvent &event, buffer->snapshot()) {
+            if (event.timestamp < sinceTimestamp) continue;
+
+            result += ",\n{\"cat\":\"";
+            result += event.category;
+            result += "\",\"name\":\"";
+            result += event.name;
+            result += "\",\"ph\":\"";
+            result += event.phase;
+            result += "\",\"ts\":";
+            result += QByteArray::number(event.timestamp / 1000.0, 'f', 3);
+            result += ",\"pid\":1,\"tid\":" + tid;
+
+            if (event.phase == 'i') {
+                result += ",\"s\":\"t\"";
+            }
+
+            if (event.hasRect) {
+                result += ",\"args\":{\"x\":" + QByteArray::number(event.x) +
+                    ",\"y\":" + QByteArray::number(event.y) +
+                    ",\"width\":" + QByteArray::number(event.width) +
+                    ",\"height\":" + QByteArray::number(event.height) + "}";
+            } else if (event.argName) {
+                result += ",\"args\":{\"";
+                result += event.argName;
+                result += "\":" + QByteArray::number(event.value) + "}";
+            }
+
+            result += "}";
+        }
+    }
+
+    result += "\n]}\n";
+
+    return result;
+}
+
+bool KisTraceRecorder::saveChromeTrace(const QString &fileName, qint64 sinceTimestamp) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        warnKrita << "Failed to open trace file" << fileName;
+        return false;
+    }
+
+    const QByteArray trace = toChromeTrace(sinceTimestamp);
+    return file.write(trace) == trace.size();
+}
+
+void KisTraceRecorder::clear()
+{
+    /**
+     * The buffers belong to their threads, so we cannot reset them
+     * from here. Just hide everything recorded up to this moment.
+     */
+    QMutexLocker l(&m_d->buffersLock);
+    m_d->clearedAt = currentTimestamp();
+}
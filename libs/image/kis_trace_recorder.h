@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_TRACE_RECORDER_H
+#define __KIS_TRACE_RECORDER_H
+
+#include <QAtomicInt>
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+
+class QRect;
+class QString;
+class QByteArray;
+
+
+/**
+ * Records the events of the update scheduler, strokes queue and merge
+ * walkers and exports them in Chrome Trace Event format (readable by
+ * chrome://tracing and Perfetto).
+ *
+ * Every thread writes into its own ring buffer, so recording an event
+ * takes no locks. The oldest events are overwritten when the buffer is
+ * full. When tracing is disabled, a report is a single atomic load.
+ * Only the buffers of the few latest finished threads are kept.
+ *
+ * The trace can be saved from the GUI with the "Save Performance
+ * Trace" action.
+ *
+ * NOTE: the category, name and argument name are stored as raw
+ *       pointers, so they must be string literals.
+ */
+class KRITAIMAGE_EXPORT KisTraceRecorder
+{
+public:
+    KisTraceRecorder();
+    ~KisTraceRecorder();
+    static KisTraceRecorder* instance();
+
+    inline bool isEnabled() const {
+        return m_enabled.load();
+    }
+
+    void setEnabled(bool value);
+
+    void beginEvent(const char *category, const char *name);
+    void endEvent(const char *category, const char *name,
+                  const char *argName = 0, qint64 value = 0);
+    void instantEvent(const char *category, const char *name);
+    void rectEvent(const char *category, const char *name, const QRect &rect);
+    void counterEvent(const char *category, const char *name, qint64 value);
+
+    /**
+     * Dabs are too numerous to be recorded one-by-one, so they are
+     * accumulated per thread and reported with the end of the job
+     */
+    void addDabs(int count);
+    qint64 takeDabs();
+
+    /**
+     * Time since the recorder creation in nanoseconds
+     */
+    qint64 currentTimestamp() const;
+
+    QByteArray toChromeTrace(qint64 sinceTimestamp = 0) const;
+    bool saveChromeTrace(const QString &fileName, qint64 sinceTimestamp = 0) const;
+
+    void clear();
+
+private:
+    struct ThreadBuffer;
+    ThreadBuffer* currentThreadBuffer();
+
+private:
+    QAtomicInt m_enabled;
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+/**
+ * Records a begin/end pair for the lifetime of the object
+ */
+class KisTraceScope
+{
+public:
+    KisTraceScope(const char *category, const char *name)
+        : m_category(category),
+          m_name(name),
+          m_recorder(KisTraceRecorder::instance()),
+          m_active(m_recorder->isEnabled())
+    {
+        if (m_active) {
+            m_recorder->beginEvent(m_category, m_name);
+        }
+    }
+
+    ~KisTraceScope() {
+        if (m_active) {
+            m_recorder->endEvent(m_category, m_name);
+        }
+    }
+
+private:
+    const char *m_category;
+    const char *m_name;
+    KisTraceRecorder *m_recorder;
+    bool m_active;
+};
+
+#endif /* __KIS_TRACE_RECORDER_H */
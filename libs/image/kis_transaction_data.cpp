@@ -233,6 +233,17 @@ void KisTransactionData::redo()
     possiblyNotifySelectionChanged();
 }
 
+qint64 KisTransactionData::memoryUsage() const
+{
+    qint64 result = KUndo2Command::memoryUsage();
+
+    if (m_d->memento) {
+        result += m_d->memento->memoryUsage();
+    }
+
+    return result;
+}
+
 void KisTransactionData::undo()
 {
     DEBUG_ACTION("Undo()");
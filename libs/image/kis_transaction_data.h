@@ -45,6 +45,8 @@ public:
 
     virtual void endTransaction();
 
+    qint64 memoryUsage() const;
+
 protected:
     virtual void saveSelectionOutlineCache();
     virtual void restoreSelectionOutlineCache(bool undo);
@@ -26,6 +26,7 @@
 #include "kis_spontaneous_job.h"
 #include "kis_base_rects_walker.h"
 #include "kis_async_merger.h"
+#include "kis_trace_recorder.h"
 
 
 class KisUpdateJobItem :  public QObject, public QRunnable
@@ -53,12 +54,28 @@ public:
     }
 
     void run() {
+        KisTraceRecorder *trace = KisTraceRecorder::instance();
+        const bool tracing = trace->isEnabled();
+        const char *jobName =
+            m_type == MERGE ? "merge" :
+            m_type == STROKE ? "stroke" : "spontaneous";
+
+        if (tracing) {
+            trace->beginEvent("updater", m_exclusive ? "wait-exclusive-write" : "wait-exclusive-read");
+        }
+
         if(m_exclusive) {
             m_exclusiveJobLock->lockForWrite();
         } else {
             m_exclusiveJobLock->lockForRead();
         }
 
+        if (tracing) {
+            trace->endEvent("updater", m_exclusive ? "wait-exclusive-write" : "wait-exclusive-read");
+            trace->takeDabs();
+            trace->beginEvent("updater", jobName);
+        }
+
         if(m_type == MERGE) {
             runMergeJob();
         } else {
@@ -68,6 +85,10 @@ public:
             m_runnableJob = 0;
         }
 
+        if (tracing) {
+            trace->endEvent("updater", jobName, "dabs", trace->takeDabs());
+        }
+
         setDone();
 
         emit sigDoSomeUsefulWork();
@@ -80,6 +101,13 @@ public:
         Q_ASSERT(m_type == MERGE);
         // dbgKrita << "Executing merge job" << m_walker->changeRect()
         //          << "on thread" << QThread::currentThreadId();
+        KisTraceRecorder *trace = KisTraceRecorder::instance();
+        if (trace->isEnabled()) {
+            trace->rectEvent("walker", "requested-rect", m_walker->requestedRect());
+            trace->rectEvent("walker", "need-rect", m_accessRect);
+            trace->rectEvent("walker", "change-rect", m_changeRect);
+        }
+
         m_merger.startMerge(*m_walker);
 
         QRect changeRect = m_walker->changeRect();
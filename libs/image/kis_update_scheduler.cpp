@@ -231,6 +231,11 @@ void KisUpdateScheduler::explicitRegenerateLevelOfDetail()
     processQueues();
 }
 
+void KisUpdateScheduler::setUpdatePriorityHint(const QRect &visibleRect, const QPointF &focusPoint)
+{
+    m_d->updatesQueue.setUpdatePriorityHint(visibleRect, focusPoint);
+}
+
 int KisUpdateScheduler::currentLevelOfDetail() const
 {
     int levelOfDetail = -1;
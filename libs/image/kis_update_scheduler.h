@@ -27,6 +27,7 @@
 #include "kis_stroke_strategy_factory.h"
 
 class QRect;
+class QPointF;
 class KoProgressProxy;
 class KisProjectionUpdateListener;
 class KisSpontaneousJob;
@@ -155,6 +156,13 @@ public:
      */
     void explicitRegenerateLevelOfDetail();
 
+    /**
+     * Sets the part of the image visible in the canvas and the point
+     * the user works around. The projection updates are processed in
+     * order of distance from them. \see KisSimpleUpdateQueue::setUpdatePriorityHint()
+     */
+    void setUpdatePriorityHint(const QRect &visibleRect, const QPointF &focusPoint);
+
     /**
      * Install a factory of a stroke strategy, that will be started
      * every time when the scheduler needs to synchronize LOD caches
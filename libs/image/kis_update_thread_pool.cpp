@@ -0,0 +1,238 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_update_thread_pool.h"
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "kis_assert.h"
+
+
+namespace {
+
+struct WorkerQueue
+{
+    QMutex lock;
+    QList<QRunnable*> jobs;
+};
+
+}
+
+class KisUpdateThreadPool::WorkerThread : public QThread
+{
+public:
+    WorkerThread(KisUpdateThreadPool::Private *_pool, int _index)
+        : pool(_pool),
+          index(_index)
+    {
+        setObjectName(QString("KisUpdateWorker %1").arg(index));
+    }
+
+    void run();
+
+    KisUpdateThreadPool::Private *pool;
+    int index;
+};
+
+struct KisUpdateThreadPool::Private
+{
+    QVector<WorkerQueue*> queues;
+    QVector<WorkerThread*> threads;
+
+    /**
+     * The number of runnables sitting in the queues
+     */
+    QAtomicInt queuedJobs;
+
+    /**
+     * The number of runnables that are either queued or running
+     */
+    QAtomicInt activeJobs;
+
+    QAtomicInt idleWorkers;
+    QAtomicInt nextQueue;
+    QAtomicInt quit;
+
+    QMutex sleepLock;
+    QWaitCondition sleepCondition;
+
+    QMutex doneLock;
+    QWaitCondition doneCondition;
+
+    int currentWorkerIndex() const;
+    QRunnable* takeJob(int index);
+    void workerLoop(int index);
+};
+
+void KisUpdateThreadPool::WorkerThread::run()
+{
+    pool->workerLoop(index);
+}
+
+int KisUpdateThreadPool::Private::currentWorkerIndex() const
+{
+    WorkerThread *thread = dynamic_cast<WorkerThread*>(QThread::currentThread());
+    return thread && thread->pool == this ? thread->index : -1;
+}
+
+QRunnable* KisUpdateThreadPool::Private::takeJob(int index)
+{
+    QRunnable *job = 0;
+
+    {
+        WorkerQueue *queue = queues[index];
+        QMutexLocker l(&queue->lock);
+        if (!queue->jobs.isEmpty()) {
+            job = queue->jobs.takeFirst();
+        }
+    }
+
+    /**
+     * Steal from the tail, so that the owner and the thief do not
+     * fight for the same end of the queue
+     */
+    for (int i = 1; !job && i < queues.size(); i++) {
+        WorkerQueue *queue = queues[(index + i) % queues.size()];
+        QMutexLocker l(&queue->lock);
+        if (!queue->jobs.isEmpty()) {
+            job = queue->jobs.takeLast();
+        }
+    }
+
+    if (job) {
+        queuedJobs.deref();
+    }
+
+    return job;
+}
+
+void KisUpdateThreadPool::Private::workerLoop(int index)
+{
+    forever {
+        QRunnable *job = takeJob(index);
+
+        if (job) {
+            const bool autoDelete = job->autoDelete();
+            job->run();
+            if (autoDelete) {
+                delete job;
+            }
+
+            if (!activeJobs.deref()) {
+                QMutexLocker l(&doneLock);
+                doneCondition.wakeAll();
+            }
+            continue;
+        }
+
+        QMutexLocker l(&sleepLock);
+
+        /**
+         * The ordered increment pairs with the one in start(), so
+         * either we see the new job or the producer sees us sleeping
+         */
+        idleWorkers.fetchAndAddOrdered(1);
+        if (!queuedJobs.loadAcquire() && !quit.loadAcquire()) {
+            sleepCondition.wait(&sleepLock);
+        }
+        idleWorkers.fetchAndAddOrdered(-1);
+
+        if (quit.loadAcquire() && !queuedJobs.loadAcquire()) break;
+    }
+}
+
+KisUpdateThreadPool::KisUpdateThreadPool(int threadCount)
+    : m_d(new Private)
+{
+    KIS_ASSERT_RECOVER_NOOP(threadCount > 0);
+    threadCount = qMax(1, threadCount);
+
+    for (int i = 0; i < threadCount; i++) {
+        m_d->queues.append(new WorkerQueue);
+    }
+
+    for (int i = 0; i < threadCount; i++) {
+        WorkerThread *thread = new WorkerThread(m_d.data(), i);
+        m_d->threads.append(thread);
+        thread->start();
+    }
+}
+
+KisUpdateThreadPool::~KisUpdateThreadPool()
+{
+    waitForDone();
+
+    {
+        QMutexLocker l(&m_d->sleepLock);
+        m_d->quit.storeRelease(1);
+        m_d->sleepCondition.wakeAll();
+    }
+
+    Q_FOREACH (WorkerThread *thread, m_d->threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    qDeleteAll(m_d->queues);
+}
+
+void KisUpdateThreadPool::start(QRunnable *runnable)
+{
+    m_d->activeJobs.ref();
+
+    int index = m_d->currentWorkerIndex();
+    if (index < 0) {
+        index = (m_d->nextQueue.fetchAndAddRelaxed(1) & 0x7fffffff) % m_d->queues.size();
+    }
+
+    {
+        WorkerQueue *queue = m_d->queues[index];
+        QMutexLocker l(&queue->lock);
+        queue->jobs.append(runnable);
+    }
+
+    m_d->queuedJobs.fetchAndAddOrdered(1);
+
+    if (m_d->idleWorkers.loadAcquire() > 0) {
+        QMutexLocker l(&m_d->sleepLock);
+        m_d->sleepCondition.wakeOne();
+    }
+}
+
+void KisUpdateThreadPool::waitForDone()
+{
+    KIS_ASSERT_RECOVER_RETURN(m_d->currentWorkerIndex() < 0);
+
+    QMutexLocker l(&m_d->doneLock);
+    while (m_d->activeJobs.loadAcquire()) {
+        m_d->doneCondition.wait(&m_d->doneLock);
+    }
+}
+
+int KisUpdateThreadPool::threadCount() const
+{
+    return m_d->threads.size();
+}
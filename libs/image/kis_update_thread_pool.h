@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __KIS_UPDATE_THREAD_POOL_H
+#define __KIS_UPDATE_THREAD_POOL_H
+
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+
+class QRunnable;
+
+
+/**
+ * A drop-in replacement for QThreadPool used by KisUpdaterContext.
+ *
+ * Every worker thread owns a queue of runnables. A runnable started
+ * from a worker thread (which is what happens when a finished job
+ * asks the scheduler for more work) is put into the queue of that
+ * very worker, so it is picked up right after the current job
+ * returns, without waking anyone up. Runnables started from other
+ * threads are distributed over the queues in a round-robin manner.
+ * Idle workers steal runnables from the tail of the other queues
+ * before going to sleep.
+ *
+ * The pool does not know anything about the kind of the jobs it
+ * executes, so all the exclusive/sequential/barrier guarantees are
+ * still provided by the updater context and the strokes queue.
+ */
+class KRITAIMAGE_EXPORT KisUpdateThreadPool
+{
+public:
+    KisUpdateThreadPool(int threadCount);
+    ~KisUpdateThreadPool();
+
+    /**
+     * Queues \p runnable for execution. If QRunnable::autoDelete()
+     * is set, the runnable is deleted after it has finished.
+     */
+    void start(QRunnable *runnable);
+
+    /**
+     * Blocks until all the started runnables, including the ones
+     * started by the runnables themselves, are finished. Must not
+     * be called from a worker thread.
+     */
+    void waitForDone();
+
+    int threadCount() const;
+
+private:
+    class WorkerThread;
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_UPDATE_THREAD_POOL_H */
@@ -36,6 +36,7 @@
 #include "kis_debug.h"
 #include "kis_global.h"
 #include "kis_image_config.h"
+#include "kis_trace_recorder.h"
 
 
 #include <brushengine/kis_paintop_preset.h>
@@ -85,12 +86,15 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
           numTickets(0),
           numUpdates(0),
           mousePath(0.0),
+          strokeTraceStart(0),
+          numStrokes(0),
           loggingEnabled(false)
     {
         loggingEnabled = KisImageConfig().enablePerfLog();
     }
 
     QHash<void*, StrokeTicket*> preliminaryTickets;
+    QMultiHash<void*, StrokeTicket*> mergedTickets;
     QSet<StrokeTicket*> finishedTickets;
 
     qint64 jobsTime;
@@ -104,6 +108,9 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
     QElapsedTimer strokeTime;
     KisPaintOpPresetSP preset;
 
+    qint64 strokeTraceStart;
+    int numStrokes;
+
     bool loggingEnabled;
 };
 
@@ -116,6 +123,8 @@ KisUpdateTimeMonitor::KisUpdateTimeMonitor()
             dir.remove("log");
         }
         dir.mkdir("log");
+
+        KisTraceRecorder::instance()->setEnabled(true);
     }
 }
 
@@ -144,6 +153,7 @@ void KisUpdateTimeMonitor::startStrokeMeasure()
     m_d->lastMousePos = QPointF();
     m_d->preset = 0;
     m_d->strokeTime.start();
+    m_d->strokeTraceStart = KisTraceRecorder::instance()->currentTimestamp();
 }
 
 void KisUpdateTimeMonitor::endStrokeMeasure()
@@ -203,6 +213,10 @@ void KisUpdateTimeMonitor::printValues()
            << nonUpdateTime << "\t"
            << responseTime << "\n";
     logFile.close();
+
+    KisTraceRecorder::instance()->saveChromeTrace(
+        QString("log/%1stroke.%2.json").arg(prefix).arg(m_d->numStrokes++),
+        m_d->strokeTraceStart);
 }
 
 void KisUpdateTimeMonitor::reportJobStarted(void *key)
@@ -223,8 +237,15 @@ void KisUpdateTimeMonitor::reportJobFinished(void *key, const QVector<QRect> &re
 
     QMutexLocker locker(&m_d->mutex);
 
-    StrokeTicket *ticket = m_d->preliminaryTickets.take(key);
-    if( ticket ){
+    QList<StrokeTicket*> tickets = m_d->mergedTickets.values(key);
+    m_d->mergedTickets.remove(key);
+
+    StrokeTicket *ownTicket = m_d->preliminaryTickets.take(key);
+    if (ownTicket) {
+        tickets.append(ownTicket);
+    }
+
+    Q_FOREACH (StrokeTicket *ticket, tickets) {
         ticket->jobCompleted();
 
         Q_FOREACH (const QRect &rect, rects) {
@@ -234,6 +255,25 @@ void KisUpdateTimeMonitor::reportJobFinished(void *key, const QVector<QRect> &re
     }
 }
 
+void KisUpdateTimeMonitor::reportJobMerged(void *key, void *targetKey)
+{
+    if (!m_d->loggingEnabled) return;
+
+    QMutexLocker locker(&m_d->mutex);
+
+    QList<StrokeTicket*> tickets = m_d->mergedTickets.values(key);
+    m_d->mergedTickets.remove(key);
+
+    StrokeTicket *ownTicket = m_d->preliminaryTickets.take(key);
+    if (ownTicket) {
+        tickets.append(ownTicket);
+    }
+
+    Q_FOREACH (StrokeTicket *ticket, tickets) {
+        m_d->mergedTickets.insert(targetKey, ticket);
+    }
+}
+
 void KisUpdateTimeMonitor::reportUpdateFinished(const QRect &rect)
 {
     if (!m_d->loggingEnabled) return;
@@ -44,6 +44,13 @@ public:
 
     void reportJobStarted(void *key);
     void reportJobFinished(void *key, const QVector<QRect> &rects);
+
+    /**
+     * The job \p key has been merged into the job \p targetKey and
+     * will never be reported finished by itself. Its ticket is
+     * finished together with the one of \p targetKey.
+     */
+    void reportJobMerged(void *key, void *targetKey);
     void reportUpdateFinished(const QRect &rect);
 
 
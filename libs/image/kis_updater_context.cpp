@@ -19,20 +19,25 @@
 #include "kis_updater_context.h"
 
 #include <QThread>
-#include <QThreadPool>
 
 #include "kis_update_job_item.h"
 #include "kis_stroke_job.h"
 
 
-KisUpdaterContext::KisUpdaterContext(qint32 threadCount)
+qint32 KisUpdaterContext::realThreadCount(qint32 threadCount)
 {
     if(threadCount <= 0) {
         threadCount = QThread::idealThreadCount();
         threadCount = threadCount > 0 ? threadCount : 1;
     }
 
-    m_jobs.resize(threadCount);
+    return threadCount;
+}
+
+KisUpdaterContext::KisUpdaterContext(qint32 threadCount)
+    : m_threadPool(realThreadCount(threadCount))
+{
+    m_jobs.resize(m_threadPool.threadCount());
     for(qint32 i = 0; i < m_jobs.size(); i++) {
         m_jobs[i] = new KisUpdateJobItem(&m_exclusiveJobLock);
         connect(m_jobs[i], SIGNAL(sigContinueUpdate(const QRect&)),
@@ -22,11 +22,11 @@
 #include <QObject>
 #include <QMutex>
 #include <QReadWriteLock>
-#include <QThreadPool>
 
 #include "kis_base_rects_walker.h"
 #include "kis_async_merger.h"
 #include "kis_lock_free_lod_counter.h"
+#include "kis_update_thread_pool.h"
 
 
 class KisUpdateJobItem;
@@ -130,6 +130,9 @@ protected:
                                     const KisUpdateJobItem* job);
     qint32 findSpareThread();
 
+private:
+    static qint32 realThreadCount(qint32 threadCount);
+
 protected:
     /**
      * The lock is shared by all the child update job items.
@@ -141,7 +144,7 @@ protected:
 
     QMutex m_lock;
     QVector<KisUpdateJobItem*> m_jobs;
-    QThreadPool m_threadPool;
+    KisUpdateThreadPool m_threadPool;
     KisLockFreeLodCounter m_lodCounter;
 };
 
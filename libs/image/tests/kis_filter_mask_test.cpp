@@ -122,4 +122,61 @@ void KisFilterMaskTest::testProjectionSelected()
 
 }
 
+void KisFilterMaskTest::testStackedMasksFused()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QImage qimage(QString(FILES_DATA_DIR) + QDir::separator() + "hakonepa.png");
+    QImage inverted(QString(FILES_DATA_DIR) + QDir::separator() + "inverted_hakonepa.png");
+
+    KisFilterSP f = KisFilterRegistry::instance()->value("invert");
+    Q_ASSERT(f);
+
+    KisImageSP image = new KisImage(0, IMAGE_WIDTH, IMAGE_HEIGHT, cs, "tests");
+    KisPaintDeviceSP device = new KisPaintDevice(cs);
+    device->convertFromQImage(qimage, 0, 0, 0);
+    KisPaintLayerSP layer = new KisPaintLayer(image, 0, OPACITY_OPAQUE_U8, device);
+    image->addNode(layer);
+
+    /**
+     * The masks get the default selection that selects everything,
+     * like the ones created from the GUI. The first one has real
+     * selection data, so it cannot be fused and is applied
+     * separately, the two others are fused into a single pass.
+     */
+    QList<KisFilterMaskSP> masks;
+    for (int i = 0; i < 3; i++) {
+        KisFilterMaskSP mask = new KisFilterMask();
+        mask->setFilter(f->defaultConfiguration(0));
+        mask->createNodeProgressProxy();
+        image->addNode(mask, layer);
+        mask->initSelection(layer);
+        masks << mask;
+    }
+
+    masks[0]->selection()->pixelSelection()->clear();
+    masks[0]->select(qimage.rect(), MAX_SELECTED);
+
+    QVERIFY(!masks[0]->inplaceColorTransformation(layer->projection()));
+    QVERIFY(masks[1]->inplaceColorTransformation(layer->projection()));
+    QVERIFY(masks[2]->inplaceColorTransformation(layer->projection()));
+
+    image->initialRefreshGraph();
+
+    QPoint errpoint;
+    if (!TestUtil::compareQImages(errpoint, inverted, layer->projection()->convertToQImage(0, 0, 0, qimage.width(), qimage.height()))) {
+        layer->projection()->convertToQImage(0, 0, 0, qimage.width(), qimage.height()).save("filtermasktest3.png");
+        QFAIL(QString("Failed to create inverted image, first different pixel: %1,%2 ").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+
+    masks[0]->setVisible(false);
+    layer->setDirty();
+    image->waitForDone();
+
+    if (!TestUtil::compareQImages(errpoint, qimage, layer->projection()->convertToQImage(0, 0, 0, qimage.width(), qimage.height()))) {
+        layer->projection()->convertToQImage(0, 0, 0, qimage.width(), qimage.height()).save("filtermasktest4.png");
+        QFAIL(QString("Failed to create identical image, first different pixel: %1,%2 ").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
 QTEST_MAIN(KisFilterMaskTest)
@@ -32,6 +32,7 @@ private Q_SLOTS:
     void testCreation();
     void testProjectionNotSelected();
     void testProjectionSelected();
+    void testStackedMasksFused();
 
 };
 
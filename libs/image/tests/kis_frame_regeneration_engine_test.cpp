@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_frame_regeneration_engine_test.h"
+
+#include <QTest>
+#include <QMutex>
+
+#include <testutil.h>
+#include <KoColor.h>
+
+#include "kis_frame_regeneration_engine.h"
+#include "kis_image_animation_interface.h"
+#include "kis_raster_keyframe_channel.h"
+#include "kis_transparency_mask.h"
+
+
+void KisFrameRegenerationEngineTest::testRegenerateFrames()
+{
+    QRect refRect(QRect(0,0,512,512));
+    TestUtil::MaskParent p(refRect);
+
+    KisPaintLayerSP layer2 = new KisPaintLayer(p.image, "paint2", OPACITY_OPAQUE_U8);
+    p.image->addNode(layer2);
+
+    const QRect rc1(101,101,100,100);
+    const QRect rc2(102,102,100,100);
+    const QRect rc3(103,103,100,100);
+    const QRect rc4(104,104,100,100);
+
+    KisImageAnimationInterface *i = p.image->animationInterface();
+    KisPaintDeviceSP dev1 = p.layer->paintDevice();
+    KisPaintDeviceSP dev2 = layer2->paintDevice();
+
+    dev1->fill(rc1, KoColor(Qt::red, dev1->colorSpace()));
+    dev2->fill(rc2, KoColor(Qt::green, dev2->colorSpace()));
+    p.image->refreshGraph();
+
+    KisPaintDeviceSP frame0Projection = new KisPaintDevice(*p.image->projection());
+
+    i->switchCurrentTimeAsync(10);
+    p.image->waitForDone();
+
+    dev1->keyframeChannel()->addKeyframe(10);
+    dev2->keyframeChannel()->addKeyframe(10);
+
+    dev1->fill(rc3, KoColor(Qt::red, dev1->colorSpace()));
+    dev2->fill(rc4, KoColor(Qt::green, dev2->colorSpace()));
+    p.image->refreshGraph();
+
+    QVERIFY(KisFrameRegenerationEngine::canRegenerateFrames(p.image));
+
+    QList<int> frames;
+    frames << 0 << 5 << 10 << 15;
+
+    KisFrameRegenerationEngine engine(p.image, frames, 4, qint64(1) << 30);
+    QCOMPARE(engine.maxConcurrentFrames(), 4);
+
+    QMutex lock;
+    QMap<int, KisPaintDeviceSP> result;
+
+    engine.regenerateFrames(
+        [&lock, &result] (int time, KisPaintDeviceSP projection) {
+            QMutexLocker l(&lock);
+            result.insert(time, projection);
+        });
+
+    QCOMPARE(result.size(), 4);
+
+    QCOMPARE(result[0]->exactBounds(), rc1 | rc2);
+    QCOMPARE(result[5]->exactBounds(), rc1 | rc2);
+    QCOMPARE(result[10]->exactBounds(), rc3 | rc4);
+    QCOMPARE(result[15]->exactBounds(), rc3 | rc4);
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, result[0], frame0Projection));
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, result[10], p.image->projection()));
+
+    // the image itself is not touched
+    QCOMPARE(i->currentTime(), 10);
+    QCOMPARE(p.image->projection()->exactBounds(), rc3 | rc4);
+
+    // a single frame can be fetched as well
+    QCOMPARE(engine.regenerateFrame(5)->exactBounds(), rc1 | rc2);
+}
+
+void KisFrameRegenerationEngineTest::testUnsupportedNodes()
+{
+    TestUtil::MaskParent p;
+    QVERIFY(KisFrameRegenerationEngine::canRegenerateFrames(p.image));
+
+    KisTransparencyMaskSP mask = new KisTransparencyMask();
+    p.image->addNode(mask, p.layer);
+
+    QVERIFY(!KisFrameRegenerationEngine::canRegenerateFrames(p.image));
+}
+
+QTEST_MAIN(KisFrameRegenerationEngineTest)
@@ -334,4 +334,51 @@ void KisGradientPainterTest::testCachedStrategy()
     QVERIFY(maxError < 2 * maxRelError);
 }
 
+void KisGradientPainterTest::testPatchedGradient()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP refDev = new KisPaintDevice(cs);
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    QRect imageRect(0,0,300,300);
+
+    QLinearGradient testGradient;
+    testGradient.setColorAt(0.0, Qt::white);
+    testGradient.setColorAt(0.5, Qt::green);
+    testGradient.setColorAt(1.0, Qt::black);
+    QScopedPointer<KoStopGradient> gradient(
+        KoStopGradient::fromQGradient(&testGradient));
+
+    const QPointF start(30, 50);
+    const QPointF end(250, 210);
+
+    KisGradientPainter refGc(refDev);
+    refGc.setGradient(gradient.data());
+    refGc.setGradientShape(KisGradientPainter::GradientShapeRadial);
+    refGc.paintGradient(start, end,
+                        KisGradientPainter::GradientRepeatAlternate,
+                        0, false, imageRect);
+
+    KisGradientPainter gc(dev);
+    gc.setGradient(gradient.data());
+    gc.setGradientShape(KisGradientPainter::GradientShapeRadial);
+
+    KisGradientPainter::PreparedGradientSP prepared =
+        gc.prepareGradient(start, end,
+                           KisGradientPainter::GradientRepeatAlternate,
+                           0, false, imageRect);
+    QVERIFY(prepared);
+
+    QVector<QRect> patches = KritaUtils::splitRectIntoPatches(imageRect, QSize(64, 64));
+    QVERIFY(patches.size() > 1);
+
+    Q_FOREACH (const QRect &rc, patches) {
+        KisGradientPainter patchGc(dev);
+        QVERIFY(patchGc.paintGradientPatch(prepared, rc));
+    }
+
+    QCOMPARE(dev->convertToQImage(0, imageRect),
+             refDev->convertToQImage(0, imageRect));
+}
+
 QTEST_MAIN(KisGradientPainterTest)
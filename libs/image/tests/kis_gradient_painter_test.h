@@ -37,6 +37,8 @@ private Q_SLOTS:
     void testSplitDisjointPaths();
 
     void testCachedStrategy();
+
+    void testPatchedGradient();
 };
 
 #endif
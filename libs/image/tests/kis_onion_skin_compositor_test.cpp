@@ -21,6 +21,7 @@
 #include <QTest>
 
 #include "kis_onion_skin_compositor.h"
+#include "kis_onion_skin_cache.h"
 #include "kis_paint_device.h"
 #include "kis_raster_keyframe_channel.h"
 #include "kis_image_animation_interface.h"
@@ -188,4 +189,105 @@ void KisOnionSkinCompositorTest::testSettings()
     QVERIFY(result == expected);
 }
 
+void KisOnionSkinCompositorTest::testCache()
+{
+    KisImageConfig config;
+    config.setOnionSkinTintFactor(64);
+    config.setOnionSkinTintColorBackward(Qt::blue);
+    config.setOnionSkinTintColorForward(Qt::red);
+    config.setNumberOfOnionSkins(1);
+    config.setOnionSkinOpacity(-1, 128);
+    config.setOnionSkinOpacity(1, 128);
+
+    KisOnionSkinCompositor *compositor = KisOnionSkinCompositor::instance();
+    compositor->configChanged();
+
+    TestUtil::MaskParent p;
+
+    KisImageAnimationInterface *i = p.image->animationInterface();
+    KisPaintDeviceSP paintDevice = p.layer->paintDevice();
+    KisKeyframeChannel *keyframes = paintDevice->keyframeChannel();
+
+    keyframes->addKeyframe(0);
+    keyframes->addKeyframe(10);
+    keyframes->addKeyframe(20);
+
+    paintDevice->fill(QRect(0,0,256,512), KoColor(Qt::red, paintDevice->colorSpace()));
+    paintDevice->setDirty(QRect(0,0,256,512));
+
+    i->switchCurrentTimeAsync(10);
+    p.image->waitForDone();
+
+    paintDevice->fill(QRect(0,0,512,256), KoColor(Qt::green, paintDevice->colorSpace()));
+    paintDevice->setDirty(QRect(0,0,512,256));
+
+    i->switchCurrentTimeAsync(20);
+    p.image->waitForDone();
+
+    paintDevice->fill(QRect(0,256,512,256), KoColor(Qt::blue, paintDevice->colorSpace()));
+    paintDevice->setDirty(QRect(0,256,512,256));
+
+    i->switchCurrentTimeAsync(10);
+    p.image->waitForDone();
+
+    KisOnionSkinCache cache;
+    const QRect rc(0,0,512,512);
+
+    KisPaintDeviceSP skins = cache.projection(paintDevice);
+
+    KisPaintDeviceSP expectedComposite = new KisPaintDevice(p.image->colorSpace());
+    compositor->composite(paintDevice, expectedComposite, rc);
+    QVERIFY(TestUtil::comparePaintDevicesClever<quint8>(skins, expectedComposite, 1));
+
+    // both skins have been tinted once
+    QCOMPARE(cache.regenerationCount(), 1);
+    QCOMPARE(cache.tintCount(), 2);
+
+    // the cache should not be regenerated when nothing has changed
+    cache.projection(paintDevice);
+    QCOMPARE(cache.regenerationCount(), 1);
+    QCOMPARE(cache.tintCount(), 2);
+
+    // painting on the current frame should not invalidate the cache
+    paintDevice->fill(QRect(0,0,128,128), KoColor(Qt::white, paintDevice->colorSpace()));
+    paintDevice->setDirty(QRect(0,0,128,128));
+    cache.projection(paintDevice);
+    QCOMPARE(cache.regenerationCount(), 1);
+    QCOMPARE(cache.tintCount(), 2);
+
+    // changing content of one of the skins should update the cache
+    i->switchCurrentTimeAsync(20);
+    p.image->waitForDone();
+
+    paintDevice->fill(QRect(0,0,512,512), KoColor(Qt::black, paintDevice->colorSpace()));
+    paintDevice->setDirty(QRect(0,0,512,512));
+
+    i->switchCurrentTimeAsync(10);
+    p.image->waitForDone();
+
+    skins = cache.projection(paintDevice);
+
+    expectedComposite->clear();
+    compositor->composite(paintDevice, expectedComposite, rc);
+    QVERIFY(TestUtil::comparePaintDevicesClever<quint8>(skins, expectedComposite, 1));
+
+    // only the changed skin has been tinted again
+    QCOMPARE(cache.regenerationCount(), 2);
+    QCOMPARE(cache.tintCount(), 3);
+
+    // changing the tint should update the cache
+    config.setOnionSkinTintColorForward(Qt::green);
+    compositor->configChanged();
+
+    skins = cache.projection(paintDevice);
+
+    expectedComposite->clear();
+    compositor->composite(paintDevice, expectedComposite, rc);
+    QVERIFY(TestUtil::comparePaintDevicesClever<quint8>(skins, expectedComposite, 1));
+
+    // all the skins have been tinted again
+    QCOMPARE(cache.regenerationCount(), 3);
+    QCOMPARE(cache.tintCount(), 5);
+}
+
 QTEST_MAIN(KisOnionSkinCompositorTest)
@@ -277,5 +277,60 @@ void KisSimpleUpdateQueueTest::testSpontaneousJobsCompression()
     QCOMPARE(jobsList[0], job3);
 }
 
+void KisSimpleUpdateQueueTest::testPriorityHint()
+{
+    QRect imageRect(0,0,1024,1024);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "priority test");
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+
+    image->lock();
+    image->addNode(paintLayer);
+    image->unlock();
+
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+
+    queue.setUpdatePriorityHint(QRect(600,600,300,300), QPointF(800,700));
+    queue.addUpdateJob(paintLayer, QRect(0,0,1000,1000), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 4);
+
+    KisTestableUpdaterContext context(2);
+    queue.processQueue(context);
+
+    QVector<KisUpdateJobItem*> jobs = context.getJobs();
+    QCOMPARE(jobs.size(), 2);
+
+    // the visible patch goes first, then the ones closer to the viewport
+    QVERIFY(checkWalker(jobs[0]->walker(), QRect(512,512,488,488)));
+    QVERIFY(checkWalker(jobs[1]->walker(), QRect(512,0,488,512)));
+
+    QCOMPARE(walkersList.size(), 2);
+    QVERIFY(checkWalker(walkersList[0], QRect(0,512,512,488)));
+    QVERIFY(checkWalker(walkersList[1], QRect(0,0,512,512)));
+
+    context.clear();
+    walkersList.clear();
+
+    // with the hint set, long strips are split as well
+    queue.addUpdateJob(paintLayer, QRect(0,0,1000,100), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 2);
+    QVERIFY(checkWalker(walkersList[0], QRect(0,0,512,100)));
+    QVERIFY(checkWalker(walkersList[1], QRect(512,0,488,100)));
+
+    walkersList.clear();
+
+    // an empty hint returns the queue to FIFO order
+    queue.setUpdatePriorityHint(QRect(), QPointF());
+    queue.addUpdateJob(paintLayer, QRect(0,0,1000,100), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 1);
+    QVERIFY(checkWalker(walkersList[0], QRect(0,0,1000,100)));
+}
+
 QTEST_MAIN(KisSimpleUpdateQueueTest)
 
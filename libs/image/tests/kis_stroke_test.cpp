@@ -190,4 +190,79 @@ void KisStrokeTest::testCancelStrokeCase6()
     stroke.clearQueueOnCancel();
 }
 
+class MergingStrokeStrategy : public KisTestingStrokeStrategy
+{
+public:
+    MergingStrokeStrategy(int maxMerges)
+        : m_maxMerges(maxMerges),
+          m_numMerges(0)
+    {
+    }
+
+    bool tryMergeJobData(KisStrokeJobData *target, const KisStrokeJobData *next) {
+        Q_UNUSED(target);
+        Q_UNUSED(next);
+
+        if (m_numMerges >= m_maxMerges) return false;
+
+        m_numMerges++;
+        return true;
+    }
+
+    void setMaxMerges(int value) {
+        m_maxMerges = value;
+    }
+
+    int numMerges() const {
+        return m_numMerges;
+    }
+
+private:
+    int m_maxMerges;
+    int m_numMerges;
+};
+
+void KisStrokeTest::testMergeDabJobs()
+{
+    MergingStrokeStrategy *strategy = new MergingStrokeStrategy(2);
+    KisStroke stroke(strategy);
+    QQueue<KisStrokeJob*> &queue = stroke.testingGetQueue();
+
+    for (int i = 0; i < 4; i++) {
+        stroke.addJob(new KisTestingStrokeJobData());
+    }
+    stroke.addJob(new KisTestingStrokeJobData(KisStrokeJobData::CONCURRENT));
+    stroke.addJob(new KisTestingStrokeJobData());
+    stroke.endStroke();
+
+    QCOMPARE(queue.size(), 8);
+
+    // the init job is never merged
+    delete stroke.popOneJob();
+    QCOMPARE(queue.size(), 7);
+    QCOMPARE(strategy->numMerges(), 0);
+
+    // two of the waiting dabs are merged, then the strategy refuses
+    delete stroke.popOneJob();
+    QCOMPARE(queue.size(), 4);
+    QCOMPARE(strategy->numMerges(), 2);
+    SCOMPARE(getJobName(queue[0]), "dab");
+
+    // concurrent jobs are never merged
+    strategy->setMaxMerges(100);
+    delete stroke.popOneJob();
+    QCOMPARE(queue.size(), 3);
+    delete stroke.popOneJob();
+    QCOMPARE(queue.size(), 2);
+    QCOMPARE(strategy->numMerges(), 2);
+
+    // the finishing job is never merged
+    delete stroke.popOneJob();
+    QCOMPARE(queue.size(), 1);
+    SCOMPARE(getJobName(queue[0]), "finish");
+
+    delete stroke.popOneJob();
+    QCOMPARE(queue.size(), 0);
+}
+
 QTEST_MAIN(KisStrokeTest)
@@ -0,0 +1,333 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_trace_recorder_test.h"
+
+#include <QTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThread>
+#include <QSet>
+
+#include "kis_trace_recorder.h"
+
+
+QJsonArray parseEvents(const KisTraceRecorder &recorder, qint64 since = 0)
+{
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(recorder.toChromeTrace(since), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qWarning() << "Failed to parse the trace:" << error.errorString();
+        return QJsonArray();
+    }
+
+    return doc.object().value("traceEvents").toArray();
+}
+
+QList<QJsonObject> findEvents(const QJsonArray &events, const QString &name)
+{
+    QList<QJsonObject> result;
+
+    Q_FOREACH (const QJsonValue &value, events) {
+        QJsonObject event = value.toObject();
+        if (event.value("name").toString() == name) {
+            result << event;
+        }
+    }
+
+    return result;
+}
+
+void KisTraceRecorderTest::testDisabled()
+{
+    KisTraceRecorder recorder;
+    recorder.setEnabled(false);
+
+    recorder.beginEvent("test", "job");
+    recorder.endEvent("test", "job");
+    recorder.instantEvent("test", "instant");
+    recorder.addDabs(10);
+
+    QCOMPARE(recorder.takeDabs(), qint64(0));
+    QVERIFY(parseEvents(recorder).isEmpty());
+}
+
+void KisTraceRecorderTest::testChromeTraceExport()
+{
+    KisTraceRecorder recorder;
+    recorder.setEnabled(true);
+
+    recorder.beginEvent("test", "job");
+    recorder.rectEvent("test", "rect", QRect(10, 20, 30, 40));
+    recorder.addDabs(3);
+    recorder.addDabs(2);
+    recorder.endEvent("test", "job", "dabs", recorder.takeDabs());
+    recorder.counterEvent("test", "counter", 42);
+
+    QJsonArray events = parseEvents(recorder);
+
+    QList<QJsonObject> threadNames = findEvents(events, "thread_name");
+    QCOMPARE(threadNames.size(), 1);
+    QCOMPARE(threadNames.first().value("ph").toString(), QString("M"));
+
+    QList<QJsonObject> jobs = findEvents(events, "job");
+    QCOMPARE(jobs.size(), 2);
+    QCOMPARE(jobs[0].value("ph").toString(), QString("B"));
+    QCOMPARE(jobs[1].value("ph").toString(), QString("E"));
+    QCOMPARE(jobs[1].value("args").toObject().value("dabs").toInt(), 5);
+    QVERIFY(jobs[0].value("ts").toDouble() <= jobs[1].value("ts").toDouble());
+
+    QList<QJsonObject> rects = findEvents(events, "rect");
+    QCOMPARE(rects.size(), 1);
+    QJsonObject rectArgs = rects.first().value("args").toObject();
+    QCOMPARE(rectArgs.value("x").toInt(), 10);
+    QCOMPARE(rectArgs.value("y").toInt(), 20);
+    QCOMPARE(rectArgs.value("width").toInt(), 30);
+    QCOMPARE(rectArgs.value("height").toInt(), 40);
+
+    QList<QJsonObject> counters = findEvents(events, "counter");
+    QCOMPARE(counters.size(), 1);
+    QCOMPARE(counters.first().value("ph").toString(), QString("C"));
+    QCOMPARE(counters.first().value("args").toObject().value("counter").toInt(), 42);
+}
+
+class TracingThread : public QThread
+{
+public:
+    TracingThread(KisTraceRecorder *recorder) : m_recorder(recorder) {}
+
+    void run() {
+        for (int i = 0; i < 100; i++) {
+            m_recorder->beginEvent("test", "thread-job");
+            m_recorder->instantEvent("test", "tick");
+            m_recorder->endEvent("test", "thread-job");
+        }
+    }
+
+private:
+    KisTraceRecorder *m_recorder;
+};
+
+void KisTraceRecorderTest::testMultipleThreads()
+{
+    KisTraceRecorder recorder;
+    recorder.setEnabled(true);
+
+    QList<TracingThread*> threads;
+    for (int i = 0; i < 4; i++) {
+        threads << new TracingThread(&recorder);
+    }
+
+    Q_FOREACH (TracingThread *thread, threads) {
+        thread->start();
+    }
+
+    Q_FOREACH (TracingThread *thread, threads) {
+        thread->wait();
+    }
+
+    qDeleteAll(threads);
+
+    QJsonArray events = parseEvents(recorder);
+
+    QCOMPARE(findEvents(events, "thread_name").size(), 4);
+    QCOMPARE(findEvents(events, "tick").size(), 400);
+
+    QSet<int> threadIds;
+    Q_FOREACH (const QJsonObject &event, findEvents(events, "tick")) {
+        threadIds.insert(event.value("tid").toInt());
+    }
+    QCOMPARE(threadIds.size(), 4);
+}
+
+void KisTraceRecorderTest::testRingBufferOverflow()
+{
+    KisTraceRecorder recorder;
+    recorder.setEnabled(true);
+
+    // the recorder never allocates less than 1024 events per thread
+    const int numEvents = 100000;
+
+    for (int i = 0; i < numEvents; i++) {
+        recorder.counterEvent("test", "counter", i);
+    }
+
+    QList<QJsonObject> counters = findEvents(parseEvents(recorder), "counter");
+    QVERIFY(counters.size() > 0);
+    QVERIFY(counters.size() < numEvents);
+
+    // the newest events survive in the right order
+    QCOMPARE(counters.last().value("args").toObject().value("counter").toInt(), numEvents - 1);
+    QCOMPARE(counters.first().value("args").toObject().value("counter").toInt(),
+             numEvents - counters.size());
+}
+
+class RectsThread : public QThread
+{
+public:
+    RectsThread(KisTraceRecorder *recorder) : m_recorder(recorder) {}
+
+    void run() {
+        for (int i = 0; i < 200000; i++) {
+            m_recorder->rectEvent("test", "rect", QRect(i, i, i, i));
+        }
+    }
+
+private:
+    KisTraceRecorder *m_recorder;
+};
+
+void KisTraceRecorderTest::testExportWhileRecording()
+{
+    KisTraceRecorder recorder;
+    recorder.setEnabled(true);
+
+    RectsThread thread(&recorder);
+    thread.start();
+
+    /**
+     * The writer wraps around its buffer many times while we export,
+     * but every exported event must be consistent and in order
+     */
+    bool eventsConsistent = true;
+
+    while (eventsConsistent && !thread.isFinished()) {
+        QList<QJsonObject> rects = findEvents(parseEvents(recorder), "rect");
+
+        int lastValue = -1;
+        Q_FOREACH (const QJsonObject &event, rects) {
+            QJsonObject args = event.value("args").toObject();
+            const int value = args.value("x").toInt();
+
+            if (args.value("y").toInt() != value ||
+                args.value("width").toInt() != value ||
+                args.value("height").toInt() != value ||
+                value <= lastValue) {
+
+                eventsConsistent = false;
+                break;
+            }
+
+            lastValue = value;
+        }
+    }
+
+    thread.wait();
+    QVERIFY(eventsConsistent);
+}
+
+void KisTraceRecorderTest::testFinishedThreadsAreDropped()
+{
+    KisTraceRecorder recorder;
+    recorder.setEnabled(true);
+
+    const int numThreads = 100;
+
+    for (int i = 0; i < numThreads; i++) {
+        TracingThread thread(&recorder);
+        thread.start();
+        thread.wait();
+    }
+
+    QJsonArray events = parseEvents(recorder);
+
+    // only the latest finished threads are kept
+    const int numKeptThreads = findEvents(events, "thread_name").size();
+    QVERIFY(numKeptThreads > 0);
+    QVERIFY(numKeptThreads < numThreads);
+    QCOMPARE(findEvents(events, "tick").size(), numKeptThreads * 100);
+}
+
+void KisTraceRecorderTest::testClear()
+{
+    KisTraceRecorder recorder;
+    recorder.setEnabled(true);
+
+    recorder.instantEvent("test", "old");
+    QTest::qSleep(1);
+    recorder.clear();
+    QTest::qSleep(1);
+    recorder.instantEvent("test", "new");
+
+    QJsonArray events = parseEvents(recorder);
+    QCOMPARE(findEvents(events, "old").size(), 0);
+    QCOMPARE(findEvents(events, "new").size(), 1);
+
+    const qint64 since = recorder.currentTimestamp();
+    QTest::qSleep(1);
+    recorder.instantEvent("test", "newest");
+
+    events = parseEvents(recorder, since);
+    QCOMPARE(findEvents(events, "new").size(), 0);
+    QCOMPARE(findEvents(events, "newest").size(), 1);
+}
+
+class SequentialRecordersThread : public QThread
+{
+public:
+    void run() {
+        {
+            KisTraceRecorder firstRecorder;
+            firstRecorder.setEnabled(true);
+            firstRecorder.instantEvent("test", "first");
+        }
+
+        secondRecorder.reset(new KisTraceRecorder());
+        secondRecorder->setEnabled(true);
+        secondRecorder->instantEvent("test", "second");
+    }
+
+    QScopedPointer<KisTraceRecorder> secondRecorder;
+};
+
+void KisTraceRecorderTest::testSequentialRecorders()
+{
+    /**
+     * The thread storage of the second recorder is likely to get the
+     * id of the first one, together with its stale per-thread data
+     */
+    {
+        KisTraceRecorder firstRecorder;
+        firstRecorder.setEnabled(true);
+        firstRecorder.instantEvent("test", "first");
+    }
+
+    {
+        KisTraceRecorder secondRecorder;
+        secondRecorder.setEnabled(true);
+        secondRecorder.instantEvent("test", "second");
+
+        QJsonArray events = parseEvents(secondRecorder);
+        QCOMPARE(findEvents(events, "first").size(), 0);
+        QCOMPARE(findEvents(events, "second").size(), 1);
+        QCOMPARE(findEvents(events, "thread_name").size(), 1);
+    }
+
+    // the thread exits after its first recorder is gone
+    SequentialRecordersThread thread;
+    thread.start();
+    thread.wait();
+
+    QJsonArray events = parseEvents(*thread.secondRecorder);
+    QCOMPARE(findEvents(events, "first").size(), 0);
+    QCOMPARE(findEvents(events, "second").size(), 1);
+    QCOMPARE(findEvents(events, "thread_name").size(), 1);
+}
+
+QTEST_MAIN(KisTraceRecorderTest)
@@ -0,0 +1,239 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_update_thread_pool_test.h"
+
+#include <QTest>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+
+#include "kis_update_thread_pool.h"
+
+
+class CountingJob : public QRunnable
+{
+public:
+    CountingJob(QAtomicInt &counter)
+        : m_counter(counter)
+    {
+    }
+
+    void run() {
+        m_counter.ref();
+    }
+
+private:
+    QAtomicInt &m_counter;
+};
+
+void KisUpdateThreadPoolTest::testWaitForDone()
+{
+    const int numJobs = 10000;
+    QAtomicInt counter;
+
+    KisUpdateThreadPool pool(4);
+    QCOMPARE(pool.threadCount(), 4);
+
+    for (int i = 0; i < numJobs; i++) {
+        pool.start(new CountingJob(counter));
+    }
+
+    pool.waitForDone();
+    QCOMPARE(int(counter), numJobs);
+
+    // the pool must be reusable after waiting
+    for (int i = 0; i < numJobs; i++) {
+        pool.start(new CountingJob(counter));
+    }
+
+    pool.waitForDone();
+    QCOMPARE(int(counter), 2 * numJobs);
+}
+
+class SpawningJob : public QRunnable
+{
+public:
+    SpawningJob(KisUpdateThreadPool &pool, QAtomicInt &counter, int depth)
+        : m_pool(pool),
+          m_counter(counter),
+          m_depth(depth)
+    {
+    }
+
+    void run() {
+        m_counter.ref();
+
+        if (m_depth > 0) {
+            m_pool.start(new SpawningJob(m_pool, m_counter, m_depth - 1));
+            m_pool.start(new SpawningJob(m_pool, m_counter, m_depth - 1));
+        }
+    }
+
+private:
+    KisUpdateThreadPool &m_pool;
+    QAtomicInt &m_counter;
+    int m_depth;
+};
+
+void KisUpdateThreadPoolTest::testNestedJobs()
+{
+    const int depth = 12;
+    QAtomicInt counter;
+
+    KisUpdateThreadPool pool(4);
+    pool.start(new SpawningJob(pool, counter, depth));
+    pool.waitForDone();
+
+    QCOMPARE(int(counter), (1 << (depth + 1)) - 1);
+}
+
+class SleepingJob : public QRunnable
+{
+public:
+    SleepingJob(QMutex &lock, QSet<QThread*> &threads)
+        : m_lock(lock),
+          m_threads(threads)
+    {
+    }
+
+    void run() {
+        {
+            QMutexLocker l(&m_lock);
+            m_threads.insert(QThread::currentThread());
+        }
+        QTest::qSleep(20);
+    }
+
+private:
+    QMutex &m_lock;
+    QSet<QThread*> &m_threads;
+};
+
+class ForkingJob : public QRunnable
+{
+public:
+    ForkingJob(KisUpdateThreadPool &pool, QMutex &lock, QSet<QThread*> &threads)
+        : m_pool(pool),
+          m_lock(lock),
+          m_threads(threads)
+    {
+    }
+
+    void run() {
+        for (int i = 0; i < 8; i++) {
+            m_pool.start(new SleepingJob(m_lock, m_threads));
+        }
+    }
+
+private:
+    KisUpdateThreadPool &m_pool;
+    QMutex &m_lock;
+    QSet<QThread*> &m_threads;
+};
+
+void KisUpdateThreadPoolTest::testStealing()
+{
+    QMutex lock;
+    QSet<QThread*> threads;
+
+    KisUpdateThreadPool pool(4);
+
+    /**
+     * All the sleeping jobs land in the queue of a single worker,
+     * so the only way for them to run in parallel is to be stolen
+     */
+    pool.start(new ForkingJob(pool, lock, threads));
+    pool.waitForDone();
+
+    QVERIFY(threads.size() > 1);
+    QVERIFY(!threads.contains(QThread::currentThread()));
+}
+
+template <class Pool>
+class ChainedJob : public QRunnable
+{
+public:
+    ChainedJob(Pool &pool, QAtomicInt &counter, int numJobs)
+        : m_pool(pool),
+          m_counter(counter),
+          m_numJobs(numJobs)
+    {
+    }
+
+    void run() {
+        if (m_counter.fetchAndAddOrdered(1) < m_numJobs) {
+            m_pool.start(new ChainedJob(m_pool, m_counter, m_numJobs));
+        }
+    }
+
+private:
+    Pool &m_pool;
+    QAtomicInt &m_counter;
+    int m_numJobs;
+};
+
+void KisUpdateThreadPoolTest::benchmarkChainedJobs_data()
+{
+    QTest::addColumn<bool>("useUpdatePool");
+
+    QTest::newRow("qthreadpool") << false;
+    QTest::newRow("update-pool") << true;
+}
+
+/**
+ * Every job starts the next one, which is exactly what happens
+ * when a finished job asks the scheduler for more work. The time
+ * is dominated by the dispatch cost.
+ */
+void KisUpdateThreadPoolTest::benchmarkChainedJobs()
+{
+    QFETCH(bool, useUpdatePool);
+
+    const int numChains = 4;
+    const int numJobs = 50000;
+
+    if (useUpdatePool) {
+        KisUpdateThreadPool pool(numChains);
+
+        QBENCHMARK {
+            QAtomicInt counter;
+            for (int i = 0; i < numChains; i++) {
+                pool.start(new ChainedJob<KisUpdateThreadPool>(pool, counter, numJobs));
+            }
+            pool.waitForDone();
+        }
+    } else {
+        QThreadPool pool;
+        pool.setMaxThreadCount(numChains);
+
+        QBENCHMARK {
+            QAtomicInt counter;
+            for (int i = 0; i < numChains; i++) {
+                pool.start(new ChainedJob<QThreadPool>(pool, counter, numJobs));
+            }
+            pool.waitForDone();
+        }
+    }
+}
+
+QTEST_MAIN(KisUpdateThreadPoolTest)
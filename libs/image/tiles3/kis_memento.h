@@ -46,6 +46,8 @@ public:
 
         m_oldDefaultPixel = 0;
         m_newDefaultPixel = 0;
+
+        m_memoryUsage = 0;
     }
 
     inline ~KisMemento() {
@@ -84,6 +86,15 @@ public:
         return m_newDefaultPixel;
     }
 
+    /**
+     * The amount of memory occupied by the tiles of the revision
+     * (uncompressed). The tiles shared with the previous revision
+     * are not counted.
+     */
+    qint64 memoryUsage() const {
+        return m_memoryUsage;
+    }
+
 private:
     friend class KisMementoManager;
 
@@ -107,6 +118,8 @@ private:
     qint32 m_extentMaxX;
     qint32 m_extentMinY;
     qint32 m_extentMaxY;
+
+    qint64 m_memoryUsage;
 };
 
 #endif // KIS_MEMENTO_H_
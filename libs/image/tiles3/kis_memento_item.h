@@ -127,6 +127,20 @@ public:
         m_type = CHANGED;
     }
 
+    /**
+     * Replaces the tile data of a committed item with \p tileData,
+     * which must have exactly the same content. Used for sharing
+     * identical tiles between neighbouring revisions.
+     */
+    void replaceTileData(KisTileData *tileData) {
+        Q_ASSERT(m_committedFlag);
+
+        tileData->acquire();
+        tileData->setMementoed(true);
+        releaseTileData();
+        m_tileData = tileData;
+    }
+
     void commit() {
         if (m_committedFlag) return;
         if (m_tileData) {
@@ -175,6 +189,9 @@ public:
     inline KisTileData* tileData() const {
         return m_tileData;
     }
+    inline bool isCommitted() const {
+        return m_committedFlag;
+    }
 
     void debugPrintInfo() {
         QString s = QString("------\n"
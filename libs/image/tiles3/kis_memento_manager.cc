@@ -17,6 +17,8 @@
  */
 
 #include <QtGlobal>
+#include <string.h>
+
 #include "kis_memento_manager.h"
 #include "kis_memento.h"
 
@@ -99,8 +101,8 @@ KisMementoManager::KisMementoManager(const KisMementoManager& rhs)
 
 KisMementoManager::~KisMementoManager()
 {
-    // Nothing to be done here. Happily...
-    // Everything is done by QList and KisSharedPtr...
+    // Everything else is done by QList and KisSharedPtr...
+    resetRecentHistory();
     DEBUG_LOG_SIMPLE_ACTION("died\n");
 }
 
@@ -166,6 +168,52 @@ void KisMementoManager::registerTileDeleted(KisTile *tile)
     }
 }
 
+namespace {
+
+inline qint64 tileDataSize(KisTileData *td)
+{
+    return qint64(td->pixelSize()) * KisTileData::WIDTH * KisTileData::HEIGHT;
+}
+
+/**
+ * Checks whether the new revision of the tile is an exact copy of
+ * the previous one, which happens quite often when a filter or a
+ * transformation is applied to a big area. The comparison is done
+ * only when both tiles are in memory, we don't want to bring the
+ * history back from swap for that.
+ */
+bool sameTileContent(KisMementoItemSP mi, KisMementoItemSP parentMI)
+{
+    if (mi->isCommitted() ||
+        mi->type() != KisMementoItem::CHANGED ||
+        parentMI->type() != KisMementoItem::CHANGED) {
+
+        return false;
+    }
+
+    KisTileData *td = mi->tileData();
+    KisTileData *parentTD = parentMI->tileData();
+
+    if (td == parentTD ||
+        td->pixelSize() != parentTD->pixelSize() ||
+        !td->data() || !parentTD->data()) {
+
+        return false;
+    }
+
+    td->blockSwapping();
+    parentTD->blockSwapping();
+
+    const bool result = !memcmp(td->data(), parentTD->data(), tileDataSize(td));
+
+    parentTD->unblockSwapping();
+    td->unblockSwapping();
+
+    return result;
+}
+
+}
+
 void KisMementoManager::commit()
 {
     if (m_index.isEmpty()) {
@@ -187,20 +235,49 @@ void KisMementoManager::commit()
     KisMementoItemSP parentMI;
     bool newTile;
 
+    qint64 memoryUsage = 0;
+
+    resetRecentHistory();
+
     KisMementoItemHashTableIterator iter(&m_index);
     while ((mi = iter.tile())) {
         parentMI = m_headsHashTable.getTileLazy(mi->col(), mi->row(), newTile);
 
+        /**
+         * If the tile has not actually changed, let the previous
+         * revision use the new tile data and free the old copy.
+         * The new data keeps being shared with the device, so the
+         * next write to the tile will still be registered via COW.
+         */
+        if (sameTileContent(mi, parentMI)) {
+            parentMI->replaceTileData(mi->tileData());
+        }
+
+        KisTileData *parentTileData = parentMI->tileData();
+        parentTileData->ref();
+        parentTileData->setRecentHistory(true);
+        m_recentHistoryTileData.append(parentTileData);
+
         mi->setParent(parentMI);
         mi->commit();
         revisionList.append(mi);
 
+        if (mi->type() == KisMementoItem::CHANGED &&
+            mi->tileData() != parentMI->tileData()) {
+
+            memoryUsage += tileDataSize(mi->tileData());
+        }
+
         m_headsHashTable.deleteTile(mi->col(), mi->row());
 
         iter.moveCurrentToHashTable(&m_headsHashTable);
         //++iter; // previous line does this for us
     }
 
+    if (m_currentMemento) {
+        m_currentMemento->m_memoryUsage = memoryUsage;
+    }
+
     KisHistoryItem hItem;
     hItem.itemList = revisionList;
     hItem.memento = m_currentMemento.data();
@@ -215,6 +292,15 @@ void KisMementoManager::commit()
     KisTileDataStore::instance()->kickPooler();
 }
 
+void KisMementoManager::resetRecentHistory()
+{
+    Q_FOREACH (KisTileData *tileData, m_recentHistoryTileData) {
+        tileData->setRecentHistory(false);
+        tileData->deref();
+    }
+    m_recentHistoryTileData.clear();
+}
+
 KisTileSP KisMementoManager::getCommitedTile(qint32 col, qint32 row)
 {
     /**
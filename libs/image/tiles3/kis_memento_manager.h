@@ -20,6 +20,7 @@
 #define KIS_MEMENTO_MANAGER_
 
 #include <QList>
+#include <QVector>
 
 #include "kis_memento_item.h"
 #include "kis_tile_hash_table.h"
@@ -114,6 +115,7 @@ public:
 protected:
     qint32 findRevisionByMemento(KisMementoSP memento) const;
     void resetRevisionHistory(KisMementoItemList list);
+    void resetRecentHistory();
 
 protected:
     /**
@@ -146,6 +148,13 @@ protected:
      */
     KisMementoSP m_currentMemento;
 
+    /**
+     * The tile datas the latest revision would be undone into.
+     * They are referenced and marked as recent history, so that
+     * the swapper doesn't push them out of memory proactively.
+     */
+    QVector<KisTileData*> m_recentHistoryTileData;
+
     /**
      * The flag that blocks registration of changes on tiles.
      * This is a temporary state of the memento manager, that
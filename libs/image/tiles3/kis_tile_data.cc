@@ -39,6 +39,7 @@ const qint32 KisTileData::HEIGHT = __TILE_DATA_HEIGHT;
 KisTileData::KisTileData(qint32 pixelSize, const quint8 *defPixel, KisTileDataStore *store)
     : m_state(NORMAL),
       m_mementoFlag(0),
+      m_recentHistoryFlag(0),
       m_age(0),
       m_usersCount(0),
       m_refCount(0),
@@ -66,6 +67,7 @@ KisTileData::KisTileData(qint32 pixelSize, const quint8 *defPixel, KisTileDataSt
 KisTileData::KisTileData(const KisTileData& rhs, bool checkFreeMemory)
     : m_state(NORMAL),
       m_mementoFlag(0),
+      m_recentHistoryFlag(0),
       m_age(0),
       m_usersCount(0),
       m_refCount(0),
@@ -115,6 +115,17 @@ inline void KisTileData::setMementoed(bool value) {
     m_mementoFlag += value ? 1 : -1;
 }
 
+inline bool KisTileData::recentHistory() const {
+    return m_recentHistoryFlag.load();
+}
+inline void KisTileData::setRecentHistory(bool value) {
+    if (value) {
+        m_recentHistoryFlag.ref();
+    } else {
+        m_recentHistoryFlag.deref();
+    }
+}
+
 inline bool KisTileData::historical() const {
     return mementoed() && numUsers() <= 1;
 }
@@ -118,6 +118,14 @@ public:
     inline bool mementoed() const;
     inline void setMementoed(bool value);
 
+    /**
+     * Show whether a tile data is needed for undoing the latest
+     * revision of some memento manager, so it should not be swapped
+     * out proactively
+     */
+    inline bool recentHistory() const;
+    inline void setRecentHistory(bool value);
+
     /**
      * Controlling methods for setting 'age' marks
      */
@@ -221,6 +229,12 @@ private:
      */
     qint32 m_mementoFlag;
 
+    /**
+     * Counts the memento managers whose latest revision
+     * would be undone into this tile data.
+     */
+    QAtomicInt m_recentHistoryFlag;
+
     /**
      * Counts up time after last access to the tile data.
      * 0 - recently accessed
@@ -24,6 +24,7 @@
 #include "kis_tile_data_store.h"
 #include "kis_tile_data.h"
 #include "kis_debug.h"
+#include "kis_trace_recorder.h"
 
 #include "kis_tile_data_store_iterators.h"
 
@@ -224,6 +225,8 @@ void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
          */
 
         if(!td->data()) {
+            KisTraceScope trace("tiles", "swap-in");
+
             td->m_swapLock.lockForWrite();
 
             m_swappedStore.swapInTileData(td);
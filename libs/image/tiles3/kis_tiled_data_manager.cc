@@ -44,6 +44,8 @@
 
 KisTiledDataManager::KisTiledDataManager(quint32 pixelSize,
                                          const quint8 *defaultPixel)
+    : m_revision(nextRevision()),
+      m_revisionChanged(0)
 {
     /* See comment in destructor for details */
     m_mementoManager = new KisMementoManager();
@@ -60,7 +62,9 @@ KisTiledDataManager::KisTiledDataManager(quint32 pixelSize,
 }
 
 KisTiledDataManager::KisTiledDataManager(const KisTiledDataManager &dm)
-    : KisShared()
+    : KisShared(),
+      m_revision(nextRevision()),
+      m_revisionChanged(0)
 {
     /* See comment in destructor for details */
 
@@ -112,6 +116,21 @@ void KisTiledDataManager::setDefaultPixelImpl(const quint8 *defaultPixel)
     m_mementoManager->setDefaultTileData(td);
 
     memcpy(m_defaultPixel, defaultPixel, pixelSize());
+    markChanged();
+}
+
+qint64 KisTiledDataManager::nextRevision()
+{
+    static QAtomicInteger<qint64> lastRevision(0);
+    return lastRevision.fetchAndAddOrdered(1) + 1;
+}
+
+qint64 KisTiledDataManager::revision() const
+{
+    if (m_revisionChanged.fetchAndStoreOrdered(0)) {
+        m_revision.store(nextRevision());
+    }
+    return m_revision.load();
 }
 
 bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
@@ -281,6 +300,7 @@ wrongString:
 void KisTiledDataManager::purge(const QRect& area)
 {
     QWriteLocker locker(&m_lock);
+    markChanged();
 
     QList<KisTileSP> tilesToDelete;
     {
@@ -328,6 +348,7 @@ quint8* KisTiledDataManager::duplicatePixel(qint32 num, const quint8 *pixel)
 void KisTiledDataManager::clear(QRect clearRect, const quint8 *clearPixel)
 {
     QWriteLocker locker(&m_lock);
+    markChanged();
 
     if (clearPixel == 0)
         clearPixel = m_defaultPixel;
@@ -447,6 +468,7 @@ void KisTiledDataManager::clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 c
 void KisTiledDataManager::clear()
 {
     QWriteLocker locker(&m_lock);
+    markChanged();
 
     m_hashTable->clear();
 
@@ -461,6 +483,7 @@ template<bool useOldSrcData>
 void KisTiledDataManager::bitBltImpl(KisTiledDataManager *srcDM, const QRect &rect)
 {
     QWriteLocker locker(&m_lock);
+    markChanged();
 
     if (rect.isEmpty()) return;
 
@@ -526,6 +549,7 @@ template<bool useOldSrcData>
 void KisTiledDataManager::bitBltRoughImpl(KisTiledDataManager *srcDM, const QRect &rect)
 {
     QWriteLocker locker(&m_lock);
+    markChanged();
 
     if (rect.isEmpty()) return;
 
@@ -596,6 +620,7 @@ void KisTiledDataManager::setExtent(QRect newRect)
     if (newRect.contains(oldRect)) return;
 
     QWriteLocker locker(&m_lock);
+    markChanged();
 
     KisTileSP tile;
     QRect tileRect;
@@ -22,6 +22,7 @@
 #include <QtGlobal>
 #include <QVector>
 #include <QRegion>
+#include <QAtomicInteger>
 
 #include <kis_shared.h>
 #include <kis_shared_ptr.h>
@@ -90,6 +91,8 @@ public:
 
     inline KisTileSP getTile(qint32 col, qint32 row, bool writable) {
         if (writable) {
+            markChanged();
+
             bool newTile;
             KisTileSP tile = m_hashTable->getTileLazy(col, row, newTile);
             if (newTile)
@@ -132,6 +135,7 @@ public:
         commit();
 
         QWriteLocker locker(&m_lock);
+        markChanged();
         m_mementoManager->rollback(m_hashTable);
         const quint8 *defaultPixel = memento->oldDefaultPixel();
         if(memcmp(m_defaultPixel, defaultPixel, m_pixelSize)) {
@@ -143,6 +147,7 @@ public:
         commit();
 
         QWriteLocker locker(&m_lock);
+        markChanged();
         m_mementoManager->rollforward(m_hashTable);
         const quint8 *defaultPixel = memento->newDefaultPixel();
         if(memcmp(m_defaultPixel, defaultPixel, m_pixelSize)) {
@@ -168,6 +173,14 @@ public:
 
     static void releaseInternalPools();
 
+    /**
+     * \return a number identifying the current state of the pixel data.
+     * The number changes every time the data is (or might have been)
+     * modified and is unique among all the data managers of the process,
+     * so two equal revisions always mean equal data.
+     */
+    qint64 revision() const;
+
 protected:
     /**
      * Reads and writes the tiles 
@@ -313,6 +326,14 @@ private:
 
     mutable QReadWriteLock m_lock;
 
+    /**
+     * Writers only raise m_revisionChanged, the new revision number is
+     * fetched lazily by revision(), so writing stays free of contention
+     * on the global counter.
+     */
+    mutable QAtomicInteger<qint64> m_revision;
+    mutable QAtomicInt m_revisionChanged;
+
 private:
     // Allow compression routines to calculate (col,row) coordinates
     // and pixel size
@@ -324,6 +345,14 @@ private:
 private:
     void setDefaultPixelImpl(const quint8 *defPixel);
 
+    inline void markChanged() {
+        if (!m_revisionChanged.load()) {
+            m_revisionChanged.store(1);
+        }
+    }
+
+    static qint64 nextRevision();
+
     QRect extentImpl() const;
 
     bool writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles);
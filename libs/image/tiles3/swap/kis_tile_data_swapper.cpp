@@ -42,6 +42,7 @@ const qint32 KisTileDataSwapper::DELAY = 0.7 * SEC;
 
 class SoftSwapStrategy;
 class AggressiveSwapStrategy;
+class HistorySwapStrategy;
 
 
 struct Q_DECL_HIDDEN KisTileDataSwapper::Private
@@ -140,6 +141,20 @@ void KisTileDataSwapper::doJob()
             memoryMetric -= pass<AggressiveSwapStrategy>(hardFree);
             DEBUG_VALUE(memoryMetric);
         }
+
+        /**
+         * We are under memory pressure already, so the rest of the
+         * undo tiles, which nobody has touched since the last cycle,
+         * go to the (compressed) swap as well. Otherwise the
+         * swapper would be woken up again after the very next
+         * commit. The tiles needed for undoing the latest
+         * revisions stay in memory.
+         */
+        if (m_d->limits.compressHistory()) {
+            DEBUG_ACTION("\t history pass");
+            memoryMetric -= pass<HistorySwapStrategy>(memoryMetric);
+            DEBUG_VALUE(memoryMetric);
+        }
     }
 }
 
@@ -165,6 +180,10 @@ public:
     static inline bool swapOutFirst(KisTileData *td) {
         return td->age() > 0;
     }
+
+    static inline bool swapOutYoung() {
+        return true;
+    }
 };
 
 class AggressiveSwapStrategy
@@ -189,6 +208,38 @@ public:
     static inline bool swapOutFirst(KisTileData *td) {
         return td->age() > 0;
     }
+
+    static inline bool swapOutYoung() {
+        return true;
+    }
+};
+
+class HistorySwapStrategy
+{
+public:
+    typedef KisTileDataStoreIterator iterator;
+
+    static inline iterator* beginIteration(KisTileDataStore *store) {
+        return store->beginIteration();
+    }
+
+    static inline void endIteration(KisTileDataStore *store, iterator *iter) {
+        store->endIteration(iter);
+    }
+
+    static inline bool isInteresting(KisTileData *td) {
+        // the latest revisions will most probably be undone soon
+        return td->historical() && !td->recentHistory();
+    }
+
+    static inline bool swapOutFirst(KisTileData *td) {
+        return td->age() > 0;
+    }
+
+    static inline bool swapOutYoung() {
+        // the young ones are just marked old and wait for the next cycle
+        return false;
+    }
 };
 
 
@@ -218,7 +269,9 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
         }
         else {
             item->markOld();
-            additionalCandidates.append(item);
+            if (strategy::swapOutYoung()) {
+                additionalCandidates.append(item);
+            }
         }
 
     }
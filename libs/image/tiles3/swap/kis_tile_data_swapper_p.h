@@ -69,6 +69,8 @@ public:
 
         m_softLimitThreshold = qBound(0, MiB_TO_METRIC(config.tilesSoftLimit()), m_hardLimitThreshold);
         m_softLimit = m_softLimitThreshold - m_softLimitThreshold / 8;
+
+        m_compressHistory = config.compressUndoHistory();
     }
 
     /**
@@ -95,12 +97,21 @@ public:
         return m_softLimit;
     }
 
+    /**
+     * Whether all the old undo tiles should be swapped out
+     * when the soft limit is exceeded
+     */
+    inline bool compressHistory() {
+        return m_compressHistory;
+    }
+
 private:
     qint32 m_emergencyThreshold;
     qint32 m_hardLimitThreshold;
     qint32 m_hardLimit;
     qint32 m_softLimitThreshold;
     qint32 m_softLimit;
+    bool m_compressHistory;
 };
 
 
@@ -539,6 +539,154 @@ void KisTiledDataManagerTest::testUndoSetDefaultPixel()
     QVERIFY(memoryIsFilled(oddPixel2, tile10->data(), TILESIZE));
 }
 
+void KisTiledDataManagerTest::testUndoMemoryUsage()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+
+    QVector<quint8> buffer1(TILESIZE, oddPixel1);
+    QVector<quint8> buffer2(TILESIZE, oddPixel2);
+
+    KisTileSP tile00;
+    KisTileSP tile10;
+
+    KisMementoSP memento1 = dm.getMemento();
+    dm.writeBytes(buffer1.data(), 0, 0, 64, 64);
+    dm.writeBytes(buffer1.data(), 64, 0, 64, 64);
+    dm.commit();
+
+    QCOMPARE(memento1->memoryUsage(), qint64(2 * TILESIZE));
+
+    // the first tile is rewritten with the same content
+    KisMementoSP memento2 = dm.getMemento();
+    dm.writeBytes(buffer1.data(), 0, 0, 64, 64);
+    dm.writeBytes(buffer2.data(), 64, 0, 64, 64);
+    dm.commit();
+
+    QCOMPARE(memento2->memoryUsage(), qint64(TILESIZE));
+
+    // the shared tile must still be versioned properly
+    KisMementoSP memento3 = dm.getMemento();
+    dm.writeBytes(buffer2.data(), 0, 0, 64, 64);
+    dm.commit();
+
+    QCOMPARE(memento3->memoryUsage(), qint64(TILESIZE));
+
+    dm.rollback(memento3);
+
+    tile00 = dm.getTile(0, 0, false);
+    tile10 = dm.getTile(1, 0, false);
+    QVERIFY(memoryIsFilled(oddPixel1, tile00->data(), TILESIZE));
+    QVERIFY(memoryIsFilled(oddPixel2, tile10->data(), TILESIZE));
+
+    dm.rollback(memento2);
+
+    tile00 = dm.getTile(0, 0, false);
+    tile10 = dm.getTile(1, 0, false);
+    QVERIFY(memoryIsFilled(oddPixel1, tile00->data(), TILESIZE));
+    QVERIFY(memoryIsFilled(oddPixel1, tile10->data(), TILESIZE));
+
+    dm.rollback(memento1);
+
+    tile00 = dm.getTile(0, 0, false);
+    tile10 = dm.getTile(1, 0, false);
+    QVERIFY(memoryIsFilled(defaultPixel, tile00->data(), TILESIZE));
+    QVERIFY(memoryIsFilled(defaultPixel, tile10->data(), TILESIZE));
+
+    dm.rollforward(memento1);
+    dm.rollforward(memento2);
+    dm.rollforward(memento3);
+
+    tile00 = dm.getTile(0, 0, false);
+    tile10 = dm.getTile(1, 0, false);
+    QVERIFY(memoryIsFilled(oddPixel2, tile00->data(), TILESIZE));
+    QVERIFY(memoryIsFilled(oddPixel2, tile10->data(), TILESIZE));
+
+    // redo doesn't change the accounting
+    QCOMPARE(memento2->memoryUsage(), qint64(TILESIZE));
+}
+
+void KisTiledDataManagerTest::testRecentHistoryMarks()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+    quint8 oddPixel3 = 130;
+
+    QVector<quint8> buffer1(TILESIZE, oddPixel1);
+    QVector<quint8> buffer2(TILESIZE, oddPixel2);
+    QVector<quint8> buffer3(TILESIZE, oddPixel3);
+
+    KisMementoSP memento1 = dm.getMemento();
+    dm.writeBytes(buffer1.data(), 0, 0, 64, 64);
+    dm.commit();
+
+    KisTileData *tileData1 = dm.getTile(0, 0, false)->tileData();
+    QVERIFY(!tileData1->recentHistory());
+
+    // undoing the latest revision needs the first tile data
+    KisMementoSP memento2 = dm.getMemento();
+    dm.writeBytes(buffer2.data(), 0, 0, 64, 64);
+    dm.commit();
+
+    KisTileData *tileData2 = dm.getTile(0, 0, false)->tileData();
+    QVERIFY(tileData1 != tileData2);
+    QVERIFY(tileData1->historical());
+    QVERIFY(tileData1->recentHistory());
+    QVERIFY(!tileData2->recentHistory());
+
+    // now it is the second one
+    KisMementoSP memento3 = dm.getMemento();
+    dm.writeBytes(buffer3.data(), 0, 0, 64, 64);
+    dm.commit();
+
+    QVERIFY(tileData1->historical());
+    QVERIFY(!tileData1->recentHistory());
+    QVERIFY(tileData2->historical());
+    QVERIFY(tileData2->recentHistory());
+}
+
+void KisTiledDataManagerTest::testRevision()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+    KisTiledDataManager otherDM(1, &defaultPixel);
+
+    const qint64 initialRevision = dm.revision();
+    QCOMPARE(dm.revision(), initialRevision);
+    QVERIFY(otherDM.revision() != initialRevision);
+
+    // reading doesn't change the revision
+    dm.getTile(0, 0, false);
+    QCOMPARE(dm.revision(), initialRevision);
+
+    quint8 oddPixel = 128;
+
+    KisMementoSP memento = dm.getMemento();
+    dm.clear(QRect(0,0,64,64), &oddPixel);
+    dm.commit();
+
+    const qint64 changedRevision = dm.revision();
+    QVERIFY(changedRevision != initialRevision);
+    QCOMPARE(dm.revision(), changedRevision);
+
+    dm.rollback(memento);
+    QVERIFY(dm.revision() != changedRevision);
+
+    const qint64 writtenRevision = dm.revision();
+    dm.getTile(1, 1, true);
+    QVERIFY(dm.revision() != writtenRevision);
+
+    // a copy is a separate data manager
+    KisTiledDataManager copyDM(dm);
+    QVERIFY(copyDM.revision() != dm.revision());
+}
+
 //#include <valgrind/callgrind.h>
 
 void KisTiledDataManagerTest::benchmarkReadOnlyTileLazy()
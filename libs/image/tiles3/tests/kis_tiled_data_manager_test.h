@@ -52,6 +52,9 @@ private Q_SLOTS:
     void testTransactions();
     void testPurgeHistory();
     void testUndoSetDefaultPixel();
+    void testRevision();
+    void testUndoMemoryUsage();
+    void testRecentHistoryMarks();
 
     void benchmarkReadOnlyTileLazy();
     void benchmarkSharedPointers();
@@ -396,6 +396,35 @@ void KUndo2Command::redoMergedCommands()
     }
     redo();
 }
+/*!
+    Returns the amount of memory in bytes held by the command for
+    undoing and redoing the action. KUndo2QStack uses it for applying
+    the memory limit of the stack.
+
+    The default implementation returns the sum of the memory usage of
+    the child commands and the commands merged into this one. Commands
+    that store bulky data should reimplement it.
+
+    \sa KUndo2QStack::setUndoMemoryLimit()
+*/
+
+qint64 KUndo2Command::memoryUsage() const
+{
+    qint64 result = 0;
+
+    Q_FOREACH (const KUndo2Command *cmd, d->child_list) {
+        result += cmd->memoryUsage();
+    }
+
+    Q_FOREACH (const KUndo2Command *cmd, m_mergeCommandsVector) {
+        if (cmd != this) {
+            result += cmd->memoryUsage();
+        }
+    }
+
+    return result;
+}
+
 QVector<KUndo2Command*> KUndo2Command::mergeCommandsVector()
 {
     return m_mergeCommandsVector;
@@ -590,10 +619,37 @@ void KUndo2QStack::purgeRedoState()
 
 bool KUndo2QStack::checkUndoLimit()
 {
-    if (m_undo_limit <= 0 || !m_macro_stack.isEmpty() || m_undo_limit >= m_command_list.count())
+    if (!m_macro_stack.isEmpty())
         return false;
 
-    int del_count = m_command_list.count() - m_undo_limit;
+    int del_count = 0;
+
+    if (m_undo_limit > 0 && m_undo_limit < m_command_list.count())
+        del_count = m_command_list.count() - m_undo_limit;
+
+    /**
+     * Walk from the newest command to the oldest one and drop
+     * everything that doesn't fit into the memory budget. The
+     * newest command is always kept, otherwise the user would not
+     * be able to undo the action just done.
+     */
+    if (m_undo_memory_limit > 0) {
+        qint64 totalMemory = 0;
+
+        for (int i = m_command_list.count() - 1; i >= del_count; --i) {
+            totalMemory += m_command_list.at(i)->memoryUsage();
+
+            if (totalMemory > m_undo_memory_limit &&
+                i < m_command_list.count() - 1 && i < m_index) {
+
+                del_count = i + 1;
+                break;
+            }
+        }
+    }
+
+    if (!del_count)
+        return false;
 
     for (int i = 0; i < del_count; ++i)
         delete m_command_list.takeFirst();
@@ -617,7 +673,7 @@ bool KUndo2QStack::checkUndoLimit()
 */
 
 KUndo2QStack::KUndo2QStack(QObject *parent)
-    : QObject(parent), m_index(0), m_clean_index(0), m_group(0), m_undo_limit(0), m_useCumulativeUndoRedo(false), m_lastMergedSetCount(0), m_lastMergedIndex(0)
+    : QObject(parent), m_index(0), m_clean_index(0), m_group(0), m_undo_limit(0), m_undo_memory_limit(0), m_useCumulativeUndoRedo(false), m_lastMergedSetCount(0), m_lastMergedIndex(0)
 {
     setTimeT1(5);
     setTimeT2(1);
@@ -1258,6 +1314,29 @@ int KUndo2QStack::undoLimit() const
     return m_undo_limit;
 }
 
+/*!
+    Sets the maximum amount of memory in bytes the commands of the
+    stack may hold, as reported by KUndo2Command::memoryUsage(). When
+    the limit is exceeded, the oldest commands are deleted from the
+    bottom of the stack. The most recent command is never deleted.
+    The default value is 0, which means that there is no limit.
+
+    Unlike setUndoLimit(), the limit may be changed at any time. It is
+    applied when the next command is pushed.
+
+    \sa setUndoLimit()
+*/
+
+void KUndo2QStack::setUndoMemoryLimit(qint64 bytes)
+{
+    m_undo_memory_limit = bytes;
+}
+
+qint64 KUndo2QStack::undoMemoryLimit() const
+{
+    return m_undo_memory_limit;
+}
+
 /*!
     \property KUndo2QStack::active
     \brief the active status of this stack.
@@ -118,6 +118,8 @@ public:
     virtual void undoMergedCommands();
     virtual void redoMergedCommands();
 
+    virtual qint64 memoryUsage() const;
+
     /**
      * \return user-defined object associated with the command
      *
@@ -188,6 +190,9 @@ public:
     void setUndoLimit(int limit);
     int undoLimit() const;
 
+    void setUndoMemoryLimit(qint64 bytes);
+    qint64 undoMemoryLimit() const;
+
     const KUndo2Command *command(int index) const;
 
     void setUseCumulativeUndoRedo(bool value);
@@ -228,6 +233,7 @@ private:
     int m_clean_index;
     KUndo2Group *m_group;
     int m_undo_limit;
+    qint64 m_undo_memory_limit;
     bool m_useCumulativeUndoRedo;
     double m_timeT1;
     double m_timeT2;
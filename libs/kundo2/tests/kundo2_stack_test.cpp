@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kundo2_stack_test.h"
+
+#include <QTest>
+#include <kundo2stack.h>
+
+
+class MemoryCommand : public KUndo2Command
+{
+public:
+    MemoryCommand(qint64 memory, KUndo2Command *parent = 0)
+        : KUndo2Command(kundo2_noi18n("memory command"), parent),
+          m_memory(memory)
+    {
+    }
+
+    qint64 memoryUsage() const {
+        return m_memory + KUndo2Command::memoryUsage();
+    }
+
+private:
+    qint64 m_memory;
+};
+
+void KUndo2StackTest::testMemoryLimitEvictsOldest()
+{
+    KUndo2QStack stack;
+    stack.setUndoMemoryLimit(250);
+
+    QVector<KUndo2Command*> commands;
+
+    for (int i = 0; i < 5; i++) {
+        commands << new MemoryCommand(100);
+        stack.push(commands.last());
+
+        QVERIFY(stack.count() <= 2);
+        QCOMPARE(stack.index(), stack.count());
+    }
+
+    // only the two newest commands fit into the limit
+    QCOMPARE(stack.count(), 2);
+    QCOMPARE(stack.index(), 2);
+    QCOMPARE(stack.command(0), commands[3]);
+    QCOMPARE(stack.command(1), commands[4]);
+}
+
+void KUndo2StackTest::testMemoryLimitKeepsNewest()
+{
+    KUndo2QStack stack;
+    stack.setUndoMemoryLimit(250);
+
+    stack.push(new MemoryCommand(100));
+    stack.push(new MemoryCommand(100));
+
+    // the newest command is kept even if it alone exceeds the limit
+    KUndo2Command *hugeCommand = new MemoryCommand(1000);
+    stack.push(hugeCommand);
+
+    QCOMPARE(stack.count(), 1);
+    QCOMPARE(stack.index(), 1);
+    QCOMPARE(stack.command(0), hugeCommand);
+    QVERIFY(stack.canUndo());
+}
+
+void KUndo2StackTest::testMemoryLimitAdjustsCleanIndex()
+{
+    KUndo2QStack stack;
+    stack.setUndoMemoryLimit(250);
+
+    stack.push(new MemoryCommand(100));
+    stack.push(new MemoryCommand(100));
+    stack.setClean();
+    QCOMPARE(stack.cleanIndex(), 2);
+
+    stack.push(new MemoryCommand(100));
+    QCOMPARE(stack.count(), 2);
+    QCOMPARE(stack.index(), 2);
+    QCOMPARE(stack.cleanIndex(), 1);
+
+    stack.push(new MemoryCommand(100));
+    QCOMPARE(stack.count(), 2);
+    QCOMPARE(stack.index(), 2);
+    QCOMPARE(stack.cleanIndex(), 0);
+
+    // the clean command itself is evicted
+    stack.push(new MemoryCommand(100));
+    QCOMPARE(stack.count(), 2);
+    QCOMPARE(stack.index(), 2);
+    QCOMPARE(stack.cleanIndex(), -1);
+    QVERIFY(!stack.isClean());
+}
+
+void KUndo2StackTest::testMemoryLimitWithOpenMacro()
+{
+    KUndo2QStack stack;
+    stack.setUndoMemoryLimit(250);
+
+    KUndo2Command *firstCommand = new MemoryCommand(100);
+    stack.push(firstCommand);
+    stack.push(new MemoryCommand(100));
+
+    stack.beginMacro(kundo2_noi18n("macro"));
+
+    for (int i = 0; i < 5; i++) {
+        stack.push(new MemoryCommand(100));
+    }
+
+    // nothing is evicted while the macro is open
+    QCOMPARE(stack.count(), 3);
+    QCOMPARE(stack.command(0), firstCommand);
+
+    stack.endMacro();
+
+    // the macro is the newest command now, so it is the only one kept
+    QCOMPARE(stack.count(), 1);
+    QCOMPARE(stack.index(), 1);
+    QCOMPARE(stack.command(0)->childCount(), 5);
+}
+
+QTEST_MAIN(KUndo2StackTest)
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This library is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KoColorAdjustmentKernels.h"
+
+#include "KoColorAdjustmentKernelsFactoryPerArch.h"
+
+
+class KoColorAdjustmentScalarKernels : public KoColorAdjustmentKernels
+{
+public:
+    void adjustHSV(float *r, float *g, float *b, qint32 nPixels,
+                   float hueShift, float saturationShift, float valueShift) const
+    {
+        for (qint32 i = 0; i < nPixels; i++) {
+            adjustHSVScalar(r + i, g + i, b + i, hueShift, saturationShift, valueShift);
+        }
+    }
+
+    void adjustHSL(float *r, float *g, float *b, qint32 nPixels,
+                   float hueShift, float saturationScale, float lightnessShift) const
+    {
+        for (qint32 i = 0; i < nPixels; i++) {
+            adjustHSLScalar(r + i, g + i, b + i, hueShift, saturationScale, lightnessShift);
+        }
+    }
+
+    void colorBalance(float *r, float *g, float *b, qint32 nPixels,
+                      const ColorBalance &params) const
+    {
+        for (qint32 i = 0; i < nPixels; i++) {
+            colorBalanceScalar(r + i, g + i, b + i, params);
+        }
+    }
+};
+
+
+KoColorAdjustmentKernels::~KoColorAdjustmentKernels()
+{
+}
+
+KoColorAdjustmentKernels* KoColorAdjustmentKernels::create()
+{
+    return createOptimizedClass<KoColorAdjustmentKernelsFactory>(0);
+}
+
+KoColorAdjustmentKernels* KoColorAdjustmentKernels::createScalar()
+{
+    return new KoColorAdjustmentScalarKernels();
+}
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This library is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KO_COLOR_ADJUSTMENT_KERNELS_H
+#define __KO_COLOR_ADJUSTMENT_KERNELS_H
+
+#include <QtGlobal>
+#include "kritapigment_export.h"
+
+/**
+ * The per-pixel math of the HSV/HSL adjustment and color balance
+ * transformations. The kernels work on planar float RGB data in
+ * range [0, 1], so the color transformations only have to unpack
+ * their pixels of any channel type into three float arrays. The
+ * results are written back into the same arrays and are not clamped.
+ *
+ * The best implementation for the current CPU is selected at runtime.
+ */
+class KRITAPIGMENT_EXPORT KoColorAdjustmentKernels
+{
+public:
+    struct ColorBalance {
+        // cyan-red, magenta-green and yellow-blue shifts for every range
+        float shadows[3];
+        float midtones[3];
+        float highlights[3];
+        bool preserveLuminosity;
+    };
+
+public:
+    virtual ~KoColorAdjustmentKernels();
+
+    /**
+     * Shifts the HSV hue by \p hueShift degrees and adds
+     * \p saturationShift and \p valueShift to the saturation and
+     * value of every pixel
+     */
+    virtual void adjustHSV(float *r, float *g, float *b, qint32 nPixels,
+                           float hueShift, float saturationShift, float valueShift) const = 0;
+
+    /**
+     * Shifts the HSL hue by \p hueShift degrees, multiplies the
+     * saturation by \p saturationScale and brightens (positive) or
+     * darkens (negative) the lightness by \p lightnessShift
+     */
+    virtual void adjustHSL(float *r, float *g, float *b, qint32 nPixels,
+                           float hueShift, float saturationScale, float lightnessShift) const = 0;
+
+    virtual void colorBalance(float *r, float *g, float *b, qint32 nPixels,
+                              const ColorBalance &params) const = 0;
+
+    /**
+     * Creates the fastest kernels supported by the CPU
+     */
+    static KoColorAdjustmentKernels* create();
+
+    /**
+     * Creates plain scalar kernels. Used for reference
+     * in tests and benchmarks.
+     */
+    static KoColorAdjustmentKernels* createScalar();
+};
+
+#endif /* __KO_COLOR_ADJUSTMENT_KERNELS_H */
@@ -0,0 +1,336 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This library is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KoColorAdjustmentKernelsFactoryPerArch.h"
+
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wlocal-type-template-args"
+#endif
+
+
+#ifdef HAVE_VC
+
+/**
+ * Branchless versions of the color model conversions from
+ * KoColorConversions. Every switch and condition of the scalar
+ * code is replaced with a selection by a mask, so the results
+ * are the same as the ones of the scalar functions.
+ */
+template<Vc::Implementation _impl>
+struct KoColorAdjustmentVectorMath
+{
+    typedef Vc::float_v float_v;
+    typedef Vc::float_v::Mask mask_v;
+
+    static inline float_v clampUnit(float_v::AsArg value) {
+        return Vc::min(Vc::max(value, float_v(Vc::Zero)), float_v(Vc::One));
+    }
+
+    static inline void rgbToHSV(float_v::AsArg r, float_v::AsArg g, float_v::AsArg b,
+                                float_v &h, float_v &s, float_v &v)
+    {
+        const float_v zero(Vc::Zero);
+        const float_v epsilon(1e-6f);
+
+        const float_v max = Vc::max(r, Vc::max(g, b));
+        const float_v min = Vc::min(r, Vc::min(g, b));
+        const float_v delta = max - min;
+
+        v = max;
+        s = Vc::iif(max > epsilon, delta / max, zero);
+
+        h = Vc::iif(r == max, (g - b) / delta,
+            Vc::iif(g == max, float_v(2.0f) + (b - r) / delta,
+                              float_v(4.0f) + (r - g) / delta));
+
+        h *= float_v(60.0f);
+        h = Vc::iif(h < zero, h + float_v(360.0f), h);
+
+        // the hue is undefined for the achromatic pixels
+        h = Vc::iif(s < epsilon, float_v(-1.0f), h);
+    }
+
+    static inline void hsvToRGB(float_v h, float_v::AsArg s, float_v::AsArg v,
+                                float_v &r, float_v &g, float_v &b)
+    {
+        const float_v zero(Vc::Zero);
+        const float_v one(Vc::One);
+
+        const mask_v achromatic = s < float_v(1e-6f) || h == float_v(-1.0f);
+
+        h = Vc::iif(h >= float_v(360.0f), h - float_v(360.0f), h);
+        h /= float_v(60.0f);
+
+        const float_v i = Vc::max(Vc::floor(h), zero);
+        const float_v f = h - i;
+        const float_v p = v * (one - s);
+        const float_v q = v * (one - (s * f));
+        const float_v t = v * (one - (s * (one - f)));
+
+        const mask_v i0 = i == zero;
+        const mask_v i1 = i == float_v(1.0f);
+        const mask_v i2 = i == float_v(2.0f);
+        const mask_v i3 = i == float_v(3.0f);
+        const mask_v i4 = i == float_v(4.0f);
+        const mask_v i5 = i == float_v(5.0f);
+
+        r = Vc::iif(i0 || i5, v, Vc::iif(i1, q, Vc::iif(i2 || i3, p, t)));
+        g = Vc::iif(i0, t, Vc::iif(i1 || i2, v, Vc::iif(i3, q, p)));
+        b = Vc::iif(i0 || i1, p, Vc::iif(i2, t, Vc::iif(i3 || i4, v, q)));
+
+        r = Vc::iif(achromatic, v, r);
+        g = Vc::iif(achromatic, v, g);
+        b = Vc::iif(achromatic, v, b);
+    }
+
+    static inline void rgbToHSL(float_v::AsArg r, float_v::AsArg g, float_v::AsArg b,
+                                float_v &h, float_v &s, float_v &l)
+    {
+        const float_v zero(Vc::Zero);
+        const float_v half(0.5f);
+
+        const float_v v = Vc::max(r, Vc::max(g, b));
+        const float_v m = Vc::min(r, Vc::min(g, b));
+        const float_v vm = v - m;
+
+        l = (m + v) * half;
+
+        const mask_v undefined = l <= zero || vm <= zero;
+
+        s = vm / Vc::iif(l <= half, v + m, float_v(2.0f) - v - m);
+
+        const float_v r2 = (v - r) / vm;
+        const float_v g2 = (v - g) / vm;
+        const float_v b2 = (v - b) / vm;
+
+        h = Vc::iif(r == v, Vc::iif(g == m, float_v(5.0f) + b2, float_v(1.0f) - g2),
+            Vc::iif(g == v, Vc::iif(b == m, float_v(1.0f) + r2, float_v(3.0f) - b2),
+                            Vc::iif(r == m, float_v(3.0f) + g2, float_v(5.0f) - r2)));
+
+        h *= float_v(60.0f);
+        h = Vc::iif(h >= float_v(360.0f), h - float_v(360.0f), h);
+
+        h = Vc::iif(undefined, float_v(-1.0f), h);
+        s = Vc::iif(undefined, zero, s);
+    }
+
+    static inline void hslToRGB(float_v h, float_v::AsArg sl, float_v::AsArg l,
+                                float_v &r, float_v &g, float_v &b)
+    {
+        const float_v zero(Vc::Zero);
+        const float_v one(Vc::One);
+
+        const float_v v = Vc::iif(l <= float_v(0.5f), l * (one + sl), l + sl - l * sl);
+        const mask_v black = v <= zero;
+
+        const float_v m = l + l - v;
+        const float_v sv = (v - m) / v;
+
+        h = Vc::iif(h >= float_v(360.0f), h - float_v(360.0f), h);
+        h /= float_v(60.0f);
+
+        // the scalar version truncates the sextant towards zero
+        const float_v sextant = Vc::max(Vc::floor(h), zero);
+        const float_v fract = h - sextant;
+        const float_v vsf = v * sv * fract;
+        const float_v mid1 = m + vsf;
+        const float_v mid2 = v - vsf;
+
+        const mask_v s0 = sextant == zero;
+        const mask_v s1 = sextant == float_v(1.0f);
+        const mask_v s2 = sextant == float_v(2.0f);
+        const mask_v s3 = sextant == float_v(3.0f);
+        const mask_v s4 = sextant == float_v(4.0f);
+        const mask_v s5 = sextant == float_v(5.0f);
+
+        r = Vc::iif(s0 || s5, v, Vc::iif(s1, mid2, Vc::iif(s2 || s3, m, mid1)));
+        g = Vc::iif(s0, mid1, Vc::iif(s1 || s2, v, Vc::iif(s3, mid2, m)));
+        b = Vc::iif(s0 || s1, m, Vc::iif(s2, mid1, Vc::iif(s3 || s4, v, mid2)));
+
+        r = Vc::iif(black, zero, r);
+        g = Vc::iif(black, zero, g);
+        b = Vc::iif(black, zero, b);
+    }
+
+    static inline float_v wrapHue(float_v h)
+    {
+        const float_v fullCircle(360.0f);
+
+        h = Vc::iif(h > fullCircle, h - fullCircle, h);
+        h = Vc::iif(h < float_v(Vc::Zero), h + fullCircle, h);
+        return h;
+    }
+};
+
+template<Vc::Implementation _impl>
+class KoColorAdjustmentVectorKernels : public KoColorAdjustmentKernels
+{
+    typedef Vc::float_v float_v;
+    typedef KoColorAdjustmentVectorMath<_impl> VMath;
+
+public:
+    void adjustHSV(float *r, float *g, float *b, qint32 nPixels,
+                   float hueShift, float saturationShift, float valueShift) const
+    {
+        const qint32 vectorSize = float_v::size();
+        const qint32 numVectorPixels = nPixels - nPixels % vectorSize;
+
+        const float_v hueShiftVec(hueShift);
+        const float_v saturationShiftVec(saturationShift);
+        const float_v valueShiftVec(valueShift);
+
+        for (qint32 i = 0; i < numVectorPixels; i += vectorSize) {
+            float_v red, green, blue;
+            red.load(r + i, Vc::Unaligned);
+            green.load(g + i, Vc::Unaligned);
+            blue.load(b + i, Vc::Unaligned);
+
+            float_v h, s, v;
+            VMath::rgbToHSV(red, green, blue, h, s, v);
+
+            h = VMath::wrapHue(h + hueShiftVec);
+            s += saturationShiftVec;
+            v += valueShiftVec;
+
+            VMath::hsvToRGB(h, s, v, red, green, blue);
+
+            red.store(r + i, Vc::Unaligned);
+            green.store(g + i, Vc::Unaligned);
+            blue.store(b + i, Vc::Unaligned);
+        }
+
+        for (qint32 i = numVectorPixels; i < nPixels; i++) {
+            adjustHSVScalar(r + i, g + i, b + i, hueShift, saturationShift, valueShift);
+        }
+    }
+
+    void adjustHSL(float *r, float *g, float *b, qint32 nPixels,
+                   float hueShift, float saturationScale, float lightnessShift) const
+    {
+        const qint32 vectorSize = float_v::size();
+        const qint32 numVectorPixels = nPixels - nPixels % vectorSize;
+
+        const float_v hueShiftVec(hueShift);
+        const float_v saturationScaleVec(saturationScale);
+        const float_v lightnessShiftVec(lightnessShift);
+        const float_v one(Vc::One);
+
+        for (qint32 i = 0; i < numVectorPixels; i += vectorSize) {
+            float_v red, green, blue;
+            red.load(r + i, Vc::Unaligned);
+            green.load(g + i, Vc::Unaligned);
+            blue.load(b + i, Vc::Unaligned);
+
+            float_v h, s, l;
+            VMath::rgbToHSL(red, green, blue, h, s, l);
+
+            h = VMath::wrapHue(h + hueShiftVec);
+            s = VMath::clampUnit(s * saturationScaleVec);
+
+            if (lightnessShift < 0) {
+                l *= lightnessShiftVec + one;
+            } else {
+                l += lightnessShiftVec * (one - l);
+            }
+
+            VMath::hslToRGB(h, s, l, red, green, blue);
+
+            red.store(r + i, Vc::Unaligned);
+            green.store(g + i, Vc::Unaligned);
+            blue.store(b + i, Vc::Unaligned);
+        }
+
+        for (qint32 i = numVectorPixels; i < nPixels; i++) {
+            adjustHSLScalar(r + i, g + i, b + i, hueShift, saturationScale, lightnessShift);
+        }
+    }
+
+    void colorBalance(float *r, float *g, float *b, qint32 nPixels,
+                      const ColorBalance &params) const
+    {
+        const qint32 vectorSize = float_v::size();
+        const qint32 numVectorPixels = nPixels - nPixels % vectorSize;
+
+        const float_v a(0.25f);
+        const float_v bias(0.333f);
+        const float_v scale(0.7f);
+        const float_v half(0.5f);
+        const float_v one(Vc::One);
+
+        for (qint32 i = 0; i < numVectorPixels; i += vectorSize) {
+            float_v red, green, blue;
+            red.load(r + i, Vc::Unaligned);
+            green.load(g + i, Vc::Unaligned);
+            blue.load(b + i, Vc::Unaligned);
+
+            float_v h, s, l;
+            VMath::rgbToHSL(red, green, blue, h, s, l);
+
+            /**
+             * The weights of the tonal ranges depend on the lightness
+             * only, so they are shared by all the three channels
+             */
+            const float_v shadowsWeight =
+                VMath::clampUnit((l - bias) / -a + half) * scale;
+            const float_v midtonesWeight =
+                VMath::clampUnit((l - bias) / a + half) *
+                VMath::clampUnit((l + bias - one) / -a + half) * scale;
+            const float_v highlightsWeight =
+                VMath::clampUnit((l + bias - one) / a + half) * scale;
+
+            float_v *channels[3] = {&red, &green, &blue};
+
+            for (int ch = 0; ch < 3; ch++) {
+                float_v &value = *channels[ch];
+
+                value += float_v(params.shadows[ch]) * shadowsWeight;
+                value += float_v(params.midtones[ch]) * midtonesWeight;
+                value += float_v(params.highlights[ch]) * highlightsWeight;
+                value = VMath::clampUnit(value);
+            }
+
+            if (params.preserveLuminosity) {
+                float_v newLightness;
+                VMath::rgbToHSL(red, green, blue, h, s, newLightness);
+                VMath::hslToRGB(h, s, l, red, green, blue);
+            }
+
+            red.store(r + i, Vc::Unaligned);
+            green.store(g + i, Vc::Unaligned);
+            blue.store(b + i, Vc::Unaligned);
+        }
+
+        for (qint32 i = numVectorPixels; i < nPixels; i++) {
+            colorBalanceScalar(r + i, g + i, b + i, params);
+        }
+    }
+};
+
+#endif /* HAVE_VC */
+
+
+template<>
+KoColorAdjustmentKernelsFactory::ReturnType
+KoColorAdjustmentKernelsFactory::create<Vc::CurrentImplementation::current()>(ParamType)
+{
+#ifdef HAVE_VC
+    return new KoColorAdjustmentVectorKernels<Vc::CurrentImplementation::current()>();
+#else
+    return KoColorAdjustmentKernels::createScalar();
+#endif
+}
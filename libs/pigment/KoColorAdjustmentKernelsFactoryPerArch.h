@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This library is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KO_COLOR_ADJUSTMENT_KERNELS_FACTORY_PER_ARCH_H
+#define __KO_COLOR_ADJUSTMENT_KERNELS_FACTORY_PER_ARCH_H
+
+#include "KoVcMultiArchBuildSupport.h"
+#include "KoColorAdjustmentKernels.h"
+#include "KoColorConversions.h"
+
+struct KoColorAdjustmentKernelsFactory
+{
+    typedef void* ParamType;
+    typedef KoColorAdjustmentKernels* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType);
+};
+
+/**
+ * The reference implementations of the kernels for a single pixel.
+ * The vectorized versions must give the same results.
+ */
+
+static inline void adjustHSVScalar(float *r, float *g, float *b,
+                                   float hueShift, float saturationShift, float valueShift)
+{
+    float h, s, v;
+    RGBToHSV(*r, *g, *b, &h, &s, &v);
+
+    h += hueShift;
+    if (h > 360) h -= 360;
+    if (h < 0) h += 360;
+    s += saturationShift;
+    v += valueShift;
+
+    HSVToRGB(h, s, v, r, g, b);
+}
+
+static inline void adjustHSLScalar(float *r, float *g, float *b,
+                                   float hueShift, float saturationScale, float lightnessShift)
+{
+    float h, s, l;
+    RGBToHSL(*r, *g, *b, &h, &s, &l);
+
+    h += hueShift;
+    if (h > 360) h -= 360;
+    if (h < 0) h += 360;
+
+    s *= saturationScale;
+    if (s < 0.0) s = 0.0;
+    if (s > 1.0) s = 1.0;
+
+    if (lightnessShift < 0)
+        l *= (lightnessShift + 1.0);
+    else
+        l += (lightnessShift * (1.0 - l));
+
+    HSLToRGB(h, s, l, r, g, b);
+}
+
+static inline float colorBalanceTransformScalar(float value, float lightness,
+                                                float shadows, float midtones, float highlights)
+{
+    static const float a = 0.25, b = 0.333, scale = 0.7;
+
+    shadows *= qBound(0.0, (lightness - b) / -a + 0.5, 1.0) * scale;
+    midtones *= qBound(0.0, (lightness - b) /  a + 0.5, 1.0) * qBound(0.0, (lightness + b - 1) / -a + 0.5, 1.0) * scale;
+    highlights *= qBound(0.0, (lightness + b - 1) /  a + 0.5, 1.0) * scale;
+
+    value += shadows;
+    value += midtones;
+    value += highlights;
+
+    return qBound(0.0f, value, 1.0f);
+}
+
+static inline void colorBalanceScalar(float *r, float *g, float *b,
+                                      const KoColorAdjustmentKernels::ColorBalance &params)
+{
+    float hue, saturation, lightness;
+    RGBToHSL(*r, *g, *b, &hue, &saturation, &lightness);
+
+    float red = colorBalanceTransformScalar(*r, lightness, params.shadows[0], params.midtones[0], params.highlights[0]);
+    float green = colorBalanceTransformScalar(*g, lightness, params.shadows[1], params.midtones[1], params.highlights[1]);
+    float blue = colorBalanceTransformScalar(*b, lightness, params.shadows[2], params.midtones[2], params.highlights[2]);
+
+    if (params.preserveLuminosity) {
+        float h2, s2, l2;
+        RGBToHSL(red, green, blue, &h2, &s2, &l2);
+        HSLToRGB(h2, s2, lightness, &red, &green, &blue);
+    }
+
+    *r = red;
+    *g = green;
+    *b = blue;
+}
+
+#endif /* __KO_COLOR_ADJUSTMENT_KERNELS_FACTORY_PER_ARCH_H */
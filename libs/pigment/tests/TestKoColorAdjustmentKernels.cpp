@@ -0,0 +1,168 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoColorAdjustmentKernels.h"
+
+#include <QTest>
+#include <QDebug>
+#include <QVector>
+#include <QScopedPointer>
+
+#include <cmath>
+
+#include "KoColorAdjustmentKernels.h"
+
+/**
+ * Planar pixels covering a coarse grid of the RGB cube plus all the
+ * 8-bit gray levels, which are the special case of the undefined hue.
+ * The number of pixels is odd, so the scalar tail of the vectorized
+ * kernels is checked as well.
+ */
+struct PlanarPixels
+{
+    PlanarPixels() {
+        for (int r = 0; r < 256; r += 15) {
+            for (int g = 0; g < 256; g += 15) {
+                for (int b = 0; b < 256; b += 15) {
+                    append(r, g, b);
+                }
+            }
+        }
+
+        for (int v = 0; v < 256; v++) {
+            append(v, v, v);
+        }
+
+        append(255, 0, 0);
+    }
+
+    void append(int r, int g, int b) {
+        red << r / 255.0f;
+        green << g / 255.0f;
+        blue << b / 255.0f;
+    }
+
+    int size() const {
+        return red.size();
+    }
+
+    QVector<float> red;
+    QVector<float> green;
+    QVector<float> blue;
+};
+
+static bool comparePixels(const PlanarPixels &ref, const PlanarPixels &result)
+{
+    const float tolerance = 1e-4;
+
+    for (int i = 0; i < ref.size(); i++) {
+        if (std::abs(ref.red[i] - result.red[i]) > tolerance ||
+            std::abs(ref.green[i] - result.green[i]) > tolerance ||
+            std::abs(ref.blue[i] - result.blue[i]) > tolerance) {
+
+            qDebug() << "Pixel" << i << "differs:"
+                     << "ref" << ref.red[i] << ref.green[i] << ref.blue[i]
+                     << "result" << result.red[i] << result.green[i] << result.blue[i];
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static const float adjustments[][3] = {
+    {0.0f, 0.0f, 0.0f},
+    {0.3f, 0.2f, -0.1f},
+    {-0.7f, -0.5f, 0.4f},
+    {1.0f, 1.0f, 1.0f},
+    {-1.0f, -1.0f, -1.0f},
+    {0.5f, 0.9f, 0.5f}
+};
+
+static const int numAdjustments = sizeof(adjustments) / sizeof(adjustments[0]);
+
+void TestKoColorAdjustmentKernels::testHSV()
+{
+    QScopedPointer<KoColorAdjustmentKernels> scalar(KoColorAdjustmentKernels::createScalar());
+    QScopedPointer<KoColorAdjustmentKernels> optimized(KoColorAdjustmentKernels::create());
+
+    for (int i = 0; i < numAdjustments; i++) {
+        const float *adj = adjustments[i];
+
+        PlanarPixels ref;
+        PlanarPixels result;
+
+        scalar->adjustHSV(ref.red.data(), ref.green.data(), ref.blue.data(), ref.size(),
+                          adj[0] * 180, adj[1], adj[2]);
+        optimized->adjustHSV(result.red.data(), result.green.data(), result.blue.data(), result.size(),
+                             adj[0] * 180, adj[1], adj[2]);
+
+        QVERIFY(comparePixels(ref, result));
+    }
+}
+
+void TestKoColorAdjustmentKernels::testHSL()
+{
+    QScopedPointer<KoColorAdjustmentKernels> scalar(KoColorAdjustmentKernels::createScalar());
+    QScopedPointer<KoColorAdjustmentKernels> optimized(KoColorAdjustmentKernels::create());
+
+    for (int i = 0; i < numAdjustments; i++) {
+        const float *adj = adjustments[i];
+
+        PlanarPixels ref;
+        PlanarPixels result;
+
+        scalar->adjustHSL(ref.red.data(), ref.green.data(), ref.blue.data(), ref.size(),
+                          adj[0] * 180, adj[1] + 1.0f, adj[2]);
+        optimized->adjustHSL(result.red.data(), result.green.data(), result.blue.data(), result.size(),
+                             adj[0] * 180, adj[1] + 1.0f, adj[2]);
+
+        QVERIFY(comparePixels(ref, result));
+    }
+}
+
+void TestKoColorAdjustmentKernels::testColorBalance()
+{
+    QScopedPointer<KoColorAdjustmentKernels> scalar(KoColorAdjustmentKernels::createScalar());
+    QScopedPointer<KoColorAdjustmentKernels> optimized(KoColorAdjustmentKernels::create());
+
+    for (int i = 0; i < numAdjustments; i++) {
+        const float *adj = adjustments[i];
+
+        KoColorAdjustmentKernels::ColorBalance params;
+        for (int ch = 0; ch < 3; ch++) {
+            params.shadows[ch] = adj[ch];
+            params.midtones[ch] = adj[(ch + 1) % 3];
+            params.highlights[ch] = -adj[(ch + 2) % 3];
+        }
+
+        for (int preserve = 0; preserve < 2; preserve++) {
+            params.preserveLuminosity = preserve;
+
+            PlanarPixels ref;
+            PlanarPixels result;
+
+            scalar->colorBalance(ref.red.data(), ref.green.data(), ref.blue.data(), ref.size(), params);
+            optimized->colorBalance(result.red.data(), result.green.data(), result.blue.data(), result.size(), params);
+
+            QVERIFY(comparePixels(ref, result));
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(TestKoColorAdjustmentKernels)
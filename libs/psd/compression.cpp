@@ -19,10 +19,13 @@
 #include "compression.h"
 
 #include <QBuffer>
+#include <QVarLengthArray>
 #include "psd_utils.h"
 #include "kis_debug.h"
 #include <QtEndian>
 
+#include <string.h>
+
 // from gimp's psd-save.c
 static quint32 pack_pb_line (const QByteArray &src,
                              QByteArray &dst)
@@ -33,6 +36,16 @@ static quint32 pack_pb_line (const QByteArray &src,
     quint32 dest_ptr = 0;
     const char *start = src.constData();
 
+    /**
+     * Writing through QByteArray::operator[] past the end reallocates
+     * the array on every byte, so encode into a scratch buffer first.
+     * Every packet carries at least one byte of payload and a replicate
+     * packet covers at least two bytes, so the output is never longer
+     * than twice the input.
+     */
+    QVarLengthArray<char, 4096> buffer(2 * length + 1);
+    char *dstData = buffer.data();
+
     length = 0;
     while (remaining > 0)
     {
@@ -46,8 +59,8 @@ static quint32 pack_pb_line (const QByteArray &src,
         if (i > 1)              /* Match found */
         {
 
-            dst[dest_ptr++] = -(i - 1);
-            dst[dest_ptr++] = *start;
+            dstData[dest_ptr++] = -(i - 1);
+            dstData[dest_ptr++] = *start;
 
             start += i;
             remaining -= i;
@@ -72,10 +85,10 @@ static quint32 pack_pb_line (const QByteArray &src,
 
             if (i > 0)               /* Some distinct ones found */
             {
-                dst[dest_ptr++] = i - 1;
+                dstData[dest_ptr++] = i - 1;
                 for (j = 0; j < i; j++)
                 {
-                    dst[dest_ptr++] = start[j];
+                    dstData[dest_ptr++] = start[j];
                 }
                 start += i;
                 remaining -= i;
@@ -84,6 +97,8 @@ static quint32 pack_pb_line (const QByteArray &src,
 
         }
     }
+
+    dst = QByteArray(buffer.constData(), dest_ptr);
     return length;
 }
 
@@ -127,14 +142,10 @@ quint32 decode_packbits(const char *src, char* dst, quint16 packed_len, quint32
                 error_code = 2;
             }
             dat = *src;
-            for (; n > 0; --n)
-            {
-                if (! unpack_left)
-                    break;
-                *dst = dat;
-                dst++;
-                unpack_left--;
-            }
+            n = qMin(n, unpack_left);
+            memset(dst, dat, n);
+            dst += n;
+            unpack_left -= n;
             if (unpack_left)
             {
                 src++;
@@ -144,25 +155,25 @@ quint32 decode_packbits(const char *src, char* dst, quint16 packed_len, quint32
         else              /* copy next n+1 gchars literally */
         {
             n++;
-            for (; n > 0; --n)
+            const qint32 copied = qMin(n, qMin(pack_left, unpack_left));
+            memcpy(dst, src, copied);
+            dst += copied;
+            src += copied;
+            unpack_left -= copied;
+            pack_left -= copied;
+
+            if (copied < n)
             {
                 if (! pack_left)
                 {
                     dbgFile << "Input buffer exhausted in copy";
                     error_code = 3;
-                    break;
                 }
-                if (! unpack_left)
+                else
                 {
                     dbgFile << "Output buffer exhausted in copy";
                     error_code = 4;
-                    break;
                 }
-                *dst = *src;
-                dst++;
-                unpack_left--;
-                src++;
-                pack_left--;
             }
         }
     }
@@ -209,10 +220,8 @@ QByteArray Compression::uncompress(quint32 unpacked_len, QByteArray bytes, Compr
         return bytes;
     case RLE:
     {
-        char *dst = new char[unpacked_len];
-        decode_packbits(bytes.constData(), dst, bytes.length(), unpacked_len);
-        QByteArray ba(dst, unpacked_len);
-        delete[] dst;
+        QByteArray ba(unpacked_len, 0);
+        uncompressRLE(bytes.constData(), bytes.length(), ba.data(), unpacked_len);
         return ba;
      }
     case ZIP:
@@ -238,6 +247,11 @@ QByteArray Compression::uncompress(quint32 unpacked_len, QByteArray bytes, Compr
     return QByteArray();
 }
 
+void Compression::uncompressRLE(const char *src, int packedLength, char *dst, int unpackedLength)
+{
+    decode_packbits(src, dst, packedLength, unpackedLength);
+}
+
 QByteArray Compression::compress(QByteArray bytes, Compression::CompressionType compressionType)
 {
     if (bytes.size() < 1) return QByteArray();
@@ -249,7 +263,7 @@ QByteArray Compression::compress(QByteArray bytes, Compression::CompressionType
     {
         QByteArray dst;
         int packed_len = pack_pb_line(bytes, dst);
-        Q_ASSERT(packed_len == dst.size());
+        Q_ASSERT(packed_len == (int)dst.size());
         Q_UNUSED(packed_len);
         return dst;
     }
@@ -34,6 +34,14 @@ public:
     };
 
     static QByteArray uncompress(quint32 unpacked_len, QByteArray bytes, CompressionType compressionType);
+
+    /**
+     * Decodes a single PackBits-compressed row right into \p dst,
+     * without any intermediate allocations. If the compressed data
+     * is too short, the rest of \p dst is left untouched.
+     */
+    static void uncompressRLE(const char *src, int packedLength, char *dst, int unpackedLength);
+
     static QByteArray compress(QByteArray bytes, CompressionType compressionType);
 };
 
@@ -95,7 +95,8 @@ public:
      * fill it with data from the appIdentification. This is only
      * applicable if Mode is set to Write.
      *
-     * @bug saving not completely implemented (fixed temporary file)
+     * When writing, the destination is replaced atomically on finalize().
+     * Only local urls are supported.
      */
     static KoStore *createStore(const QUrl &url, Mode mode,
                                 const QByteArray &appIdentification = QByteArray(), Backend backend = Auto, bool writeMimetype = true);
@@ -23,7 +23,6 @@
 
 #include <QBuffer>
 #include <QByteArray>
-#include <QTemporaryFile>
 
 #include <kzip.h>
 #include <StoreDebug.h>
@@ -33,6 +32,7 @@
 KoZipStore::KoZipStore(const QString & _filename, Mode mode, const QByteArray & appIdentification,
                        bool writeMimetype)
     : KoStore(mode, writeMimetype)
+    , m_writeFailed(false)
 {
     debugStore << "KoZipStore Constructor filename =" << _filename
                << " mode = " << int(mode)
@@ -49,6 +49,7 @@ KoZipStore::KoZipStore(const QString & _filename, Mode mode, const QByteArray &
 KoZipStore::KoZipStore(QIODevice *dev, Mode mode, const QByteArray & appIdentification,
                        bool writeMimetype)
     : KoStore(mode, writeMimetype)
+    , m_writeFailed(false)
 {
     m_pZip = new KZip(dev);
     init(appIdentification);
@@ -57,6 +58,7 @@ KoZipStore::KoZipStore(QIODevice *dev, Mode mode, const QByteArray & appIdentifi
 KoZipStore::KoZipStore(QWidget* window, const QUrl &_url, const QString & _filename, Mode mode,
                        const QByteArray & appIdentification, bool writeMimetype)
     : KoStore(mode, writeMimetype)
+    , m_writeFailed(false)
 {
     debugStore << "KoZipStore Constructor url" << _url.url(QUrl::PreferLocalFile)
                << " filename = " << _filename
@@ -70,10 +72,11 @@ KoZipStore::KoZipStore(QWidget* window, const QUrl &_url, const QString & _filen
     if (mode == KoStore::Read) {
         d->localFileName = _filename;
     } else {
-        QTemporaryFile f("kozip");
-        f.open();
-        d->localFileName = f.fileName();
-        f.close();
+        // KArchive writes named files through QSaveFile, that is into a
+        // temporary file in the same directory which is renamed over the
+        // destination on close(). That makes the save atomic and avoids
+        // copying the whole archive once more after it has been written.
+        d->localFileName = _url.toLocalFile();
     }
 
     m_pZip = new KZip(d->localFileName);
@@ -87,14 +90,6 @@ KoZipStore::~KoZipStore()
     if (!d->finalized)
         finalize(); // ### no error checking when the app forgot to call finalize itself
     delete m_pZip;
-
-    // When writing, we write to a temp file that then gets copied over the original filename
-    if (d->mode == Write) {
-        QFile f(d->localFileName);
-        if (f.copy(d->url.toLocalFile())) {
-            f.remove();
-        }
-    }
 }
 
 void KoZipStore::init(const QByteArray& appIdentification)
@@ -143,6 +138,14 @@ bool KoZipStore::openWrite(const QString& name)
 {
     Q_D(KoStore);
     d->stream = 0; // Don't use!
+
+    m_writeBuffer.resize(0);
+    m_writeFailed = false;
+
+    m_currentEntry = EntryStatistics();
+    m_currentEntry.name = name;
+    m_entryTimer.start();
+
     return m_pZip->prepareWriting(name, "", "" /*m_pZip->rootDir()->user(), m_pZip->rootDir()->group()*/, 0);
 }
 
@@ -180,10 +183,51 @@ qint64 KoZipStore::write(const char* _data, qint64 _len)
         return 0;
     }
 
+    if (m_writeFailed) {
+        return 0;
+    }
+
+    m_currentEntry.writeCalls++;
+
+    if (m_writeBuffer.size() + _len > WriteBufferSize) {
+        if (!flushWriteBuffer()) {
+            return 0;
+        }
+    }
+
+    if (_len >= WriteBufferSize) {
+        // big chunks go straight into the compressor, there is no
+        // point in copying them into the buffer first
+        m_currentEntry.flushes++;
+        if (!m_pZip->writeData(_data, _len)) {     // writeData returns a bool!
+            m_writeFailed = true;
+            return 0;
+        }
+    } else {
+        if (m_writeBuffer.capacity() < WriteBufferSize) {
+            m_writeBuffer.reserve(WriteBufferSize);
+        }
+        m_writeBuffer.append(_data, _len);
+    }
+
     d->size += _len;
-    if (m_pZip->writeData(_data, _len))     // writeData returns a bool!
-        return _len;
-    return 0;
+    return _len;
+}
+
+bool KoZipStore::flushWriteBuffer()
+{
+    if (m_writeBuffer.isEmpty()) return true;
+
+    m_currentEntry.flushes++;
+    m_writeFailed = !m_pZip->writeData(m_writeBuffer.constData(), m_writeBuffer.size());
+    m_writeBuffer.resize(0);
+
+    return !m_writeFailed;
+}
+
+QList<KoZipStore::EntryStatistics> KoZipStore::entryStatistics() const
+{
+    return m_entryStatistics;
 }
 
 QStringList KoZipStore::directoryList() const
@@ -202,8 +246,26 @@ QStringList KoZipStore::directoryList() const
 bool KoZipStore::closeWrite()
 {
     Q_D(KoStore);
-    debugStore << "Wrote file" << d->fileName << " into ZIP archive. size" << d->size;
-    return m_pZip->finishWriting(d->size);
+    bool result = flushWriteBuffer();
+    result &= m_pZip->finishWriting(d->size);
+
+    m_currentEntry.uncompressedSize = d->size;
+    m_currentEntry.elapsedMs = m_entryTimer.elapsed();
+
+    const KArchiveEntry *entry = m_pZip->directory()->entry(m_currentEntry.name);
+    if (entry && entry->isFile()) {
+        m_currentEntry.compressedSize = static_cast<const KZipFileEntry*>(entry)->compressedSize();
+    }
+
+    m_entryStatistics.append(m_currentEntry);
+
+    debugStore << "Wrote file" << d->fileName << " into ZIP archive. size" << d->size
+               << "compressed" << m_currentEntry.compressedSize
+               << "in" << m_currentEntry.elapsedMs << "ms"
+               << "(" << m_currentEntry.megabytesPerSecond() << "MiB/s,"
+               << m_currentEntry.writeCalls << "writes," << m_currentEntry.flushes << "chunks )";
+
+    return result;
 }
 
 bool KoZipStore::enterRelativeDirectory(const QString& dirName)
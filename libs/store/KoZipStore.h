@@ -22,6 +22,10 @@
 
 #include "KoStore.h"
 
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+
 class KZip;
 class KArchiveDirectory;
 class QUrl;
@@ -29,13 +33,35 @@ class QUrl;
 class KoZipStore : public KoStore
 {
 public:
+    /**
+     * Throughput counters of a single entry written into the archive.
+     * They are collected between open() and close() of every entry.
+     */
+    struct EntryStatistics {
+        EntryStatistics() : uncompressedSize(0), compressedSize(0), writeCalls(0), flushes(0), elapsedMs(0) {}
+
+        QString name;
+        qint64 uncompressedSize;
+        qint64 compressedSize;
+        qint64 writeCalls; ///< number of write() calls made by the client
+        qint64 flushes; ///< number of chunks actually passed to the archive
+        qint64 elapsedMs;
+
+        qreal megabytesPerSecond() const {
+            return elapsedMs > 0 ? qreal(uncompressedSize) / 1048576.0 / (qreal(elapsedMs) / 1000.0) : 0.0;
+        }
+    };
+
     KoZipStore(const QString & _filename, Mode _mode, const QByteArray & appIdentification,
                bool writeMimetype = true);
     KoZipStore(QIODevice *dev, Mode mode, const QByteArray & appIdentification,
                bool writeMimetype = true);
     /**
      * QUrl-constructor
-     * @todo saving not completely implemented (fixed temporary file)
+     *
+     * In Write mode the archive is streamed into a temporary file placed
+     * next to the destination, which atomically replaces the destination
+     * when the store is finalized. Only local urls are supported.
      */
     KoZipStore(QWidget* window, const QUrl &_url, const QString & _filename, Mode _mode,
                const QByteArray & appIdentification, bool writeMimetype = true);
@@ -46,6 +72,18 @@ public:
 
     virtual QStringList directoryList() const;
 
+    /**
+     * @return the throughput counters of all the entries written so far
+     */
+    QList<EntryStatistics> entryStatistics() const;
+
+    /**
+     * The size of the buffer small writes are coalesced in before being
+     * passed to the compressor. Writes bigger than the buffer bypass it,
+     * so the memory used per entry never exceeds this value.
+     */
+    static const int WriteBufferSize = 256 * 1024;
+
 protected:
     void init(const QByteArray& appIdentification);
     virtual bool doFinalize();
@@ -59,6 +97,9 @@ protected:
     virtual bool enterAbsoluteDirectory(const QString& path);
     virtual bool fileExists(const QString& absPath) const;
 
+private:
+    bool flushWriteBuffer();
+
 private:
 
     /// The archive
@@ -68,6 +109,14 @@ private:
     current directory in the archive to speed up the verification process */
     const KArchiveDirectory* m_currentDir;
 
+    /// Coalesces small writes (e.g. tile headers) before they reach the compressor
+    QByteArray m_writeBuffer;
+    bool m_writeFailed;
+
+    QElapsedTimer m_entryTimer;
+    EntryStatistics m_currentEntry;
+    QList<EntryStatistics> m_entryStatistics;
+
     Q_DECLARE_PRIVATE(KoStore)
 };
 
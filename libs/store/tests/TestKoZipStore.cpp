@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "TestKoZipStore.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QUrl>
+
+#include <KoStore.h>
+#include "../KoZipStore.h"
+
+static QByteArray generateData(int size, int seed)
+{
+    QByteArray data(size, '\0');
+    quint32 value = seed;
+    for (int i = 0; i < size; i++) {
+        value = value * 1103515245 + 12345;
+        // keep the data somewhat compressible
+        data[i] = char((value >> 24) & 0x0f);
+    }
+    return data;
+}
+
+void TestKoZipStore::testChunkedWriteRoundtrip()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QDir::separator() + "test.zip";
+
+    // many small writes, similar to what the tile serializer does
+    const QByteArray smallChunks = generateData(3 * KoZipStore::WriteBufferSize + 17, 1);
+    // a single write bigger than the coalescing buffer
+    const QByteArray bigChunk = generateData(2 * KoZipStore::WriteBufferSize + 5, 2);
+
+    {
+        KoZipStore store(0, QUrl::fromLocalFile(fileName), QString(),
+                         KoStore::Write, "application/x-test");
+        QVERIFY(!store.bad());
+
+        QVERIFY(store.open("small.bin"));
+        for (int offset = 0; offset < smallChunks.size(); offset += 37) {
+            const int length = qMin(37, smallChunks.size() - offset);
+            QCOMPARE(store.write(smallChunks.constData() + offset, length), qint64(length));
+        }
+        QVERIFY(store.close());
+
+        QVERIFY(store.open("big.bin"));
+        QCOMPARE(store.write(bigChunk.constData(), bigChunk.size()), qint64(bigChunk.size()));
+        QVERIFY(store.close());
+
+        const QList<KoZipStore::EntryStatistics> stats = store.entryStatistics();
+        QCOMPARE(stats.size(), 2);
+
+        QCOMPARE(stats[0].name, QString("small.bin"));
+        QCOMPARE(stats[0].uncompressedSize, qint64(smallChunks.size()));
+        QCOMPARE(stats[0].writeCalls, qint64((smallChunks.size() + 36) / 37));
+        QVERIFY(stats[0].flushes <= smallChunks.size() / KoZipStore::WriteBufferSize + 1);
+        QVERIFY(stats[0].compressedSize > 0);
+        QVERIFY(stats[0].compressedSize < stats[0].uncompressedSize);
+
+        QCOMPARE(stats[1].name, QString("big.bin"));
+        QCOMPARE(stats[1].uncompressedSize, qint64(bigChunk.size()));
+        QCOMPARE(stats[1].writeCalls, qint64(1));
+        QCOMPARE(stats[1].flushes, qint64(1));
+
+        QVERIFY(store.finalize());
+    }
+
+    QScopedPointer<KoStore> store(KoStore::createStore(fileName, KoStore::Read));
+    QVERIFY(!store->bad());
+
+    QVERIFY(store->open("small.bin"));
+    QCOMPARE(store->read(store->size()), smallChunks);
+    QVERIFY(store->close());
+
+    QVERIFY(store->open("big.bin"));
+    QCOMPARE(store->read(store->size()), bigChunk);
+    QVERIFY(store->close());
+}
+
+void TestKoZipStore::testAtomicReplace()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QDir::separator() + "test.zip";
+
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("old content");
+    }
+
+    const QByteArray data = generateData(1000, 3);
+
+    {
+        QScopedPointer<KoStore> store(KoStore::createStore(QUrl::fromLocalFile(fileName), KoStore::Write, "application/x-test"));
+        QVERIFY(!store->bad());
+
+        QVERIFY(store->open("data.bin"));
+        QCOMPARE(store->write(data), qint64(data.size()));
+        QVERIFY(store->close());
+
+        // the destination must not be touched until the store is finalized
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), QByteArray("old content"));
+        file.close();
+
+        QVERIFY(store->finalize());
+    }
+
+    // no temporary files are left behind
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files), QStringList() << "test.zip");
+
+    QScopedPointer<KoStore> store(KoStore::createStore(fileName, KoStore::Read));
+    QVERIFY(!store->bad());
+    QVERIFY(store->open("data.bin"));
+    QCOMPARE(store->read(store->size()), data);
+    QVERIFY(store->close());
+}
+
+QTEST_GUILESS_MAIN(TestKoZipStore)
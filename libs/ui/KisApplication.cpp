@@ -41,6 +41,7 @@
 #include <QStyle>
 #include <QStyleFactory>
 #include <QSysInfo>
+#include <QTextStream>
 #include <QTimer>
 #include <QWidget>
 
@@ -78,6 +79,7 @@
 #include <metadata/kis_meta_data_io_backend.h>
 #include "kisexiv2/kis_exiv2.h"
 #include "KisApplicationArguments.h"
+#include "KisBatchExporter.h"
 #include <kis_debug.h>
 #include "kis_action_registry.h"
 #include <kis_brush_server.h>
@@ -344,13 +346,14 @@ bool KisApplication::start(const KisApplicationArguments &args)
     const bool exportAs = args.exportAs();
     const bool exportAsPdf = args.exportAsPdf();
     const QString exportFileName = args.exportFileName();
+    const bool batchExport = args.batchExport();
 
-    m_batchRun = (print || exportAs || exportAsPdf || !exportFileName.isEmpty());
+    m_batchRun = (print || exportAs || exportAsPdf || !exportFileName.isEmpty() || batchExport);
     // print & exportAsPdf do user interaction ATM
-    const bool needsMainWindow = !exportAs;
+    const bool needsMainWindow = !exportAs && !batchExport;
     // only show the mainWindow when no command-line mode option is passed
     // TODO: fix print & exportAsPdf to work without mainwindow shown
-    const bool showmainWindow = !exportAs; // would be !batchRun;
+    const bool showmainWindow = !exportAs && !batchExport; // would be !batchRun;
 
     const bool showSplashScreen = !m_batchRun && qgetenv("NOSPLASH").isEmpty() &&  qgetenv("XDG_CURRENT_DESKTOP") != "GNOME";
     if (showSplashScreen) {
@@ -399,6 +402,10 @@ bool KisApplication::start(const KisApplicationArguments &args)
 
     setSplashScreenLoadingText(""); // done loading, so clear out label
 
+    if (batchExport) {
+        return runBatchExport(args);
+    }
+
     // Get the command line arguments which we have to parse
     int argsCount = args.filenames().count();
     if (argsCount > 0) {
@@ -481,6 +488,39 @@ bool KisApplication::start(const KisApplicationArguments &args)
     return true;
 }
 
+bool KisApplication::runBatchExport(const KisApplicationArguments &args)
+{
+    KisBatchExporter exporter;
+
+    if (!exporter.setOutputFormat(args.batchFormat())) {
+        dbgKrita << i18n("Unknown batch export format \"%1\", use the --batch-format option", args.batchFormat()) << endl;
+        return false;
+    }
+
+    exporter.setOutputDirectory(args.batchOutputDir());
+    exporter.setMaxInFlightDocuments(args.batchJobs());
+
+    const QStringList files = KisBatchExporter::collectInputFiles(args.filenames());
+    if (files.isEmpty()) {
+        dbgKrita << i18n("No files to export") << endl;
+        return false;
+    }
+
+    if (!exporter.outputDirectory().isEmpty()) {
+        QDir().mkpath(exporter.outputDirectory());
+    }
+
+    const bool result = exporter.run(files);
+
+    QTextStream out(stdout);
+    out << exporter.report();
+    out.flush();
+
+    QTimer::singleShot(0, this, SLOT(quit()));
+
+    return result;
+}
+
 KisApplication::~KisApplication()
 {
     delete d;
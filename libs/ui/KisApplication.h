@@ -109,6 +109,7 @@ private:
     void clearConfig();
     void loadResources();
     void loadPlugins();
+    bool runBatchExport(const KisApplicationArguments &args);
 
 private:
     KisApplicationPrivate * const d;
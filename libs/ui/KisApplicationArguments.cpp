@@ -39,6 +39,8 @@ struct Q_DECL_HIDDEN KisApplicationArguments::Private
         , print(false)
         , exportAs(false)
         , exportAsPdf(false)
+        , batchExport(false)
+        , batchJobs(0)
     {
     }
 
@@ -50,6 +52,10 @@ struct Q_DECL_HIDDEN KisApplicationArguments::Private
     bool exportAs;
     bool exportAsPdf;
     QString exportFileName;
+    bool batchExport;
+    QString batchFormat;
+    QString batchOutputDir;
+    int batchJobs;
 };
 
 KisApplicationArguments::KisApplicationArguments(const QApplication &app)
@@ -64,6 +70,10 @@ KisApplicationArguments::KisApplicationArguments(const QApplication &app)
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export-pdf"), i18n("Only export to PDF and exit")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export"), i18n("Export to the given filename and exit")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export-filename"), i18n("Filename for export/export-pdf"), QLatin1String("filename")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-export"), i18n("Export all the given files, directories and .lst file lists in parallel and exit")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-format"), i18n("File format of batch-export, e.g. png"), QLatin1String("format")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-output"), i18n("Directory for batch-export, by default the files are exported next to their sources"), QLatin1String("directory")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-jobs"), i18n("Maximum number of documents batch-export loads at the same time"), QLatin1String("count")));
     parser.addPositionalArgument(QLatin1String("[file(s)]"), i18n("File(s) or URL(s) to open"));
     parser.process(app);
 
@@ -93,6 +103,10 @@ KisApplicationArguments::KisApplicationArguments(const QApplication &app)
     d->exportAs = parser.isSet("export");
     d->exportAsPdf = parser.isSet("export-pdf");
     d->exportFileName = parser.value("export-filename");
+    d->batchExport = parser.isSet("batch-export");
+    d->batchFormat = parser.value("batch-format");
+    d->batchOutputDir = parser.value("batch-output");
+    d->batchJobs = parser.value("batch-jobs").toInt();
 }
 
 KisApplicationArguments::KisApplicationArguments(const KisApplicationArguments &rhs)
@@ -106,6 +120,10 @@ KisApplicationArguments::KisApplicationArguments(const KisApplicationArguments &
     d->exportAs = rhs.exportAs();
     d->exportAsPdf = rhs.exportAsPdf();
     d->exportFileName = rhs.exportFileName();
+    d->batchExport = rhs.batchExport();
+    d->batchFormat = rhs.batchFormat();
+    d->batchOutputDir = rhs.batchOutputDir();
+    d->batchJobs = rhs.batchJobs();
 }
 
 KisApplicationArguments::~KisApplicationArguments()
@@ -122,6 +140,10 @@ void KisApplicationArguments::operator=(const KisApplicationArguments &rhs)
     d->exportAs = rhs.exportAs();
     d->exportAsPdf = rhs.exportAsPdf();
     d->exportFileName = rhs.exportFileName();
+    d->batchExport = rhs.batchExport();
+    d->batchFormat = rhs.batchFormat();
+    d->batchOutputDir = rhs.batchOutputDir();
+    d->batchJobs = rhs.batchJobs();
 }
 
 QByteArray KisApplicationArguments::serialize()
@@ -142,6 +164,10 @@ QByteArray KisApplicationArguments::serialize()
     ds << d->exportAs;
     ds << d->exportAsPdf;
     ds << d->exportFileName;
+    ds << d->batchExport;
+    ds << d->batchFormat;
+    ds << d->batchOutputDir;
+    ds << d->batchJobs;
 
     buf.close();
 
@@ -170,6 +196,10 @@ KisApplicationArguments KisApplicationArguments::deserialize(QByteArray &seriali
     ds >> args.d->exportAs;
     ds >> args.d->exportAsPdf;
     ds >> args.d->exportFileName;
+    ds >> args.d->batchExport;
+    ds >> args.d->batchFormat;
+    ds >> args.d->batchOutputDir;
+    ds >> args.d->batchJobs;
 
     buf.close();
 
@@ -216,6 +246,26 @@ QString KisApplicationArguments::exportFileName() const
     return d->exportFileName;
 }
 
+bool KisApplicationArguments::batchExport() const
+{
+    return d->batchExport;
+}
+
+QString KisApplicationArguments::batchFormat() const
+{
+    return d->batchFormat;
+}
+
+QString KisApplicationArguments::batchOutputDir() const
+{
+    return d->batchOutputDir;
+}
+
+int KisApplicationArguments::batchJobs() const
+{
+    return d->batchJobs;
+}
+
 KisApplicationArguments::KisApplicationArguments()
     : d(new Private)
 {
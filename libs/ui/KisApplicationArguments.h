@@ -48,6 +48,10 @@ public:
     bool exportAs() const;
     bool exportAsPdf() const;
     QString exportFileName() const;
+    bool batchExport() const;
+    QString batchFormat() const;
+    QString batchOutputDir() const;
+    int batchJobs() const;
 
 private:
 
@@ -0,0 +1,432 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisBatchExporter.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QUrl>
+
+#include <klocalizedstring.h>
+
+#include <KoColorSpaceRegistry.h>
+#include <KisMimeDatabase.h>
+
+#include "kis_debug.h"
+#include "kis_image.h"
+#include "kis_memory_statistics_server.h"
+#include "kis_resource_server_provider.h"
+#include "KisDocument.h"
+#include "KisImportExportManager.h"
+#include "KisPart.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+qint64 processPeakMemory()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef Q_OS_MAC
+        // OSX reports the value in bytes
+        return qint64(usage.ru_maxrss);
+#else
+        return qint64(usage.ru_maxrss) * 1024;
+#endif
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Exports a document that has already been loaded in the GUI
+ * thread. The job does not touch the document's QObject machinery,
+ * so it can run on a pool thread. The export filters are run in
+ * batch mode: they must resolve their configuration without creating
+ * the options dialog or its config widget and must not show any
+ * message boxes. The document's image is kept under the barrier lock
+ * by the GUI thread while the job is running.
+ */
+class ExportJob : public QRunnable
+{
+public:
+    ExportJob(KisDocument *doc, KisBatchExporter::JobResult *result, const QByteArray &mimeType)
+        : m_doc(doc),
+          m_result(result),
+          m_mimeType(mimeType)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() {
+        QElapsedTimer timer;
+        timer.start();
+
+        KisImportExportManager manager(m_doc);
+        manager.setBatchMode(true);
+        QByteArray mimeType = m_mimeType;
+        m_result->status = manager.exportDocument(m_result->outputFile, mimeType);
+
+        m_result->exportTime = timer.elapsed();
+        m_finished.store(1);
+    }
+
+    bool isFinished() const {
+        return m_finished.load();
+    }
+
+    KisDocument* document() const {
+        return m_doc;
+    }
+
+    KisBatchExporter::JobResult* result() const {
+        return m_result;
+    }
+
+private:
+    KisDocument *m_doc;
+    KisBatchExporter::JobResult *m_result;
+    QByteArray m_mimeType;
+    QAtomicInt m_finished;
+};
+
+QString formatMemory(qint64 bytes)
+{
+    return bytes > 0 ? QString("%1 MiB").arg(qreal(bytes) / (1 << 20), 0, 'f', 1) : QString("n/a");
+}
+
+}
+
+struct KisBatchExporter::Private
+{
+    Private()
+        : maxInFlightDocuments(0),
+          totalTime(0)
+    {
+    }
+
+    QString outputDirectory;
+    QString outputMimeType;
+    int maxInFlightDocuments;
+
+    QVector<JobResult> results;
+    qint64 totalTime;
+
+    QString outputFileName(const QString &inputFile) const;
+
+    KisDocument* loadDocument(JobResult *result);
+    void releaseDocument(ExportJob *job);
+};
+
+QString KisBatchExporter::Private::outputFileName(const QString &inputFile) const
+{
+    const QFileInfo info(inputFile);
+    QString suffix = KisMimeDatabase::suffixesForMimeType(outputMimeType).first();
+    if (suffix.startsWith("*.")) {
+        suffix = suffix.mid(2);
+    }
+
+    const QDir dir(outputDirectory.isEmpty() ? info.absolutePath() : outputDirectory);
+
+    return dir.absoluteFilePath(info.completeBaseName() + "." + suffix);
+}
+
+
+/**
+ * Loading creates the document's QObjects and calls GUI-only API
+ * (e.g. the override cursor), so it is done in the GUI thread
+ */
+KisDocument* KisBatchExporter::Private::loadDocument(JobResult *result)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    KisDocument *doc = KisPart::instance()->createDocument();
+    doc->setFileBatchMode(true);
+
+    if (!doc->openUrl(QUrl::fromLocalFile(result->inputFile)) || !doc->image()) {
+        delete doc;
+        result->status = KisImportExportFilter::ParsingError;
+        result->loadTime = timer.elapsed();
+        return 0;
+    }
+
+    // vector layers are rasterized by the events posted to the GUI thread
+    QCoreApplication::processEvents();
+    doc->image()->barrierLock();
+
+    result->loadTime = timer.elapsed();
+    result->imageMemory =
+        KisMemoryStatisticsServer::instance()->fetchMemoryStatistics(doc->image()).imageSize;
+
+    return doc;
+}
+
+void KisBatchExporter::Private::releaseDocument(ExportJob *job)
+{
+    KisDocument *doc = job->document();
+    doc->image()->unlock();
+    delete doc;
+
+    /**
+     * The document leaves a memory release object to be deleted
+     * later. The batch runs before the application's event loop is
+     * started, so deliver the deferred deletions right away.
+     */
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+    job->result()->peakMemory = processPeakMemory();
+    delete job;
+}
+
+KisBatchExporter::KisBatchExporter()
+    : m_d(new Private)
+{
+}
+
+KisBatchExporter::~KisBatchExporter()
+{
+}
+
+void KisBatchExporter::setOutputDirectory(const QString &path)
+{
+    m_d->outputDirectory = path.isEmpty() ? path : QDir::current().absoluteFilePath(path);
+}
+
+QString KisBatchExporter::outputDirectory() const
+{
+    return m_d->outputDirectory;
+}
+
+bool KisBatchExporter::setOutputFormat(const QString &format)
+{
+    QString mimeType = format;
+
+    if (!format.contains('/')) {
+        mimeType = KisMimeDatabase::mimeTypeForSuffix(format);
+    }
+
+    if (mimeType.isEmpty() ||
+        mimeType == "application/octet-stream" ||
+        KisMimeDatabase::suffixesForMimeType(mimeType).isEmpty() ||
+        !KisImportExportManager::mimeFilter(KisImportExportManager::Export).contains(mimeType)) {
+
+        return false;
+    }
+
+    m_d->outputMimeType = mimeType;
+    return true;
+}
+
+QString KisBatchExporter::outputMimeType() const
+{
+    return m_d->outputMimeType;
+}
+
+void KisBatchExporter::setMaxInFlightDocuments(int value)
+{
+    m_d->maxInFlightDocuments = qMax(0, value);
+}
+
+int KisBatchExporter::maxInFlightDocuments() const
+{
+    return m_d->maxInFlightDocuments > 0 ?
+        m_d->maxInFlightDocuments : QThread::idealThreadCount();
+}
+
+QStringList KisBatchExporter::collectInputFiles(const QStringList &paths)
+{
+    const QStringList importMimeTypes =
+        KisImportExportManager::mimeFilter(KisImportExportManager::Import);
+
+    QStringList files;
+
+    Q_FOREACH (const QString &path, paths) {
+        const QFileInfo info(path);
+
+        if (info.isDir()) {
+            QDir dir(path);
+            Q_FOREACH (const QFileInfo &entry, dir.entryInfoList(QDir::Files, QDir::Name)) {
+                if (importMimeTypes.contains(KisMimeDatabase::mimeTypeForFile(entry.fileName()))) {
+                    files << entry.absoluteFilePath();
+                }
+            }
+        } else if (info.suffix() == "lst") {
+            QFile listFile(path);
+            if (!listFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                warnKrita << "Could not open the batch list" << path;
+                continue;
+            }
+
+            const QDir listDir = info.absoluteDir();
+            QTextStream stream(&listFile);
+            while (!stream.atEnd()) {
+                const QString line = stream.readLine().trimmed();
+                if (line.isEmpty() || line.startsWith('#')) continue;
+
+                files << listDir.absoluteFilePath(line);
+            }
+        } else {
+            files << info.absoluteFilePath();
+        }
+    }
+
+    return files;
+}
+
+bool KisBatchExporter::run(const QStringList &inputFiles)
+{
+    KIS_ASSERT_RECOVER(!m_d->outputMimeType.isEmpty()) { return false; }
+
+    /**
+     * All the global registries are lazily initialized and are not
+     * supposed to be created from a worker thread, so make sure they
+     * exist before the jobs are started. After that the jobs share
+     * the loaded resources and the color spaces with their cached
+     * conversion transformations.
+     */
+    KoColorSpaceRegistry::instance();
+    KisResourceServerProvider::instance();
+    KisMemoryStatisticsServer::instance();
+    KisPart::instance();
+    KisImportExportManager::mimeFilter(KisImportExportManager::Import);
+    KisImportExportManager::mimeFilter(KisImportExportManager::Export);
+
+    m_d->results.clear();
+    m_d->results.resize(inputFiles.size());
+
+    for (int i = 0; i < inputFiles.size(); i++) {
+        m_d->results[i].inputFile = inputFiles[i];
+        m_d->results[i].outputFile = m_d->outputFileName(inputFiles[i]);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(maxInFlightDocuments());
+
+    const QByteArray mimeType = m_d->outputMimeType.toLatin1();
+
+    /**
+     * Saving into the native format generates the preview through
+     * QPixmap, which is not allowed outside the GUI thread
+     */
+    const bool exportInGuiThread =
+        mimeType == KisDocument::nativeFormatMimeType() ||
+        KisDocument::extraNativeMimeTypes().contains(m_d->outputMimeType);
+
+    QList<ExportJob*> inFlightJobs;
+    int nextFile = 0;
+
+    while (nextFile < m_d->results.size() || !inFlightJobs.isEmpty()) {
+        QList<ExportJob*>::iterator it = inFlightJobs.begin();
+        while (it != inFlightJobs.end()) {
+            if ((*it)->isFinished()) {
+                m_d->releaseDocument(*it);
+                it = inFlightJobs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        while (inFlightJobs.size() < maxInFlightDocuments() &&
+               nextFile < m_d->results.size()) {
+
+            JobResult *result = &m_d->results[nextFile++];
+
+            KisDocument *doc = m_d->loadDocument(result);
+            if (!doc) continue;
+
+            ExportJob *job = new ExportJob(doc, result, mimeType);
+
+            if (exportInGuiThread) {
+                job->run();
+                m_d->releaseDocument(job);
+            } else {
+                inFlightJobs << job;
+                pool.start(job);
+            }
+        }
+
+        if (!inFlightJobs.isEmpty()) {
+            pool.waitForDone(20);
+            QCoreApplication::processEvents();
+        }
+    }
+
+    m_d->totalTime = timer.elapsed();
+
+    bool success = true;
+    Q_FOREACH (const JobResult &result, m_d->results) {
+        if (result.status != KisImportExportFilter::OK) {
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+QVector<KisBatchExporter::JobResult> KisBatchExporter::results() const
+{
+    return m_d->results;
+}
+
+QString KisBatchExporter::report() const
+{
+    QString report;
+    QTextStream stream(&report);
+
+    int numFailed = 0;
+    qint64 peakMemory = 0;
+
+    Q_FOREACH (const JobResult &result, m_d->results) {
+        stream << result.inputFile << " -> " << result.outputFile << endl;
+
+        if (result.status == KisImportExportFilter::OK) {
+            stream << "    " << i18n("load: %1 ms, export: %2 ms, image: %3, process peak: %4",
+                                     result.loadTime, result.exportTime,
+                                     formatMemory(result.imageMemory),
+                                     formatMemory(result.peakMemory)) << endl;
+        } else {
+            stream << "    " << i18n("failed with status %1", (int)result.status) << endl;
+            numFailed++;
+        }
+
+        peakMemory = qMax(peakMemory, result.peakMemory);
+    }
+
+    stream << i18n("Exported %1 of %2 files in %3 ms using %4 parallel documents, process peak memory: %5",
+                   m_d->results.size() - numFailed, m_d->results.size(),
+                   m_d->totalTime, maxInFlightDocuments(),
+                   formatMemory(peakMemory)) << endl;
+
+    return report;
+}
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISBATCHEXPORTER_H
+#define KISBATCHEXPORTER_H
+
+#include <QScopedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "KisImportExportFilter.h"
+#include "kritaui_export.h"
+
+/**
+ * KisBatchExporter converts a set of files into another format
+ * without any user interaction. The documents are loaded and released
+ * in the GUI thread, since KisDocument uses GUI-only API there, while
+ * their KisImportExportManager exports run concurrently on a thread
+ * pool. Exporting into the native format needs QPixmap for the
+ * preview, so it is done in the GUI thread as well.
+ *
+ * The exporter is meant to be run by the application after all the
+ * resources, plugins and color spaces have been loaded, so that all
+ * the jobs share them (and the color conversion transformations
+ * cached by the color spaces) instead of loading them once per file.
+ *
+ * The number of documents in flight is bounded by
+ * setMaxInFlightDocuments(), which is what limits the memory
+ * consumption of a big batch: every document keeps its whole image in
+ * memory until its export is finished.
+ */
+class KRITAUI_EXPORT KisBatchExporter
+{
+public:
+    struct JobResult {
+        JobResult()
+            : status(KisImportExportFilter::StupidError),
+              loadTime(0),
+              exportTime(0),
+              imageMemory(0),
+              peakMemory(0)
+        {
+        }
+
+        QString inputFile;
+        QString outputFile;
+        KisImportExportFilter::ConversionStatus status;
+
+        /// the time spent on loading the document, in milliseconds
+        qint64 loadTime;
+
+        /// the time spent on exporting the document, in milliseconds
+        qint64 exportTime;
+
+        /// the memory occupied by the loaded image, in bytes
+        qint64 imageMemory;
+
+        /// the peak memory of the whole process by the end of the job,
+        /// in bytes, or 0 if the platform doesn't report it
+        qint64 peakMemory;
+    };
+
+public:
+    KisBatchExporter();
+    ~KisBatchExporter();
+
+    /**
+     * The directory the exported files are written to. If empty (the
+     * default), every file is written next to its source.
+     */
+    void setOutputDirectory(const QString &path);
+    QString outputDirectory() const;
+
+    /**
+     * The format of the exported files, either a mimetype or a file
+     * suffix ("png", "*.png")
+     *
+     * @return false if the format is not known
+     */
+    bool setOutputFormat(const QString &format);
+    QString outputMimeType() const;
+
+    /**
+     * The maximum number of documents loaded at the same time. Zero
+     * means the ideal thread count of the machine.
+     */
+    void setMaxInFlightDocuments(int value);
+    int maxInFlightDocuments() const;
+
+    /**
+     * Expands \p paths into the list of files to export. Directories
+     * are replaced with the files they contain that Krita can import,
+     * files with the ".lst" suffix are treated as lists of paths, one
+     * per line. Relative paths inside lists are resolved against the
+     * location of the list.
+     */
+    static QStringList collectInputFiles(const QStringList &paths);
+
+    /**
+     * Exports all \p inputFiles and blocks until all of them are
+     * processed. The GUI event loop keeps being processed while
+     * waiting.
+     *
+     * @return true if all the files have been exported successfully
+     */
+    bool run(const QStringList &inputFiles);
+
+    QVector<JobResult> results() const;
+
+    /**
+     * A human-readable per-file timing and memory report of the
+     * last run()
+     */
+    QString report() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISBATCHEXPORTER_H
@@ -78,6 +78,7 @@
 #include <kis_debug.h>
 #include <kis_group_layer.h>
 #include <kis_image.h>
+#include <kis_image_config.h>
 #include <kis_layer.h>
 #include <kis_name_server.h>
 #include <kis_paint_layer.h>
@@ -98,6 +99,7 @@
 #include "flake/kis_shape_controller.h"
 #include "kra/kis_kra_loader.h"
 #include "kra/kis_kra_saver.h"
+#include "kra/kis_kra_save_cache.h"
 #include "kis_statusbar.h"
 #include "widgets/kis_progress_widget.h"
 #include "kis_canvas_resource_provider.h"
@@ -356,6 +358,7 @@ public:
 
     KisKraLoader* kraLoader;
     KisKraSaver* kraSaver;
+    KisKraSaveCache kraSaveCache;
 
     bool suppressProgress;
     KoProgressProxy* fileProgressProxy;
@@ -526,6 +529,7 @@ KisDocument::KisDocument()
 
     init();
     undoStack()->setUndoLimit(KisConfig().undoStackLimit());
+    undoStack()->setUndoMemoryLimit(qint64(KisImageConfig().undoMemoryLimit()) << 20);
     setBackupFile(KisConfig().backupFile());
 }
 
@@ -733,6 +737,8 @@ bool KisDocument::saveFile(KisPropertiesConfigurationSP exportConfiguration)
                 setErrorMessage(i18n("Copying the temporary file failed: %1 to %2: %3", tempFile.fileName(), dstFile.fileName(), tempFile.errorString()));
             }
             else {
+                d->kraSaveCache.relocate(tempororaryFileName, localFilePath());
+
                 r = tempFile.remove();
                 if (!r) {
                     setErrorMessage(i18n("Could not remove temporary file %1: %2", tempFile.fileName(), tempFile.errorString()));
@@ -966,12 +972,16 @@ bool KisDocument::saveNativeFormat(const QString & file)
 
     bool result = false;
 
+    d->kraSaveCache.beginSave();
+
     if (!d->isAutosaving) {
         KisAsyncActionFeedback f(i18n("Saving document..."), 0);
         result = f.runAction(std::bind(&KisDocument::saveNativeFormatCalligra, this, store));
     } else {
         result = saveNativeFormatCalligra(store);
     }
+
+    d->kraSaveCache.endSave(file, result);
     return result;
 }
 
@@ -1765,6 +1775,7 @@ bool KisDocument::completeLoading(KoStore* store)
 
 bool KisDocument::completeSaving(KoStore* store)
 {
+    d->kraSaver->setSaveCache(&d->kraSaveCache);
     d->kraSaver->saveKeyframes(store, url().url(), isStoredExtern());
     d->kraSaver->saveBinaryData(store, d->image, url().url(), isStoredExtern(), d->isAutosaving);
     bool retval = true;
@@ -196,7 +196,9 @@ KisImportExportFilter::ConversionStatus KisImportExportManager::exportDocument(c
 
     if (!m_graph.isValid()) {
         errFile << "Couldn't create a valid graph for this source mimetype.";
-        QApplication::restoreOverrideCursor();
+        if (!d->batch) {
+            QApplication::restoreOverrideCursor();
+        }
         if (!d->batch && !userCancelled) {
             QMessageBox::critical(0, i18nc("@title:window", "Krita"), i18n("Could not export file: the export filter is missing."));
         }
@@ -211,8 +213,8 @@ KisImportExportFilter::ConversionStatus KisImportExportManager::exportDocument(c
         errFile << "Couldn't create a valid filter chain to " << mimeType << " !" << endl;
         if (!d->batch) {
             QMessageBox::critical(0, i18nc("@title:window", "Krita"), i18n("Could not export file: the export filter is missing."));
+            QApplication::restoreOverrideCursor();
         }
-        QApplication::restoreOverrideCursor();
         return KisImportExportFilter::BadConversionGraph;
     }
 
@@ -70,6 +70,7 @@
 #include <KoPluginLoader.h>
 #include <KoDocumentInfo.h>
 #include <KoGlobal.h>
+#include <KoFileDialog.h>
 
 #include "input/kis_input_manager.h"
 #include "canvas/kis_canvas2.h"
@@ -126,6 +127,8 @@
 #include "kis_icon_utils.h"
 #include "kis_guides_manager.h"
 #include "kis_derived_resources.h"
+#include "kis_image_config.h"
+#include "kis_trace_recorder.h"
 
 
 class BlockingUserInputEventFilter : public QObject
@@ -600,6 +603,13 @@ void KisViewManager::createActions()
     KisAction *tabletDebugger = actionManager()->createAction("tablet_debugger");
     connect(tabletDebugger, SIGNAL(triggered()), this, SLOT(toggleTabletLogger()));
 
+    KisAction *traceRecording = actionManager()->createAction("toggle_trace_recording");
+    traceRecording->setChecked(KisTraceRecorder::instance()->isEnabled());
+    connect(traceRecording, SIGNAL(toggled(bool)), this, SLOT(slotToggleTraceRecording(bool)));
+
+    KisAction *saveTrace = actionManager()->createAction("save_performance_trace");
+    connect(saveTrace, SIGNAL(triggered()), this, SLOT(slotSavePerformanceTrace()));
+
     d->createTemplate = actionManager()->createAction("create_template");
     connect(d->createTemplate, SIGNAL(triggered()), this, SLOT(slotCreateTemplate()));
 
@@ -1113,6 +1123,31 @@ void KisViewManager::toggleTabletLogger()
     d->inputManager.toggleTabletLogger();
 }
 
+void KisViewManager::slotToggleTraceRecording(bool value)
+{
+    KisTraceRecorder::instance()->setEnabled(value);
+
+    KisImageConfig cfg;
+    cfg.setEnableTracing(value);
+}
+
+void KisViewManager::slotSavePerformanceTrace()
+{
+    KoFileDialog dialog(mainWindow(), KoFileDialog::SaveFile, "SavePerformanceTrace");
+    dialog.setCaption(i18n("Save Performance Trace"));
+    dialog.setDefaultDir(QDesktopServices::storageLocation(QDesktopServices::DocumentsLocation));
+    dialog.setMimeTypeFilters(QStringList() << "application/json");
+    QString fileName = dialog.filename();
+
+    if (fileName.isEmpty()) return;
+
+    if (!KisTraceRecorder::instance()->saveChromeTrace(fileName)) {
+        QMessageBox::critical(mainWindow(),
+                              i18nc("@title:window", "Couldn't save performance trace"),
+                              i18n("Could not write the performance trace to %1", fileName));
+    }
+}
+
 void KisViewManager::openResourcesDirectory()
 {
     QString dir = KoResourcePaths::locateLocal("data", "");
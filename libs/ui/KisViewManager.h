@@ -228,6 +228,8 @@ private Q_SLOTS:
     void slotSaveIncrementalBackup();
     void showStatusBar(bool toggled);
     void toggleTabletLogger();
+    void slotToggleTraceRecording(bool value);
+    void slotSavePerformanceTrace();
     void openResourcesDirectory();
     void initializeStatusBarVisibility();
     void guiUpdateTimeout();
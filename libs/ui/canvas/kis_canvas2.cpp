@@ -67,6 +67,7 @@
 #include "KisView.h"
 #include "kis_canvas_controller.h"
 #include "kis_grid_config.h"
+#include "kis_global.h"
 
 #include "kis_animation_player.h"
 #include "kis_animation_frame_cache.h"
@@ -127,6 +128,9 @@ public:
     bool lodAllowedInCanvas;
     bool bootstrapLodBlocked;
 
+    QPointF priorityCursorPos;
+    bool hasPriorityCursorPos = false;
+
     bool effectiveLodAllowedInCanvas() {
         return lodAllowedInCanvas && !bootstrapLodBlocked;
     }
@@ -720,6 +724,7 @@ void KisCanvas2::notifyZoomChanged()
     }
 
     notifyLevelOfDetailChange();
+    notifyUpdatePriorityChange();
     updateCanvas(); // update the canvas, because that isn't done when zooming using KoZoomAction
 }
 
@@ -738,6 +743,44 @@ void KisCanvas2::notifyLevelOfDetailChange()
     image->setDesiredLevelOfDetail(lod);
 }
 
+void KisCanvas2::notifyUpdatePriorityChange()
+{
+    KisImageSP image = this->image();
+    if (!image || !m_d->canvasWidget) return;
+
+    const QRectF widgetRect(QPointF(), m_d->canvasWidget->widget()->size());
+    const QRect visibleRect =
+        m_d->coordinatesConverter->widgetToImage(widgetRect).toAlignedRect() &
+        image->bounds();
+
+    const QPointF focusPoint =
+        m_d->hasPriorityCursorPos && widgetRect.contains(m_d->priorityCursorPos) ?
+        m_d->coordinatesConverter->widgetToImage(m_d->priorityCursorPos) :
+        QRectF(visibleRect).center();
+
+    image->setUpdatePriorityHint(visibleRect, focusPoint);
+}
+
+void KisCanvas2::notifyCursorMoved(const QPointF &widgetPos)
+{
+    /**
+     * The hint only has to be approximate, so don't bother the
+     * update queue on every single mouse event
+     */
+    const qreal minimalDistance = 32.0;
+
+    if (m_d->hasPriorityCursorPos &&
+        kisDistance(widgetPos, m_d->priorityCursorPos) < minimalDistance) {
+
+        return;
+    }
+
+    m_d->priorityCursorPos = widgetPos;
+    m_d->hasPriorityCursorPos = true;
+
+    notifyUpdatePriorityChange();
+}
+
 void KisCanvas2::preScale()
 {
     if (!m_d->currentCanvasIsOpenGL) {
@@ -788,6 +831,7 @@ void KisCanvas2::documentOffsetMoved(const QPoint &documentOffset)
 
     emit documentOffsetUpdateFinished();
 
+    notifyUpdatePriorityChange();
     updateCanvas();
 }
 
@@ -268,6 +268,13 @@ public:
 
     void setFavoriteResourceManager(KisFavoriteResourceManager* favoriteResourceManager);
 
+    /**
+     * Called by the input manager when the cursor moves over the
+     * canvas widget. The image updates around the cursor get higher
+     * priority.
+     */
+    void notifyCursorMoved(const QPointF &widgetPos);
+
 private:
     Q_DISABLE_COPY(KisCanvas2)
 
@@ -280,6 +287,7 @@ private:
     void resetCanvas(bool useOpenGL);
 
     void notifyLevelOfDetailChange();
+    void notifyUpdatePriorityChange();
 
     // Completes construction of canvas.
     // To be called by KisView in its constructor, once it has been setup enough
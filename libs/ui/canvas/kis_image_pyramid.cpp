@@ -18,6 +18,7 @@
 #include "kis_image_pyramid.h"
 
 #include <QBitArray>
+#include <QtConcurrent>
 #include <KoChannelInfo.h>
 #include <KoCompositeOp.h>
 #include <KoColorSpaceRegistry.h>
@@ -32,6 +33,7 @@
 #include "kis_debug.h"
 #include "kis_config.h"
 #include "kis_image_config.h"
+#include "kis_image_pyramid_downsampler.h"
 
 //#define DEBUG_PYRAMID
 
@@ -100,8 +102,23 @@ inline void alignRectBy2(qint32 &x, qint32 &y, qint32 &w, qint32 &h)
 
 /************* class KisImagePyramid ********************************/
 
+struct KisImagePyramid::ChunkRecalculator
+{
+    ChunkRecalculator(KisImagePyramid *pyramid)
+        : m_pyramid(pyramid)
+    {
+    }
+
+    inline void operator() (const QRect &rect) {
+        m_pyramid->recalculateChunk(rect);
+    }
+
+    KisImagePyramid *m_pyramid;
+};
+
 KisImagePyramid::KisImagePyramid(qint32 pyramidHeight)
-        : m_monitorProfile(0)
+        : m_downsampler(KisImagePyramidDownsampler::create())
+        , m_monitorProfile(0)
         , m_monitorColorSpace(0)
         , m_pyramidHeight(pyramidHeight)
 {
@@ -208,7 +225,12 @@ void KisImagePyramid::setImage(KisImageWSP newImage)
             }
 
         }
-        //TODO: check whether there is needed recalculateCache()
+
+        /**
+         * The downsampled planes are not touched by the updates until
+         * the image changes, so fill them right now
+         */
+        recalculateLevels(rc);
     }
 }
 
@@ -334,18 +356,41 @@ void KisImagePyramid::retrieveImageData(const QRect &rect)
 
 void KisImagePyramid::recalculateCache(KisPPUpdateInfoSP info)
 {
-    KisPaintDevice *src;
-    KisPaintDevice *dst;
-    QRect currentSrcRect = info->dirtyImageRectVar;
+    recalculateLevels(info->dirtyImageRectVar);
+}
 
-    for (int i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
-        src = m_pyramid[i-1].data();
-        dst = m_pyramid[i].data();
-        if (!currentSrcRect.isEmpty()) {
-            currentSrcRect = downsampleByFactor2(currentSrcRect, src, dst);
+void KisImagePyramid::recalculateLevels(const QRect &dirtyRect)
+{
+    if (dirtyRect.isEmpty() || m_pyramidHeight <= FIRST_NOT_ORIGINAL_INDEX) return;
+
+    /**
+     * The dirty rect is split into chunks that are downsampled in
+     * parallel. The chunks are aligned by 2^(m_pyramidHeight - 1),
+     * so on every plane they start at even coordinates and never
+     * overlap each other after downsampling.
+     */
+    const qint32 chunkSize = qMax(256, 1 << (m_pyramidHeight - 1));
+
+    qint32 firstX = dirtyRect.x();
+    qint32 firstY = dirtyRect.y();
+    alignByPow2Lo(firstX, chunkSize);
+    alignByPow2Lo(firstY, chunkSize);
+
+    QVector<QRect> chunks;
+
+    for (qint32 y = firstY; y <= dirtyRect.bottom(); y += chunkSize) {
+        for (qint32 x = firstX; x <= dirtyRect.right(); x += chunkSize) {
+            chunks << (QRect(x, y, chunkSize, chunkSize) & dirtyRect);
         }
     }
 
+    if (chunks.size() == 1) {
+        recalculateChunk(chunks.first());
+    } else {
+        ChunkRecalculator recalculator(this);
+        QtConcurrent::blockingMap(chunks, recalculator);
+    }
+
 #ifdef DEBUG_PYRAMID
     QImage image = m_pyramid[ORIGINAL_INDEX]->convertToQImage(m_monitorProfile, m_renderingIntent, m_conversionFlags);
     image.save("./PYRAMID_BASE.png");
@@ -360,6 +405,19 @@ void KisImagePyramid::recalculateCache(KisPPUpdateInfoSP info)
 #endif
 }
 
+void KisImagePyramid::recalculateChunk(const QRect &rect)
+{
+    QRect currentSrcRect = rect;
+
+    for (int i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
+        if (currentSrcRect.isEmpty()) break;
+
+        currentSrcRect = downsampleByFactor2(currentSrcRect,
+                                             m_pyramid[i-1].data(),
+                                             m_pyramid[i].data());
+    }
+}
+
 QRect KisImagePyramid::downsampleByFactor2(const QRect& srcRect,
         KisPaintDevice* src,
         KisPaintDevice* dst)
@@ -390,8 +448,8 @@ QRect KisImagePyramid::downsampleByFactor2(const QRect& srcRect,
 
             Q_ASSERT(!isOdd(conseqPixels));
 
-            downsamplePixels(srcIt0->oldRawData(), srcIt1->oldRawData(),
-                             dstIt->rawData(), conseqPixels);
+            m_downsampler->downsamplePixels(srcIt0->oldRawData(), srcIt1->oldRawData(),
+                                            dstIt->rawData(), conseqPixels);
 
 
             srcIt1->nextPixels(conseqPixels);
@@ -406,39 +464,6 @@ QRect KisImagePyramid::downsampleByFactor2(const QRect& srcRect,
     return QRect(dstX, dstY, dstWidth, dstHeight);
 }
 
-void  KisImagePyramid::downsamplePixels(const quint8 *srcRow0,
-                                        const quint8 *srcRow1,
-                                        quint8 *dstRow,
-                                        qint32 numSrcPixels)
-{
-    /**
-     * FIXME (mandatory): Use SSE and friends here.
-     */
-
-    qint16 b = 0;
-    qint16 g = 0;
-    qint16 r = 0;
-    qint16 a = 0;
-
-    static const qint32 pixelSize = 4; // This is preview argb8 mode
-
-    for (qint32 i = 0; i < numSrcPixels / 2; i++) {
-        b = srcRow0[0] + srcRow1[0] + srcRow0[4] + srcRow1[4];
-        g = srcRow0[1] + srcRow1[1] + srcRow0[5] + srcRow1[5];
-        r = srcRow0[2] + srcRow1[2] + srcRow0[6] + srcRow1[6];
-        a = srcRow0[3] + srcRow1[3] + srcRow0[7] + srcRow1[7];
-
-        dstRow[0] = b / 4;
-        dstRow[1] = g / 4;
-        dstRow[2] = r / 4;
-        dstRow[3] = a / 4;
-
-        dstRow += pixelSize;
-        srcRow0 += 2 * pixelSize;
-        srcRow1 += 2 * pixelSize;
-    }
-}
-
 int KisImagePyramid::findFirstGoodPlaneIndex(qreal scale,
         QSize originalSize)
 {
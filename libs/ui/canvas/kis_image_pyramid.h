@@ -22,14 +22,18 @@
 #include <QImage>
 #include <QVector>
 #include <QThreadStorage>
+#include <QScopedPointer>
 
 #include <KoColorSpace.h>
 #include <kis_image.h>
 #include <kis_paint_device.h>
 #include "kis_projection_backend.h"
+#include "kritaui_export.h"
 
+class KisImagePyramidDownsampler;
 
-class KisImagePyramid : QObject, public KisProjectionBackend
+
+class KRITAUI_EXPORT KisImagePyramid : QObject, public KisProjectionBackend
 {
     Q_OBJECT
 
@@ -88,12 +92,19 @@ private:
                               KisPaintDevice* src, KisPaintDevice* dst);
 
     /**
-     * Auxiliary function. Downsamples two lines in @srcRow0
-     * and @srcRow1 into one line @dstRow
-     * Note: @numSrcPixels must be EVEN
+     * Regenerates all the downsampled planes for @dirtyRect of the
+     * original plane, splitting it into chunks processed in parallel
+     */
+    void recalculateLevels(const QRect &dirtyRect);
+
+    /**
+     * Regenerates all the downsampled planes for @rect of the
+     * original plane. It is safe to call it concurrently for
+     * non-overlapping chunks of the image (see recalculateCache())
      */
-    void downsamplePixels(const quint8 *srcRow0, const quint8 *srcRow1,
-                          quint8 *dstRow, qint32 numSrcPixels);
+    void recalculateChunk(const QRect &rect);
+
+    struct ChunkRecalculator;
 
     /**
      * Searches for the last pyramid plane that can cover
@@ -114,10 +125,13 @@ private Q_SLOTS:
     void configChanged();
 
 private:
+    friend class KisImagePyramidTest;
 
     QVector<KisPaintDeviceSP> m_pyramid;
     KisImageWSP  m_originalImage;
 
+    QScopedPointer<KisImagePyramidDownsampler> m_downsampler;
+
     const KoColorProfile* m_monitorProfile;
     const KoColorSpace* m_monitorColorSpace;
 
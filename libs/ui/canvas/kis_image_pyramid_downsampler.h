@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_IMAGE_PYRAMID_DOWNSAMPLER_H
+#define __KIS_IMAGE_PYRAMID_DOWNSAMPLER_H
+
+#include <QtGlobal>
+#include "kritaui_export.h"
+
+/**
+ * Downsamples rows of the 8-bit RGBA pixels of KisImagePyramid planes
+ * with a 2x2 box filter. The best implementation for the current CPU
+ * is selected at runtime.
+ */
+class KRITAUI_EXPORT KisImagePyramidDownsampler
+{
+public:
+    virtual ~KisImagePyramidDownsampler();
+
+    /**
+     * Downsamples two lines in @srcRow0 and @srcRow1 into one
+     * line @dstRow
+     * Note: @numSrcPixels must be EVEN
+     */
+    virtual void downsamplePixels(const quint8 *srcRow0, const quint8 *srcRow1,
+                                  quint8 *dstRow, qint32 numSrcPixels) const = 0;
+
+    /**
+     * Creates the fastest downsampler supported by the CPU
+     */
+    static KisImagePyramidDownsampler* create();
+
+    /**
+     * Creates a plain scalar downsampler. Used for reference
+     * in tests and benchmarks.
+     */
+    static KisImagePyramidDownsampler* createScalar();
+};
+
+#endif /* __KIS_IMAGE_PYRAMID_DOWNSAMPLER_H */
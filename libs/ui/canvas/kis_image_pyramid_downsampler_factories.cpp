@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_image_pyramid_downsampler_factories.h"
+
+#include "kis_image_pyramid_downsampler.h"
+
+
+#ifdef HAVE_VC
+
+template<Vc::Implementation _impl>
+class KisImagePyramidVectorDownsampler : public KisImagePyramidDownsampler
+{
+public:
+    void downsamplePixels(const quint8 *srcRow0, const quint8 *srcRow1,
+                          quint8 *dstRow, qint32 numSrcPixels) const
+    {
+        typedef Vc::uint_v uint_v;
+
+        const quint32 *src0 = reinterpret_cast<const quint32*>(srcRow0);
+        const quint32 *src1 = reinterpret_cast<const quint32*>(srcRow1);
+        quint32 *dst = reinterpret_cast<quint32*>(dstRow);
+
+        const qint32 numDstPixels = numSrcPixels / 2;
+        const qint32 vectorSize = uint_v::size();
+        const qint32 numVectorPixels = numDstPixels - numDstPixels % vectorSize;
+
+        /**
+         * Every pixel is handled as a 32-bit word. Even and odd channels
+         * are summed up separately in the 16-bit halves of the word, so
+         * the sum of four pixels never overflows and the result is
+         * exactly the same as the one of the scalar version.
+         */
+        const uint_v mask(quint32(0x00FF00FF));
+
+        for (qint32 i = 0; i < numVectorPixels; i += vectorSize) {
+            uint_v p00, p01, p10, p11;
+            Vc::deinterleave(&p00, &p01, src0 + 2 * i, Vc::Unaligned);
+            Vc::deinterleave(&p10, &p11, src1 + 2 * i, Vc::Unaligned);
+
+            const uint_v evenSum =
+                (p00 & mask) + (p01 & mask) +
+                (p10 & mask) + (p11 & mask);
+
+            const uint_v oddSum =
+                ((p00 >> 8) & mask) + ((p01 >> 8) & mask) +
+                ((p10 >> 8) & mask) + ((p11 >> 8) & mask);
+
+            const uint_v result =
+                ((evenSum >> 2) & mask) | (((oddSum >> 2) & mask) << 8);
+
+            result.store(dst + i, Vc::Unaligned);
+        }
+
+        const qint32 pixelSize = 4;
+        const qint32 srcOffset = 2 * numVectorPixels * pixelSize;
+
+        downsamplePixelsScalar(srcRow0 + srcOffset,
+                               srcRow1 + srcOffset,
+                               dstRow + numVectorPixels * pixelSize,
+                               numSrcPixels - 2 * numVectorPixels);
+    }
+};
+
+#endif /* HAVE_VC */
+
+
+template<>
+KisImagePyramidDownsamplerFactory::ReturnType
+KisImagePyramidDownsamplerFactory::create<Vc::CurrentImplementation::current()>(ParamType)
+{
+#ifdef HAVE_VC
+    return new KisImagePyramidVectorDownsampler<Vc::CurrentImplementation::current()>();
+#else
+    return KisImagePyramidDownsampler::createScalar();
+#endif
+}
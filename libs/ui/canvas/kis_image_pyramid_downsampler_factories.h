@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_IMAGE_PYRAMID_DOWNSAMPLER_FACTORIES_H
+#define __KIS_IMAGE_PYRAMID_DOWNSAMPLER_FACTORIES_H
+
+#include <compositeops/KoVcMultiArchBuildSupport.h>
+#include <QtGlobal>
+
+class KisImagePyramidDownsampler;
+
+struct KisImagePyramidDownsamplerFactory
+{
+    typedef void* ParamType;
+    typedef KisImagePyramidDownsampler* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType);
+};
+
+/**
+ * The reference implementation of the 2x2 box filter for
+ * 8-bit RGBA pixels
+ */
+static inline void downsamplePixelsScalar(const quint8 *srcRow0,
+                                          const quint8 *srcRow1,
+                                          quint8 *dstRow,
+                                          qint32 numSrcPixels)
+{
+    qint16 b = 0;
+    qint16 g = 0;
+    qint16 r = 0;
+    qint16 a = 0;
+
+    static const qint32 pixelSize = 4; // This is preview argb8 mode
+
+    for (qint32 i = 0; i < numSrcPixels / 2; i++) {
+        b = srcRow0[0] + srcRow1[0] + srcRow0[4] + srcRow1[4];
+        g = srcRow0[1] + srcRow1[1] + srcRow0[5] + srcRow1[5];
+        r = srcRow0[2] + srcRow1[2] + srcRow0[6] + srcRow1[6];
+        a = srcRow0[3] + srcRow1[3] + srcRow0[7] + srcRow1[7];
+
+        dstRow[0] = b / 4;
+        dstRow[1] = g / 4;
+        dstRow[2] = r / 4;
+        dstRow[3] = a / 4;
+
+        dstRow += pixelSize;
+        srcRow0 += 2 * pixelSize;
+        srcRow1 += 2 * pixelSize;
+    }
+}
+
+#endif /* __KIS_IMAGE_PYRAMID_DOWNSAMPLER_FACTORIES_H */
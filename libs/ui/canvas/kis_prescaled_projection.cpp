@@ -95,9 +95,11 @@ KisPrescaledProjection::KisPrescaledProjection()
 {
     updateSettings();
 
-    // we disable building the pyramid with setting its height to 1
-    // XXX: setting it higher than 1 is broken because it's not updated until you show/hide the layer
-    m_d->projectionBackend = new KisImagePyramid(1);
+    /**
+     * The planes down to 1:8 let the zoomed out canvas be prescaled
+     * from a smaller image instead of the full resolution one
+     */
+    m_d->projectionBackend = new KisImagePyramid(4);
 
     connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), SLOT(updateSettings()));
 }
@@ -555,9 +555,14 @@ PerformanceTab::PerformanceTab(QWidget *parent, const char *name)
     sliderUndoLimit->setRange(0, 50, 2);
     sliderMemoryLimit->setSingleStep(0.01);
 
+    sliderUndoMemoryLimit->setSuffix(i18n(" %"));
+    sliderUndoMemoryLimit->setRange(0, 100, 2);
+    sliderUndoMemoryLimit->setSingleStep(0.01);
+
     intMemoryLimit->setMinimumWidth(80);
     intPoolLimit->setMinimumWidth(80);
     intUndoLimit->setMinimumWidth(80);
+    intUndoMemoryLimit->setMinimumWidth(80);
 
 
     SliderAndSpinBoxSync *sync1 =
@@ -590,6 +595,17 @@ PerformanceTab::PerformanceTab(QWidget *parent, const char *name)
     sync3->slotParentValueChanged();
     m_syncs << sync3;
 
+    SliderAndSpinBoxSync *sync4 =
+        new SliderAndSpinBoxSync(sliderUndoMemoryLimit,
+                                 intUndoMemoryLimit,
+                                 std::bind(&PerformanceTab::realTilesRAM,
+                                             this));
+
+
+    connect(intPoolLimit, SIGNAL(valueChanged(int)), sync4, SLOT(slotParentValueChanged()));
+    sync4->slotParentValueChanged();
+    m_syncs << sync4;
+
     sliderSwapSize->setSuffix(i18n(" GiB"));
     sliderSwapSize->setRange(1, 64);
     intSwapSize->setRange(1, 64);
@@ -621,9 +637,11 @@ void PerformanceTab::load(bool requestDefault)
     sliderMemoryLimit->setValue(cfg.memoryHardLimitPercent(requestDefault));
     sliderPoolLimit->setValue(cfg.memoryPoolLimitPercent(requestDefault));
     sliderUndoLimit->setValue(cfg.memorySoftLimitPercent(requestDefault));
+    sliderUndoMemoryLimit->setValue(cfg.undoMemoryLimitPercent(requestDefault));
 
     chkPerformanceLogging->setChecked(cfg.enablePerfLog(requestDefault));
     chkProgressReporting->setChecked(cfg.enableProgressReporting(requestDefault));
+    chkCompressUndoHistory->setChecked(cfg.compressUndoHistory(requestDefault));
 
     sliderSwapSize->setValue(cfg.maxSwapSize(requestDefault) / 1024);
     lblSwapFileLocation->setText(cfg.swapDir(requestDefault));
@@ -642,9 +660,11 @@ void PerformanceTab::save()
     cfg.setMemoryHardLimitPercent(sliderMemoryLimit->value());
     cfg.setMemorySoftLimitPercent(sliderUndoLimit->value());
     cfg.setMemoryPoolLimitPercent(sliderPoolLimit->value());
+    cfg.setUndoMemoryLimitPercent(sliderUndoMemoryLimit->value());
 
     cfg.setEnablePerfLog(chkPerformanceLogging->isChecked());
     cfg.setEnableProgressReporting(chkProgressReporting->isChecked());
+    cfg.setCompressUndoHistory(chkCompressUndoHistory->isChecked());
 
     cfg.setMaxSwapSize(sliderSwapSize->value() * 1024);
 
@@ -1015,6 +1035,17 @@ bool KisDlgPreferences::editPreferences()
 
         dialog->m_performanceSettings->save();
 
+        if (part) {
+            // the undo memory limit depends on the memory settings
+            const qint64 undoMemoryLimit = qint64(KisImageConfig().undoMemoryLimit()) << 20;
+
+            Q_FOREACH (QPointer<KisDocument> doc, part->documents()) {
+                if (doc) {
+                    doc->undoStack()->setUndoMemoryLimit(undoMemoryLimit);
+                }
+            }
+        }
+
         if (!cfg.useOpenGL() && dialog->m_displaySettings->grpOpenGL->isChecked())
             cfg.setCanvasState("TRY_OPENGL");
         cfg.setUseOpenGL(dialog->m_displaySettings->grpOpenGL->isChecked());
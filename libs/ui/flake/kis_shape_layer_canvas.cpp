@@ -20,15 +20,18 @@
 
 #include <QPainter>
 #include <QMutexLocker>
+#include <QtConcurrent>
 
 #include <KoShapeManager.h>
 #include <KoViewConverter.h>
 #include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
 
 #include <kis_paint_device.h>
 #include <kis_image.h>
 #include <kis_layer.h>
 #include <kis_painter.h>
+#include <krita_utils.h>
 #include <flake/kis_shape_layer.h>
 #include <KoCompositeOpRegistry.h>
 #include <KoSelection.h>
@@ -103,41 +106,110 @@ void KisShapeLayerCanvas::updateCanvas(const QRectF& rc)
     emit forwardRepaint();
 }
 
+namespace {
+
+/**
+ * Writes one patch of the rendered image into the projection,
+ * converting it into the color space of the layer. The patches are
+ * disjoint, so several of them can be written at the same time.
+ */
+struct PatchWriter {
+    PatchWriter(const QImage &image, const QPoint &imageOffset, KisPaintDeviceSP projection)
+        : m_image(image),
+          m_imageOffset(imageOffset),
+          m_projection(projection)
+    {
+    }
+
+    void operator() (const QRect &rc) {
+        const QImage patch = m_image.copy(rc.translated(-m_imageOffset));
+        const KoColorSpace *dstCS = m_projection->colorSpace();
+
+        // the same shortcut as KisPaintDevice::convertFromQImage() does
+        if (dstCS->id() == "RGBA") {
+            m_projection->writeBytes(patch.constBits(), rc);
+        } else {
+            const int numPixels = rc.width() * rc.height();
+            QVector<quint8> buffer(numPixels * dstCS->pixelSize());
+
+            KoColorSpaceRegistry::instance()->rgb8()->
+                convertPixelsTo(patch.constBits(), buffer.data(), dstCS, numPixels,
+                                KoColorConversionTransformation::internalRenderingIntent(),
+                                KoColorConversionTransformation::internalConversionFlags());
+
+            m_projection->writeBytes(buffer.constData(), rc);
+        }
+    }
+
+private:
+    const QImage &m_image;
+    QPoint m_imageOffset;
+    KisPaintDeviceSP m_projection;
+};
+
+}
+
 void KisShapeLayerCanvas::repaint()
 {
-    QRect r;
+    QRegion region;
 
     {
         QMutexLocker locker(&m_dirtyRegionMutex);
-        r = m_dirtyRegion.boundingRect();
+        region = m_dirtyRegion;
         m_dirtyRegion = QRegion();
     }
 
-    if (r.isEmpty()) return;
+    region &= m_parentLayer->image()->bounds();
+    if (region.isEmpty()) return;
+
+    /**
+     * Keep the dirty region as a set of patches aligned to the update
+     * grid instead of its bounding rect, so that two small shapes in
+     * the opposite corners of the image don't rerender everything in
+     * between. Every grid cell gets a single patch covering all the
+     * dirty rects inside it.
+     */
+    const QSize patchSize = KritaUtils::optimalPatchSize();
+    QMap<QPair<int, int>, QRect> cells;
+
+    Q_FOREACH (const QRect &rc, KritaUtils::splitRegionIntoPatches(region, patchSize)) {
+        cells[qMakePair(rc.y() / patchSize.height(), rc.x() / patchSize.width())] |= rc;
+    }
+
+    QVector<QRect> patches = cells.values().toVector();
 
-    r = r.intersected(m_parentLayer->image()->bounds());
-    QImage image(r.width(), r.height(), QImage::Format_ARGB32);
+    QRegion patchesRegion;
+    Q_FOREACH (const QRect &rc, patches) {
+        patchesRegion += rc;
+    }
+
+    /**
+     * The shapes are not thread-safe: painting them fills their caches
+     * (e.g. the ones of vector and text shapes), so they are painted
+     * here, in the GUI thread, once for all the patches. The clip
+     * region limits the painting to the patches themselves. Only the
+     * color conversion of the patches is done in parallel.
+     */
+    const QRect imageRect = patchesRegion.boundingRect();
+    QImage image(imageRect.width(), imageRect.height(), QImage::Format_ARGB32);
     image.fill(0);
-    QPainter p(&image);
 
+    QPainter p(&image);
     p.setRenderHint(QPainter::Antialiasing);
     p.setRenderHint(QPainter::TextAntialiasing);
-    p.translate(-r.x(), -r.y());
-    p.setClipRect(r);
+    p.translate(-imageRect.x(), -imageRect.y());
+    p.setClipRegion(patchesRegion);
 #ifdef DEBUG_REPAINT
     QColor color = QColor(random() % 255, random() % 255, random() % 255);
-    p.fillRect(r, color);
+    p.fillRect(imageRect, color);
 #endif
 
     m_shapeManager->paint(p, *m_viewConverter, false);
     p.end();
 
-    KisPaintDeviceSP dev = new KisPaintDevice(m_projection->colorSpace());
-    dev->convertFromQImage(image, 0);
-
-    KisPainter::copyAreaOptimized(r.topLeft(), dev, m_projection, QRect(QPoint(), r.size()));
+    QtConcurrent::blockingMap(patches, PatchWriter(image, imageRect.topLeft(), m_projection));
 
-    m_parentLayer->setDirty(r);
+    m_parentLayer->setDirty(patches);
 }
 
 KoToolProxy * KisShapeLayerCanvas::toolProxy() const
@@ -336,6 +336,10 @@ bool KisInputManager::eventFilterImpl(QEvent * event)
         QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
         retval = compressMoveEventCommon(mouseEvent);
 
+        if (d->canvas) {
+            d->canvas->notifyCursorMoved(mouseEvent->localPos());
+        }
+
         break;
     }
     case QEvent::Wheel: {
@@ -440,6 +444,10 @@ bool KisInputManager::eventFilterImpl(QEvent * event)
         QTabletEvent *tabletEvent = static_cast<QTabletEvent*>(event);
         retval = compressMoveEventCommon(tabletEvent);
 
+        if (d->canvas) {
+            d->canvas->notifyCursorMoved(tabletEvent->posF());
+        }
+
         /**
          * The flow of tablet events means the tablet is in the
          * proximity area, so activate it even when the
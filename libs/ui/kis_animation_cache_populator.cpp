@@ -37,6 +37,8 @@
 #include "KisViewManager.h"
 #include "kis_node_manager.h"
 #include "kis_keyframe_channel.h"
+#include "kis_frame_regeneration_engine.h"
+#include "kis_config.h"
 
 
 struct KisAnimationCachePopulator::Private
@@ -62,6 +64,20 @@ struct KisAnimationCachePopulator::Private
 
     QFutureWatcher<void> infoConversionWatcher;
 
+    /**
+     * Frames regenerated concurrently by KisFrameRegenerationEngine
+     * are collected here. When all of them are ready, they are
+     * uploaded into the textures cache in the GUI thread, and then
+     * converted and compressed concurrently again.
+     */
+    QFutureWatcher<void> parallelRegenerationWatcher;
+    QList<QPair<int, KisPaintDeviceSP>> parallelProjections;
+
+    QFutureWatcher<void> parallelConversionWatcher;
+    QList<KisOpenGLUpdateInfoSP> parallelInfos;
+    QList<int> parallelInfoFrames;
+
+    bool parallelFramesInvalidated;
 
 
     enum State {
@@ -80,16 +96,21 @@ struct KisAnimationCachePopulator::Private
           part(_part),
           idleCounter(0),
           requestedFrame(-1),
+          parallelFramesInvalidated(false),
           state(WaitingForIdle)
     {
         timer.setSingleShot(true);
         connect(&infoConversionWatcher, SIGNAL(finished()), q, SLOT(slotInfoConverted()));
+        connect(&parallelRegenerationWatcher, SIGNAL(finished()), q, SLOT(slotParallelFramesRegenerated()));
+        connect(&parallelConversionWatcher, SIGNAL(finished()), q, SLOT(slotParallelFramesConverted()));
     }
 
     static void processFrameInfo(KisOpenGLUpdateInfoSP info) {
         if (info->needsConversion()) {
             info->convertColorSpace();
         }
+
+        KisAnimationFrameCache::compressFrameData(info);
     }
 
     void frameReceived(int frame)
@@ -229,25 +250,171 @@ struct KisAnimationCachePopulator::Private
 
             // TODO: optimize check for fully-cached case
 
-            for (int frame = currentRange.start(); frame <= currentRange.end(); frame++) {
-                if (skipRange.contains(frame)) {
-                    if (skipRange.isInfinite()) {
+            /**
+             * Regenerate the frames in the order the playback is going
+             * to reach them, so that when the memory budget of the cache
+             * is exhausted, it is filled with the frames needed first.
+             */
+            const int length = currentRange.end() - currentRange.start() + 1;
+            const int playhead =
+                qBound(currentRange.start(), animation->currentUITime(), currentRange.end());
+
+            KisConfig cfg;
+            const int maxFramesInBatch = cfg.maxNumberOfThreads();
+
+            QList<int> uncachedFrames;
+            QList<KisTimeRange> coveredRanges;
+
+            for (int i = 0; i < length; i++) {
+                const int frame =
+                    currentRange.start() + (playhead - currentRange.start() + i) % length;
+
+                if (skipRange.contains(frame)) continue;
+
+                bool isCovered = false;
+                Q_FOREACH (const KisTimeRange &range, coveredRanges) {
+                    if (range.contains(frame)) {
+                        isCovered = true;
                         break;
-                    } else {
-                        frame = skipRange.end();
-                        continue;
                     }
                 }
+                if (isCovered) continue;
 
                 if (cache->frameStatus(frame) != KisAnimationFrameCache::Cached) {
-                    return regenerate(cache, frame);
+                    if (!cache->frameFitsIntoCache(frame)) break;
+
+                    uncachedFrames << frame;
+                    if (uncachedFrames.size() >= maxFramesInBatch) break;
+
+                    /**
+                     * The frames identical to this one will be cached
+                     * along with it, don't render them twice
+                     */
+                    KisTimeRange identicalRange = KisTimeRange::infinite(0);
+                    KisTimeRange::calculateTimeRangeRecursive(image->root(), frame, identicalRange, true);
+                    coveredRanges << identicalRange;
                 }
             }
+
+            if (uncachedFrames.size() > 1 &&
+                KisFrameRegenerationEngine::canRegenerateFrames(image)) {
+
+                return regenerateConcurrently(cache, uncachedFrames);
+            }
+
+            if (!uncachedFrames.isEmpty()) {
+                return regenerate(cache, uncachedFrames.first());
+            }
         }
 
         return false;
     }
 
+    bool regenerateConcurrently(KisAnimationFrameCacheSP cache, const QList<int> &frames)
+    {
+        if (state == WaitingForFrame || state == WaitingForConvertedFrame) {
+            // Already busy, deny request
+            return false;
+        }
+
+        KIS_ASSERT_RECOVER_NOOP(QThread::currentThread() == q->thread());
+
+        KisConfig cfg;
+        QSharedPointer<KisFrameRegenerationEngine> engine(
+            new KisFrameRegenerationEngine(cache->image(), frames,
+                                           cfg.maxNumberOfThreads(),
+                                           qint64(cfg.frameRegenerationMemoryLimit()) * 1024 * 1024));
+
+        requestCache = cache;
+        parallelProjections.clear();
+        parallelFramesInvalidated = false;
+
+        /**
+         * The frames are rendered outside the strokes system, so the
+         * user may change the image while they are in progress. The
+         * cache notifies us about it and the results are dropped.
+         */
+        imageRequestConnections.clear();
+        imageRequestConnections.addConnection(
+            cache.data(), SIGNAL(changed()),
+            q, SLOT(slotParallelFramesInvalidated()));
+
+        enterState(WaitingForConvertedFrame);
+
+        QFuture<void> future =
+            QtConcurrent::run(
+                std::bind(&KisAnimationCachePopulator::Private::processFramesConcurrently,
+                          this, engine));
+
+        parallelRegenerationWatcher.setFuture(future);
+
+        return true;
+    }
+
+    void processFramesConcurrently(QSharedPointer<KisFrameRegenerationEngine> engine)
+    {
+        engine->regenerateFrames(
+            [this] (int time, KisPaintDeviceSP projection) {
+                QMutexLocker l(&mutex);
+                parallelProjections.append(qMakePair(time, projection));
+            });
+    }
+
+    void parallelFramesRegenerated()
+    {
+        KIS_ASSERT_RECOVER(requestCache) {
+            imageRequestConnections.clear();
+            enterState(WaitingForIdle);
+            return;
+        }
+
+        parallelInfos.clear();
+        parallelInfoFrames.clear();
+
+        if (!parallelFramesInvalidated) {
+            /**
+             * The textures object shares its channel flags and
+             * proofing state with the canvas, so the tiles are
+             * fetched in the GUI thread only. They are converted
+             * into the display color space in processFrameInfo().
+             */
+            typedef QPair<int, KisPaintDeviceSP> FrameProjectionPair;
+            Q_FOREACH (const FrameProjectionPair &frame, parallelProjections) {
+                parallelInfos << requestCache->fetchFrameData(frame.first, frame.second);
+                parallelInfoFrames << frame.first;
+            }
+        }
+
+        parallelProjections.clear();
+
+        QFuture<void> future =
+            QtConcurrent::map(parallelInfos,
+                              &KisAnimationCachePopulator::Private::processFrameInfo);
+
+        parallelConversionWatcher.setFuture(future);
+    }
+
+    void parallelFramesConverted()
+    {
+        imageRequestConnections.clear();
+
+        KIS_ASSERT_RECOVER(requestCache) {
+            enterState(WaitingForIdle);
+            return;
+        }
+
+        if (!parallelFramesInvalidated) {
+            for (int i = 0; i < parallelInfos.size(); i++) {
+                requestCache->addConvertedFrameData(parallelInfos[i], parallelInfoFrames[i]);
+            }
+        }
+
+        parallelInfos.clear();
+        parallelInfoFrames.clear();
+        requestCache = 0;
+        enterState(BetweenFrames);
+    }
+
     bool regenerate(KisAnimationFrameCacheSP cache, int frame)
     {
         if (state == WaitingForFrame || state == WaitingForConvertedFrame) {
@@ -383,6 +550,21 @@ void KisAnimationCachePopulator::slotInfoConverted()
     m_d->infoConverted();
 }
 
+void KisAnimationCachePopulator::slotParallelFramesRegenerated()
+{
+    m_d->parallelFramesRegenerated();
+}
+
+void KisAnimationCachePopulator::slotParallelFramesConverted()
+{
+    m_d->parallelFramesConverted();
+}
+
+void KisAnimationCachePopulator::slotParallelFramesInvalidated()
+{
+    m_d->parallelFramesInvalidated = true;
+}
+
 void KisAnimationCachePopulator::slotRequestRegeneration()
 {
     m_d->enterState(Private::WaitingForIdle);
@@ -52,6 +52,9 @@ private Q_SLOTS:
     void slotFrameReady(int frame);
     void slotFrameCancelled();
     void slotInfoConverted();
+    void slotParallelFramesRegenerated();
+    void slotParallelFramesConverted();
+    void slotParallelFramesInvalidated();
 
     void slotPrivateStartWaitingForConvertedFrame();
 
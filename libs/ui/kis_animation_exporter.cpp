@@ -22,6 +22,9 @@
 #include <QProgressDialog>
 #include <KisMimeDatabase.h>
 #include <QEventLoop>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QtConcurrent>
 
 #include "KoFileDialog.h"
 #include "KisDocument.h"
@@ -35,6 +38,8 @@
 #include "kis_group_layer.h"
 #include "kis_time_range.h"
 #include "kis_painter.h"
+#include "kis_config.h"
+#include "kis_frame_regeneration_engine.h"
 
 #include "kis_image_lock_hijacker.h"
 
@@ -115,8 +120,79 @@ struct KisAnimationExporter::Private
 
     KisPropertiesConfigurationSP exportConfiguration;
 
+    KisImportExportFilter::ConversionStatus exportFramesConcurrently();
 };
 
+/**
+ * When the layer stack is simple enough, the frames are rendered by
+ * KisFrameRegenerationEngine in batches, without switching the image
+ * time. The frames of a batch are rendered concurrently, and then
+ * saved in order in the GUI thread. The size of a batch is limited
+ * by the number of threads, so that no more than that many rendered
+ * frames wait for being saved at any moment.
+ */
+KisImportExportFilter::ConversionStatus KisAnimationExporter::Private::exportFramesConcurrently()
+{
+    KIS_ASSERT_RECOVER_RETURN_VALUE(saveFrameCallback, KisImportExportFilter::InternalError);
+
+    KisConfig cfg;
+    const int maxThreads = cfg.maxNumberOfThreads();
+    const qint64 memoryLimit = qint64(cfg.frameRegenerationMemoryLimit()) * 1024 * 1024;
+
+    KisImportExportFilter::ConversionStatus result = KisImportExportFilter::OK;
+
+    for (int batchStart = firstFrame;
+         batchStart <= lastFrame && result == KisImportExportFilter::OK;
+         batchStart += maxThreads) {
+
+        QList<int> frames;
+        for (int time = batchStart; time <= lastFrame && frames.size() < maxThreads; time++) {
+            frames << time;
+        }
+
+        KisFrameRegenerationEngine engine(image, frames, maxThreads, memoryLimit);
+
+        QMutex renderedFramesLock;
+        QMap<int, KisPaintDeviceSP> renderedFrames;
+
+        QFutureWatcher<void> watcher;
+        QEventLoop loop;
+        loop.connect(&watcher, SIGNAL(finished()), SLOT(quit()));
+
+        watcher.setFuture(QtConcurrent::run([&engine, &renderedFrames, &renderedFramesLock] () {
+            engine.regenerateFrames(
+                [&renderedFrames, &renderedFramesLock] (int time, KisPaintDeviceSP projection) {
+                    QMutexLocker l(&renderedFramesLock);
+                    renderedFrames.insert(time, projection);
+                });
+        }));
+
+        loop.exec();
+
+        Q_FOREACH (int time, frames) {
+            if (isCancelled) {
+                result = KisImportExportFilter::UserCancelled;
+                break;
+            }
+
+            KIS_ASSERT_RECOVER(renderedFrames.contains(time)) {
+                result = KisImportExportFilter::InternalError;
+                break;
+            }
+
+            result = saveFrameCallback(time, renderedFrames.take(time), exportConfiguration);
+            if (result != KisImportExportFilter::OK) break;
+
+            if (!batchMode) {
+                emit document->sigProgress((time - firstFrame) * 100 /
+                                           qMax(1, lastFrame - firstFrame));
+            }
+        }
+    }
+
+    return result;
+}
+
 KisAnimationExporter::KisAnimationExporter(KisDocument *document, int fromTime, int toTime)
     : m_d(new Private(document, fromTime, toTime))
 {
@@ -172,12 +248,17 @@ KisImportExportFilter::ConversionStatus KisAnimationExporter::exportAnimation()
     KIS_ASSERT_RECOVER(!m_d->image->locked()) { return KisImportExportFilter::InternalError; }
 
     m_d->status = KisImportExportFilter::OK;
-    m_d->currentFrame = m_d->firstFrame;
-    m_d->image->animationInterface()->requestFrameRegeneration(m_d->currentFrame, m_d->image->bounds());
 
-    QEventLoop loop;
-    loop.connect(this, SIGNAL(sigFinished()), SLOT(quit()));
-    loop.exec();
+    if (KisFrameRegenerationEngine::canRegenerateFrames(m_d->image)) {
+        m_d->status = m_d->exportFramesConcurrently();
+    } else {
+        m_d->currentFrame = m_d->firstFrame;
+        m_d->image->animationInterface()->requestFrameRegeneration(m_d->currentFrame, m_d->image->bounds());
+
+        QEventLoop loop;
+        loop.connect(this, SIGNAL(sigFinished()), SLOT(quit()));
+        loop.exec();
+    }
 
     if (!m_d->batchMode) {
         disconnect(m_d->document, SIGNAL(sigProgressCanceled()), this, SLOT(cancel()));
@@ -18,7 +18,11 @@
 
 #include "kis_animation_frame_cache.h"
 
+#include <limits>
+
 #include <QMap>
+#include <QSet>
+#include <QtConcurrent>
 
 #include "kis_debug.h"
 
@@ -27,38 +31,101 @@
 #include "kis_time_range.h"
 #include "KisPart.h"
 #include "kis_animation_cache_populator.h"
+#include "kis_config.h"
+#include "kis_memory_statistics_server.h"
+#include "tiles3/swap/kis_lzf_compression.h"
 
 #include "opengl/kis_opengl_image_textures.h"
 
+namespace {
+
+struct TileCompressor {
+    inline void operator() (KisTextureTileUpdateInfoSP &tile) {
+        KisLzfCompression compression;
+        tile->compressData(&compression);
+    }
+};
+
+struct TileDecompressor {
+    inline void operator() (KisTextureTileUpdateInfoSP &tile) {
+        KisLzfCompression compression;
+        tile = tile->decompressedCopy(&compression);
+    }
+};
+
+}
 
 struct KisAnimationFrameCache::Private
 {
     Private(KisOpenGLImageTexturesSP _textures)
-        : textures(_textures)
+        : textures(_textures),
+          accessCounter(0),
+          memoryUsage(0),
+          uncompressedMemoryUsage(0)
     {
         image = textures->image();
+
+        KisConfig cfg;
+        memoryLimit = qint64(cfg.frameCacheMemoryLimit()) * 1024 * 1024;
     }
 
     ~Private()
     {
         qDeleteAll(frames);
+
+        KisMemoryStatisticsServer *server = KisMemoryStatisticsServer::instance();
+        if (server) {
+            server->notifyFrameCacheMemoryChanged(-memoryUsage, -uncompressedMemoryUsage);
+        }
     }
 
     KisOpenGLImageTexturesSP textures;
     KisImageWSP image;
 
+    /**
+     * The pixel data of a regenerated frame. When the image doesn't
+     * change over several frames, the data is shared between all of
+     * them, therefore it is stored separately from the Frame objects.
+     */
+    struct FrameData
+    {
+        FrameData(KisOpenGLUpdateInfoSP _info)
+            : info(_info),
+              memorySize(0),
+              uncompressedMemorySize(0),
+              lastAccess(0)
+        {
+            Q_FOREACH (KisTextureTileUpdateInfoSP tile, info->tileList) {
+                memorySize += tile->memoryFootprint();
+                uncompressedMemorySize += tile->uncompressedMemoryFootprint();
+            }
+        }
+
+        KisOpenGLUpdateInfoSP info;
+        qint64 memorySize;
+        qint64 uncompressedMemorySize;
+        quint64 lastAccess;
+    };
+
+    typedef QSharedPointer<FrameData> FrameDataSP;
+
     struct Frame
     {
-        KisOpenGLUpdateInfoSP openGlFrame;
+        FrameDataSP data;
         int length;
 
-        Frame(KisOpenGLUpdateInfoSP info, int length)
-            : openGlFrame(info), length(length)
+        Frame(FrameDataSP data, int length)
+            : data(data), length(length)
         {}
     };
 
     QMap<int, Frame*> frames;
 
+    quint64 accessCounter;
+    qint64 memoryLimit;
+    qint64 memoryUsage;
+    qint64 uncompressedMemoryUsage;
+
     Frame *getFrame(int time)
     {
         if (frames.isEmpty()) return 0;
@@ -86,9 +153,14 @@ struct KisAnimationFrameCache::Private
         invalidate(range);
 
         int length = range.isInfinite() ? -1 : range.end() - range.start() + 1;
-        Frame *frame = new Frame(info, length);
+        FrameDataSP data(new FrameData(info));
+        data->lastAccess = ++accessCounter;
+
+        Frame *frame = new Frame(data, length);
 
         frames.insert(range.start(), frame);
+        updateMemoryUsage();
+        fitIntoMemoryLimit(range.start());
     }
 
     /**
@@ -121,7 +193,7 @@ struct KisAnimationFrameCache::Private
                     // Reinsert with a later start
                     int newStart = range.end() + 1;
                     int newLength = frameIsInfinite ? -1 : (end - newStart + 1);
-                    frames.insert(newStart, new Frame(frame->openGlFrame, newLength));
+                    frames.insert(newStart, new Frame(frame->data, newLength));
                 }
 
                 it = frames.erase(it);
@@ -140,9 +212,185 @@ struct KisAnimationFrameCache::Private
             it++;
         }
 
+        if (cacheChanged) {
+            updateMemoryUsage();
+        }
+
         return cacheChanged;
     }
 
+    /**
+     * Recalculates the amount of memory occupied by the cache and
+     * reports the change to the memory statistics server
+     */
+    void updateMemoryUsage()
+    {
+        QSet<FrameData*> uniqueData;
+
+        qint64 newMemoryUsage = 0;
+        qint64 newUncompressedMemoryUsage = 0;
+
+        Q_FOREACH (Frame *frame, frames) {
+            if (uniqueData.contains(frame->data.data())) continue;
+            uniqueData.insert(frame->data.data());
+
+            newMemoryUsage += frame->data->memorySize;
+            newUncompressedMemoryUsage += frame->data->uncompressedMemorySize;
+        }
+
+        if (newMemoryUsage != memoryUsage ||
+            newUncompressedMemoryUsage != uncompressedMemoryUsage) {
+
+            KisMemoryStatisticsServer::instance()->
+                notifyFrameCacheMemoryChanged(newMemoryUsage - memoryUsage,
+                                              newUncompressedMemoryUsage - uncompressedMemoryUsage);
+
+            memoryUsage = newMemoryUsage;
+            uncompressedMemoryUsage = newUncompressedMemoryUsage;
+        }
+    }
+
+    /**
+     * The number of frames the playback should pass before it reaches
+     * \p time. Frames outside the clip range will never be reached, so
+     * they are the first candidates for eviction.
+     */
+    int playbackDistance(int time) const
+    {
+        KisImageAnimationInterface *animation = image->animationInterface();
+        const KisTimeRange &clipRange = animation->fullClipRange();
+        const int playhead = animation->currentUITime();
+
+        if (!clipRange.isValid() || clipRange.isInfinite()) {
+            return qAbs(time - playhead);
+        }
+
+        if (!clipRange.contains(time)) {
+            return std::numeric_limits<int>::max();
+        }
+
+        return time >= playhead ?
+            time - playhead :
+            clipRange.end() - playhead + 1 + time - clipRange.start();
+    }
+
+    int playbackDistance(int start, const Frame *frame) const
+    {
+        const int end = frame->length < 0 ?
+            std::numeric_limits<int>::max() : start + frame->length - 1;
+
+        const int playhead = image->animationInterface()->currentUITime();
+
+        if (start <= playhead && playhead <= end) return 0;
+
+        const KisTimeRange &clipRange = image->animationInterface()->fullClipRange();
+        if (clipRange.isValid() && start < clipRange.start() && end >= clipRange.start()) {
+            return playbackDistance(clipRange.start());
+        }
+
+        return playbackDistance(start);
+    }
+
+    /**
+     * Drops the frames which are the farthest from the playhead
+     * (the least recently used ones first) until the cache fits into
+     * the memory budget. The frame at \p protectedTime is never
+     * dropped, otherwise the frame we have just regenerated could
+     * be evicted immediately.
+     */
+    void fitIntoMemoryLimit(int protectedTime)
+    {
+        int numEvicted = 0;
+
+        while (memoryUsage > memoryLimit) {
+            Frame *protectedFrame = getFrame(protectedTime);
+
+            FrameData *victim = 0;
+            int victimDistance = -1;
+
+            for (QMap<int, Frame*>::const_iterator it = frames.constBegin();
+                 it != frames.constEnd(); ++it) {
+
+                FrameData *data = it.value()->data.data();
+                if (protectedFrame && data == protectedFrame->data.data()) continue;
+
+                const int distance = playbackDistance(it.key(), it.value());
+
+                if (!victim || distance > victimDistance ||
+                    (distance == victimDistance && data->lastAccess < victim->lastAccess)) {
+
+                    victim = data;
+                    victimDistance = distance;
+                }
+            }
+
+            if (!victim) break;
+
+            QMap<int, Frame*>::iterator it = frames.begin();
+            while (it != frames.end()) {
+                if (it.value()->data.data() == victim) {
+                    delete it.value();
+                    it = frames.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            numEvicted++;
+            updateMemoryUsage();
+        }
+
+        if (numEvicted) {
+            KisMemoryStatisticsServer::instance()->notifyFrameCacheEviction(numEvicted);
+        }
+    }
+
+    /**
+     * Checks if the frame at \p time, when regenerated, would stay in
+     * the cache, i.e. if there is free space for it or if it is closer
+     * to the playhead than some other cached frame.
+     */
+    bool frameFitsIntoCache(int time)
+    {
+        if (frames.isEmpty()) return true;
+
+        const qint64 averageFrameSize = memoryUsage / frames.size();
+        if (memoryUsage + averageFrameSize <= memoryLimit) return true;
+
+        const int distance = playbackDistance(time);
+
+        for (QMap<int, Frame*>::const_iterator it = frames.constBegin();
+             it != frames.constEnd(); ++it) {
+
+            if (playbackDistance(it.key(), it.value()) > distance) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    KisOpenGLUpdateInfoSP uploadableFrameInfo(FrameDataSP data)
+    {
+        data->lastAccess = ++accessCounter;
+
+        if (data->info->tileList.isEmpty() ||
+            !data->info->tileList.first()->isCompressed()) {
+
+            return data->info;
+        }
+
+        KisOpenGLUpdateInfoSP info = new KisOpenGLUpdateInfo(ConversionOptions());
+        info->assignDirtyImageRect(data->info->dirtyImageRect());
+        info->assignLevelOfDetail(data->info->levelOfDetail());
+        info->tileList = data->info->tileList;
+
+        TileDecompressor decompressor;
+        QtConcurrent::blockingMap(info->tileList, decompressor);
+
+        return info;
+    }
+
     // TODO: verify that we don't have any leak here!
     typedef QMap<KisOpenGLImageTexturesSP, KisAnimationFrameCache*> CachesMap;
     static CachesMap caches;
@@ -188,7 +436,7 @@ bool KisAnimationFrameCache::uploadFrame(int time)
     if (!frame) {
         KisPart::instance()->cachePopulator()->regenerate(this, time);
     } else {
-        m_d->textures->recalculateCache(frame->openGlFrame);
+        m_d->textures->recalculateCache(m_d->uploadableFrameInfo(frame->data));
     }
 
     return frame != 0;
@@ -200,6 +448,22 @@ KisAnimationFrameCache::CacheStatus KisAnimationFrameCache::frameStatus(int time
     return (frame) ? Cached : Uncached;
 }
 
+bool KisAnimationFrameCache::frameFitsIntoCache(int time) const
+{
+    return m_d->frameFitsIntoCache(time);
+}
+
+qint64 KisAnimationFrameCache::memoryUsage() const
+{
+    return m_d->memoryUsage;
+}
+
+void KisAnimationFrameCache::testingSetMemoryLimit(qint64 bytes)
+{
+    m_d->memoryLimit = bytes;
+    m_d->fitIntoMemoryLimit(m_d->image->animationInterface()->currentUITime());
+}
+
 KisImageWSP KisAnimationFrameCache::image()
 {
     return m_d->image;
@@ -228,6 +492,12 @@ KisOpenGLUpdateInfoSP KisAnimationFrameCache::fetchFrameData(int time) const
     return m_d->textures->updateCache(m_d->image->bounds());
 }
 
+KisOpenGLUpdateInfoSP KisAnimationFrameCache::fetchFrameData(int time, KisPaintDeviceSP projection) const
+{
+    Q_UNUSED(time);
+    return m_d->textures->updateCacheNoConversion(m_d->image->bounds(), projection);
+}
+
 void KisAnimationFrameCache::addConvertedFrameData(KisOpenGLUpdateInfoSP info, int time)
 {
     KisTimeRange identicalRange = KisTimeRange::infinite(0);
@@ -237,3 +507,12 @@ void KisAnimationFrameCache::addConvertedFrameData(KisOpenGLUpdateInfoSP info, i
 
     emit changed();
 }
+
+void KisAnimationFrameCache::compressFrameData(KisOpenGLUpdateInfoSP info)
+{
+    KisConfig cfg;
+    if (!cfg.frameCacheCompression()) return;
+
+    TileCompressor compressor;
+    QtConcurrent::blockingMap(info->tileList, compressor);
+}
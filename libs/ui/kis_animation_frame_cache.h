@@ -58,11 +58,47 @@ public:
 
     CacheStatus frameStatus(int time) const;
 
+    /**
+     * \return true if the frame at \p time would be kept in the cache
+     * after regeneration, that is, the memory budget is not yet filled
+     * with frames closer to the playhead.
+     */
+    bool frameFitsIntoCache(int time) const;
+
+    /**
+     * \return the amount of memory occupied by the cached frames
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * Overrides the memory budget read from the config and evicts
+     * the frames that don't fit into it anymore. Used in tests only.
+     */
+    void testingSetMemoryLimit(qint64 bytes);
+
     KisImageWSP image();
 
     KisOpenGLUpdateInfoSP fetchFrameData(int time) const;
+
+    /**
+     * Prepares the data of a frame rendered into a private \p projection
+     * by KisFrameRegenerationEngine. In contrast to the overload above,
+     * it doesn't require the image to be switched to \p time.
+     *
+     * The pixels are not converted into the display color space, the
+     * caller should call convertColorSpace() on the returned info
+     * (in a background thread) before adding it to the cache.
+     */
+    KisOpenGLUpdateInfoSP fetchFrameData(int time, KisPaintDeviceSP projection) const;
     void addConvertedFrameData(KisOpenGLUpdateInfoSP info, int time);
 
+    /**
+     * Compresses the pixel data of a regenerated frame before it is
+     * added to the cache. The call is heavy, so it should be done in
+     * a background thread, along with the color conversion of the frame.
+     */
+    static void compressFrameData(KisOpenGLUpdateInfoSP info);
+
 Q_SIGNALS:
     void changed();
 
@@ -1644,6 +1644,36 @@ bool KisConfig::animationDropFrames(bool defaultValue) const
     return (defaultValue ? true : m_cfg.readEntry("animationDropFrames", true));
 }
 
+int KisConfig::frameCacheMemoryLimit(bool defaultValue) const
+{
+    return (defaultValue ? 2048 : m_cfg.readEntry("frameCacheMemoryLimit", 2048));
+}
+
+void KisConfig::setFrameCacheMemoryLimit(int value)
+{
+    m_cfg.writeEntry("frameCacheMemoryLimit", value);
+}
+
+bool KisConfig::frameCacheCompression(bool defaultValue) const
+{
+    return (defaultValue ? true : m_cfg.readEntry("frameCacheCompression", true));
+}
+
+void KisConfig::setFrameCacheCompression(bool value)
+{
+    m_cfg.writeEntry("frameCacheCompression", value);
+}
+
+int KisConfig::frameRegenerationMemoryLimit(bool defaultValue) const
+{
+    return (defaultValue ? 1024 : m_cfg.readEntry("frameRegenerationMemoryLimit", 1024));
+}
+
+void KisConfig::setFrameRegenerationMemoryLimit(int value)
+{
+    m_cfg.writeEntry("frameRegenerationMemoryLimit", value);
+}
+
 int KisConfig::scribbingUpdatesDelay(bool defaultValue) const
 {
     return (defaultValue ? 30 : m_cfg.readEntry("scribbingUpdatesDelay", 30));
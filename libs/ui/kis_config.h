@@ -467,6 +467,23 @@ public:
     bool animationDropFrames(bool defaultValue = false) const;
     void setAnimationDropFrames(bool value);
 
+    /**
+     * Memory budget of the animation playback cache of a single
+     * image, in MiB
+     */
+    int frameCacheMemoryLimit(bool defaultValue = false) const;
+    void setFrameCacheMemoryLimit(int value);
+
+    bool frameCacheCompression(bool defaultValue = false) const;
+    void setFrameCacheCompression(bool value);
+
+    /**
+     * Memory budget for the projections of the animation frames
+     * regenerated concurrently in the background, in MiB
+     */
+    int frameRegenerationMemoryLimit(bool defaultValue = false) const;
+    void setFrameRegenerationMemoryLimit(int value);
+
     int scribbingUpdatesDelay(bool defaultValue = false) const;
     void setScribbingUpdatesDelay(int value);
 
@@ -65,6 +65,7 @@
 #include <KoColorModelStandardIds.h>
 #include "dialogs/kis_dlg_png_import.h"
 #include "kis_clipboard.h"
+#include "kis_png_idat_encoder.h"
 
 namespace
 {
@@ -833,6 +834,25 @@ KisImageWSP KisPNGConverter::image()
     return m_image;
 }
 
+bool KisPNGConverter::saveDeviceToIODevice(QIODevice *io, const QRect &imageRect, const qreal xRes, const qreal yRes, KisPaintDeviceSP dev, KisMetaData::Store* metaData)
+{
+    KisPNGConverter pngconv(0);
+    vKisAnnotationSP_it annotIt = 0;
+    KisMetaData::Store* metaDataStore = 0;
+    if (metaData) {
+        metaDataStore = new KisMetaData::Store(*metaData);
+    }
+    KisPNGOptions options;
+    options.compression = 0;
+    options.interlace = false;
+    options.tryToSaveAsIndexed = false;
+    options.alpha = true;
+    KisImageBuilder_Result result = pngconv.buildFile(io, imageRect, xRes, yRes, dev, annotIt, annotIt, options, metaDataStore);
+    delete metaDataStore;
+
+    return result == KisImageBuilder_RESULT_OK;
+}
+
 bool KisPNGConverter::saveDeviceToStore(const QString &filename, const QRect &imageRect, const qreal xRes, const qreal yRes, KisPaintDeviceSP dev, KoStore *store, KisMetaData::Store* metaData)
 {
     if (store->open(filename)) {
@@ -841,24 +861,10 @@ bool KisPNGConverter::saveDeviceToStore(const QString &filename, const QRect &im
             dbgFile << "Could not open for writing:" << filename;
             return false;
         }
-        KisPNGConverter pngconv(0);
-        vKisAnnotationSP_it annotIt = 0;
-        KisMetaData::Store* metaDataStore = 0;
-        if (metaData) {
-            metaDataStore = new KisMetaData::Store(*metaData);
-        }
-        KisPNGOptions options;
-        options.compression = 0;
-        options.interlace = false;
-        options.tryToSaveAsIndexed = false;
-        options.alpha = true;
-        bool success = pngconv.buildFile(&io, imageRect, xRes, yRes, dev, annotIt, annotIt, options, metaDataStore);
-        if (success != KisImageBuilder_RESULT_OK) {
+        if (!saveDeviceToIODevice(&io, imageRect, xRes, yRes, dev, metaData)) {
             dbgFile << "Saving PNG failed:" << filename;
-            delete metaDataStore;
             return false;
         }
-        delete metaDataStore;
         io.close();
         if (!store->close()) {
             return false;
@@ -871,6 +877,17 @@ bool KisPNGConverter::saveDeviceToStore(const QString &filename, const QRect &im
 
 }
 
+bool KisPNGConverter::saveDeviceToBuffer(QByteArray *data, const QRect &imageRect, const qreal xRes, const qreal yRes, KisPaintDeviceSP dev, KisMetaData::Store* metaData)
+{
+    QBuffer buffer(data);
+    if (!saveDeviceToIODevice(&buffer, imageRect, xRes, yRes, dev, metaData)) {
+        dbgFile << "Saving PNG to a buffer failed";
+        data->clear();
+        return false;
+    }
+    return true;
+}
+
 
 KisImageBuilder_Result KisPNGConverter::buildFile(const QString &filename, const QRect &imageRect, const qreal xRes, const qreal yRes, KisPaintDeviceSP device, vKisAnnotationSP_it annotationsStart, vKisAnnotationSP_it annotationsEnd, KisPNGOptions options, KisMetaData::Store* metaData)
 {
@@ -1228,10 +1245,47 @@ KisImageBuilder_Result KisPNGConverter::buildFile(QIODevice* iodevice, const QRe
         }
     }
 
-    png_write_image(png_ptr, row_pointers);
+    if (interlacetype == PNG_INTERLACE_NONE) {
+        /**
+         * libpng filters and deflates the rows in a single thread, so
+         * we encode the IDAT chunks ourselves with all the cores.
+         */
+        const int bitsPerPixel = png_get_channels(png_ptr, info_ptr) * color_nb_bits;
+        KisPNGIDATEncoder encoder(row_pointers, imageRect.height(),
+                                  png_get_rowbytes(png_ptr, info_ptr),
+                                  qMax(1, bitsPerPixel / 8),
+                                  options.compression);
+
+        encoder.setUseFilters(color_type != PNG_COLOR_TYPE_PALETTE && color_nb_bits >= 8);
+#ifndef WORDS_BIGENDIAN
+        encoder.setSwapBytes16(color_nb_bits > 8);
+#endif
+
+        QByteArray chunk;
+        while (!(chunk = encoder.nextChunk()).isEmpty()) {
+            png_write_chunk(png_ptr, (png_bytep)"IDAT", (png_bytep)chunk.constData(), chunk.size());
+        }
 
-    // Writing is over
-    png_write_end(png_ptr, info_ptr);
+        if (encoder.failed()) {
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            for (int y = 0; y < imageRect.height(); y++) {
+                delete[] row_pointers[y];
+            }
+            delete[] row_pointers;
+            if (color_type == PNG_COLOR_TYPE_PALETTE) {
+                delete [] palette;
+            }
+            return KisImageBuilder_RESULT_FAILURE;
+        }
+
+        // png_write_end() refuses to work without png_write_image()
+        png_write_chunk(png_ptr, (png_bytep)"IEND", 0, 0);
+    } else {
+        png_write_image(png_ptr, row_pointers);
+
+        // Writing is over
+        png_write_end(png_ptr, info_ptr);
+    }
 
     // Free memory
     png_destroy_write_struct(&png_ptr, &info_ptr);
@@ -116,11 +116,19 @@ public:
 
     static bool saveDeviceToStore(const QString &filename, const QRect &imageRect, const qreal xRes, const qreal yRes, KisPaintDeviceSP dev, KoStore *store, KisMetaData::Store* metaData = 0);
 
+    /**
+     * Encodes \p dev the same way as saveDeviceToStore() does, but into
+     * \p data. It doesn't touch the document, so it can be used in a
+     * background thread while the store is busy with something else.
+     */
+    static bool saveDeviceToBuffer(QByteArray *data, const QRect &imageRect, const qreal xRes, const qreal yRes, KisPaintDeviceSP dev, KisMetaData::Store* metaData = 0);
+
     static bool isColorSpaceSupported(const KoColorSpace *cs);
 
 public Q_SLOTS:
     virtual void cancel();
 private:
+    static bool saveDeviceToIODevice(QIODevice *io, const QRect &imageRect, const qreal xRes, const qreal yRes, KisPaintDeviceSP dev, KisMetaData::Store* metaData);
     void progress(png_structp png_ptr, png_uint_32 row_number, int pass);
 private:
     png_uint_32 m_max_row;
@@ -0,0 +1,468 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_png_idat_encoder.h"
+
+#include <string.h>
+#include <zlib.h>
+
+#include <QVector>
+#include <QThread>
+#include <QtConcurrent>
+
+#include "kis_assert.h"
+#include "kis_debug.h"
+
+
+namespace {
+
+/**
+ * The size of the deflate window. Every block is primed with that
+ * much filtered data of the preceding one.
+ */
+const int dictionarySize = 32768;
+
+enum FilterType {
+    FilterNone = 0,
+    FilterSub,
+    FilterUp,
+    FilterAverage,
+    FilterPaeth,
+    NumFilters
+};
+
+/**
+ * The filters read only the unfiltered rows, so the loops have no
+ * dependencies between iterations and are vectorized by the compiler.
+ */
+
+inline void filterSub(const quint8 *raw, quint8 *dst, int size, int bpp)
+{
+    for (int i = 0; i < bpp; i++) {
+        dst[i] = raw[i];
+    }
+    for (int i = bpp; i < size; i++) {
+        dst[i] = raw[i] - raw[i - bpp];
+    }
+}
+
+inline void filterUp(const quint8 *raw, const quint8 *prior, quint8 *dst, int size)
+{
+    for (int i = 0; i < size; i++) {
+        dst[i] = raw[i] - prior[i];
+    }
+}
+
+inline void filterAverage(const quint8 *raw, const quint8 *prior, quint8 *dst, int size, int bpp)
+{
+    for (int i = 0; i < bpp; i++) {
+        dst[i] = raw[i] - (prior[i] >> 1);
+    }
+    for (int i = bpp; i < size; i++) {
+        dst[i] = raw[i] - ((raw[i - bpp] + prior[i]) >> 1);
+    }
+}
+
+inline quint8 paethPredictor(int a, int b, int c)
+{
+    const int pa = qAbs(b - c);
+    const int pb = qAbs(a - c);
+    const int pc = qAbs(a + b - 2 * c);
+
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+inline void filterPaeth(const quint8 *raw, const quint8 *prior, quint8 *dst, int size, int bpp)
+{
+    for (int i = 0; i < bpp; i++) {
+        dst[i] = raw[i] - prior[i];
+    }
+    for (int i = bpp; i < size; i++) {
+        dst[i] = raw[i] - paethPredictor(raw[i - bpp], prior[i], prior[i - bpp]);
+    }
+}
+
+/**
+ * The heuristic recommended by the PNG specification and used by
+ * libpng: the filter giving the smallest sum of absolute values of
+ * the filtered bytes (taken as signed) wins.
+ */
+inline quint32 filterCost(const quint8 *data, int size)
+{
+    quint32 sum = 0;
+    for (int i = 0; i < size; i++) {
+        const quint8 v = data[i];
+        sum += v < 128 ? v : 256 - v;
+    }
+    return sum;
+}
+
+inline void swapByteOrder16(const quint8 *src, quint8 *dst, int size)
+{
+    for (int i = 0; i < size - 1; i += 2) {
+        dst[i] = src[i + 1];
+        dst[i + 1] = src[i];
+    }
+}
+
+struct Block {
+    Block() : firstRow(0), numRows(0), isLast(false), adler(0), failed(false) {}
+
+    int firstRow;
+    int numRows;
+    bool isLast;
+
+    QByteArray filtered;
+    QByteArray dictionary;
+    QByteArray compressed;
+    uLong adler;
+    bool failed;
+};
+
+}
+
+
+struct KisPNGIDATEncoder::Private
+{
+    Private(const quint8 * const *_rows, int _numRows,
+            int _rowBytes, int _bytesPerPixel,
+            int _compressionLevel)
+        : rows(_rows),
+          numRows(_numRows),
+          rowBytes(_rowBytes),
+          bytesPerPixel(_bytesPerPixel),
+          compressionLevel(_compressionLevel),
+          useFilters(false),
+          swapBytes16(false),
+          blockSize(512 * 1024),
+          nextRow(0),
+          nextBlock(0),
+          adler(adler32(0L, Z_NULL, 0)),
+          failed(false)
+    {
+    }
+
+    const quint8 * const *rows;
+    const int numRows;
+    const int rowBytes;
+    const int bytesPerPixel;
+    const int compressionLevel;
+
+    bool useFilters;
+    bool swapBytes16;
+    int blockSize;
+
+    int nextRow;
+    QVector<Block> batch;
+    int nextBlock;
+    QByteArray lastDictionary;
+    uLong adler;
+    bool failed;
+
+    bool encodeNextBatch();
+
+    const quint8* prepareRow(int row, QVector<quint8> &buffer) const;
+    void filterBlock(Block &block) const;
+    void deflateBlock(Block &block) const;
+    void writeZlibHeader(quint8 *dst) const;
+
+    struct FilterBlock {
+        FilterBlock(const Private *d) : m_d(d) {}
+
+        void operator()(Block &block) const {
+            m_d->filterBlock(block);
+        }
+
+        const Private *m_d;
+    };
+
+    struct DeflateBlock {
+        DeflateBlock(const Private *d) : m_d(d) {}
+
+        void operator()(Block &block) const {
+            m_d->deflateBlock(block);
+        }
+
+        const Private *m_d;
+    };
+};
+
+
+KisPNGIDATEncoder::KisPNGIDATEncoder(const quint8 * const *rows, int numRows,
+                                     int rowBytes, int bytesPerPixel,
+                                     int compressionLevel)
+    : m_d(new Private(rows, numRows, rowBytes, bytesPerPixel, compressionLevel))
+{
+}
+
+KisPNGIDATEncoder::~KisPNGIDATEncoder()
+{
+}
+
+void KisPNGIDATEncoder::setUseFilters(bool value)
+{
+    m_d->useFilters = value;
+}
+
+void KisPNGIDATEncoder::setSwapBytes16(bool value)
+{
+    m_d->swapBytes16 = value;
+}
+
+void KisPNGIDATEncoder::setBlockSize(int bytes)
+{
+    m_d->blockSize = bytes;
+}
+
+int KisPNGIDATEncoder::blockSize() const
+{
+    return m_d->blockSize;
+}
+
+QByteArray KisPNGIDATEncoder::nextChunk()
+{
+    if (m_d->nextBlock >= m_d->batch.size() &&
+        !m_d->encodeNextBatch()) {
+
+        return QByteArray();
+    }
+
+    Block &block = m_d->batch[m_d->nextBlock++];
+    QByteArray chunk = block.compressed;
+    block.compressed = QByteArray();
+
+    return chunk;
+}
+
+bool KisPNGIDATEncoder::failed() const
+{
+    return m_d->failed;
+}
+
+bool KisPNGIDATEncoder::Private::encodeNextBatch()
+{
+    batch.clear();
+    nextBlock = 0;
+
+    if (failed || nextRow >= numRows) return false;
+
+    const int rowsPerBlock = qMax(1, blockSize / rowBytes);
+    const int maxBlocks = 4 * QThread::idealThreadCount();
+
+    while (batch.size() < maxBlocks && nextRow < numRows) {
+        Block block;
+        block.firstRow = nextRow;
+        block.numRows = qMin(rowsPerBlock, numRows - nextRow);
+        nextRow += block.numRows;
+        block.isLast = nextRow >= numRows;
+
+        batch.append(block);
+    }
+
+    QtConcurrent::blockingMap(batch, FilterBlock(this));
+
+    /**
+     * Nothing is ever matched against the window when storing the data,
+     * so priming is useless for level 0
+     */
+    if (compressionLevel != 0) {
+        for (int i = 0; i < batch.size(); i++) {
+            const QByteArray &previous = i > 0 ? batch[i - 1].filtered : lastDictionary;
+            const int size = qMin(dictionarySize, previous.size());
+            batch[i].dictionary = QByteArray::fromRawData(previous.constData() + previous.size() - size, size);
+        }
+    }
+
+    QtConcurrent::blockingMap(batch, DeflateBlock(this));
+
+    if (compressionLevel != 0) {
+        lastDictionary = batch.last().filtered.right(dictionarySize);
+    }
+
+    for (int i = 0; i < batch.size(); i++) {
+        Block &block = batch[i];
+
+        if (block.failed) {
+            warnFile << "Failed to deflate PNG rows" << block.firstRow << "to" << block.firstRow + block.numRows - 1;
+            failed = true;
+            batch.clear();
+            return false;
+        }
+
+        adler = adler32_combine(adler, block.adler, block.filtered.size());
+        block.dictionary = QByteArray();
+        block.filtered = QByteArray();
+    }
+
+    Block &last = batch.last();
+    if (last.isLast) {
+        // the zlib trailer: Adler-32 of all the data, big endian
+        last.compressed.append(char((adler >> 24) & 0xff));
+        last.compressed.append(char((adler >> 16) & 0xff));
+        last.compressed.append(char((adler >> 8) & 0xff));
+        last.compressed.append(char(adler & 0xff));
+    }
+
+    return true;
+}
+
+const quint8* KisPNGIDATEncoder::Private::prepareRow(int row, QVector<quint8> &buffer) const
+{
+    if (!swapBytes16) return rows[row];
+
+    swapByteOrder16(rows[row], buffer.data(), rowBytes);
+    return buffer.constData();
+}
+
+void KisPNGIDATEncoder::Private::filterBlock(Block &block) const
+{
+    const int filteredRowBytes = rowBytes + 1;
+    block.filtered.resize(filteredRowBytes * block.numRows);
+    quint8 *dst = reinterpret_cast<quint8*>(block.filtered.data());
+
+    const bool doFilter = useFilters && compressionLevel != 0;
+
+    QVector<quint8> rawBuffer(swapBytes16 ? rowBytes : 0);
+    QVector<quint8> priorBuffer(rowBytes, 0);
+    QVector<quint8> candidates(doFilter ? NumFilters * rowBytes : 0);
+
+    /**
+     * The row above the first one is all zeros
+     */
+    const quint8 *prior = priorBuffer.constData();
+    if (block.firstRow > 0 && doFilter) {
+        prior = prepareRow(block.firstRow - 1, priorBuffer);
+    }
+
+    for (int i = 0; i < block.numRows; i++) {
+        const quint8 *raw = prepareRow(block.firstRow + i, rawBuffer);
+        quint8 *filteredRow = dst + i * filteredRowBytes;
+
+        FilterType bestFilter = FilterNone;
+        const quint8 *bestData = raw;
+
+        if (doFilter) {
+            quint8 *data[NumFilters];
+            for (int f = 0; f < NumFilters; f++) {
+                data[f] = candidates.data() + f * rowBytes;
+            }
+
+            filterSub(raw, data[FilterSub], rowBytes, bytesPerPixel);
+            filterUp(raw, prior, data[FilterUp], rowBytes);
+            filterAverage(raw, prior, data[FilterAverage], rowBytes, bytesPerPixel);
+            filterPaeth(raw, prior, data[FilterPaeth], rowBytes, bytesPerPixel);
+
+            quint32 bestCost = filterCost(raw, rowBytes);
+            for (int f = FilterSub; f < NumFilters; f++) {
+                const quint32 cost = filterCost(data[f], rowBytes);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestFilter = FilterType(f);
+                    bestData = data[f];
+                }
+            }
+        }
+
+        filteredRow[0] = bestFilter;
+        memcpy(filteredRow + 1, bestData, rowBytes);
+
+        if (swapBytes16) {
+            std::swap(rawBuffer, priorBuffer);
+        }
+        prior = raw;
+    }
+
+    block.adler = adler32(adler32(0L, Z_NULL, 0),
+                          reinterpret_cast<const Bytef*>(block.filtered.constData()),
+                          block.filtered.size());
+}
+
+void KisPNGIDATEncoder::Private::writeZlibHeader(quint8 *dst) const
+{
+    const int level = compressionLevel == Z_DEFAULT_COMPRESSION ? 6 : compressionLevel;
+    const int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+
+    // deflate with the 32KiB window, no preset dictionary
+    const int cmf = 0x78;
+    int flg = flevel << 6;
+    flg += 31 - (cmf * 256 + flg) % 31;
+
+    dst[0] = cmf;
+    dst[1] = flg;
+}
+
+void KisPNGIDATEncoder::Private::deflateBlock(Block &block) const
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+
+    /**
+     * Negative window bits produce a raw deflate stream. The zlib
+     * header and trailer are written by ourselves.
+     */
+    int result = deflateInit2(&stream, compressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    if (result != Z_OK) {
+        block.failed = true;
+        return;
+    }
+
+    if (!block.dictionary.isEmpty()) {
+        deflateSetDictionary(&stream,
+                             reinterpret_cast<const Bytef*>(block.dictionary.constData()),
+                             block.dictionary.size());
+    }
+
+    const int headerSize = block.firstRow == 0 ? 2 : 0;
+    block.compressed.resize(headerSize + deflateBound(&stream, block.filtered.size()) + 16);
+    if (headerSize) {
+        writeZlibHeader(reinterpret_cast<quint8*>(block.compressed.data()));
+    }
+
+    stream.next_in = reinterpret_cast<Bytef*>(block.filtered.data());
+    stream.avail_in = block.filtered.size();
+
+    /**
+     * The full flush byte-aligns the end of the block, so the next
+     * one can be appended right after it
+     */
+    const int flush = block.isLast ? Z_FINISH : Z_FULL_FLUSH;
+
+    forever {
+        const int written = headerSize + stream.total_out;
+        if (written >= block.compressed.size()) {
+            block.compressed.resize(2 * block.compressed.size());
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(block.compressed.data()) + written;
+        stream.avail_out = block.compressed.size() - written;
+
+        result = deflate(&stream, flush);
+
+        if (result == Z_STREAM_ERROR ||
+            (block.isLast ? result == Z_STREAM_END : stream.avail_out > 0)) {
+
+            break;
+        }
+    }
+
+    block.failed = result == Z_STREAM_ERROR;
+    block.compressed.resize(headerSize + stream.total_out);
+
+    deflateEnd(&stream);
+}
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __KIS_PNG_IDAT_ENCODER_H
+#define __KIS_PNG_IDAT_ENCODER_H
+
+#include <QScopedPointer>
+#include <QByteArray>
+
+#include "kritaui_export.h"
+
+
+/**
+ * Encodes the image data of a non-interlaced PNG file, that is the
+ * zlib stream stored in the IDAT chunks, using all the threads of the
+ * global thread pool.
+ *
+ * The rows are split into blocks of about blockSize() bytes. Every
+ * block is filtered and deflated independently. The blocks are ended
+ * with a full flush and primed with the last 32KiB of the preceding
+ * block, so their concatenation is a single standard zlib stream of
+ * nearly the same size as the one libpng would create. Every block is
+ * returned as a separate IDAT chunk.
+ *
+ * The rows are expected to be in the final PNG layout (packed pixels,
+ * channel order), except for the byte order of 16-bit samples, which
+ * can be swapped on the fly with setSwapBytes16().
+ */
+class KRITAUI_EXPORT KisPNGIDATEncoder
+{
+public:
+    /**
+     * \p rows must stay valid while the encoder is in use.
+     * \p bytesPerPixel is the distance between the corresponding bytes
+     * of neighbouring pixels used by the filters, that is one for
+     * images with less than 8 bits per pixel.
+     */
+    KisPNGIDATEncoder(const quint8 * const *rows, int numRows,
+                      int rowBytes, int bytesPerPixel,
+                      int compressionLevel);
+    ~KisPNGIDATEncoder();
+
+    /**
+     * Enables the adaptive row filters. They are disabled by default,
+     * which is what PNG recommends for palette images and images with
+     * less than 8 bits per sample. Filtering is useless for the
+     * compression level 0, so it is never done for it.
+     */
+    void setUseFilters(bool value);
+
+    /**
+     * Converts 16-bit samples from the native little endian order
+     * into the big endian one demanded by PNG
+     */
+    void setSwapBytes16(bool value);
+
+    /**
+     * The amount of unfiltered data deflated by one job
+     */
+    void setBlockSize(int bytes);
+    int blockSize() const;
+
+    /**
+     * Returns the data of the next IDAT chunk. The chunks are encoded
+     * in batches, so the memory usage doesn't depend on the size of
+     * the image. An empty array means that all the rows have been
+     * encoded.
+     */
+    QByteArray nextChunk();
+
+    /**
+     * Returns true if deflating failed. No more chunks are returned
+     * after a failure.
+     */
+    bool failed() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_PNG_IDAT_ENCODER_H */
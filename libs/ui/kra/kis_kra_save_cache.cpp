@@ -0,0 +1,176 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_kra_save_cache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QString>
+
+#include <KoStore.h>
+
+#include "kis_debug.h"
+
+
+struct KisKraSaveCache::Private
+{
+    Private()
+        : isSaving(false),
+          sourceSize(-1)
+    {
+    }
+
+    bool isSaving;
+
+    QString sourceFileName;
+    QDateTime sourceModified;
+    qint64 sourceSize;
+
+    /// revision -> entry name in the source file
+    QHash<qint64, QString> sourceEntries;
+    QScopedPointer<KoStore> sourceStore;
+
+    /// revision -> entry name in the file being saved
+    QHash<qint64, QString> newEntries;
+
+    void rememberFileState(const QString &fileName) {
+        QFileInfo info(fileName);
+        sourceFileName = fileName;
+        sourceModified = info.lastModified();
+        sourceSize = info.size();
+    }
+
+    bool sourceIsUnchanged() const {
+        QFileInfo info(sourceFileName);
+        return info.exists() &&
+            info.lastModified() == sourceModified &&
+            info.size() == sourceSize;
+    }
+
+    static QString entryName(KoStore *store, const QString &location) {
+        return store->currentPath() + location;
+    }
+};
+
+KisKraSaveCache::KisKraSaveCache()
+    : m_d(new Private)
+{
+}
+
+KisKraSaveCache::~KisKraSaveCache()
+{
+}
+
+void KisKraSaveCache::beginSave()
+{
+    m_d->isSaving = true;
+    m_d->newEntries.clear();
+    m_d->sourceStore.reset();
+
+    if (m_d->sourceEntries.isEmpty()) return;
+
+    if (!m_d->sourceIsUnchanged()) {
+        dbgFile << "The previously saved file" << m_d->sourceFileName << "has changed, saving all the layers";
+        m_d->sourceEntries.clear();
+        return;
+    }
+
+    m_d->sourceStore.reset(KoStore::createStore(m_d->sourceFileName, KoStore::Read));
+    if (!m_d->sourceStore || m_d->sourceStore->bad()) {
+        m_d->sourceStore.reset();
+        m_d->sourceEntries.clear();
+    }
+}
+
+bool KisKraSaveCache::copyEntry(KoStore *store, const QString &location, qint64 revision, bool *error)
+{
+    *error = false;
+
+    if (!m_d->isSaving || !m_d->sourceStore) return false;
+
+    const QString sourceName = m_d->sourceEntries.value(revision);
+    if (sourceName.isEmpty()) return false;
+
+    KoStore *source = m_d->sourceStore.data();
+    if (!source->open(sourceName)) {
+        return false;
+    }
+
+    if (!store->open(location)) {
+        source->close();
+        *error = true;
+        return false;
+    }
+
+    const qint64 chunkSize = 1024 * 1024;
+    qint64 bytesLeft = source->size();
+
+    while (bytesLeft > 0) {
+        const QByteArray chunk = source->read(qMin(chunkSize, bytesLeft));
+        if (chunk.isEmpty() || store->write(chunk) != chunk.size()) {
+            *error = true;
+            break;
+        }
+        bytesLeft -= chunk.size();
+    }
+
+    source->close();
+    *error |= !store->close();
+
+    if (*error) {
+        warnFile << "Failed to copy" << sourceName << "from the previously saved file";
+    } else {
+        dbgFile << "Reused unchanged entry" << sourceName << "as" << location;
+    }
+
+    return !*error;
+}
+
+void KisKraSaveCache::registerEntry(KoStore *store, const QString &location, qint64 revision)
+{
+    if (!m_d->isSaving) return;
+    m_d->newEntries.insert(revision, Private::entryName(store, location));
+}
+
+void KisKraSaveCache::closeSource()
+{
+    m_d->sourceStore.reset();
+}
+
+void KisKraSaveCache::endSave(const QString &fileName, bool success)
+{
+    if (!m_d->isSaving) return;
+
+    m_d->isSaving = false;
+    m_d->sourceStore.reset();
+
+    if (success) {
+        m_d->sourceEntries = m_d->newEntries;
+        m_d->rememberFileState(fileName);
+    }
+
+    m_d->newEntries.clear();
+}
+
+void KisKraSaveCache::relocate(const QString &oldFileName, const QString &newFileName)
+{
+    if (m_d->sourceFileName != oldFileName) return;
+    m_d->rememberFileState(newFileName);
+}
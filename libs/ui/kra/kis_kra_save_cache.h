@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef KIS_KRA_SAVE_CACHE_H
+#define KIS_KRA_SAVE_CACHE_H
+
+#include <QtGlobal>
+#include <QScopedPointer>
+
+#include <kritaui_export.h>
+
+class KoStore;
+class QString;
+
+/**
+ * Keeps track of which paint device data has been written into the
+ * file of the last successful save, so that the next save can copy
+ * the entries of unchanged devices from that file instead of
+ * serializing the devices once again.
+ *
+ * The entries are identified by the revision of the data manager
+ * (see KisTiledDataManager::revision()), which is unique within the
+ * process, so an entry can be reused even if the layer got a
+ * different file name in the meantime.
+ *
+ * Usage:
+ *
+ * \code
+ * cache.beginSave();
+ * // for every device
+ * if (!cache.copyEntry(store, location, revision)) {
+ *     // write the device as usual
+ * }
+ * cache.registerEntry(store, location, revision);
+ * // when all the devices are written
+ * cache.closeSource();
+ * // after the store has been finalized
+ * cache.endSave(fileName, success);
+ * \endcode
+ *
+ * Outside of beginSave()/endSave() all the calls are no-ops.
+ */
+class KRITAUI_EXPORT KisKraSaveCache
+{
+public:
+    KisKraSaveCache();
+    ~KisKraSaveCache();
+
+    /**
+     * Starts a new save session and opens the file of the previous
+     * save, if it is still present and has not been modified since.
+     */
+    void beginSave();
+
+    /**
+     * If the data with \p revision has been saved into the previous
+     * file, opens \p location in \p store and copies the entry into it.
+     *
+     * \return true if the entry has been copied. If false is returned
+     * and \p error is set, the destination entry is broken and the
+     * save should be aborted, otherwise the caller should write the
+     * entry itself.
+     */
+    bool copyEntry(KoStore *store, const QString &location, qint64 revision, bool *error);
+
+    /**
+     * Records that the data with \p revision has been written
+     * into \p location of \p store
+     */
+    void registerEntry(KoStore *store, const QString &location, qint64 revision);
+
+    /**
+     * Closes the file of the previous save. Should be called as soon
+     * as no more entries are going to be copied, because the new file
+     * may have to replace the old one.
+     */
+    void closeSource();
+
+    /**
+     * Finishes the save session. If \p success is true, \p fileName
+     * becomes the source of the entries for the next save.
+     */
+    void endSave(const QString &fileName, bool success);
+
+    /**
+     * Notifies the cache that the saved file has been moved
+     * to \p newFileName
+     */
+    void relocate(const QString &oldFileName, const QString &newFileName);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* KIS_KRA_SAVE_CACHE_H */
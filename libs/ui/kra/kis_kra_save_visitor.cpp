@@ -54,6 +54,8 @@
 
 #include "kis_config.h"
 #include "kis_store_paintdevice_writer.h"
+#include "kis_kra_save_cache.h"
+#include "kis_datamanager.h"
 #include "flake/kis_shape_selection.h"
 
 #include "kis_raster_keyframe_channel.h"
@@ -74,6 +76,7 @@ KisKraSaveVisitor::KisKraSaveVisitor(KoStore *store, const QString & name, QMap<
     , m_name(name)
     , m_nodeFileNames(nodeFileNames)
     , m_writer(new KisStorePaintDeviceWriter(store))
+    , m_saveCache(0)
 {
 }
 
@@ -88,6 +91,11 @@ void KisKraSaveVisitor::setExternalUri(const QString &uri)
     m_uri = uri;
 }
 
+void KisKraSaveVisitor::setSaveCache(KisKraSaveCache *cache)
+{
+    m_saveCache = cache;
+}
+
 bool KisKraSaveVisitor::visit(KisExternalLayer * layer)
 {
     bool result = false;
@@ -307,6 +315,10 @@ struct SimpleDevicePolicy
         return dev->write(store);
     }
 
+    KisDataManagerSP dataManager(KisPaintDeviceSP dev) const {
+        return dev->dataManager();
+    }
+
     KoColor defaultPixel(KisPaintDeviceSP dev) const {
         return dev->defaultPixel();
     }
@@ -321,6 +333,10 @@ struct FramedDevicePolicy
         return dev->framesInterface()->writeFrame(store, m_frameId);
     }
 
+    KisDataManagerSP dataManager(KisPaintDeviceSP dev) const {
+        return dev->framesInterface()->frameDataManager(m_frameId);
+    }
+
     KoColor defaultPixel(KisPaintDeviceSP dev) const {
         return dev->framesInterface()->frameDefaultPixel(m_frameId);
     }
@@ -367,6 +383,23 @@ bool KisKraSaveVisitor::savePaintDevice(KisPaintDeviceSP device,
 template<class DevicePolicy>
 bool KisKraSaveVisitor::savePaintDeviceFrame(KisPaintDeviceSP device, QString location, DevicePolicy policy)
 {
+    const qint64 revision = policy.dataManager(device)->revision();
+
+    if (m_saveCache) {
+        bool error = false;
+        bool copied = m_saveCache->copyEntry(m_store, location, revision, &error);
+
+        if (error) {
+            m_errorMessages << i18n("Failed to copy unchanged layer data into %1.", location);
+            return false;
+        }
+
+        if (copied) {
+            m_saveCache->registerEntry(m_store, location, revision);
+            return saveDefaultPixel(device, location, policy);
+        }
+    }
+
     if (m_store->open(location)) {
         if (!policy.write(device, *m_writer)) {
             device->disconnect();
@@ -374,8 +407,17 @@ bool KisKraSaveVisitor::savePaintDeviceFrame(KisPaintDeviceSP device, QString lo
             return false;
         }
 
-        m_store->close();
+        if (m_store->close() && m_saveCache) {
+            m_saveCache->registerEntry(m_store, location, revision);
+        }
     }
+
+    return saveDefaultPixel(device, location, policy);
+}
+
+template<class DevicePolicy>
+bool KisKraSaveVisitor::saveDefaultPixel(KisPaintDeviceSP device, QString location, DevicePolicy policy)
+{
     if (m_store->open(location + ".defaultpixel")) {
         m_store->write((char*)policy.defaultPixel(device).data(), device->colorSpace()->pixelSize());
         m_store->close();
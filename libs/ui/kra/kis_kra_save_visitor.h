@@ -29,6 +29,7 @@
 
 
 class KisPaintDeviceWriter;
+class KisKraSaveCache;
 class KoStore;
 
 class KisKraSaveVisitor : public KisNodeVisitor
@@ -41,6 +42,12 @@ public:
 public:
     void setExternalUri(const QString &uri);
 
+    /**
+     * Lets the visitor copy the data of the paint devices that have
+     * not changed since the previous save instead of writing it
+     */
+    void setSaveCache(KisKraSaveCache *cache);
+
     bool visit(KisNode*) {
         return true;
     }
@@ -77,6 +84,9 @@ private:
     template<class DevicePolicy>
     bool savePaintDeviceFrame(KisPaintDeviceSP device, QString location, DevicePolicy policy);
 
+    template<class DevicePolicy>
+    bool saveDefaultPixel(KisPaintDeviceSP device, QString location, DevicePolicy policy);
+
     bool saveAnnotations(KisLayer* layer);
     bool saveSelection(KisNode* node);
     bool saveFilterConfiguration(KisNode* node);
@@ -92,6 +102,7 @@ private:
     QString m_name;
     QMap<const KisNode*, QString> m_nodeFileNames;
     KisPaintDeviceWriter *m_writer;
+    KisKraSaveCache *m_saveCache;
     QStringList m_errorMessages;
 };
 
@@ -20,6 +20,7 @@
 
 #include "kis_kra_tags.h"
 #include "kis_kra_save_visitor.h"
+#include "kis_kra_save_cache.h"
 #include "kis_kra_savexml_visitor.h"
 
 #include <QDomDocument>
@@ -29,6 +30,7 @@
 
 #include <QUrl>
 #include <QBuffer>
+#include <QtConcurrent>
 
 #include <KoDocumentInfo.h>
 #include <KoColorSpaceRegistry.h>
@@ -60,6 +62,24 @@
 
 using namespace KRA;
 
+namespace {
+
+QByteArray encodeMergedImage(KisImageSP image)
+{
+    KisPaintDeviceSP dev = image->projection();
+    if (!KisPNGConverter::isColorSpaceSupported(dev->colorSpace())) {
+        dev = new KisPaintDevice(*dev.data());
+        KUndo2Command *cmd = dev->convertTo(KoColorSpaceRegistry::instance()->rgb8());
+        delete cmd;
+    }
+
+    QByteArray data;
+    KisPNGConverter::saveDeviceToBuffer(&data, image->bounds(), image->xRes(), image->yRes(), dev);
+    return data;
+}
+
+}
+
 struct KisKraSaver::Private
 {
 public:
@@ -68,12 +88,14 @@ public:
     QMap<const KisNode*, QString> keyframeFilenames;
     QString imageName;
     QStringList errorMessages;
+    KisKraSaveCache *saveCache;
 };
 
 KisKraSaver::KisKraSaver(KisDocument* document)
         : m_d(new Private)
 {
     m_d->doc = document;
+    m_d->saveCache = 0;
 
     m_d->imageName = m_d->doc->documentInfo()->aboutInfo("title");
     if (m_d->imageName.isEmpty()) {
@@ -86,6 +108,11 @@ KisKraSaver::~KisKraSaver()
     delete m_d;
 }
 
+void KisKraSaver::setSaveCache(KisKraSaveCache *cache)
+{
+    m_d->saveCache = cache;
+}
+
 QDomElement KisKraSaver::saveXML(QDomDocument& doc,  KisImageWSP image)
 {
     QDomElement imageElement = doc.createElement("IMAGE"); // Legacy!
@@ -183,16 +210,33 @@ bool KisKraSaver::saveBinaryData(KoStore* store, KisImageWSP image, const QStrin
 {
     QString location;
 
+    /**
+     * The merged image is encoded in the background while the layers
+     * are being written. The store can only write one file at a time,
+     * so the encoded data is added at the end.
+     */
+    QFuture<QByteArray> mergedImage;
+    if (!autosave) {
+        mergedImage = QtConcurrent::run(encodeMergedImage, KisImageSP(image));
+    }
+
     // Save the layers data
     KisKraSaveVisitor visitor(store, m_d->imageName, m_d->nodeFileNames);
 
     if (external)
         visitor.setExternalUri(uri);
 
+    visitor.setSaveCache(m_d->saveCache);
+
     image->rootLayer()->accept(visitor);
 
+    if (m_d->saveCache) {
+        m_d->saveCache->closeSource();
+    }
+
     m_d->errorMessages.append(visitor.errorMessages());
     if (!m_d->errorMessages.isEmpty()) {
+        mergedImage.waitForFinished();
         return false;
     }
 
@@ -274,14 +318,11 @@ bool KisKraSaver::saveBinaryData(KoStore* store, KisImageWSP image, const QStrin
     }
 
     if (!autosave) {
-        KisPaintDeviceSP dev = image->projection();
-        if (!KisPNGConverter::isColorSpaceSupported(dev->colorSpace())) {
-            dev = new KisPaintDevice(*dev.data());
-            KUndo2Command *cmd = dev->convertTo(KoColorSpaceRegistry::instance()->rgb8());
-            delete cmd;
+        const QByteArray mergedImageData = mergedImage.result();
+        if (!mergedImageData.isEmpty() && store->open("mergedimage.png")) {
+            store->write(mergedImageData);
+            store->close();
         }
-
-        KisPNGConverter::saveDeviceToStore("mergedimage.png", image->bounds(), image->xRes(), image->yRes(), dev, store);
     }
 
     saveAssistants(store, uri,external);
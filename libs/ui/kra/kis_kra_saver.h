@@ -22,6 +22,7 @@
 #include <kis_types.h>
 
 class KisDocument;
+class KisKraSaveCache;
 class QDomElement;
 class QDomDocument;
 class KoStore;
@@ -36,6 +37,12 @@ public:
 
     ~KisKraSaver();
 
+    /**
+     * Lets the saver reuse the layer data that has not changed
+     * since the previous save, see KisKraSaveCache
+     */
+    void setSaveCache(KisKraSaveCache *cache);
+
     QDomElement saveXML(QDomDocument& doc,  KisImageWSP image);
 
     bool saveKeyframes(KoStore *store, const QString &uri, bool external);
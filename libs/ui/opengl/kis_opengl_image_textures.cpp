@@ -31,6 +31,7 @@
 
 #include "kis_image.h"
 #include "kis_config.h"
+#include "opengl/kis_texture_tile_converter.h"
 #include "KisPart.h"
 
 #ifdef HAVE_OPENEXR
@@ -247,15 +248,25 @@ void KisOpenGLImageTextures::destroyImageTextureTiles()
 
 KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCache(const QRect& rect)
 {
-    return updateCacheImpl(rect, true);
+    return updateCacheImpl(rect, m_image->projection(), m_image->currentLevelOfDetail(), true);
+}
+
+KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCache(const QRect& rect, KisPaintDeviceSP projection)
+{
+    return updateCacheImpl(rect, projection, 0, true);
 }
 
 KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheNoConversion(const QRect& rect)
 {
-    return updateCacheImpl(rect, false);
+    return updateCacheImpl(rect, m_image->projection(), m_image->currentLevelOfDetail(), false);
+}
+
+KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheNoConversion(const QRect& rect, KisPaintDeviceSP projection)
+{
+    return updateCacheImpl(rect, projection, 0, true, true);
 }
 
-KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect, bool convertColorSpace)
+KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect, KisPaintDeviceSP projection, int levelOfDetail, bool convertColorSpace, bool deferConversion)
 {
     const KoColorSpace *dstCS = m_tilesDestinationColorSpace;
 
@@ -289,7 +300,7 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect,
 
     QBitArray channelFlags; // empty by default
 
-    if (m_channelFlags.size() != m_image->projection()->colorSpace()->channels().size()) {
+    if (m_channelFlags.size() != projection->colorSpace()->channels().size()) {
         setChannelFlags(QBitArray());
     }
     if (!m_useOcio) { // Ocio does its own channel flipping
@@ -302,7 +313,6 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect,
     info->tileList.reserve(numItems);
 
     const QRect bounds = m_image->bounds();
-    const int levelOfDetail = m_image->currentLevelOfDetail();
 
     QRect alignedUpdateRect = updateRect;
     QRect alignedBounds = bounds;
@@ -331,23 +341,6 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect,
                                                      m_infoChunksPool));
             // Don't update empty tiles
             if (tileInfo->valid()) {
-                tileInfo->retrieveData(m_image, channelFlags, m_onlyOneChannelSelected, m_selectedChannelIndex);
-
-                //create transform
-                if (m_createNewProofingTransform) {
-                    const KoColorSpace *proofingSpace = KoColorSpaceRegistry::instance()->colorSpace(m_proofingConfig->proofingModel,m_proofingConfig->proofingDepth,m_proofingConfig->proofingProfile);
-                    m_proofingTransform.reset(tileInfo->generateProofingTransform(dstCS, proofingSpace, m_renderingIntent, m_proofingConfig->intent, m_proofingConfig->conversionFlags, m_proofingConfig->warningColor, m_proofingConfig->adaptationState));
-                    m_createNewProofingTransform = false;
-                }
-
-                if (convertColorSpace) {
-                    if (m_proofingConfig && m_proofingTransform && m_proofingConfig->conversionFlags.testFlag(KoColorConversionTransformation::SoftProofing)) {
-                        tileInfo->proofTo(dstCS, m_proofingConfig->conversionFlags, m_proofingTransform.data());
-                    } else {
-                        tileInfo->convertTo(dstCS, m_renderingIntent, m_conversionFlags);
-                    }
-                }
-
                 info->tileList.append(tileInfo);
             }
             else {
@@ -356,6 +349,29 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect,
         }
     }
 
+    KisTextureTileConverter converter;
+    converter.setChannelFlags(channelFlags, m_onlyOneChannelSelected, m_selectedChannelIndex);
+
+    bool useProofing = false;
+
+    if (convertColorSpace && m_proofingConfig) {
+        //create transform
+        if (m_createNewProofingTransform) {
+            const KoColorSpace *proofingSpace = KoColorSpaceRegistry::instance()->colorSpace(m_proofingConfig->proofingModel,m_proofingConfig->proofingDepth,m_proofingConfig->proofingProfile);
+            m_proofingTransform.reset(projection->colorSpace()->createProofingTransform(dstCS, proofingSpace, m_renderingIntent, m_proofingConfig->intent, m_proofingConfig->conversionFlags, m_proofingConfig->warningColor.data(), m_proofingConfig->adaptationState));
+            m_createNewProofingTransform = false;
+        }
+
+        if (m_proofingTransform && m_proofingConfig->conversionFlags.testFlag(KoColorConversionTransformation::SoftProofing)) {
+            converter.setProofingTransform(m_proofingTransform.data(), m_proofingConfig->conversionFlags);
+            useProofing = true;
+        }
+    }
+
+    converter.setConversionOptions(deferConversion && !useProofing ? ConversionOptions() : options);
+
+    converter.convertTiles(info->tileList, projection);
+
     info->assignDirtyImageRect(rect);
     info->assignLevelOfDetail(levelOfDetail);
     return info;
@@ -131,8 +131,26 @@ public:
     }
 
     KisOpenGLUpdateInfoSP updateCache(const QRect& rect);
+
+    /**
+     * Prepares the texture tiles for a projection that is not the
+     * current projection of the image, e.g. an animation frame
+     * rendered by KisFrameRegenerationEngine. The \p projection must
+     * have the bounds and the color space of the image.
+     */
+    KisOpenGLUpdateInfoSP updateCache(const QRect& rect, KisPaintDeviceSP projection);
     KisOpenGLUpdateInfoSP updateCacheNoConversion(const QRect& rect);
 
+    /**
+     * Same as updateCache(rect, projection), but the tiles are only
+     * fetched from the \p projection. The returned info keeps the
+     * conversion options, so the caller should call
+     * KisOpenGLUpdateInfo::convertColorSpace(), which is safe to do in
+     * a background thread. Soft proofing uses a shared transformation,
+     * so when it is active, the tiles are converted right away.
+     */
+    KisOpenGLUpdateInfoSP updateCacheNoConversion(const QRect& rect, KisPaintDeviceSP projection);
+
     void recalculateCache(KisUpdateInfoSP info);
 
     void slotImageSizeChanged(qint32 w, qint32 h);
@@ -156,7 +174,7 @@ private:
     void getTextureSize(KisGLTexturesInfo *texturesInfo);
 
     void updateTextureFormat();
-    KisOpenGLUpdateInfoSP updateCacheImpl(const QRect& rect, bool convertColorSpace);
+    KisOpenGLUpdateInfoSP updateCacheImpl(const QRect& rect, KisPaintDeviceSP projection, int levelOfDetail, bool convertColorSpace, bool deferConversion = false);
 
 private:
     KisImageWSP m_image;
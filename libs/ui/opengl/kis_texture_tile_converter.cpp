@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_texture_tile_converter.h"
+
+#include <QtConcurrent>
+
+#include <KoColorConversionTransformation.h>
+
+
+namespace {
+
+struct TileProcessor {
+    TileProcessor(KisPaintDeviceSP _projection,
+                  const QBitArray &_channelFlags,
+                  bool _onlyOneChannelSelected,
+                  int _selectedChannelIndex,
+                  const ConversionOptions &_options)
+        : projection(_projection),
+          channelFlags(_channelFlags),
+          onlyOneChannelSelected(_onlyOneChannelSelected),
+          selectedChannelIndex(_selectedChannelIndex),
+          options(_options)
+    {
+    }
+
+    inline void operator() (KisTextureTileUpdateInfoSP &tile) {
+        tile->retrieveData(projection, channelFlags, onlyOneChannelSelected, selectedChannelIndex);
+
+        if (options.m_needsConversion) {
+            tile->convertTo(options.m_destinationColorSpace,
+                            options.m_renderingIntent,
+                            options.m_conversionFlags);
+        }
+    }
+
+    KisPaintDeviceSP projection;
+    QBitArray channelFlags;
+    bool onlyOneChannelSelected;
+    int selectedChannelIndex;
+    ConversionOptions options;
+};
+
+}
+
+struct KisTextureTileConverter::Private
+{
+    QBitArray channelFlags;
+    bool onlyOneChannelSelected = false;
+    int selectedChannelIndex = 0;
+
+    ConversionOptions options;
+
+    KoColorConversionTransformation *proofingTransform = 0;
+    KoColorConversionTransformation::ConversionFlags proofingFlags;
+};
+
+KisTextureTileConverter::KisTextureTileConverter()
+    : m_d(new Private)
+{
+}
+
+KisTextureTileConverter::~KisTextureTileConverter()
+{
+}
+
+void KisTextureTileConverter::setChannelFlags(const QBitArray &channelFlags,
+                                              bool onlyOneChannelSelected,
+                                              int selectedChannelIndex)
+{
+    m_d->channelFlags = channelFlags;
+    m_d->onlyOneChannelSelected = onlyOneChannelSelected;
+    m_d->selectedChannelIndex = selectedChannelIndex;
+}
+
+void KisTextureTileConverter::setConversionOptions(const ConversionOptions &options)
+{
+    m_d->options = options;
+}
+
+void KisTextureTileConverter::setProofingTransform(KoColorConversionTransformation *transform,
+                                                   KoColorConversionTransformation::ConversionFlags proofingFlags)
+{
+    m_d->proofingTransform = transform;
+    m_d->proofingFlags = proofingFlags;
+}
+
+void KisTextureTileConverter::convertTiles(KisTextureTileUpdateInfoSPList &tiles, KisPaintDeviceSP projection) const
+{
+    if (tiles.isEmpty()) return;
+
+    const bool useProofing = m_d->options.m_needsConversion && m_d->proofingTransform;
+
+    /**
+     * The proofing transformation is shared, so it is not safe to use
+     * it from several threads. It is applied in a separate pass below.
+     */
+    TileProcessor processor(projection,
+                            m_d->channelFlags,
+                            m_d->onlyOneChannelSelected,
+                            m_d->selectedChannelIndex,
+                            useProofing ? ConversionOptions() : m_d->options);
+
+    if (tiles.size() == 1) {
+        processor(tiles.first());
+    } else {
+        QtConcurrent::blockingMap(tiles, processor);
+    }
+
+    if (useProofing) {
+        Q_FOREACH (KisTextureTileUpdateInfoSP tile, tiles) {
+            tile->proofTo(m_d->options.m_destinationColorSpace,
+                          m_d->proofingFlags,
+                          m_d->proofingTransform);
+        }
+    }
+}
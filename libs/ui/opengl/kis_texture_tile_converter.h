@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_TEXTURE_TILE_CONVERTER_H
+#define __KIS_TEXTURE_TILE_CONVERTER_H
+
+#include <QScopedPointer>
+#include <QBitArray>
+
+#include "kritaui_export.h"
+#include "kis_types.h"
+#include "canvas/kis_update_info.h"
+#include "opengl/kis_texture_tile_update_info.h"
+
+class KoColorConversionTransformation;
+
+
+/**
+ * Prepares the pixel data of texture tiles for uploading: reads the
+ * patches from the projection, filters the channels and converts them
+ * into the color space of the textures.
+ *
+ * The converter doesn't touch OpenGL, so it can be used in any thread
+ * and without any GPU present. The tiles are processed concurrently
+ * on the global thread pool. The buffers are taken from the
+ * KisTextureTileInfoPool of the tiles, the color transformations are
+ * reused via KoColorConversionCache.
+ */
+class KRITAUI_EXPORT KisTextureTileConverter
+{
+public:
+    KisTextureTileConverter();
+    ~KisTextureTileConverter();
+
+    /**
+     * Sets the channels that should be shown. Empty \p channelFlags
+     * means that all the channels are visible.
+     */
+    void setChannelFlags(const QBitArray &channelFlags,
+                         bool onlyOneChannelSelected,
+                         int selectedChannelIndex);
+
+    /**
+     * Sets the destination color space of the tiles. If \p options
+     * doesn't need a conversion, the tiles are left in the color space
+     * of the projection.
+     */
+    void setConversionOptions(const ConversionOptions &options);
+
+    /**
+     * Sets the transformation used for soft proofing instead of the
+     * usual conversion. The converter doesn't take ownership of
+     * \p transform. Pass null to disable proofing.
+     */
+    void setProofingTransform(KoColorConversionTransformation *transform,
+                              KoColorConversionTransformation::ConversionFlags proofingFlags);
+
+    /**
+     * Fills all the \p tiles with the data from \p projection
+     */
+    void convertTiles(KisTextureTileUpdateInfoSPList &tiles, KisPaintDeviceSP projection) const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_TEXTURE_TILE_CONVERTER_H */
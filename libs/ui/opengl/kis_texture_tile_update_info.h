@@ -29,6 +29,7 @@
 #include <KoColorConversionTransformation.h>
 #include <KoChannelInfo.h>
 #include <kis_lod_transform.h>
+#include "tiles3/swap/kis_abstract_compression.h"
 #include "kis_texture_tile_info_pool.h"
 
 
@@ -65,9 +66,7 @@ public:
     }
 
     ~DataBuffer() {
-        if (m_data) {
-            m_pool->free(m_data, m_pixelSize);
-        }
+        release();
     }
 
     void allocate(int pixelSize) {
@@ -77,6 +76,13 @@ public:
         m_data = m_pool->malloc(m_pixelSize);
     }
 
+    void release() {
+        if (m_data) {
+            m_pool->free(m_data, m_pixelSize);
+            m_data = 0;
+        }
+    }
+
     inline quint8* data() const {
         return m_data;
     }
@@ -132,12 +138,12 @@ public:
     ~KisTextureTileUpdateInfo() {
     }
 
-    void retrieveData(KisImageWSP image, const QBitArray &channelFlags, bool onlyOneChannelSelected, int selectedChannelIndex)
+    void retrieveData(KisPaintDeviceSP projection, const QBitArray &channelFlags, bool onlyOneChannelSelected, int selectedChannelIndex)
     {
-        m_patchColorSpace = image->projection()->colorSpace();
+        m_patchColorSpace = projection->colorSpace();
         m_patchPixels.allocate(m_patchColorSpace->pixelSize());
 
-        image->projection()->readBytes(m_patchPixels.data(),
+        projection->readBytes(m_patchPixels.data(),
                                        m_patchRect.x(), m_patchRect.y(),
                                        m_patchRect.width(), m_patchRect.height());
 
@@ -226,14 +232,98 @@ public:
         }
     }
 
-    KoColorConversionTransformation *generateProofingTransform(const KoColorSpace* dstCS, const KoColorSpace* proofingSpace,
-                                                       KoColorConversionTransformation::Intent renderingIntent,
-                                                       KoColorConversionTransformation::Intent proofingIntent,
-                                                       KoColorConversionTransformation::ConversionFlags conversionFlags,
-                                                       KoColor gamutWarning,
-                                                       double adaptationState)
+    /**
+     * Compresses the pixels of the patch with \p compression and
+     * returns the uncompressed buffer back to the pool. The tile
+     * cannot be uploaded to the texture after that, use
+     * decompressedCopy() to get an uploadable version of it.
+     */
+    void compressData(KisAbstractCompression *compression)
+    {
+        if (isCompressed() || !m_patchPixels.data()) return;
+
+        const qint32 dataSize = patchDataSize();
+        DataBuffer linearizedPixels(m_patchColorSpace->pixelSize(), m_pool);
+
+        KisAbstractCompression::linearizeColors(m_patchPixels.data(), linearizedPixels.data(),
+                                                dataSize, pixelSize());
+
+        m_compressedPixels.resize(compression->outputBufferSize(dataSize));
+        const qint32 compressedSize =
+            compression->compress(linearizedPixels.data(), dataSize,
+                                  reinterpret_cast<quint8*>(m_compressedPixels.data()),
+                                  m_compressedPixels.size());
+
+        if (compressedSize <= 0) {
+            m_compressedPixels.clear();
+            return;
+        }
+
+        m_compressedPixels.resize(compressedSize);
+        m_compressedPixels.squeeze();
+        m_patchPixels.release();
+    }
+
+    /**
+     * Creates an uploadable copy of a tile that was compressed with
+     * compressData(). The tile itself stays compressed, so it can be
+     * restored as many times as needed.
+     */
+    KisTextureTileUpdateInfoSP decompressedCopy(KisAbstractCompression *compression) const
     {
-        return m_patchColorSpace->createProofingTransform(dstCS, proofingSpace, renderingIntent, proofingIntent, conversionFlags, gamutWarning.data(), adaptationState);
+        KisTextureTileUpdateInfoSP info(new KisTextureTileUpdateInfo(m_pool));
+
+        info->m_tileCol = m_tileCol;
+        info->m_tileRow = m_tileRow;
+        info->m_currentImageRect = m_currentImageRect;
+        info->m_tileRect = m_tileRect;
+        info->m_patchRect = m_patchRect;
+        info->m_patchColorSpace = m_patchColorSpace;
+        info->m_patchLevelOfDetail = m_patchLevelOfDetail;
+        info->m_originalPatchRect = m_originalPatchRect;
+        info->m_originalTileRect = m_originalTileRect;
+
+        info->m_patchPixels.allocate(m_patchColorSpace->pixelSize());
+
+        if (!isCompressed()) {
+            if (m_patchPixels.data()) {
+                memcpy(info->m_patchPixels.data(), m_patchPixels.data(), patchDataSize());
+            }
+            return info;
+        }
+
+        const qint32 dataSize = patchDataSize();
+        DataBuffer linearizedPixels(m_patchColorSpace->pixelSize(), m_pool);
+
+        const qint32 bytesRead =
+            compression->decompress(reinterpret_cast<const quint8*>(m_compressedPixels.constData()),
+                                    m_compressedPixels.size(),
+                                    linearizedPixels.data(), dataSize);
+        KIS_SAFE_ASSERT_RECOVER_NOOP(bytesRead == dataSize);
+
+        KisAbstractCompression::delinearizeColors(linearizedPixels.data(), info->m_patchPixels.data(),
+                                                  dataSize, pixelSize());
+        return info;
+    }
+
+    inline bool isCompressed() const {
+        return !m_compressedPixels.isEmpty();
+    }
+
+    /**
+     * The amount of memory the pixel data of the tile occupies
+     * in its current (compressed or not) state
+     */
+    inline qint64 memoryFootprint() const {
+        return isCompressed() ? m_compressedPixels.size() : m_patchPixels.size();
+    }
+
+    /**
+     * The amount of memory the pixel data would occupy
+     * when uncompressed
+     */
+    inline qint64 uncompressedMemoryFootprint() const {
+        return m_pool->chunkSize(m_patchColorSpace->pixelSize());
     }
 
     inline quint8* data() const {
@@ -300,6 +390,10 @@ public:
 private:
     Q_DISABLE_COPY(KisTextureTileUpdateInfo)
 
+    inline qint32 patchDataSize() const {
+        return m_patchRect.width() * m_patchRect.height() * m_patchColorSpace->pixelSize();
+    }
+
 private:
     qint32 m_tileCol;
     qint32 m_tileRow;
@@ -317,6 +411,7 @@ private:
     QRect m_originalTileRect;
 
     DataBuffer m_patchPixels;
+    QByteArray m_compressedPixels;
     KisTextureTileInfoPoolSP m_pool;
 };
 
@@ -26,6 +26,7 @@
 #include "opengl/kis_opengl_image_textures.h"
 #include "kis_time_range.h"
 #include "kis_keyframe_channel.h"
+#include <KoColorSpaceRegistry.h>
 
 #include "kundo2command.h"
 
@@ -100,4 +101,69 @@ void KisAnimationFrameCacheTest::testCache()
 
 }
 
+void addFrame(KisAnimationFrameCacheSP cache, KisImageSP image, int time)
+{
+    cache->addConvertedFrameData(cache->fetchFrameData(time, image->projection()), time);
+}
+
+void KisAnimationFrameCacheTest::testMemoryLimit()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, 256, 256, cs, "frame cache test");
+    KisPaintLayerSP layer = new KisPaintLayer(image, "", OPACITY_OPAQUE_U8);
+    image->addNode(layer);
+
+    KisImageAnimationInterface *animation = image->animationInterface();
+    animation->setFullClipRange(KisTimeRange::fromTime(0, 9));
+
+    KUndo2Command parentCommand;
+    KisKeyframeChannel *rasterChannel = layer->getKeyframeChannel(KisKeyframeChannel::Content.id());
+    for (int time = 1; time <= 5; time++) {
+        rasterChannel->addKeyframe(time, &parentCommand);
+    }
+    rasterChannel->addKeyframe(20, &parentCommand);
+
+    KisOpenGLImageTexturesSP glTex = KisOpenGLImageTextures::getImageTextures(image, 0, KoColorConversionTransformation::IntentPerceptual, KoColorConversionTransformation::Empty);
+    KisAnimationFrameCacheSP cache = new KisAnimationFrameCache(glTex);
+
+    addFrame(cache, image, 0);
+    const qint64 frameSize = cache->memoryUsage();
+    QVERIFY(frameSize > 0);
+
+    addFrame(cache, image, 1);
+    addFrame(cache, image, 2);
+    addFrame(cache, image, 3);
+    addFrame(cache, image, 20);
+
+    QCOMPARE(cache->memoryUsage(), 5 * frameSize);
+
+    /**
+     * The playhead is at frame 0. The frame outside the clip range
+     * is never reached by the playback, so it goes first, then the
+     * frame that is the farthest from the playhead.
+     */
+    cache->testingSetMemoryLimit(3 * frameSize + frameSize / 2);
+
+    QCOMPARE(cache->memoryUsage(), 3 * frameSize);
+    verifyRangeIsCachedStatus(cache, 0, 2, KisAnimationFrameCache::Cached);
+    QCOMPARE(cache->frameStatus(3), KisAnimationFrameCache::Uncached);
+    QCOMPARE(cache->frameStatus(20), KisAnimationFrameCache::Uncached);
+
+    /**
+     * The newly added frame is never evicted, even though it is
+     * the farthest one, frame 2 is dropped instead
+     */
+    addFrame(cache, image, 4);
+
+    QCOMPARE(cache->memoryUsage(), 3 * frameSize);
+    verifyRangeIsCachedStatus(cache, 0, 1, KisAnimationFrameCache::Cached);
+    QCOMPARE(cache->frameStatus(2), KisAnimationFrameCache::Uncached);
+    QCOMPARE(cache->frameStatus(4), KisAnimationFrameCache::Cached);
+
+    // frame 2 is closer to the playhead than frame 4, frame 5 is not
+    QVERIFY(cache->frameFitsIntoCache(2));
+    QVERIFY(!cache->frameFitsIntoCache(5));
+    QVERIFY(!cache->frameFitsIntoCache(20));
+}
+
 QTEST_MAIN(KisAnimationFrameCacheTest)
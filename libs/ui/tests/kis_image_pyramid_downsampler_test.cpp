@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_image_pyramid_downsampler_test.h"
+
+#include <QScopedPointer>
+#include "canvas/kis_image_pyramid_downsampler.h"
+
+
+void KisImagePyramidDownsamplerTest::testVectorMatchesScalar_data()
+{
+    QTest::addColumn<int>("numSrcPixels");
+    QTest::addColumn<int>("offset");
+
+    QTest::newRow("2px") << 2 << 0;
+    QTest::newRow("14px") << 14 << 0;
+    QTest::newRow("64px") << 64 << 0;
+    QTest::newRow("130px") << 130 << 0;
+    QTest::newRow("130px-unaligned") << 130 << 4;
+    QTest::newRow("4096px") << 4096 << 0;
+}
+
+void KisImagePyramidDownsamplerTest::testVectorMatchesScalar()
+{
+    QFETCH(int, numSrcPixels);
+    QFETCH(int, offset);
+
+    const int pixelSize = 4;
+    const int srcSize = numSrcPixels * pixelSize + offset;
+    const int dstSize = numSrcPixels / 2 * pixelSize + offset;
+
+    QVector<quint8> srcRow0(srcSize);
+    QVector<quint8> srcRow1(srcSize);
+
+    qsrand(numSrcPixels);
+    for (int i = 0; i < srcSize; i++) {
+        srcRow0[i] = qrand() & 0xff;
+        srcRow1[i] = qrand() & 0xff;
+    }
+
+    // check the extreme values as well
+    srcRow0[offset] = srcRow1[offset] = 255;
+    srcRow0[offset + pixelSize] = srcRow1[offset + pixelSize] = 255;
+
+    QVector<quint8> referenceRow(dstSize, 0);
+    QVector<quint8> resultRow(dstSize, 0);
+
+    QScopedPointer<KisImagePyramidDownsampler> scalar(KisImagePyramidDownsampler::createScalar());
+    QScopedPointer<KisImagePyramidDownsampler> optimized(KisImagePyramidDownsampler::create());
+
+    scalar->downsamplePixels(srcRow0.constData() + offset, srcRow1.constData() + offset,
+                             referenceRow.data() + offset, numSrcPixels);
+
+    optimized->downsamplePixels(srcRow0.constData() + offset, srcRow1.constData() + offset,
+                                resultRow.data() + offset, numSrcPixels);
+
+    QCOMPARE(resultRow, referenceRow);
+    QCOMPARE(int(referenceRow[offset]), 255);
+}
+
+QTEST_MAIN(KisImagePyramidDownsamplerTest)
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_image_pyramid_test.h"
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_image.h>
+#include <kis_paint_layer.h>
+#include <kis_group_layer.h>
+
+#include "canvas/kis_image_pyramid.h"
+
+
+QVector<quint8> readPlane(KisPaintDeviceSP plane, const QRect &rect)
+{
+    QVector<quint8> bytes(rect.width() * rect.height() * plane->pixelSize());
+    plane->readBytes(bytes.data(), rect);
+    return bytes;
+}
+
+void KisImagePyramidTest::testParallelMatchesSequential()
+{
+    // odd size, so that the last chunks are not aligned
+    const QRect imageRect(0, 0, 1001, 733);
+    const int pyramidHeight = 5;
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "pyramid test");
+    KisPaintLayerSP layer = new KisPaintLayer(image, "layer", OPACITY_OPAQUE_U8);
+    image->addNode(layer, image->rootLayer());
+
+    QVector<quint8> noise(imageRect.width() * imageRect.height() * cs->pixelSize());
+    qsrand(1);
+    for (int i = 0; i < noise.size(); i++) {
+        noise[i] = qrand() & 0xff;
+    }
+    layer->paintDevice()->writeBytes(noise.constData(), imageRect);
+    image->refreshGraph();
+
+    /**
+     * setImage() rebuilds all the levels, splitting the image
+     * into chunks processed by the thread pool
+     */
+    KisImagePyramid parallelPyramid(pyramidHeight);
+    parallelPyramid.setMonitorProfile(0,
+                                      KoColorConversionTransformation::internalRenderingIntent(),
+                                      KoColorConversionTransformation::internalConversionFlags());
+    parallelPyramid.setImage(image);
+
+    KisImagePyramid sequentialPyramid(pyramidHeight);
+    sequentialPyramid.setMonitorProfile(0,
+                                        KoColorConversionTransformation::internalRenderingIntent(),
+                                        KoColorConversionTransformation::internalConversionFlags());
+    sequentialPyramid.setImage(image);
+
+    for (int i = 1; i < pyramidHeight; i++) {
+        sequentialPyramid.m_pyramid[i]->clear();
+    }
+    sequentialPyramid.recalculateChunk(imageRect);
+
+    QRect planeRect = imageRect;
+
+    for (int i = 0; i < pyramidHeight; i++) {
+        KisPaintDeviceSP parallelPlane = parallelPyramid.m_pyramid[i];
+        KisPaintDeviceSP sequentialPlane = sequentialPyramid.m_pyramid[i];
+
+        QVERIFY(!parallelPlane->exactBounds().isEmpty());
+        QCOMPARE(parallelPlane->exactBounds(), sequentialPlane->exactBounds());
+        QVERIFY(readPlane(parallelPlane, planeRect) == readPlane(sequentialPlane, planeRect));
+
+        planeRect = QRect(0, 0, (planeRect.width() + 1) / 2, (planeRect.height() + 1) / 2);
+    }
+
+    // update a small unaligned area in the middle of the image
+    const QRect dirtyRect(251, 317, 300, 97);
+    KisPaintDeviceSP updatedPlane = parallelPyramid.m_pyramid[0];
+    updatedPlane->fill(dirtyRect, KoColor(Qt::red, updatedPlane->colorSpace()));
+    sequentialPyramid.m_pyramid[0]->fill(dirtyRect, KoColor(Qt::red, updatedPlane->colorSpace()));
+
+    parallelPyramid.recalculateLevels(dirtyRect);
+    sequentialPyramid.recalculateChunk(dirtyRect);
+
+    planeRect = imageRect;
+
+    for (int i = 0; i < pyramidHeight; i++) {
+        QVERIFY(readPlane(parallelPyramid.m_pyramid[i], planeRect) ==
+                readPlane(sequentialPyramid.m_pyramid[i], planeRect));
+
+        planeRect = QRect(0, 0, (planeRect.width() + 1) / 2, (planeRect.height() + 1) / 2);
+    }
+}
+
+QTEST_MAIN(KisImagePyramidTest)
@@ -21,6 +21,7 @@
 #include <QTest>
 
 #include <QBitArray>
+#include <QFile>
 
 #include <KisDocument.h>
 #include <KoDocumentInfo.h>
@@ -55,6 +56,9 @@
 #include <filter/kis_filter_registry.h>
 #include <generator/kis_generator_registry.h>
 
+#include <KoStore.h>
+#include "kra/kis_kra_save_cache.h"
+
 void KisKraSaverTest::initTestCase()
 {
     KisFilterRegistry::instance();
@@ -398,4 +402,123 @@ void KisKraSaverTest::testRoundTripColorizeMask()
     QCOMPARE(strokes[2].color.colorSpace(), weirdCS);
 }
 
+void KisKraSaverTest::testSaveCacheReusesEntries()
+{
+    const QByteArray data1(100000, 'a');
+    const QByteArray data2(200000, 'b');
+
+    KisKraSaveCache cache;
+
+    {
+        cache.beginSave();
+
+        QScopedPointer<KoStore> store(KoStore::createStore(QString("save_cache_1.zip"), KoStore::Write));
+        QVERIFY(store->open("layers/layer1"));
+        store->write(data1);
+        QVERIFY(store->close());
+        cache.registerEntry(store.data(), "layers/layer1", 1);
+
+        store->pushDirectory();
+        QVERIFY(store->enterDirectory("layers"));
+        QVERIFY(store->open("layer2"));
+        store->write(data2);
+        QVERIFY(store->close());
+        cache.registerEntry(store.data(), "layer2", 2);
+        store->popDirectory();
+
+        QVERIFY(store->finalize());
+        cache.endSave("save_cache_1.zip", true);
+    }
+
+    {
+        cache.beginSave();
+
+        QScopedPointer<KoStore> store(KoStore::createStore(QString("save_cache_2.zip"), KoStore::Write));
+        bool error = false;
+
+        // the revision has never been saved
+        QVERIFY(!cache.copyEntry(store.data(), "layers/layer0", 3, &error));
+        QVERIFY(!error);
+
+        // layers may get different names between the saves
+        QVERIFY(cache.copyEntry(store.data(), "layers/layer3", 1, &error));
+        QVERIFY(!error);
+        cache.registerEntry(store.data(), "layers/layer3", 1);
+
+        QVERIFY(cache.copyEntry(store.data(), "layers/layer4", 2, &error));
+        QVERIFY(!error);
+        cache.registerEntry(store.data(), "layers/layer4", 2);
+
+        cache.closeSource();
+        QVERIFY(store->finalize());
+        cache.endSave("save_cache_2.zip", true);
+    }
+
+    QScopedPointer<KoStore> store(KoStore::createStore(QString("save_cache_2.zip"), KoStore::Read));
+    QVERIFY(store->open("layers/layer3"));
+    QCOMPARE(store->read(store->size()), data1);
+    QVERIFY(store->close());
+    QVERIFY(store->open("layers/layer4"));
+    QCOMPARE(store->read(store->size()), data2);
+    QVERIFY(store->close());
+    store.reset();
+
+    // the entries can be copied from the latest file only
+    QFile::remove("save_cache_2.zip");
+
+    cache.beginSave();
+    QScopedPointer<KoStore> store3(KoStore::createStore(QString("save_cache_3.zip"), KoStore::Write));
+    bool error = false;
+    QVERIFY(!cache.copyEntry(store3.data(), "layers/layer1", 1, &error));
+    QVERIFY(!error);
+    cache.closeSource();
+    cache.endSave("save_cache_3.zip", false);
+}
+
+void KisKraSaverTest::testIncrementalSave()
+{
+    QRect imageRect(0,0,512,512);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(new KisSurrogateUndoStore(), imageRect.width(), imageRect.height(), cs, "test image");
+    KisPaintLayerSP layer1 = new KisPaintLayer(image, "paint1", OPACITY_OPAQUE_U8);
+    KisPaintLayerSP layer2 = new KisPaintLayer(image, "paint2", OPACITY_OPAQUE_U8);
+    image->addNode(layer1);
+    image->addNode(layer2);
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    doc->setCurrentImage(image);
+    doc->documentInfo()->setAboutInfo("title", image->objectName());
+
+    layer1->paintDevice()->fill(QRect(100, 100, 100, 100), KoColor(Qt::red, cs));
+    layer2->paintDevice()->fill(QRect(200, 200, 100, 100), KoColor(Qt::green, cs));
+
+    QVERIFY(doc->saveNativeFormat("incremental_save_1.kra"));
+
+    // layer1 is reused, layer2 is written again and gets a new layer in front of it
+    layer2->paintDevice()->fill(QRect(250, 250, 100, 100), KoColor(Qt::blue, cs));
+
+    KisPaintLayerSP layer3 = new KisPaintLayer(image, "paint3", OPACITY_OPAQUE_U8);
+    image->addNode(layer3, image->root(), 0);
+    layer3->paintDevice()->fill(QRect(0, 0, 50, 50), KoColor(Qt::white, cs));
+
+    QVERIFY(doc->saveNativeFormat("incremental_save_2.kra"));
+
+    // the third save has only unchanged layers
+    QVERIFY(doc->saveNativeFormat("incremental_save_3.kra"));
+
+    Q_FOREACH (const QString &fileName, QStringList() << "incremental_save_2.kra" << "incremental_save_3.kra") {
+        QScopedPointer<KisDocument> doc2(KisPart::instance()->createDocument());
+        QVERIFY(doc2->loadNativeFormat(fileName));
+
+        Q_FOREACH (KisPaintLayerSP layer, QList<KisPaintLayerSP>() << layer1 << layer2 << layer3) {
+            KisNodeSP node = TestUtil::findNode(doc2->image()->root(), layer->name());
+            QVERIFY(node);
+
+            QPoint errorPoint;
+            QVERIFY(TestUtil::comparePaintDevices(errorPoint, layer->paintDevice(), node->paintDevice()));
+        }
+    }
+}
+
 QTEST_MAIN(KisKraSaverTest)
@@ -41,6 +41,9 @@ private Q_SLOTS:
 
     void testRoundTripColorizeMask();
 
+    void testSaveCacheReusesEntries();
+    void testIncrementalSave();
+
 };
 
 #endif
@@ -0,0 +1,170 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_png_idat_encoder_test.h"
+
+#include <zlib.h>
+
+#include "kis_png_idat_encoder.h"
+
+
+namespace {
+
+quint8 paethPredictor(int a, int b, int c)
+{
+    const int pa = qAbs(b - c);
+    const int pb = qAbs(a - c);
+    const int pc = qAbs(a + b - 2 * c);
+
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+/**
+ * A straightforward implementation of the PNG decoding filters
+ */
+bool unfilterRow(int filter, quint8 *row, const quint8 *prior, int size, int bpp)
+{
+    for (int i = 0; i < size; i++) {
+        const int a = i >= bpp ? row[i - bpp] : 0;
+        const int b = prior[i];
+        const int c = i >= bpp ? prior[i - bpp] : 0;
+
+        switch (filter) {
+        case 0:
+            break;
+        case 1:
+            row[i] += a;
+            break;
+        case 2:
+            row[i] += b;
+            break;
+        case 3:
+            row[i] += (a + b) >> 1;
+            break;
+        case 4:
+            row[i] += paethPredictor(a, b, c);
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+void KisPNGIDATEncoderTest::testRoundTrip_data()
+{
+    QTest::addColumn<int>("rowBytes");
+    QTest::addColumn<int>("numRows");
+    QTest::addColumn<int>("bytesPerPixel");
+    QTest::addColumn<int>("compressionLevel");
+    QTest::addColumn<bool>("useFilters");
+    QTest::addColumn<bool>("swapBytes16");
+    QTest::addColumn<int>("blockSize");
+
+    QTest::newRow("rgba8") << 4 * 513 << 301 << 4 << 6 << true << false << 10000;
+    QTest::newRow("rgba8-level0") << 4 * 513 << 301 << 4 << 0 << true << false << 10000;
+    QTest::newRow("rgba16") << 8 * 257 << 300 << 8 << 9 << true << true << 10000;
+    QTest::newRow("gray8-row-per-block") << 77 << 1000 << 1 << 1 << true << false << 1;
+    QTest::newRow("gray8-single-block") << 77 << 1000 << 1 << 6 << true << false << (1 << 30);
+    QTest::newRow("packed-unfiltered") << 39 << 50 << 1 << 6 << false << false << 100;
+    QTest::newRow("single-pixel") << 3 << 1 << 3 << Z_DEFAULT_COMPRESSION << true << false << 10000;
+}
+
+void KisPNGIDATEncoderTest::testRoundTrip()
+{
+    QFETCH(int, rowBytes);
+    QFETCH(int, numRows);
+    QFETCH(int, bytesPerPixel);
+    QFETCH(int, compressionLevel);
+    QFETCH(bool, useFilters);
+    QFETCH(bool, swapBytes16);
+    QFETCH(int, blockSize);
+
+    qsrand(1);
+
+    QVector<QByteArray> rows(numRows);
+    QVector<const quint8*> rowPointers(numRows);
+
+    for (int y = 0; y < numRows; y++) {
+        rows[y].resize(rowBytes);
+        for (int x = 0; x < rowBytes; x++) {
+            // smooth gradients with some noise, so that all the filters get used
+            rows[y][x] = qrand() % 4 ? (3 * x + y) & 0xff : qrand() & 0xff;
+        }
+        rowPointers[y] = reinterpret_cast<const quint8*>(rows[y].constData());
+    }
+
+    KisPNGIDATEncoder encoder(rowPointers.constData(), numRows, rowBytes, bytesPerPixel, compressionLevel);
+    encoder.setUseFilters(useFilters);
+    encoder.setSwapBytes16(swapBytes16);
+    encoder.setBlockSize(blockSize);
+
+    QByteArray stream;
+    QByteArray chunk;
+    int numChunks = 0;
+    while (!(chunk = encoder.nextChunk()).isEmpty()) {
+        stream.append(chunk);
+        numChunks++;
+    }
+
+    QVERIFY(!encoder.failed());
+    QVERIFY(numChunks >= numRows / qMax(1, blockSize / rowBytes));
+
+    const int filteredRowBytes = rowBytes + 1;
+    QByteArray filtered(filteredRowBytes * numRows, 0);
+    uLongf filteredSize = filtered.size();
+
+    // uncompress() checks both the zlib header and the Adler-32 trailer
+    QCOMPARE(uncompress(reinterpret_cast<Bytef*>(filtered.data()), &filteredSize,
+                        reinterpret_cast<const Bytef*>(stream.constData()), stream.size()),
+             Z_OK);
+    QCOMPARE(int(filteredSize), filtered.size());
+
+    QByteArray prior(rowBytes, 0);
+
+    for (int y = 0; y < numRows; y++) {
+        const int filter = quint8(filtered[y * filteredRowBytes]);
+        if (!useFilters || compressionLevel == 0) {
+            QCOMPARE(filter, 0);
+        }
+
+        QByteArray row = filtered.mid(y * filteredRowBytes + 1, rowBytes);
+        QVERIFY(unfilterRow(filter,
+                            reinterpret_cast<quint8*>(row.data()),
+                            reinterpret_cast<const quint8*>(prior.constData()),
+                            rowBytes, bytesPerPixel));
+
+        QByteArray expected = rows[y];
+        if (swapBytes16) {
+            for (int x = 0; x < rowBytes - 1; x += 2) {
+                const char tmp = expected[x];
+                expected[x] = expected[x + 1];
+                expected[x + 1] = tmp;
+            }
+        }
+
+        QCOMPARE(row, expected);
+        prior = row;
+    }
+}
+
+QTEST_MAIN(KisPNGIDATEncoderTest)
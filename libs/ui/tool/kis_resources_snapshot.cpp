@@ -295,6 +295,11 @@ KoPattern* KisResourcesSnapshot::currentPattern() const
     return m_d->currentPattern;
 }
 
+KoAbstractGradient* KisResourcesSnapshot::currentGradient() const
+{
+    return m_d->currentGradient;
+}
+
 KoColor KisResourcesSnapshot::currentFgColor() const
 {
     return m_d->currentFgColor;
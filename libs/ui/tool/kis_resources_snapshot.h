@@ -32,6 +32,7 @@ class KisPainter;
 class KisPostExecutionUndoAdapter;
 class KisRecordedPaintAction;
 class KoPattern;
+class KoAbstractGradient;
 
 /**
  * @brief The KisResourcesSnapshot class takes a snapshot of the various resources
@@ -77,6 +78,7 @@ public:
     QString compositeOpId() const;
 
     KoPattern* currentPattern() const;
+    KoAbstractGradient* currentGradient() const;
     KoColor currentFgColor() const;
     KoColor currentBgColor() const;
     KisPaintOpPresetSP currentPaintOpPreset() const;
@@ -18,6 +18,10 @@
 
 #include "freehand_stroke.h"
 
+#include <QElapsedTimer>
+#include <QRegion>
+#include <QtMath>
+
 #include "kis_canvas_resource_provider.h"
 #include <brushengine/kis_paintop_preset.h>
 #include <brushengine/kis_paintop_settings.h>
@@ -28,12 +32,78 @@
 #include <brushengine/kis_stroke_random_source.h>
 
 
+namespace {
+
+/**
+ * A batch of merged segments should not take longer than half
+ * a frame, otherwise the user would notice the delay
+ */
+const qint64 batchTimeBudget = 8000000; // ns
+const int maxBatchSizeLimit = 64;
+const int tileSize = 64;
+
+bool isMergeableSegment(const FreehandStrokeStrategy::Data *d)
+{
+    return d->batch.isEmpty() &&
+        (d->type == FreehandStrokeStrategy::Data::POINT ||
+         d->type == FreehandStrokeStrategy::Data::LINE ||
+         d->type == FreehandStrokeStrategy::Data::CURVE);
+}
+
+QVector<QRect> alignToTiles(const QVector<QRect> &rects)
+{
+    QRegion region;
+
+    Q_FOREACH (const QRect &rc, rects) {
+        if (rc.isEmpty()) continue;
+
+        const int left = qFloor(qreal(rc.left()) / tileSize) * tileSize;
+        const int top = qFloor(qreal(rc.top()) / tileSize) * tileSize;
+        const int right = qFloor(qreal(rc.right()) / tileSize) * tileSize + tileSize - 1;
+        const int bottom = qFloor(qreal(rc.bottom()) / tileSize) * tileSize + tileSize - 1;
+
+        region += QRect(QPoint(left, top), QPoint(right, bottom));
+    }
+
+    return region.rects();
+}
+
+}
+
 struct FreehandStrokeStrategy::Private
 {
-    Private(KisResourcesSnapshotSP _resources) : resources(_resources) {}
+    Private(KisResourcesSnapshotSP _resources)
+        : resources(_resources),
+          maxBatchSize(maxBatchSizeLimit / 4),
+          averageSegmentTime(0)
+    {
+    }
+
+    Private(const Private &rhs)
+        : randomSource(rhs.randomSource),
+          resources(rhs.resources),
+          maxBatchSize(int(rhs.maxBatchSize)),
+          averageSegmentTime(0)
+    {
+    }
 
     KisStrokeRandomSource randomSource;
     KisResourcesSnapshotSP resources;
+
+    /**
+     * Written by the stroke job, read by the strokes queue
+     */
+    QAtomicInt maxBatchSize;
+    qreal averageSegmentTime;
+
+    void updateBatchSize(qint64 jobTime, int numSegments) {
+        const qreal segmentTime = qreal(jobTime) / numSegments;
+
+        averageSegmentTime = averageSegmentTime > 0 ?
+            0.8 * averageSegmentTime + 0.2 * segmentTime : segmentTime;
+
+        maxBatchSize.store(qBound(1, int(batchTimeBudget / qMax(averageSegmentTime, 1.0)), maxBatchSizeLimit));
+    }
 };
 
 FreehandStrokeStrategy::FreehandStrokeStrategy(bool needsIndirectPainting,
@@ -86,10 +156,54 @@ void FreehandStrokeStrategy::init(bool needsIndirectPainting,
 void FreehandStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
 {
     Data *d = dynamic_cast<Data*>(data);
+    KisRandomSourceSP rnd = m_d->randomSource.source();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<QRect> dirtyRects = paintData(d, rnd);
+
+    if (!d->batch.isEmpty()) {
+        Q_FOREACH (const QSharedPointer<Data> &item, d->batch) {
+            dirtyRects += paintData(item.data(), rnd);
+        }
+
+        /**
+         * The segments of a batch overlap a lot, so pass the whole
+         * area to the update queue in tile-sized pieces instead
+         */
+        dirtyRects = alignToTiles(dirtyRects);
+    }
+
+    m_d->updateBatchSize(timer.nsecsElapsed(), 1 + d->batch.size());
+
+    KisUpdateTimeMonitor::instance()->reportJobFinished(data, dirtyRects);
+    d->node->setDirty(dirtyRects);
+}
+
+bool FreehandStrokeStrategy::tryMergeJobData(KisStrokeJobData *target, const KisStrokeJobData *next)
+{
+    Data *d = dynamic_cast<Data*>(target);
+    const Data *nextData = dynamic_cast<const Data*>(next);
+
+    if (!d || !nextData ||
+        d->node != nextData->node ||
+        !isMergeableSegment(nextData) ||
+        (d->batch.isEmpty() && !isMergeableSegment(d)) ||
+        1 + d->batch.size() >= m_d->maxBatchSize) {
+
+        return false;
+    }
+
+    d->batch.append(QSharedPointer<Data>(new Data(*nextData)));
+    return true;
+}
+
+QVector<QRect> FreehandStrokeStrategy::paintData(Data *d, KisRandomSourceSP rnd)
+{
     PainterInfo *info = painterInfos()[d->painterInfoId];
 
     KisUpdateTimeMonitor::instance()->reportPaintOpPreset(info->painter->preset());
-    KisRandomSourceSP rnd = m_d->randomSource.source();
 
     switch(d->type) {
     case Data::POINT:
@@ -135,9 +249,7 @@ void FreehandStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
 
     };
 
-    QVector<QRect> dirtyRects = info->painter->takeDirtyRegion();
-    KisUpdateTimeMonitor::instance()->reportJobFinished(data, dirtyRects);
-    d->node->setDirty(dirtyRects);
+    return info->painter->takeDirtyRegion();
 }
 
 KisStrokeStrategy* FreehandStrokeStrategy::createLodClone(int levelOfDetail)
@@ -19,6 +19,8 @@
 #ifndef __FREEHAND_STROKE_H
 #define __FREEHAND_STROKE_H
 
+#include <QSharedPointer>
+
 #include "kritaui_export.h"
 #include "kis_types.h"
 #include "kis_node.h"
@@ -143,6 +145,10 @@ public:
             case Data::PAINTER_PATH:
                 path = t.map(rhs.path);
             };
+
+            Q_FOREACH (const QSharedPointer<Data> &item, rhs.batch) {
+                batch.append(QSharedPointer<Data>(new Data(*item, levelOfDetail)));
+            }
         }
     public:
         KisNodeSP node;
@@ -159,6 +165,13 @@ public:
         QPainterPath path;
         QPen pen;
         KoColor customColor;
+
+        /**
+         * The segments of the following jobs merged into this one
+         * by tryMergeJobData(). They are painted in order after the
+         * segment of this job.
+         */
+        QVector<QSharedPointer<Data> > batch;
     };
 
 public:
@@ -178,6 +191,8 @@ public:
 
     void doStrokeCallback(KisStrokeJobData *data);
 
+    bool tryMergeJobData(KisStrokeJobData *target, const KisStrokeJobData *next);
+
     KisStrokeStrategy* createLodClone(int levelOfDetail);
 
 protected:
@@ -185,6 +200,7 @@ protected:
 
 private:
     void init(bool needsIndirectPainting, const QString &indirectPaintingCompositeOp);
+    QVector<QRect> paintData(Data *d, KisRandomSourceSP rnd);
 
 private:
     struct Private;
@@ -26,6 +26,7 @@
 #include <kis_debug.h>
 #include <klocalizedstring.h>
 
+#include <KoColorAdjustmentKernels.h>
 #include <KoColorConversions.h>
 #include <KoColorModelStandardIds.h>
 #include <KoColorSpace.h>
@@ -34,11 +35,12 @@
 #include <KoID.h>
 #include <kis_hsv_adjustment.h>
 
+#include <QScopedPointer>
+
 
 #define SCALE_TO_FLOAT( v ) KoColorSpaceMaths< _channel_type_, float>::scaleToA( v )
 #define SCALE_FROM_FLOAT( v  ) KoColorSpaceMaths< float, _channel_type_>::scaleToA( v )
 
-class KisColorBalanceMath;
 template<typename _channel_type_, typename traits>
 class KisColorBalanceAdjustment : public KoColorTransformation
 {
@@ -46,41 +48,54 @@ class KisColorBalanceAdjustment : public KoColorTransformation
     typedef typename RGBTrait::Pixel RGBPixel;
 
 public:
-    KisColorBalanceAdjustment(){}
+    KisColorBalanceAdjustment()
+        : m_kernels(KoColorAdjustmentKernels::create())
+    {
+    }
 
 void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const
 {
-    KisColorBalanceMath bal;
     const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
     RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
-    float value_red, value_green, value_blue, hue, saturation, lightness;
+
+    KoColorAdjustmentKernels::ColorBalance params;
+    params.shadows[0] = m_cyan_shadows;
+    params.shadows[1] = m_magenta_shadows;
+    params.shadows[2] = m_yellow_shadows;
+    params.midtones[0] = m_cyan_midtones;
+    params.midtones[1] = m_magenta_midtones;
+    params.midtones[2] = m_yellow_midtones;
+    params.highlights[0] = m_cyan_highlights;
+    params.highlights[1] = m_magenta_highlights;
+    params.highlights[2] = m_yellow_highlights;
+    params.preserveLuminosity = m_preserve_luminosity;
+
+    const int chunkSize = 256;
+    float r[chunkSize];
+    float g[chunkSize];
+    float b[chunkSize];
 
     while(nPixels > 0) {
+        const int numChunkPixels = qMin(nPixels, chunkSize);
 
-        float red = SCALE_TO_FLOAT(src->red);
-        float green = SCALE_TO_FLOAT(src->green);
-        float blue = SCALE_TO_FLOAT(src->blue);
-        RGBToHSL(red, green, blue, &hue, &saturation, &lightness);
-
-        value_red = bal.colorBalanceTransform(red, lightness, m_cyan_shadows, m_cyan_midtones, m_cyan_highlights);
-        value_green = bal.colorBalanceTransform(green, lightness, m_magenta_shadows, m_magenta_midtones, m_magenta_highlights);
-        value_blue = bal.colorBalanceTransform(blue, lightness, m_yellow_shadows, m_yellow_midtones, m_yellow_highlights);
-
-        if(m_preserve_luminosity)
-        {
-            float h1, s1, l1, h2, s2, l2;
-            RGBToHSL(SCALE_TO_FLOAT(src->red), SCALE_TO_FLOAT(src->green), SCALE_TO_FLOAT(src->blue), &h1, &s1, &l1);
-            RGBToHSL(value_red, value_green, value_blue, &h2, &s2, &l2);
-            HSLToRGB(h2, s2, l1, &value_red, &value_green, &value_blue);
+        for (int i = 0; i < numChunkPixels; i++) {
+            r[i] = SCALE_TO_FLOAT(src[i].red);
+            g[i] = SCALE_TO_FLOAT(src[i].green);
+            b[i] = SCALE_TO_FLOAT(src[i].blue);
         }
-        dst->red = SCALE_FROM_FLOAT(value_red);
-        dst->green = SCALE_FROM_FLOAT(value_green);
-        dst->blue = SCALE_FROM_FLOAT(value_blue);
-        dst->alpha = src->alpha;
-
-        --nPixels;
-        ++src;
-        ++dst;
+
+        m_kernels->colorBalance(r, g, b, numChunkPixels, params);
+
+        for (int i = 0; i < numChunkPixels; i++) {
+            dst[i].red = SCALE_FROM_FLOAT(r[i]);
+            dst[i].green = SCALE_FROM_FLOAT(g[i]);
+            dst[i].blue = SCALE_FROM_FLOAT(b[i]);
+            dst[i].alpha = src[i].alpha;
+        }
+
+        nPixels -= numChunkPixels;
+        src += numChunkPixels;
+        dst += numChunkPixels;
     }
 }
 
@@ -162,6 +177,7 @@ private:
     double m_cyan_midtones, m_magenta_midtones, m_yellow_midtones,  m_cyan_shadows, m_magenta_shadows, m_yellow_shadows,
            m_cyan_highlights, m_magenta_highlights, m_yellow_highlights;
     bool m_preserve_luminosity;
+    QScopedPointer<KoColorAdjustmentKernels> m_kernels;
 };
 
  KisColorBalanceAdjustmentFactory::KisColorBalanceAdjustmentFactory()
@@ -206,23 +222,3 @@ KoColorTransformation* KisColorBalanceAdjustmentFactory::createTransformation(co
     return adj;
 
 }
-
-KisColorBalanceMath::KisColorBalanceMath(){}
-
-
-float KisColorBalanceMath::colorBalanceTransform(float value, float lightness, float shadows, float midtones, float highlights)
-{
-      static const float a = 0.25, b = 0.333, scale = 0.7;
-
-      shadows *= CLAMP ((lightness - b) / -a + 0.5, 0, 1) * scale;
-      midtones *= CLAMP ((lightness - b) /  a + 0.5, 0, 1) * CLAMP ((lightness + b - 1) / -a + 0.5, 0, 1) * scale;
-      highlights *= CLAMP ((lightness + b - 1) /  a + 0.5, 0, 1) * scale;
-
-      value += shadows;
-      value += midtones;
-      value += highlights;
-      value = CLAMP (value, 0.0, 1.0);
-
-      return value;
-}
-
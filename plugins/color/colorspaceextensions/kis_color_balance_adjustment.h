@@ -34,13 +34,4 @@ public:
 
 };
 
-class KisColorBalanceMath
-{
-public:
-
-    KisColorBalanceMath();
-
-    float colorBalanceTransform(float value, float lightness, float shadows, float midtones, float highlights);
-};
-
 #endif
@@ -26,6 +26,7 @@
 #include <kis_debug.h>
 #include <klocalizedstring.h>
 
+#include <KoColorAdjustmentKernels.h>
 #include <KoColorConversions.h>
 #include <KoColorModelStandardIds.h>
 #include <KoColorSpace.h>
@@ -33,6 +34,8 @@
 #include <KoColorTransformation.h>
 #include <KoID.h>
 
+#include <QScopedPointer>
+
 #define SCALE_TO_FLOAT( v ) KoColorSpaceMaths< _channel_type_, float>::scaleToA( v )
 #define SCALE_FROM_FLOAT( v  ) KoColorSpaceMaths< float, _channel_type_>::scaleToA( v )
 
@@ -91,7 +94,8 @@ public:
         m_lumaGreen(0.0),
         m_lumaBlue(0.0),
         m_type(0),
-        m_colorize(false)
+        m_colorize(false),
+        m_kernels(KoColorAdjustmentKernels::create())
     {
     }
 
@@ -99,6 +103,10 @@ public:
 
     void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const
     {
+        if (!m_colorize && (m_type == 0 || m_type == 1)) {
+            transformWithKernels(srcU8, dstU8, nPixels);
+            return;
+        }
 
         //if (m_model="RGBA" || m_colorize) {
         /*It'd be nice to have LCH automatically selector for LAB in the future, but I don't know how to select LAB 
@@ -144,34 +152,8 @@ public:
                 }
                 else {
 
-                    if (m_type == 0) {
-                        RGBToHSV(SCALE_TO_FLOAT(src->red), SCALE_TO_FLOAT(src->green), SCALE_TO_FLOAT(src->blue), &h, &s, &v);
-                        h += m_adj_h * 180;
-                        if (h > 360) h -= 360;
-                        if (h < 0) h += 360;
-                        s += m_adj_s;
-                        v += m_adj_v;
-                        HSVToRGB(h, s, v, &r, &g, &b);
-                    } else if (m_type == 1) {
-
-                        RGBToHSL(SCALE_TO_FLOAT(src->red), SCALE_TO_FLOAT(src->green), SCALE_TO_FLOAT(src->blue), &h, &s, &v);
-
-                        h += m_adj_h * 180;
-                        if (h > 360) h -= 360;
-                        if (h < 0) h += 360;
-
-                        s *= (m_adj_s + 1.0);
-                        if (s < 0.0) s = 0.0;
-                        if (s > 1.0) s = 1.0;
-
-                        if (m_adj_v < 0)
-                            v *= (m_adj_v + 1.0);
-                        else
-                            v += (m_adj_v * (1.0 - v));
-
-
-                        HSLToRGB(h, s, v, &r, &g, &b);
-                    } else if (m_type == 2){
+                    // HSV (0) and HSL (1) are handled by transformWithKernels()
+                    if (m_type == 2) {
 
                         qreal red = SCALE_TO_FLOAT(src->red);
                         qreal green = SCALE_TO_FLOAT(src->green);
@@ -373,12 +355,61 @@ public:
         }
     }
 
+private:
+
+    /**
+     * HSV and HSL adjustments are done by the vectorized kernels:
+     * the pixels are unpacked into planar float buffers chunk by
+     * chunk, adjusted and packed back
+     */
+    void transformWithKernels(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const
+    {
+        const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
+        RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
+
+        const int chunkSize = 256;
+        float r[chunkSize];
+        float g[chunkSize];
+        float b[chunkSize];
+
+        const float hueShift = m_adj_h * 180;
+
+        while (nPixels > 0) {
+            const int numChunkPixels = qMin(nPixels, chunkSize);
+
+            for (int i = 0; i < numChunkPixels; i++) {
+                r[i] = SCALE_TO_FLOAT(src[i].red);
+                g[i] = SCALE_TO_FLOAT(src[i].green);
+                b[i] = SCALE_TO_FLOAT(src[i].blue);
+            }
+
+            if (m_type == 0) {
+                m_kernels->adjustHSV(r, g, b, numChunkPixels, hueShift, m_adj_s, m_adj_v);
+            } else {
+                m_kernels->adjustHSL(r, g, b, numChunkPixels, hueShift, m_adj_s + 1.0, m_adj_v);
+            }
+
+            for (int i = 0; i < numChunkPixels; i++) {
+                clamp< _channel_type_ >(&r[i], &g[i], &b[i]);
+                dst[i].red = SCALE_FROM_FLOAT(r[i]);
+                dst[i].green = SCALE_FROM_FLOAT(g[i]);
+                dst[i].blue = SCALE_FROM_FLOAT(b[i]);
+                dst[i].alpha = src[i].alpha;
+            }
+
+            nPixels -= numChunkPixels;
+            src += numChunkPixels;
+            dst += numChunkPixels;
+        }
+    }
+
 private:
 
     double m_adj_h, m_adj_s, m_adj_v;
     qreal m_lumaRed, m_lumaGreen, m_lumaBlue;
     int m_type;
     bool m_colorize;
+    QScopedPointer<KoColorAdjustmentKernels> m_kernels;
 };
 
 
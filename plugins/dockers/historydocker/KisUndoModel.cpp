@@ -205,6 +205,15 @@ QVariant KisUndoModel::data(const QModelIndex &index, int role) const
         KUndo2Command* currentCommand = const_cast<KUndo2Command*>(m_stack->command(index.row() - 1));
         return currentCommand->isMerged()?m_stack->text(index.row() - 1)+"(Merged)":m_stack->text(index.row() - 1);
     }
+    else if (role == Qt::ToolTipRole) {
+        if (index.row() > 0) {
+            const KUndo2Command* currentCommand = m_stack->command(index.row() - 1);
+            const qreal memoryMiB = qreal(currentCommand->memoryUsage()) / (1024 * 1024);
+            return i18n("%1\nMemory used: %2 MiB",
+                        m_stack->text(index.row() - 1),
+                        QString::number(memoryMiB, 'f', 1));
+        }
+    }
     else if (role == Qt::DecorationRole) {
         if (index.row() > 0) {
             const KUndo2Command* currentCommand = m_stack->command(index.row() - 1);
@@ -36,6 +36,13 @@ KisConvolutionFilter::KisConvolutionFilter(const KoID& id, const KoID & category
         : KisFilter(id, category, entry)
 {
     setColorSpaceIndependence(FULLY_INDEPENDENT);
+
+    /**
+     * The kernels are fixed 3x3 matrices and cannot be scaled down,
+     * so on a scaled device they cover a bit wider area of the image.
+     * It is still a decent preview of the final result.
+     */
+    setSupportsLevelOfDetail(true);
 }
 
 
@@ -65,6 +72,22 @@ void KisConvolutionFilter::processImpl(KisPaintDeviceSP device,
 
 }
 
+QRect KisConvolutionFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    Q_UNUSED(_config);
+    Q_UNUSED(lod);
+
+    const int halfWidth = m_matrix->width() / 2;
+    const int halfHeight = m_matrix->height() / 2;
+
+    return rect.adjusted(-halfWidth, -halfHeight, halfWidth, halfHeight);
+}
+
+QRect KisConvolutionFilter::changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    return neededRect(rect, _config, lod);
+}
+
 void KisConvolutionFilter::setIgnoreAlpha(bool v)
 {
     m_ignoreAlpha = v;
@@ -36,6 +36,9 @@ public:
                      const QRect& applyRect,
                      const KisFilterConfigurationSP config,
                      KoUpdater* progressUpdater) const;
+
+    QRect neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const;
+    QRect changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const;
 protected:
     void setIgnoreAlpha(bool v);
 
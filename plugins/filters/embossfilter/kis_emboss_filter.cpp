@@ -46,6 +46,7 @@
 #include <filter/kis_filter_configuration.h>
 #include <kis_paint_device.h>
 #include <kis_processing_information.h>
+#include <kis_lod_transform.h>
 
 #include "widgets/kis_multi_integer_filter_widget.h"
 #include <kis_iterator_ng.h>
@@ -56,6 +57,7 @@ KisEmbossFilter::KisEmbossFilter() : KisFilter(id(), categoryEmboss(), i18n("&Em
     setColorSpaceIndependence(TO_RGBA8);
     setSupportsThreading(false);
     setSupportsAdjustmentLayers(false);
+    setSupportsLevelOfDetail(true);
 }
 
 KisFilterConfigurationSP KisEmbossFilter::factoryConfiguration(const KisPaintDeviceSP) const
@@ -93,7 +95,12 @@ void KisEmbossFilter::processImpl(KisPaintDeviceSP device,
     //the actual filter function from digikam. It needs a pointer to a quint8 array
     //with the actual pixel data.
 
-    float Depth = embossdepth / 10.0;
+    /**
+     * On a scaled device the one-pixel difference spans 2^lod pixels
+     * of the original image, so the depth is scaled down accordingly
+     */
+    KisLodTransformScalar t(device);
+    float Depth = t.scale(embossdepth / 10.0);
     int    R = 0, G = 0, B = 0;
     uchar  Gray = 0;
     int Width = applyRect.width();
@@ -111,7 +118,7 @@ void KisEmbossFilter::processImpl(KisPaintDeviceSP device,
     
         // XXX: COLORSPACE_INDEPENDENCE or at least work IN RGB16A
         device->colorSpace()->toQColor(it.oldRawData(), &color1);
-        acc->moveTo(srcTopLeft.x() + it.x() + Lim_Max(it.x(), 1, Width), srcTopLeft.y() + it.y() + Lim_Max(it.y(), 1, Height));
+        acc->moveTo(it.x() + Lim_Max(it.x() - srcTopLeft.x(), 1, Width), it.y() + Lim_Max(it.y() - srcTopLeft.y(), 1, Height));
 
         device->colorSpace()->toQColor(acc->oldRawData(), &color2);
 
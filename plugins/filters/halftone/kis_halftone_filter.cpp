@@ -33,6 +33,7 @@
 #include <kis_sequential_iterator.h>
 #include <kis_types.h>
 #include <kis_painter.h>
+#include <kis_lod_transform.h>
 
 #include "kis_halftone_filter.h"
 
@@ -55,7 +56,7 @@ KisHalftoneFilter::KisHalftoneFilter()
 
     setSupportsPainting(false);
     setShowConfigurationWidget(true);
-    setSupportsLevelOfDetail(false);
+    setSupportsLevelOfDetail(true);
     setSupportsAdjustmentLayers(false);
     setSupportsThreading(false);
 }
@@ -66,7 +67,9 @@ void KisHalftoneFilter::processImpl(KisPaintDeviceSP device,
                                     const KisFilterConfigurationSP config,
                                     KoUpdater *progressUpdater) const
 {
-    qreal cellSize = (qreal)config->getInt("cellSize", 8);
+    KisLodTransformScalar t(device);
+
+    qreal cellSize = t.scale((qreal)config->getInt("cellSize", 8));
     qreal angle = fmod((qreal)config->getInt("patternAngle", 45), 90.0);
     KoColor foregroundC(Qt::black, device->colorSpace());
     foregroundC.fromKoColor(config->getColor("foreGroundColor", KoColor(Qt::black, device->colorSpace()) ) );
@@ -165,6 +168,19 @@ void KisHalftoneFilter::processImpl(KisPaintDeviceSP device,
     }
 }
 
+bool KisHalftoneFilter::supportsLevelOfDetail(const KisFilterConfigurationSP config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+
+    /**
+     * The grid is anchored at the image origin, so the scaled cells
+     * line up with the full-resolution ones. Just don't let them get
+     * smaller than the configuration widget itself allows.
+     */
+    const qreal cellSize = config ? (qreal)config->getInt("cellSize", 8) : 8.0;
+    return t.scale(cellSize) >= 3.0;
+}
+
 KisFilterConfigurationSP KisHalftoneFilter::factoryConfiguration(const KisPaintDeviceSP dev) const
 {
     Q_UNUSED(dev);
@@ -81,6 +81,8 @@ public:
 
     virtual KisConfigWidget *createConfigurationWidget(QWidget *parent, const KisPaintDeviceSP dev) const;
 
+    virtual bool supportsLevelOfDetail(const KisFilterConfigurationSP config, int lod) const;
+
 private:
     QPolygonF m_gridPoints;
 };
@@ -65,6 +65,13 @@ KisFilterNoise::KisFilterNoise() : KisFilter(id(), categoryOther(), i18n("&Rando
 {
     setColorSpaceIndependence(FULLY_INDEPENDENT);
     setSupportsPainting(true);
+
+    /**
+     * The noise is generated per-pixel, so on a scaled device we get
+     * a different pattern with the same density, which is good
+     * enough for the preview
+     */
+    setSupportsLevelOfDetail(true);
 }
 
 KisFilterConfigurationSP KisFilterNoise::factoryConfiguration(const KisPaintDeviceSP) const
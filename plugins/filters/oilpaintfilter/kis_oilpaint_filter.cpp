@@ -48,6 +48,7 @@
 #include <filter/kis_filter_configuration.h>
 #include <kis_processing_information.h>
 #include <kis_paint_device.h>
+#include <kis_lod_transform.h>
 #include "widgets/kis_multi_integer_filter_widget.h"
 
 
@@ -56,6 +57,7 @@ KisOilPaintFilter::KisOilPaintFilter() : KisFilter(id(), KisFilter::categoryArti
     setSupportsPainting(true);
     setSupportsThreading(false);
     setSupportsAdjustmentLayers(true);
+    setSupportsLevelOfDetail(true);
 }
 
 void KisOilPaintFilter::processImpl(KisPaintDeviceSP device,
@@ -71,7 +73,9 @@ void KisOilPaintFilter::processImpl(KisPaintDeviceSP device,
     qint32 height = applyRect.height();
 
     //read the filter configuration values from the KisFilterConfiguration object
-    quint32 brushSize = config ? config->getInt("brushSize", 1) : 1;
+    KisLodTransformScalar t(device);
+
+    quint32 brushSize = qMax(1, qRound(t.scale(config ? config->getInt("brushSize", 1) : 1)));
     quint32 smooth = config ? config->getInt("smooth", 30) : 30;
 
     OilPaint(device, device, srcTopLeft, applyRect.topLeft(), width, height, brushSize, smooth, progressUpdater);
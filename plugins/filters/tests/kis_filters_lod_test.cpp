@@ -0,0 +1,258 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_filters_lod_test.h"
+#include <QTest>
+
+#include <KoColorSpaceRegistry.h>
+
+#include "filter/kis_filter.h"
+#include "filter/kis_filter_configuration.h"
+#include "filter/kis_filter_registry.h"
+#include "kis_debug.h"
+#include "kis_assert.h"
+#include "kis_default_bounds_base.h"
+#include "kis_lod_transform.h"
+#include "kis_paint_device.h"
+#include "krita_utils.h"
+
+
+struct TestingLodDefaultBounds : public KisDefaultBoundsBase {
+    TestingLodDefaultBounds(const QRect &bounds)
+        : m_lod(0), m_bounds(bounds) {}
+
+    QRect bounds() const {
+        return m_bounds;
+    }
+    bool wrapAroundMode() const {
+        return false;
+    }
+
+    int currentLevelOfDetail() const {
+        return m_lod;
+    }
+
+    int currentTime() const {
+        return 0;
+    }
+    bool externalFrameActive() const {
+        return false;
+    }
+
+    void testingSetLevelOfDetail(int lod) {
+        m_lod = lod;
+    }
+
+private:
+    int m_lod;
+    QRect m_bounds;
+};
+
+void syncLodCache(KisPaintDeviceSP dev, int levelOfDetail)
+{
+    KisPaintDevice::LodDataStruct* s = dev->createLodDataStruct(levelOfDetail);
+
+    QRegion region = dev->regionForLodSyncing();
+    Q_FOREACH(QRect rect2, KritaUtils::splitRegionIntoPatches(region, KritaUtils::optimalPatchSize())) {
+        dev->updateLodDataStruct(s, rect2);
+    }
+
+    dev->uploadLodDataStruct(s);
+}
+
+KisPaintDeviceSP createDevice(const QImage &image, TestingLodDefaultBounds **bounds)
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    *bounds = new TestingLodDefaultBounds(image.rect());
+    dev->setDefaultBounds(*bounds);
+    dev->convertFromQImage(image, 0, 0, 0);
+
+    return dev;
+}
+
+/**
+ * The filters are not expected to generate exactly the same pixels on
+ * a scaled device, so we compare the averages of small blocks instead.
+ * Returns the mean absolute difference of the blocks in 8-bit levels.
+ */
+qreal blockDifference(const QImage &image1, const QImage &image2, int blockSize)
+{
+    KIS_ASSERT_RECOVER_RETURN_VALUE(image1.size() == image2.size(), 255.0);
+
+    qreal totalDifference = 0;
+    int numSamples = 0;
+
+    for (int by = 0; by < image1.height(); by += blockSize) {
+        for (int bx = 0; bx < image1.width(); bx += blockSize) {
+            const QRect block = QRect(bx, by, blockSize, blockSize) & image1.rect();
+
+            qreal sum1[4] = {0, 0, 0, 0};
+            qreal sum2[4] = {0, 0, 0, 0};
+
+            for (int y = block.top(); y <= block.bottom(); y++) {
+                for (int x = block.left(); x <= block.right(); x++) {
+                    const QRgb p1 = image1.pixel(x, y);
+                    const QRgb p2 = image2.pixel(x, y);
+
+                    sum1[0] += qRed(p1);   sum2[0] += qRed(p2);
+                    sum1[1] += qGreen(p1); sum2[1] += qGreen(p2);
+                    sum1[2] += qBlue(p1);  sum2[2] += qBlue(p2);
+                    sum1[3] += qAlpha(p1); sum2[3] += qAlpha(p2);
+                }
+            }
+
+            const int numPixels = block.width() * block.height();
+            for (int i = 0; i < 4; i++) {
+                totalDifference += qAbs(sum1[i] - sum2[i]) / numPixels;
+                numSamples++;
+            }
+        }
+    }
+
+    return numSamples ? totalDifference / numSamples : 0.0;
+}
+
+bool testFilterLod(KisFilterSP f, KisFilterConfigurationSP config, const QImage &image, qreal *difference)
+{
+    const int lod = 1;
+    const QRect lodRect = KisLodTransform(lod).map(image.rect());
+
+    /**
+     * Reference: filter the full-resolution image and downscale the
+     * result into the LoD plane
+     */
+    TestingLodDefaultBounds *refBounds = 0;
+    KisPaintDeviceSP refDev = createDevice(image, &refBounds);
+    f->process(refDev, image.rect(), config);
+
+    refBounds->testingSetLevelOfDetail(lod);
+    syncLodCache(refDev, lod);
+
+    /**
+     * Tested: downscale the image first and filter it in the LoD plane
+     */
+    TestingLodDefaultBounds *bounds = 0;
+    KisPaintDeviceSP dev = createDevice(image, &bounds);
+
+    bounds->testingSetLevelOfDetail(lod);
+    syncLodCache(dev, lod);
+    f->process(dev, lodRect, config);
+
+    const QImage refImage = refDev->convertToQImage(0, lodRect.x(), lodRect.y(), lodRect.width(), lodRect.height());
+    const QImage result = dev->convertToQImage(0, lodRect.x(), lodRect.y(), lodRect.width(), lodRect.height());
+
+    *difference = blockDifference(refImage, result, 4);
+
+    const qreal tolerance = 20.0;
+
+    if (*difference > tolerance) {
+        refImage.save(QString("lod_ref_carrot_%1.png").arg(f->id()));
+        result.save(QString("lod_carrot_%1.png").arg(f->id()));
+        return false;
+    }
+
+    return true;
+}
+
+KisFilterConfigurationSP lodTestConfiguration(KisFilterSP f, KisPaintDeviceSP dev)
+{
+    KisFilterConfigurationSP config = f->defaultConfiguration(dev);
+
+    if (f->id() == "unsharp") {
+        // the default radius is too small to be previewed in LoD
+        config->setProperty("halfSize", 5);
+    }
+
+    return config;
+}
+
+void KisFiltersLodTest::testFiltersLod()
+{
+    QImage image(QString(FILES_DATA_DIR) + QDir::separator() + "carrot.png");
+
+    QStringList filterIds;
+    filterIds << "unsharp"
+              << "sharpen" << "mean removal"
+              << "emboss laplascian" << "emboss all directions"
+              << "emboss horizontal and vertical" << "emboss vertical only"
+              << "emboss horizontal only" << "emboss diagonal"
+              << "top edge detections" << "right edge detections"
+              << "bottom edge detections" << "left edge detections"
+              << "emboss" << "noise" << "oilpaint" << "halftone"
+              << "pixelize" << "wave" << "indexcolors";
+
+    QStringList failures;
+    QStringList successes;
+
+    Q_FOREACH (const QString &id, filterIds) {
+        KisFilterSP f = KisFilterRegistry::instance()->value(id);
+        if (!f) {
+            dbgKrita << "Filter" << id << "is not available, skipping";
+            continue;
+        }
+
+        KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+        KisFilterConfigurationSP config = lodTestConfiguration(f, dev);
+
+        if (!f->supportsLevelOfDetail(config, 1)) {
+            failures << QString("%1 (doesn't support LoD)").arg(id);
+            continue;
+        }
+
+        qreal difference = 0;
+        if (testFilterLod(f, config, image, &difference)) {
+            successes << id;
+        } else {
+            failures << QString("%1 (difference %2)").arg(id).arg(difference);
+        }
+    }
+
+    dbgKrita << "LoD Success: " << successes;
+    if (failures.size() > 0) {
+        QFAIL(QString("LoD Failed filters:\n\t %1").arg(failures.join("\n\t")).toLatin1());
+    }
+}
+
+void KisFiltersLodTest::testUnsupportedConfigurations()
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+
+    KisFilterSP unsharp = KisFilterRegistry::instance()->value("unsharp");
+    if (unsharp) {
+        KisFilterConfigurationSP config = unsharp->defaultConfiguration(dev);
+        config->setProperty("halfSize", 1);
+        QVERIFY(unsharp->supportsLevelOfDetail(config, 0));
+        QVERIFY(!unsharp->supportsLevelOfDetail(config, 1));
+
+        config->setProperty("halfSize", 4);
+        QVERIFY(unsharp->supportsLevelOfDetail(config, 2));
+        QVERIFY(!unsharp->supportsLevelOfDetail(config, 3));
+    }
+
+    KisFilterSP halftone = KisFilterRegistry::instance()->value("halftone");
+    if (halftone) {
+        KisFilterConfigurationSP config = halftone->defaultConfiguration(dev);
+        config->setProperty("cellSize", 8);
+        QVERIFY(halftone->supportsLevelOfDetail(config, 1));
+        QVERIFY(!halftone->supportsLevelOfDetail(config, 2));
+    }
+}
+
+QTEST_MAIN(KisFiltersLodTest)
@@ -47,13 +47,13 @@ KisUnsharpFilter::KisUnsharpFilter() : KisFilter(id(), categoryEnhance(), i18n("
     setSupportsThreading(true);
 
     /**
-     * Officially Unsharp Mask doesn't support LoD, because it
-     * generates subtle artifacts when the unsharp radius is smaller
-     * than current zoom level. But LoD devices can still appear when
-     * the filter is used in Adjustment Layer. So the actual LoD is
-     * still counted on.
+     * Unsharp Mask generates subtle artifacts when the unsharp radius
+     * is smaller than current zoom level, so the LoD support is
+     * decided per configuration in supportsLevelOfDetail(). LoD
+     * devices can still appear when the filter is used in Adjustment
+     * Layer, so the actual LoD is always counted on.
      */
-    setSupportsLevelOfDetail(false);
+    setSupportsLevelOfDetail(true);
     setColorSpaceIndependence(FULLY_INDEPENDENT);
 }
 
@@ -208,6 +208,20 @@ void KisUnsharpFilter::processLightnessOnly(KisPaintDeviceSP device,
     }
 }
 
+bool KisUnsharpFilter::supportsLevelOfDetail(const KisFilterConfigurationSP config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+
+    QVariant value;
+    const qreal halfSize = t.scale(config && config->getProperty("halfSize", value) ? value.toDouble() : 1.0);
+
+    /**
+     * The preview is good enough as long as the blur radius still
+     * covers at least one pixel of the scaled device
+     */
+    return halfSize >= 1.0;
+}
+
 QRect KisUnsharpFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP config, int lod) const
 {
     KisLodTransformScalar t(lod);
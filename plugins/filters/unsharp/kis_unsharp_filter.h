@@ -42,6 +42,8 @@ public:
     virtual KisConfigWidget * createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev) const;
     virtual KisFilterConfigurationSP factoryConfiguration(const KisPaintDeviceSP) const;
 
+    bool supportsLevelOfDetail(const KisFilterConfigurationSP config, int lod) const;
+
     QRect changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const;
     QRect neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const;
 
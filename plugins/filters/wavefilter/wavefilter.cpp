@@ -23,6 +23,7 @@
 #include <vector>
 #include <math.h>
 #include <QPoint>
+#include <QtMath>
 
 #include <kis_debug.h>
 #include <kpluginfactory.h>
@@ -41,6 +42,7 @@
 #include <kis_paint_device.h>
 #include <filter/kis_filter_configuration.h>
 #include <kis_processing_information.h>
+#include <kis_lod_transform.h>
 #include "kis_wdg_wave.h"
 #include "ui_wdgwaveoptions.h"
 #include <kis_iterator_ng.h>
@@ -99,7 +101,7 @@ KisFilterWave::KisFilterWave() : KisFilter(id(), categoryOther(), i18n("&Wave...
     setColorSpaceIndependence(FULLY_INDEPENDENT);
     setSupportsPainting(false);
     setSupportsAdjustmentLayers(false);
-
+    setSupportsLevelOfDetail(true);
 }
 
 KisFilterConfigurationSP KisFilterWave::factoryConfiguration(const KisPaintDeviceSP) const
@@ -133,14 +135,20 @@ void KisFilterWave::processImpl(KisPaintDeviceSP device,
     if (cost == 0) cost = 1;
     int count = 0;
 
+    /**
+     * On a scaled device all the distances of the wave are scaled
+     * as well, so the curve stays the same relative to the image
+     */
+    KisLodTransformScalar t(device);
+
     QVariant value;
-    int horizontalwavelength = (config && config->getProperty("horizontalwavelength", value)) ? value.toInt() : 50;
-    int horizontalshift = (config && config->getProperty("horizontalshift", value)) ? value.toInt() : 50;
-    int horizontalamplitude = (config && config->getProperty("horizontalamplitude", value)) ? value.toInt() : 4;
+    int horizontalwavelength = qMax(1, qRound(t.scale((config && config->getProperty("horizontalwavelength", value)) ? value.toInt() : 50)));
+    int horizontalshift = qRound(t.scale((config && config->getProperty("horizontalshift", value)) ? value.toInt() : 50));
+    int horizontalamplitude = qRound(t.scale((config && config->getProperty("horizontalamplitude", value)) ? value.toInt() : 4));
     int horizontalshape = (config && config->getProperty("horizontalshape", value)) ? value.toInt() : 0;
-    int verticalwavelength = (config && config->getProperty("verticalwavelength", value)) ? value.toInt() : 50;
-    int verticalshift = (config && config->getProperty("verticalshift", value)) ? value.toInt() : 50;
-    int verticalamplitude = (config && config->getProperty("verticalamplitude", value)) ? value.toInt() : 4;
+    int verticalwavelength = qMax(1, qRound(t.scale((config && config->getProperty("verticalwavelength", value)) ? value.toInt() : 50)));
+    int verticalshift = qRound(t.scale((config && config->getProperty("verticalshift", value)) ? value.toInt() : 50));
+    int verticalamplitude = qRound(t.scale((config && config->getProperty("verticalamplitude", value)) ? value.toInt() : 4));
     int verticalshape = (config && config->getProperty("verticalshape", value)) ? value.toInt() : 0;
     KisSequentialIterator dstIt(device, applyRect);
     KisWaveCurve* verticalcurve;
@@ -168,11 +176,11 @@ void KisFilterWave::processImpl(KisPaintDeviceSP device,
 
 QRect KisFilterWave::neededRect(const QRect& rect, const KisFilterConfigurationSP config, int lod) const
 {
-    Q_UNUSED(lod);
+    KisLodTransformScalar t(lod);
 
     QVariant value;
-    int horizontalamplitude = (config && config->getProperty("horizontalamplitude", value)) ? value.toInt() : 4;
-    int verticalamplitude = (config && config->getProperty("verticalamplitude", value)) ? value.toInt() : 4;
+    int horizontalamplitude = qCeil(t.scale((config && config->getProperty("horizontalamplitude", value)) ? value.toInt() : 4));
+    int verticalamplitude = qCeil(t.scale((config && config->getProperty("verticalamplitude", value)) ? value.toInt() : 4));
     return rect.adjusted(-horizontalamplitude, -verticalamplitude, horizontalamplitude, verticalamplitude);
 }
 
@@ -26,6 +26,7 @@
 #include <ImfChannelList.h>
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
+#include <ImfThreading.h>
 
 #include <ImfStringAttribute.h>
 #include "exr_extra_tags.h"
@@ -34,6 +35,7 @@
 #include <QMessageBox>
 
 #include <QFileInfo>
+#include <QtConcurrent>
 
 #include <KoColorSpaceRegistry.h>
 #include <KoCompositeOpRegistry.h>
@@ -48,6 +50,7 @@
 #include <kis_paint_layer.h>
 #include <kis_transaction.h>
 #include "kis_iterator_ng.h"
+#include "kis_config.h"
 #include "kra/kis_kra_savexml_visitor.h"
 #include <kis_exr_layers_sorter.h>
 
@@ -138,14 +141,7 @@ struct exrConverter::Private {
     bool showNotifications;
 
 
-    template <class WrapperType>
-    void unmultiplyAlpha(typename WrapperType::pixel_type *pixel);
-
-    template<typename _T_>
-    void decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype);
-
-    template<typename _T_>
-    void decodeData1(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype);
+    void warnAboutChangedAlpha();
 
 
     QDomDocument loadExtraLayersInfo(const Imf::Header &header);
@@ -281,17 +277,21 @@ struct GrayPixelWrapper
     pixel_type &pixel;
 };
 
+/**
+ * \return true if the alpha channel of the pixel had to be modified
+ */
 template <class WrapperType>
-void exrConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pixel)
+bool unmultiplyAlpha(typename WrapperType::pixel_type *pixel)
 {
     typedef typename WrapperType::pixel_type pixel_type;
     typedef typename WrapperType::channel_type channel_type;
 
     WrapperType srcPixel(*pixel);
 
+    bool alphaWasModified = false;
+
     if (!srcPixel.checkMultipliedColorsConsistent()) {
 
-        bool alphaWasModified = false;
         channel_type newAlpha = srcPixel.alpha();
 
         pixel_type __dstPixelData;
@@ -314,34 +314,37 @@ void exrConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pi
 
         *pixel = dstPixel.pixel;
 
-        if (alphaWasModified &&
-                !this->warnedAboutChangedAlpha) {
-
-            QString msg =
-                    i18nc("@info",
-                          "The image contains pixels with zero alpha channel and non-zero "
-                          "color channels. Krita will have to modify those pixels to have "
-                          "at least some alpha. The initial values will <i>not</i> "
-                          "be reverted on saving the image back."
-                          "<br/><br/>"
-                          "This will hardly make any visual difference just keep it in mind."
-                          "<br/><br/>"
-                          "<note>Modified alpha will have a range from %1 to %2</note>",
-                          alphaEpsilon<channel_type>(),
-                          alphaNoiseThreshold<channel_type>());
-
-            if (this->showNotifications) {
-                QMessageBox::information(0, i18nc("@title:window", "EXR image will be modified"), msg);
-            } else {
-                warnKrita << "WARNING:" << msg;
-            }
-
-            this->warnedAboutChangedAlpha = true;
-        }
-
     } else if (srcPixel.alpha() > 0.0) {
         srcPixel.setUnmultiplied(srcPixel.pixel, srcPixel.alpha());
     }
+
+    return alphaWasModified;
+}
+
+void exrConverter::Private::warnAboutChangedAlpha()
+{
+    if (this->warnedAboutChangedAlpha) return;
+
+    QString msg =
+            i18nc("@info",
+                  "The image contains pixels with zero alpha channel and non-zero "
+                  "color channels. Krita will have to modify those pixels to have "
+                  "at least some alpha. The initial values will <i>not</i> "
+                  "be reverted on saving the image back."
+                  "<br/><br/>"
+                  "This will hardly make any visual difference just keep it in mind."
+                  "<br/><br/>"
+                  "<note>Modified alpha will have a range from %1 to %2</note>",
+                  alphaEpsilon<float>(),
+                  alphaNoiseThreshold<float>());
+
+    if (this->showNotifications) {
+        QMessageBox::information(0, i18nc("@title:window", "EXR image will be modified"), msg);
+    } else {
+        warnKrita << "WARNING:" << msg;
+    }
+
+    this->warnedAboutChangedAlpha = true;
 }
 
 template <typename T, typename Pixel, int size, int alphaPos>
@@ -360,118 +363,278 @@ void multiplyAlpha(Pixel *pixel)
     }
 }
 
+/**
+ * OpenEXR decompresses the whole line buffer even when only a few
+ * channels of it are requested, so all the layers are read through
+ * a single frame buffer, a chunk of rows at a time. The conversion
+ * of the chunk into the paint devices is then done concurrently.
+ */
+class Decoder
+{
+public:
+    virtual ~Decoder() {}
+    virtual int bufferPixelSize() const = 0;
+    virtual void prepareFrameBuffer(Imf::FrameBuffer *frameBuffer, int chunkY, int numRows) = 0;
+
+    /**
+     * Converts \p numRows rows of the current chunk starting at \p firstRow
+     * into the paint device. Different rows can be decoded concurrently.
+     *
+     * \return true if alpha of any pixel had to be modified
+     */
+    virtual bool decodeRows(int firstRow, int numRows) = 0;
+};
+
 template<typename _T_>
-void exrConverter::Private::decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype)
+class DecoderRgba : public Decoder
 {
-    typedef Rgba<_T_> Rgba;
+public:
+    DecoderRgba(const ExrPaintLayerInfo &info, KisPaintDeviceSP device, int width, int xstart, int ystart, Imf::PixelType ptype)
+        : m_info(info), m_device(device), m_width(width), m_xstart(xstart), m_ystart(ystart), m_chunkY(ystart), m_ptype(ptype)
+    {
+        m_hasAlpha = info.channelMap.contains("A");
+    }
 
-    QVector<Rgba> pixels(width);
+    int bufferPixelSize() const {
+        return sizeof(Rgba<_T_>);
+    }
 
-    bool hasAlpha = info.channelMap.contains("A");
+    void prepareFrameBuffer(Imf::FrameBuffer *frameBuffer, int chunkY, int numRows) {
+        typedef Rgba<_T_> Rgba;
 
-    for (int y = 0; y < height; ++y) {
-        Imf::FrameBuffer frameBuffer;
-        Rgba* frameBufferData = (pixels.data()) - xstart - (ystart + y) * width;
-        frameBuffer.insert(info.channelMap["R"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->r,
+        m_pixels.resize(m_width * numRows);
+        m_chunkY = chunkY;
+
+        Rgba* frameBufferData = (m_pixels.data()) - m_xstart - chunkY * m_width;
+        frameBuffer->insert(m_info.channelMap["R"].toLatin1().constData(),
+                Imf::Slice(m_ptype, (char *) &frameBufferData->r,
                            sizeof(Rgba) * 1,
-                           sizeof(Rgba) * width));
-        frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->g,
+                           sizeof(Rgba) * m_width));
+        frameBuffer->insert(m_info.channelMap["G"].toLatin1().constData(),
+                Imf::Slice(m_ptype, (char *) &frameBufferData->g,
                            sizeof(Rgba) * 1,
-                           sizeof(Rgba) * width));
-        frameBuffer.insert(info.channelMap["B"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->b,
+                           sizeof(Rgba) * m_width));
+        frameBuffer->insert(m_info.channelMap["B"].toLatin1().constData(),
+                Imf::Slice(m_ptype, (char *) &frameBufferData->b,
                            sizeof(Rgba) * 1,
-                           sizeof(Rgba) * width));
-        if (hasAlpha) {
-            frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                    Imf::Slice(ptype, (char *) &frameBufferData->a,
+                           sizeof(Rgba) * m_width));
+        if (m_hasAlpha) {
+            frameBuffer->insert(m_info.channelMap["A"].toLatin1().constData(),
+                    Imf::Slice(m_ptype, (char *) &frameBufferData->a,
                                sizeof(Rgba) * 1,
-                               sizeof(Rgba) * width));
+                               sizeof(Rgba) * m_width));
         }
+    }
 
-        file.setFrameBuffer(frameBuffer);
-        file.readPixels(ystart + y);
-        Rgba *rgba = pixels.data();
-        KisHLineIteratorSP it = layer->paintDevice()->createHLineIteratorNG(0, y, width);
-        do {
+    bool decodeRows(int firstRow, int numRows) {
+        typedef typename KoRgbTraits<_T_>::Pixel Pixel;
 
-            if (hasAlpha) {
-                unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
-            }
+        const int numPixels = m_width * numRows;
+        QVector<Pixel> dstPixels(numPixels);
 
-            typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(it->rawData());
+        Rgba<_T_> *rgba = m_pixels.data() + firstRow * m_width;
+        Pixel *dst = dstPixels.data();
+
+        bool alphaWasModified = false;
+
+        for (int i = 0; i < numPixels; i++) {
+            if (m_hasAlpha) {
+                alphaWasModified |= unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
+            }
 
             dst->red = rgba->r;
             dst->green = rgba->g;
             dst->blue = rgba->b;
-            if (hasAlpha) {
+            if (m_hasAlpha) {
                 dst->alpha = rgba->a;
             } else {
                 dst->alpha = 1.0;
             }
 
-
             ++rgba;
-        } while (it->nextPixel());
+            ++dst;
+        }
+
+        m_device->writeBytes(reinterpret_cast<const quint8*>(dstPixels.constData()),
+                             0, m_chunkY - m_ystart + firstRow, m_width, numRows);
+
+        return alphaWasModified;
     }
 
-}
+private:
+    const ExrPaintLayerInfo &m_info;
+    KisPaintDeviceSP m_device;
+    int m_width;
+    int m_xstart;
+    int m_ystart;
+    int m_chunkY;
+    Imf::PixelType m_ptype;
+    bool m_hasAlpha;
+    QVector<Rgba<_T_> > m_pixels;
+};
 
 template<typename _T_>
-void exrConverter::Private::decodeData1(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype)
+class DecoderGray : public Decoder
 {
+public:
     typedef typename GrayPixelWrapper<_T_>::channel_type channel_type;
     typedef typename GrayPixelWrapper<_T_>::pixel_type pixel_type;
 
-    KIS_ASSERT_RECOVER_RETURN(
-                layer->paintDevice()->colorSpace()->colorModelId() == GrayAColorModelID);
-
-    QVector<pixel_type> pixels(width);
+    DecoderGray(const ExrPaintLayerInfo &info, KisPaintDeviceSP device, int width, int xstart, int ystart, Imf::PixelType ptype)
+        : m_info(info), m_device(device), m_width(width), m_xstart(xstart), m_ystart(ystart), m_chunkY(ystart), m_ptype(ptype)
+    {
+        Q_ASSERT(info.channelMap.contains("G"));
+        dbgFile << "G -> " << info.channelMap["G"];
 
-    Q_ASSERT(info.channelMap.contains("G"));
-    dbgFile << "G -> " << info.channelMap["G"];
+        m_hasAlpha = info.channelMap.contains("A");
+        dbgFile << "Has Alpha:" << m_hasAlpha;
+    }
 
-    bool hasAlpha = info.channelMap.contains("A");
-    dbgFile << "Has Alpha:" << hasAlpha;
+    int bufferPixelSize() const {
+        return sizeof(pixel_type);
+    }
 
+    void prepareFrameBuffer(Imf::FrameBuffer *frameBuffer, int chunkY, int numRows) {
+        m_pixels.resize(m_width * numRows);
+        m_chunkY = chunkY;
 
-    for (int y = 0; y < height; ++y) {
-        Imf::FrameBuffer frameBuffer;
-        pixel_type* frameBufferData = (pixels.data()) - xstart - (ystart + y) * width;
-        frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->gray,
+        pixel_type* frameBufferData = (m_pixels.data()) - m_xstart - chunkY * m_width;
+        frameBuffer->insert(m_info.channelMap["G"].toLatin1().constData(),
+                Imf::Slice(m_ptype, (char *) &frameBufferData->gray,
                            sizeof(pixel_type) * 1,
-                           sizeof(pixel_type) * width));
+                           sizeof(pixel_type) * m_width));
 
-        if (hasAlpha) {
-            frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                    Imf::Slice(ptype, (char *) &frameBufferData->alpha,
+        if (m_hasAlpha) {
+            frameBuffer->insert(m_info.channelMap["A"].toLatin1().constData(),
+                    Imf::Slice(m_ptype, (char *) &frameBufferData->alpha,
                                sizeof(pixel_type) * 1,
-                               sizeof(pixel_type) * width));
+                               sizeof(pixel_type) * m_width));
         }
+    }
 
-        file.setFrameBuffer(frameBuffer);
-        file.readPixels(ystart + y);
+    bool decodeRows(int firstRow, int numRows) {
+        const int numPixels = m_width * numRows;
+
+        // the layout of the buffer is the same as the one of the device,
+        // so the pixels are converted in place
+        pixel_type *pixel = m_pixels.data() + firstRow * m_width;
 
-        pixel_type *srcPtr = pixels.data();
-        KisHLineIteratorSP it = layer->paintDevice()->createHLineIteratorNG(0, y, width);
-        do {
+        bool alphaWasModified = false;
 
-            if (hasAlpha) {
-                unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr);
+        for (int i = 0; i < numPixels; i++) {
+            if (m_hasAlpha) {
+                alphaWasModified |= unmultiplyAlpha<GrayPixelWrapper<_T_> >(pixel + i);
+            } else {
+                pixel[i].alpha = channel_type(1.0);
             }
+        }
+
+        m_device->writeBytes(reinterpret_cast<const quint8*>(pixel),
+                             0, m_chunkY - m_ystart + firstRow, m_width, numRows);
+
+        return alphaWasModified;
+    }
+
+private:
+    const ExrPaintLayerInfo &m_info;
+    KisPaintDeviceSP m_device;
+    int m_width;
+    int m_xstart;
+    int m_ystart;
+    int m_chunkY;
+    Imf::PixelType m_ptype;
+    bool m_hasAlpha;
+    QVector<pixel_type> m_pixels;
+};
+
+/**
+ * The rows of a chunk are converted in stripes aligned to the tiles
+ * of the paint devices
+ */
+const int STRIPE_HEIGHT = 64;
+
+/**
+ * The upper limit for the memory used by the frame buffer of a chunk
+ */
+const qint64 MAX_CHUNK_BUFFER_SIZE = 256 * 1024 * 1024;
+
+int chunkHeight(qint64 bytesPerRow, int imageHeight)
+{
+    const int maxRows = qMax(qint64(1), MAX_CHUNK_BUFFER_SIZE / qMax(qint64(1), bytesPerRow));
+    const int rows = qMax(STRIPE_HEIGHT, maxRows / STRIPE_HEIGHT * STRIPE_HEIGHT);
+
+    return qMin(rows, imageHeight);
+}
+
+/**
+ * OpenEXR compresses and decompresses line buffers on its own thread
+ * pool, so let it use as many threads as Krita is allowed to
+ */
+void setupExrThreading()
+{
+    KisConfig cfg;
+    Imf::setGlobalThreadCount(qMax(0, cfg.maxNumberOfThreads()));
+}
+
+struct DecodingJob {
+    DecodingJob() : decoder(0), firstRow(0), numRows(0), alphaWasModified(false) {}
+    DecodingJob(Decoder *_decoder, int _firstRow, int _numRows)
+        : decoder(_decoder), firstRow(_firstRow), numRows(_numRows), alphaWasModified(false) {}
+
+    Decoder *decoder;
+    int firstRow;
+    int numRows;
+    bool alphaWasModified;
+};
+
+struct DecodingJobRunner {
+    void operator() (DecodingJob &job) {
+        job.alphaWasModified = job.decoder->decodeRows(job.firstRow, job.numRows);
+    }
+};
+
+/**
+ * \return true if alpha of any pixel had to be modified
+ */
+bool decodeData(Imf::InputFile& file, const QList<Decoder*> &decoders, int ystart, int height)
+{
+    if (decoders.isEmpty()) return false;
+
+    qint64 bytesPerRow = 0;
+    Q_FOREACH (Decoder *decoder, decoders) {
+        bytesPerRow += decoder->bufferPixelSize();
+    }
+    bytesPerRow *= file.header().dataWindow().max.x - file.header().dataWindow().min.x + 1;
+
+    const int chunkRows = chunkHeight(bytesPerRow, height);
+    bool alphaWasModified = false;
+
+    for (int y = 0; y < height; y += chunkRows) {
+        const int numRows = qMin(chunkRows, height - y);
+
+        Imf::FrameBuffer frameBuffer;
+        Q_FOREACH (Decoder *decoder, decoders) {
+            decoder->prepareFrameBuffer(&frameBuffer, ystart + y, numRows);
+        }
 
-            pixel_type* dstPtr = reinterpret_cast<pixel_type*>(it->rawData());
+        file.setFrameBuffer(frameBuffer);
+        file.readPixels(ystart + y, ystart + y + numRows - 1);
 
-            dstPtr->gray = srcPtr->gray;
-            dstPtr->alpha = hasAlpha ? srcPtr->alpha : channel_type(1.0);
+        QVector<DecodingJob> jobs;
+        Q_FOREACH (Decoder *decoder, decoders) {
+            for (int row = 0; row < numRows; row += STRIPE_HEIGHT) {
+                jobs << DecodingJob(decoder, row, qMin(STRIPE_HEIGHT, numRows - row));
+            }
+        }
 
-            ++srcPtr;
-        } while (it->nextPixel());
+        QtConcurrent::blockingMap(jobs, DecodingJobRunner());
+
+        Q_FOREACH (const DecodingJob &job, jobs) {
+            alphaWasModified |= job.alphaWasModified;
+        }
     }
 
+    return alphaWasModified;
 }
 
 bool recCheckGroup(const ExrGroupLayerInfo& group, QStringList list, int idx1, int idx2)
@@ -791,7 +954,12 @@ KisImageBuilder_Result exrConverter::decode(const QString &filename)
         m_d->image->addNode(info.groupLayer, groupLayerParent);
     }
 
-    // Load the layers
+    // Create the layers and the decoders for them
+    QList<Decoder*> decoders;
+
+    typedef QPair<KisPaintLayerSP, KisGroupLayerSP> LayerMapping;
+    QVector<LayerMapping> layersToAdd;
+
     for (int i = informationObjects.size() - 1; i >= 0; --i) {
         ExrPaintLayerInfo& info = informationObjects[i];
         if (info.colorSpace) {
@@ -801,19 +969,22 @@ KisImageBuilder_Result exrConverter::decode(const QString &filename)
             layer->setCompositeOpId(COMPOSITE_OVER);
 
             if (!layer) {
+                qDeleteAll(decoders);
                 return KisImageBuilder_RESULT_FAILURE;
             }
 
             switch (info.channelMap.size()) {
             case 1:
             case 2:
-                // Decode the data
+                KIS_ASSERT_RECOVER_BREAK(
+                            layer->paintDevice()->colorSpace()->colorModelId() == GrayAColorModelID);
+
                 switch (info.imageType) {
                 case IT_FLOAT16:
-                    m_d->decodeData1<half>(file, info, layer, width, dx, dy, height, Imf::HALF);
+                    decoders << new DecoderGray<half>(info, layer->paintDevice(), width, dx, dy, Imf::HALF);
                     break;
                 case IT_FLOAT32:
-                    m_d->decodeData1<float>(file, info, layer, width, dx, dy, height, Imf::FLOAT);
+                    decoders << new DecoderGray<float>(info, layer->paintDevice(), width, dx, dy, Imf::FLOAT);
                     break;
                 case IT_UNKNOWN:
                 case IT_UNSUPPORTED:
@@ -822,13 +993,12 @@ KisImageBuilder_Result exrConverter::decode(const QString &filename)
                 break;
             case 3:
             case 4:
-                // Decode the data
                 switch (info.imageType) {
                 case IT_FLOAT16:
-                    m_d->decodeData4<half>(file, info, layer, width, dx, dy, height, Imf::HALF);
+                    decoders << new DecoderRgba<half>(info, layer->paintDevice(), width, dx, dy, Imf::HALF);
                     break;
                 case IT_FLOAT32:
-                    m_d->decodeData4<float>(file, info, layer, width, dx, dy, height, Imf::FLOAT);
+                    decoders << new DecoderRgba<float>(info, layer->paintDevice(), width, dx, dy, Imf::FLOAT);
                     break;
                 case IT_UNKNOWN:
                 case IT_UNSUPPORTED:
@@ -849,14 +1019,29 @@ KisImageBuilder_Result exrConverter::decode(const QString &filename)
                 }
                 layer->metaData()->addEntry(KisMetaData::Entry(KisMetaData::SchemaRegistry::instance()->create("http://krita.org/exrchannels/1.0/" , "exrchannels"), "channelsmap", values));
             }
-            // Add the layer
+
             KisGroupLayerSP groupLayerParent = (info.parent) ? info.parent->groupLayer : m_d->image->rootLayer();
-            m_d->image->addNode(layer, groupLayerParent);
+            layersToAdd << LayerMapping(layer, groupLayerParent);
         } else {
             dbgFile << "No decoding " << info.name << " with " << info.channelMap.size() << " channels, and lack of a color space";
         }
     }
 
+    // Decode all the layers in a single pass over the file
+    setupExrThreading();
+
+    const bool alphaWasModified = decodeData(file, decoders, dy, height);
+    qDeleteAll(decoders);
+
+    if (alphaWasModified) {
+        m_d->warnAboutChangedAlpha();
+    }
+
+    // Add the layers
+    Q_FOREACH (const LayerMapping &mapping, layersToAdd) {
+        m_d->image->addNode(mapping.first, mapping.second);
+    }
+
     if (!extraLayersInfo.isNull()) {
         KisExrLayersSorter sorter(extraLayersInfo, m_d->image);
     }
@@ -885,8 +1070,14 @@ class Encoder
 {
 public:
     virtual ~Encoder() {}
-    virtual void prepareFrameBuffer(Imf::FrameBuffer*, int line) = 0;
-    virtual void encodeData(int line) = 0;
+    virtual int bufferPixelSize() const = 0;
+    virtual void prepareFrameBuffer(Imf::FrameBuffer*, int chunkY, int numRows) = 0;
+
+    /**
+     * Fetches \p numRows rows of the current chunk starting at \p firstRow
+     * from the layer. Different rows can be encoded concurrently.
+     */
+    virtual void encodeRows(int firstRow, int numRows) = 0;
 
 };
 
@@ -894,24 +1085,36 @@ template<typename _T_, int size, int alphaPos>
 class EncoderImpl : public Encoder
 {
 public:
-    EncoderImpl(Imf::OutputFile* _file, const ExrPaintLayerSaveInfo* _info, int width) : file(_file), info(_info), pixels(width), m_width(width) {}
+    EncoderImpl(Imf::OutputFile* _file, const ExrPaintLayerSaveInfo* _info, int width) : file(_file), info(_info), m_width(width), m_chunkY(0) {}
     virtual ~EncoderImpl() {}
-    virtual void prepareFrameBuffer(Imf::FrameBuffer*, int line);
-    virtual void encodeData(int line);
+    virtual int bufferPixelSize() const;
+    virtual void prepareFrameBuffer(Imf::FrameBuffer*, int chunkY, int numRows);
+    virtual void encodeRows(int firstRow, int numRows);
 private:
     typedef ExrPixel_<_T_, size> ExrPixel;
     Imf::OutputFile* file;
     const ExrPaintLayerSaveInfo* info;
     QVector<ExrPixel> pixels;
     int m_width;
+    int m_chunkY;
 };
 
 template<typename _T_, int size, int alphaPos>
-void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* frameBuffer, int line)
+int EncoderImpl<_T_, size, alphaPos>::bufferPixelSize() const
+{
+    return sizeof(ExrPixel);
+}
+
+template<typename _T_, int size, int alphaPos>
+void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* frameBuffer, int chunkY, int numRows)
 {
     int xstart = 0;
     int ystart = 0;
-    ExrPixel* frameBufferData = (pixels.data()) - xstart - (ystart + line) * m_width;
+
+    pixels.resize(m_width * numRows);
+    m_chunkY = chunkY;
+
+    ExrPixel* frameBufferData = (pixels.data()) - xstart - (ystart + chunkY) * m_width;
     for (int k = 0; k < size; ++k) {
         frameBuffer->insert(info->channels[k].toUtf8(),
                             Imf::Slice(info->pixelType, (char *) &frameBufferData->data[k],
@@ -921,23 +1124,20 @@ void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* fram
 }
 
 template<typename _T_, int size, int alphaPos>
-void EncoderImpl<_T_, size, alphaPos>::encodeData(int line)
+void EncoderImpl<_T_, size, alphaPos>::encodeRows(int firstRow, int numRows)
 {
-    ExrPixel *rgba = pixels.data();
-    KisHLineIteratorSP it = info->layer->paintDevice()->createHLineIteratorNG(0, line, m_width);
-    do {
-        const _T_* dst = reinterpret_cast < const _T_* >(it->oldRawData());
+    // the pixel layout of the EXR buffer is the same as the one of the device
+    ExrPixel *rgba = pixels.data() + firstRow * m_width;
+    info->layer->paintDevice()->readBytes(reinterpret_cast<quint8*>(rgba),
+                                          0, m_chunkY + firstRow, m_width, numRows);
 
-        for (int i = 0; i < size; ++i) {
-            rgba->data[i] = dst[i];
-        }
+    if (alphaPos != -1) {
+        const int numPixels = m_width * numRows;
 
-        if (alphaPos != -1) {
-            multiplyAlpha<_T_, ExrPixel, size, alphaPos>(rgba);
+        for (int i = 0; i < numPixels; i++) {
+            multiplyAlpha<_T_, ExrPixel, size, alphaPos>(rgba + i);
         }
-
-        ++rgba;
-    } while (it->nextPixel());
+    }
 }
 
 Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int width)
@@ -980,23 +1180,63 @@ Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int w
     return 0;
 }
 
+struct EncodingJob {
+    EncodingJob() : encoder(0), firstRow(0), numRows(0) {}
+    EncodingJob(Encoder *_encoder, int _firstRow, int _numRows)
+        : encoder(_encoder), firstRow(_firstRow), numRows(_numRows) {}
+
+    Encoder *encoder;
+    int firstRow;
+    int numRows;
+};
+
+struct EncodingJobRunner {
+    void operator() (const EncodingJob &job) {
+        job.encoder->encodeRows(job.firstRow, job.numRows);
+    }
+};
+
 void encodeData(Imf::OutputFile& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
 {
+    setupExrThreading();
+
     QList<Encoder*> encoders;
     Q_FOREACH (const ExrPaintLayerSaveInfo& info, informationObjects) {
         encoders.push_back(encoder(file, info, width));
     }
 
-    for (int y = 0; y < height; ++y) {
+    qint64 bytesPerRow = 0;
+    Q_FOREACH (Encoder* encoder, encoders) {
+        bytesPerRow += encoder->bufferPixelSize();
+    }
+    bytesPerRow *= width;
+
+    /**
+     * The layers are fetched concurrently a chunk of rows at a time,
+     * then the whole chunk is passed to OpenEXR, which compresses its
+     * line buffers on its own thread pool.
+     */
+    const int chunkRows = chunkHeight(bytesPerRow, height);
+
+    for (int y = 0; y < height; y += chunkRows) {
+        const int numRows = qMin(chunkRows, height - y);
+
         Imf::FrameBuffer frameBuffer;
         Q_FOREACH (Encoder* encoder, encoders) {
-            encoder->prepareFrameBuffer(&frameBuffer, y);
+            encoder->prepareFrameBuffer(&frameBuffer, y, numRows);
         }
         file.setFrameBuffer(frameBuffer);
+
+        QVector<EncodingJob> jobs;
         Q_FOREACH (Encoder* encoder, encoders) {
-            encoder->encodeData(y);
+            for (int row = 0; row < numRows; row += STRIPE_HEIGHT) {
+                jobs << EncodingJob(encoder, row, qMin(STRIPE_HEIGHT, numRows - row));
+            }
         }
-        file.writePixels(1);
+
+        QtConcurrent::blockingMap(jobs, EncodingJobRunner());
+
+        file.writePixels(numRows);
     }
     qDeleteAll(encoders);
 }
@@ -87,13 +87,6 @@ KisImportExportFilter::ConversionStatus exrExport::convert(const QByteArray& fro
     KisImageWSP image = input->image();
     Q_CHECK_PTR(image);
 
-    KoDialog kdb;
-    kdb.setWindowTitle(i18n("OpenEXR Export Options"));
-    kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
-    KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
-    kdb.setMainWidget(wdg);
-    kdb.resize(kdb.minimumSize());
-
     // If a configuration object was passed to the convert method, we use that, otherwise we load from the settings
     KisPropertiesConfigurationSP cfg(new KisPropertiesConfiguration());
     if (configuration) {
@@ -102,9 +95,17 @@ KisImportExportFilter::ConversionStatus exrExport::convert(const QByteArray& fro
     else {
         cfg = lastSavedConfiguration(from, to);
     }
-    wdg->setConfiguration(cfg);
+    // the dialog is created only when it is going to be shown
+    if (!getBatchMode()) {
+        KoDialog kdb;
+        kdb.setWindowTitle(i18n("OpenEXR Export Options"));
+        kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
+        KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
+        kdb.setMainWidget(wdg);
+        kdb.resize(kdb.minimumSize());
+
+        wdg->setConfiguration(cfg);
 
-    if (!getBatchMode() ) {
         QApplication::restoreOverrideCursor();
         if (kdb.exec() == QDialog::Rejected) {
             return KisImportExportFilter::UserCancelled;
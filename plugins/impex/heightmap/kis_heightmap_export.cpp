@@ -103,14 +103,6 @@ KisImportExportFilter::ConversionStatus KisHeightMapExport::convert(const QByteA
         return KisImportExportFilter::WrongFormat;
     }
 
-    KoDialog kdb;
-    kdb.setWindowTitle(i18n("HeightMap Export Options"));
-    kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
-    KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
-    kdb.setMainWidget(wdg);
-
-    QApplication::restoreOverrideCursor();
-
     // If a configuration object was passed to the convert method, we use that, otherwise we load from the settings
     KisPropertiesConfigurationSP cfg(new KisPropertiesConfiguration());
     if (configuration) {
@@ -120,9 +112,19 @@ KisImportExportFilter::ConversionStatus KisHeightMapExport::convert(const QByteA
         cfg = lastSavedConfiguration(from, to);
     }
     cfg->setProperty("width", image->width());
-    wdg->setConfiguration(cfg);
 
+    // no widgets in batch mode: the filter may run outside the GUI thread
     if (!getBatchMode()) {
+        KoDialog kdb;
+        kdb.setWindowTitle(i18n("HeightMap Export Options"));
+        kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
+        KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
+        kdb.setMainWidget(wdg);
+
+        QApplication::restoreOverrideCursor();
+
+        wdg->setConfiguration(cfg);
+
         if (kdb.exec() == QDialog::Rejected) {
             return KisImportExportFilter::UserCancelled;
         }
@@ -133,7 +135,7 @@ KisImportExportFilter::ConversionStatus KisHeightMapExport::convert(const QByteA
     QDataStream::ByteOrder bo = cfg->getInt("endianness", 0) ? QDataStream::BigEndian : QDataStream::LittleEndian;
 
     bool downscale = false;
-    if (to == "image/x-r8" && image->colorSpace()->colorDepthId() == Integer16BitsColorDepthID) {
+    if (to == "image/x-r8" && image->colorSpace()->colorDepthId() == Integer16BitsColorDepthID && !getBatchMode()) {
 
         downscale = (QMessageBox::question(0,
                                            i18nc("@title:window", "Downscale Image"),
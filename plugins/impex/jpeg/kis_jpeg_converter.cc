@@ -120,6 +120,119 @@ QString getColorSpaceModelForColorType(J_COLOR_SPACE color_type)
     return "";
 }
 
+/**
+ * The pixels are passed to and from libjpeg in bands of this many
+ * rows. The value equals the height of a tile, so every band covers
+ * whole tiles of the paint device and writeBytes()/readBytes() can
+ * copy the data tile by tile.
+ */
+const int BAND_HEIGHT = 64;
+
+/**
+ * libjpeg-turbo can convert YCbCr right into the BGRA layout of
+ * Krita's 8-bit RGBA color space (and back) with its own SIMD code,
+ * which saves us a separate conversion pass
+ */
+#ifdef JCS_ALPHA_EXTENSIONS
+const bool canUseBGRALayout = true;
+const J_COLOR_SPACE BGRA_COLOR_SPACE = JCS_EXT_BGRA;
+#else
+const bool canUseBGRALayout = false;
+const J_COLOR_SPACE BGRA_COLOR_SPACE = JCS_RGB;
+#endif
+
+/**
+ * The conversion loops below are written so that the compiler can
+ * vectorize them: no aliasing, no branches, fixed channel offsets
+ */
+
+void convertFromJPEGGray(const quint8 * __restrict src, quint8 * __restrict dst, int numPixels)
+{
+    for (int i = 0; i < numPixels; i++) {
+        dst[2 * i] = src[i];
+        dst[2 * i + 1] = quint8_MAX;
+    }
+}
+
+void convertFromJPEGRGB(const quint8 * __restrict src, quint8 * __restrict dst, int numPixels)
+{
+    for (int i = 0; i < numPixels; i++) {
+        dst[4 * i + 0] = src[3 * i + 2];
+        dst[4 * i + 1] = src[3 * i + 1];
+        dst[4 * i + 2] = src[3 * i + 0];
+        dst[4 * i + 3] = quint8_MAX;
+    }
+}
+
+void convertFromJPEGCMYK(const quint8 * __restrict src, quint8 * __restrict dst, int numPixels)
+{
+    // JPEG files store CMYK inverted (as written by Photoshop)
+    for (int i = 0; i < numPixels; i++) {
+        dst[5 * i + 0] = quint8_MAX - src[4 * i + 0];
+        dst[5 * i + 1] = quint8_MAX - src[4 * i + 1];
+        dst[5 * i + 2] = quint8_MAX - src[4 * i + 2];
+        dst[5 * i + 3] = quint8_MAX - src[4 * i + 3];
+        dst[5 * i + 4] = quint8_MAX;
+    }
+}
+
+void convertToJPEGGray(const quint8 * __restrict src, quint8 * __restrict dst, int numPixels)
+{
+    for (int i = 0; i < numPixels; i++) {
+        dst[i] = src[2 * i];
+    }
+}
+
+void convertToJPEGRGB(const quint8 * __restrict src, quint8 * __restrict dst, int numPixels)
+{
+    for (int i = 0; i < numPixels; i++) {
+        dst[3 * i + 0] = src[4 * i + 2];
+        dst[3 * i + 1] = src[4 * i + 1];
+        dst[3 * i + 2] = src[4 * i + 0];
+    }
+}
+
+void convertToJPEGCMYK(const quint8 * __restrict src, quint8 * __restrict dst, int numPixels)
+{
+    for (int i = 0; i < numPixels; i++) {
+        dst[4 * i + 0] = quint8_MAX - src[5 * i + 0];
+        dst[4 * i + 1] = quint8_MAX - src[5 * i + 1];
+        dst[4 * i + 2] = quint8_MAX - src[5 * i + 2];
+        dst[4 * i + 3] = quint8_MAX - src[5 * i + 3];
+    }
+}
+
+/**
+ * Used for the color spaces with more than 8 bits per channel
+ */
+void convertToJPEGGeneric(const KoColorSpace *cs, J_COLOR_SPACE colorType,
+                          const quint8 *src, quint8 *dst, int numPixels)
+{
+    const int pixelSize = cs->pixelSize();
+
+    for (int i = 0; i < numPixels; i++) {
+        switch (colorType) {
+        case JCS_GRAYSCALE:
+            *(dst++) = cs->scaleToU8(src, 0);
+            break;
+        case JCS_RGB:
+            *(dst++) = cs->scaleToU8(src, 2);
+            *(dst++) = cs->scaleToU8(src, 1);
+            *(dst++) = cs->scaleToU8(src, 0);
+            break;
+        case JCS_CMYK:
+            *(dst++) = quint8_MAX - cs->scaleToU8(src, 0);
+            *(dst++) = quint8_MAX - cs->scaleToU8(src, 1);
+            *(dst++) = quint8_MAX - cs->scaleToU8(src, 2);
+            *(dst++) = quint8_MAX - cs->scaleToU8(src, 3);
+            break;
+        default:
+            break;
+        }
+        src += pixelSize;
+    }
+}
+
 }
 
 struct KisJPEGConverter::Private
@@ -176,16 +289,23 @@ KisImageBuilder_Result KisJPEGConverter::decode(const QString &filename)
         // read header
         jpeg_read_header(&cinfo, (boolean)true);
 
-        // start reading
-        jpeg_start_decompress(&cinfo);
+        const J_COLOR_SPACE colorType = cinfo.out_color_space;
 
         // Get the colorspace
-        QString modelId = getColorSpaceModelForColorType(cinfo.out_color_space);
+        QString modelId = getColorSpaceModelForColorType(colorType);
         if (modelId.isEmpty()) {
-            dbgFile << "unsupported colorspace :" << cinfo.out_color_space;
+            dbgFile << "unsupported colorspace :" << colorType;
             jpeg_destroy_decompress(&cinfo);
             return KisImageBuilder_RESULT_UNSUPPORTED_COLORSPACE;
         }
+
+        const bool decodeToBGRA = canUseBGRALayout && colorType == JCS_RGB;
+        if (decodeToBGRA) {
+            cinfo.out_color_space = BGRA_COLOR_SPACE;
+        }
+
+        // start reading
+        jpeg_start_decompress(&cinfo);
         uchar* profile_data;
         uint profile_len;
         const KoColorProfile* profile = 0;
@@ -267,50 +387,67 @@ KisImageBuilder_Result KisJPEGConverter::decode(const QString &filename)
         KisPaintLayerSP layer = KisPaintLayerSP(new KisPaintLayer(m_d->image.data(), m_d->image -> nextLayerName(), quint8_MAX));
 
         // Read data
-        JSAMPROW row_pointer = new JSAMPLE[cinfo.image_width*cinfo.num_components];
-
-        for (; cinfo.output_scanline < cinfo.image_height;) {
-            KisHLineIteratorSP it = layer->paintDevice()->createHLineIteratorNG(0, cinfo.output_scanline, cinfo.image_width);
-            jpeg_read_scanlines(&cinfo, &row_pointer, 1);
-            quint8 *src = row_pointer;
-            switch (cinfo.out_color_space) {
-            case JCS_GRAYSCALE:
-                do {
-                    quint8 *d = it->rawData();
-                    d[0] = *(src++);
-                    if (transform) transform->transform(d, d, 1);
-                    d[1] = quint8_MAX;
-
-                } while (it->nextPixel());
-                break;
-            case JCS_RGB:
-                do {
-                    quint8 *d = it->rawData();
-                    d[2] = *(src++);
-                    d[1] = *(src++);
-                    d[0] = *(src++);
-                    if (transform) transform->transform(d, d, 1);
-                    d[3] = quint8_MAX;
-
-                } while (it->nextPixel());
-                break;
-            case JCS_CMYK:
-                do {
-                    quint8 *d = it->rawData();
-                    d[0] = quint8_MAX - *(src++);
-                    d[1] = quint8_MAX - *(src++);
-                    d[2] = quint8_MAX - *(src++);
-                    d[3] = quint8_MAX - *(src++);
-                    if (transform) transform->transform(d, d, 1);
-                    d[4] = quint8_MAX;
-
-                } while (it->nextPixel());
-                break;
-            default:
-                return KisImageBuilder_RESULT_UNSUPPORTED;
+        KisPaintDeviceSP dev = layer->paintDevice();
+        const int width = cinfo.output_width;
+        const int height = cinfo.output_height;
+        const int jpegPixelSize = cinfo.output_components;
+
+        QVector<quint8> band(width * BAND_HEIGHT * cs->pixelSize());
+        QVector<quint8> jpegBand;
+        if (!decodeToBGRA) {
+            jpegBand.resize(width * BAND_HEIGHT * jpegPixelSize);
+        }
+        quint8 *jpegData = decodeToBGRA ? band.data() : jpegBand.data();
+
+        QVector<JSAMPROW> rows(BAND_HEIGHT);
+        for (int i = 0; i < BAND_HEIGHT; i++) {
+            rows[i] = jpegData + i * width * jpegPixelSize;
+        }
+
+        while (cinfo.output_scanline < cinfo.output_height) {
+            const int bandY = cinfo.output_scanline;
+            const int bandHeight = qMin(BAND_HEIGHT, height - bandY);
+
+            int rowsRead = 0;
+            while (rowsRead < bandHeight) {
+                const int numRows = jpeg_read_scanlines(&cinfo, rows.data() + rowsRead, bandHeight - rowsRead);
+                if (!numRows) {
+                    jpeg_destroy_decompress(&cinfo);
+                    delete transform;
+                    return KisImageBuilder_RESULT_FAILURE;
+                }
+                rowsRead += numRows;
             }
+
+            const int numPixels = width * bandHeight;
+
+            if (!decodeToBGRA) {
+                switch (colorType) {
+                case JCS_GRAYSCALE:
+                    convertFromJPEGGray(jpegData, band.data(), numPixels);
+                    break;
+                case JCS_RGB:
+                    convertFromJPEGRGB(jpegData, band.data(), numPixels);
+                    break;
+                case JCS_CMYK:
+                    convertFromJPEGCMYK(jpegData, band.data(), numPixels);
+                    break;
+                default:
+                    jpeg_destroy_decompress(&cinfo);
+                    delete transform;
+                    return KisImageBuilder_RESULT_UNSUPPORTED;
+                }
+            }
+
+            if (transform) {
+                transform->transform(band.data(), band.data(), numPixels);
+            }
+
+            dev->writeBytes(band.data(), 0, bandY, width, bandHeight);
         }
 
+        delete transform;
+
         m_d->image->addNode(KisNodeSP(layer.data()), m_d->image->rootLayer().data());
 
         // Read exif information
@@ -443,7 +580,6 @@ KisImageBuilder_Result KisJPEGConverter::decode(const QString &filename)
         // Finish decompression
         jpeg_finish_decompress(&cinfo);
         jpeg_destroy_decompress(&cinfo);
-        delete [] row_pointer;
         return KisImageBuilder_RESULT_OK;
     }
     catch( std::runtime_error &e) {
@@ -518,10 +654,22 @@ KisImageBuilder_Result KisJPEGConverter::buildFile(const QString &filename, KisP
     // Initialize output stream
     KisJPEGDestination::setDestination(&cinfo, &file);
 
+    /**
+     * 8-bit RGBA data can be passed to libjpeg-turbo as it is, the
+     * SIMD color converter of the library ignores the alpha channel
+     */
+    const bool is8Bit = cs->colorDepthId() == Integer8BitsColorDepthID;
+    const bool encodeFromBGRA = canUseBGRALayout && is8Bit && color_type == JCS_RGB;
+
     cinfo.image_width = width;  // image width and height, in pixels
     cinfo.image_height = height;
-    cinfo.input_components = cs->colorChannelCount(); // number of color channels per pixel */
-    cinfo.in_color_space = color_type;   // colorspace of input image
+    if (encodeFromBGRA) {
+        cinfo.input_components = cs->channelCount();
+        cinfo.in_color_space = BGRA_COLOR_SPACE;
+    } else {
+        cinfo.input_components = cs->colorChannelCount(); // number of color channels per pixel */
+        cinfo.in_color_space = color_type;   // colorspace of input image
+    }
 
     // Set default compression parameters
     jpeg_set_defaults(&cinfo);
@@ -662,77 +810,58 @@ KisImageBuilder_Result KisJPEGConverter::buildFile(const QString &filename, KisP
 
     // Write data information
 
-    JSAMPROW row_pointer = new JSAMPLE[width*cinfo.input_components];
-    int color_nb_bits = 8 * layer->paintDevice()->pixelSize() / layer->paintDevice()->channelCount();
+    const int pixelSize = dev->pixelSize();
+    const int jpegPixelSize = cinfo.input_components;
 
-    for (; cinfo.next_scanline < height;) {
-        KisHLineConstIteratorSP it = dev->createHLineConstIteratorNG(0, cinfo.next_scanline, width);
-        quint8 *dst = row_pointer;
-        switch (color_type) {
-        case JCS_GRAYSCALE:
-            if (color_nb_bits == 16) {
-                do {
-                    //const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
-                    const quint8 *d = it->oldRawData();
-                    *(dst++) = cs->scaleToU8(d, 0);//d[0] / quint8_MAX;
+    QVector<quint8> band(width * BAND_HEIGHT * pixelSize);
+    QVector<quint8> jpegBand;
+    if (!encodeFromBGRA) {
+        jpegBand.resize(width * BAND_HEIGHT * jpegPixelSize);
+    }
+    quint8 *jpegData = encodeFromBGRA ? band.data() : jpegBand.data();
 
-                } while (it->nextPixel());
-            } else {
-                do {
-                    const quint8 *d = it->oldRawData();
-                    *(dst++) = d[0];
+    QVector<JSAMPROW> rows(BAND_HEIGHT);
+    for (int i = 0; i < BAND_HEIGHT; i++) {
+        rows[i] = jpegData + i * width * jpegPixelSize;
+    }
 
-                } while (it->nextPixel());
-            }
-            break;
-        case JCS_RGB:
-            if (color_nb_bits == 16) {
-                do {
-                    //const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
-                    const quint8 *d = it->oldRawData();
-                    *(dst++) = cs->scaleToU8(d, 2); //d[2] / quint8_MAX;
-                    *(dst++) = cs->scaleToU8(d, 1); //d[1] / quint8_MAX;
-                    *(dst++) = cs->scaleToU8(d, 0); //d[0] / quint8_MAX;
-
-                } while (it->nextPixel());
-            } else {
-                do {
-                    const quint8 *d = it->oldRawData();
-                    *(dst++) = d[2];
-                    *(dst++) = d[1];
-                    *(dst++) = d[0];
+    while (cinfo.next_scanline < height) {
+        const int bandY = cinfo.next_scanline;
+        const int bandHeight = qMin(BAND_HEIGHT, int(height) - bandY);
+        const int numPixels = width * bandHeight;
 
-                } while (it->nextPixel());
-            }
-            break;
-        case JCS_CMYK:
-            if (color_nb_bits == 16) {
-                do {
-                    //const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
-                    const quint8 *d = it->oldRawData();
-                    *(dst++) = quint8_MAX - cs->scaleToU8(d, 0);//quint8_MAX - d[0] / quint8_MAX;
-                    *(dst++) = quint8_MAX - cs->scaleToU8(d, 1);//quint8_MAX - d[1] / quint8_MAX;
-                    *(dst++) = quint8_MAX - cs->scaleToU8(d, 2);//quint8_MAX - d[2] / quint8_MAX;
-                    *(dst++) = quint8_MAX - cs->scaleToU8(d, 3);//quint8_MAX - d[3] / quint8_MAX;
-
-                } while (it->nextPixel());
+        dev->readBytes(band.data(), 0, bandY, width, bandHeight);
+
+        if (!encodeFromBGRA) {
+            if (!is8Bit) {
+                convertToJPEGGeneric(cs, color_type, band.data(), jpegData, numPixels);
             } else {
-                do {
-                    const quint8 *d = it->oldRawData();
-                    *(dst++) = quint8_MAX - d[0];
-                    *(dst++) = quint8_MAX - d[1];
-                    *(dst++) = quint8_MAX - d[2];
-                    *(dst++) = quint8_MAX - d[3];
-
-                } while (it->nextPixel());
+                switch (color_type) {
+                case JCS_GRAYSCALE:
+                    convertToJPEGGray(band.data(), jpegData, numPixels);
+                    break;
+                case JCS_RGB:
+                    convertToJPEGRGB(band.data(), jpegData, numPixels);
+                    break;
+                case JCS_CMYK:
+                    convertToJPEGCMYK(band.data(), jpegData, numPixels);
+                    break;
+                default:
+                    jpeg_destroy_compress(&cinfo);
+                    return KisImageBuilder_RESULT_UNSUPPORTED;
+                }
             }
-            break;
-        default:
-            delete [] row_pointer;
-            jpeg_destroy_compress(&cinfo);
-            return KisImageBuilder_RESULT_UNSUPPORTED;
         }
-        jpeg_write_scanlines(&cinfo, &row_pointer, 1);
+
+        int rowsWritten = 0;
+        while (rowsWritten < bandHeight) {
+            const int numRows = jpeg_write_scanlines(&cinfo, rows.data() + rowsWritten, bandHeight - rowsWritten);
+            if (!numRows) {
+                jpeg_destroy_compress(&cinfo);
+                return KisImageBuilder_RESULT_FAILURE;
+            }
+            rowsWritten += numRows;
+        }
     }
 
 
@@ -740,7 +869,6 @@ KisImageBuilder_Result KisJPEGConverter::buildFile(const QString &filename, KisP
     jpeg_finish_compress(&cinfo);
     file.close();
 
-    delete [] row_pointer;
     // Free memory
     jpeg_destroy_compress(&cinfo);
 
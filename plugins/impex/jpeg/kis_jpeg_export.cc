@@ -79,13 +79,6 @@ KisImportExportFilter::ConversionStatus KisJPEGExport::convert(const QByteArray&
     KisImageWSP image = input->image();
     Q_CHECK_PTR(image);
 
-    KoDialog kdb;
-    kdb.setWindowTitle(i18n("JPEG Export Options"));
-    kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
-    KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
-    kdb.setMainWidget(wdg);
-    kdb.resize(kdb.minimumSize());
-
     // If a configuration object was passed to the convert method, we use that, otherwise we load from the settings
     KisPropertiesConfigurationSP cfg(new KisPropertiesConfiguration());
     if (configuration) {
@@ -100,12 +93,22 @@ KisImportExportFilter::ConversionStatus KisJPEGExport::convert(const QByteArray&
     bool sRGB = cs->profile()->name().contains(QLatin1String("srgb"), Qt::CaseInsensitive);
     cfg->setProperty("is_sRGB", sRGB);
 
-    wdg->setConfiguration(cfg);
+    /**
+     * In batch mode the filter may be run outside the GUI thread, so
+     * neither the dialog nor the config widget may be created there
+     */
+    if (!getBatchMode()) {
+        KoDialog kdb;
+        kdb.setWindowTitle(i18n("JPEG Export Options"));
+        kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
+        KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
+        kdb.setMainWidget(wdg);
+        kdb.resize(kdb.minimumSize());
 
+        wdg->setConfiguration(cfg);
 
-    QApplication::restoreOverrideCursor();
+        QApplication::restoreOverrideCursor();
 
-    if (!getBatchMode()) {
         if (kdb.exec() == QDialog::Rejected) {
             return KisImportExportFilter::UserCancelled;
         }
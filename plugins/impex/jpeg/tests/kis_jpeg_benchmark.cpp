@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_jpeg_benchmark.h"
+
+#include <QTest>
+#include <QDir>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+
+#include <KisDocument.h>
+#include <KisPart.h>
+#include <kis_image.h>
+#include <kis_paint_layer.h>
+#include <kis_paint_device.h>
+
+#include "kis_jpeg_converter.h"
+
+const int NUM_IMAGES = 32;
+const int IMAGE_WIDTH = 2400;
+const int IMAGE_HEIGHT = 1600;
+
+
+KisImageSP createPhoto(const KoColorSpace *cs)
+{
+    KisImageSP image = new KisImage(0, IMAGE_WIDTH, IMAGE_HEIGHT, cs, "jpeg benchmark");
+    KisPaintLayerSP layer = new KisPaintLayer(image, "photo", OPACITY_OPAQUE_U8);
+
+    const int pixelSize = cs->pixelSize();
+    QByteArray data(IMAGE_WIDTH * IMAGE_HEIGHT * pixelSize, 0);
+    quint8 *pixel = reinterpret_cast<quint8*>(data.data());
+
+    /**
+     * Smooth gradients with some noise, so that the encoder has
+     * something to do in every block
+     */
+    for (int y = 0; y < IMAGE_HEIGHT; y++) {
+        for (int x = 0; x < IMAGE_WIDTH; x++) {
+            const int noise = qrand() & 0xf;
+            for (int i = 0; i < pixelSize; i++) {
+                pixel[i] = ((x + y * i) / 16 + noise) & 0xff;
+            }
+            pixel[cs->alphaPos()] = 0xff;
+            pixel += pixelSize;
+        }
+    }
+
+    layer->paintDevice()->writeBytes(reinterpret_cast<const quint8*>(data.constData()), 0, 0, IMAGE_WIDTH, IMAGE_HEIGHT);
+    image->addNode(layer, image->root());
+
+    return image;
+}
+
+KisJPEGOptions createOptions()
+{
+    KisJPEGOptions options;
+    options.quality = 80;
+    options.progressive = false;
+    options.optimize = true;
+    options.smooth = 0;
+    options.baseLineJPEG = true;
+    options.subsampling = 0;
+    options.exif = false;
+    options.iptc = false;
+    options.xmp = false;
+    options.transparencyFillColor = Qt::white;
+    options.forceSRGB = false;
+    options.saveProfile = true;
+    return options;
+}
+
+const KoColorSpace* colorSpaceForModel(const QString &colorModel)
+{
+    return KoColorSpaceRegistry::instance()->colorSpace(colorModel, Integer8BitsColorDepthID.id(), "");
+}
+
+void KisJPEGBenchmark::initTestCase()
+{
+    qsrand(1);
+
+    m_directory = QDir::tempPath() + QDir::separator() + "kis_jpeg_benchmark";
+    QDir().mkpath(m_directory);
+}
+
+void KisJPEGBenchmark::cleanupTestCase()
+{
+    for (int i = 0; i < NUM_IMAGES; i++) {
+        QFile::remove(fileName(i));
+    }
+    QDir().rmdir(m_directory);
+}
+
+QString KisJPEGBenchmark::fileName(int index) const
+{
+    return m_directory + QDir::separator() + QString("photo_%1.jpg").arg(index);
+}
+
+void KisJPEGBenchmark::exportBatch(const QString &colorModel)
+{
+    KisImageSP image = createPhoto(colorSpaceForModel(colorModel));
+    KisPaintLayerSP layer = dynamic_cast<KisPaintLayer*>(image->root()->firstChild().data());
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+    for (int i = 0; i < NUM_IMAGES; i++) {
+        KisJPEGConverter converter(doc.data(), true);
+        QCOMPARE(converter.buildFile(fileName(i), layer,
+                                     image->beginAnnotations(), image->endAnnotations(),
+                                     createOptions(), 0),
+                 KisImageBuilder_RESULT_OK);
+    }
+}
+
+void KisJPEGBenchmark::benchmarkExport_data()
+{
+    QTest::addColumn<QString>("colorModel");
+
+    QTest::newRow("rgb") << RGBAColorModelID.id();
+    QTest::newRow("gray") << GrayAColorModelID.id();
+    QTest::newRow("cmyk") << CMYKAColorModelID.id();
+}
+
+void KisJPEGBenchmark::benchmarkExport()
+{
+    QFETCH(QString, colorModel);
+
+    QBENCHMARK {
+        exportBatch(colorModel);
+    }
+}
+
+void KisJPEGBenchmark::benchmarkImport_data()
+{
+    benchmarkExport_data();
+}
+
+void KisJPEGBenchmark::benchmarkImport()
+{
+    QFETCH(QString, colorModel);
+
+    exportBatch(colorModel);
+
+    QBENCHMARK {
+        for (int i = 0; i < NUM_IMAGES; i++) {
+            QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+            KisJPEGConverter converter(doc.data(), true);
+            QCOMPARE(converter.buildImage(fileName(i)), KisImageBuilder_RESULT_OK);
+
+            doc->setCurrentImage(converter.image());
+            QCOMPARE(doc->image()->width(), IMAGE_WIDTH);
+            QCOMPARE(doc->image()->height(), IMAGE_HEIGHT);
+            QCOMPARE(doc->image()->colorSpace()->colorModelId().id(), colorModel);
+        }
+    }
+}
+
+QTEST_MAIN(KisJPEGBenchmark)
@@ -0,0 +1,52 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __KIS_JPEG_BENCHMARK_H
+#define __KIS_JPEG_BENCHMARK_H
+
+#include <QtTest>
+
+#include <kis_types.h>
+
+/**
+ * Imports and exports a batch of medium-size photos, like when
+ * importing reference images or exporting thumbnails in batch mode
+ */
+class KisJPEGBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkExport_data();
+    void benchmarkExport();
+
+    void benchmarkImport_data();
+    void benchmarkImport();
+
+private:
+    QString fileName(int index) const;
+    void exportBatch(const QString &colorModel);
+
+private:
+    QString m_directory;
+};
+
+#endif /* __KIS_JPEG_BENCHMARK_H */
@@ -120,12 +120,6 @@ KisImportExportFilter::ConversionStatus KisPNGExport::convert(const QByteArray&
 
     if (!qApp->applicationName().toLower().contains("test")) {
 
-        KoDialog kdb;
-        kdb.setCaption(i18n("PNG Export Options"));
-        kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
-        KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
-        kdb.setMainWidget(wdg);
-
         // If a configuration object was passed to the convert method, we use that, otherwise we load from the settings
         if (configuration) {
             cfg->fromXML(configuration->toXML());
@@ -140,18 +134,24 @@ KisImportExportFilter::ConversionStatus KisPNGExport::convert(const QByteArray&
                      && !cs->profile()->name().contains(QLatin1String("g10")));
         cfg->setProperty("sRGB", sRGB);
         cfg->setProperty("isThereAlpha", isThereAlpha);
-        wdg->setConfiguration(cfg);
 
-        QApplication::restoreOverrideCursor();
-        if (hasVisibleWidgets()) {
-            if (!getBatchMode()) {
-                if (kdb.exec() == QDialog::Rejected) {
-                    return KisImportExportFilter::UserCancelled;
-                }
-                cfg = wdg->configuration();
-                KisConfig().setExportConfiguration("PNG", *cfg.data());
+        // batch exports don't show the dialog and may run on a pool thread
+        if (!getBatchMode() && hasVisibleWidgets()) {
+            KoDialog kdb;
+            kdb.setCaption(i18n("PNG Export Options"));
+            kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
+            KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
+            kdb.setMainWidget(wdg);
+
+            wdg->setConfiguration(cfg);
+
+            QApplication::restoreOverrideCursor();
 
+            if (kdb.exec() == QDialog::Rejected) {
+                return KisImportExportFilter::UserCancelled;
             }
+            cfg = wdg->configuration();
+            KisConfig().setExportConfiguration("PNG", *cfg.data());
         }
     }
 
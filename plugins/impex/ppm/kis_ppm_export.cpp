@@ -150,13 +150,6 @@ KisImportExportFilter::ConversionStatus KisPPMExport::convert(const QByteArray&
 
     if (filename.isEmpty()) return KisImportExportFilter::FileNotFound;
 
-    KoDialog kdb;
-    kdb.setWindowTitle(i18n("PPM Export Options"));
-    kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
-    KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
-    kdb.setMainWidget(wdg);
-    QApplication::restoreOverrideCursor();
-
     // If a configuration object was passed to the convert method, we use that, otherwise we load from the settings
     KisPropertiesConfigurationSP cfg(new KisPropertiesConfiguration());
     if (configuration) {
@@ -165,9 +158,17 @@ KisImportExportFilter::ConversionStatus KisPPMExport::convert(const QByteArray&
     else {
         cfg = lastSavedConfiguration(from, to);
     }
-    wdg->setConfiguration(cfg);
-
+    // the dialog is created only when it is going to be shown
     if (!getBatchMode()) {
+        KoDialog kdb;
+        kdb.setWindowTitle(i18n("PPM Export Options"));
+        kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
+        KisConfigWidget *wdg = createConfigurationWidget(&kdb, from, to);
+        kdb.setMainWidget(wdg);
+        QApplication::restoreOverrideCursor();
+
+        wdg->setConfiguration(cfg);
+
         if (kdb.exec() == QDialog::Rejected) {
             return KisImportExportFilter::UserCancelled;
         }
@@ -656,6 +656,11 @@ bool PSDLayerRecord::valid()
 }
 
 bool PSDLayerRecord::readPixelData(QIODevice *io, KisPaintDeviceSP device)
+{
+    return fetchPixelData(io) && decodePixelData(device);
+}
+
+bool PSDLayerRecord::fetchPixelData(QIODevice *io)
 {
     dbgFile << "Reading pixel data for layer" << layerName << "pos" << io->pos();
 
@@ -666,9 +671,9 @@ bool PSDLayerRecord::readPixelData(QIODevice *io, KisPaintDeviceSP device)
                                   bottom - top);
 
     try {
-        PsdPixelUtils::readChannels(io, device, m_header.colormode, channelSize, layerRect, channelInfoRecords);
+        m_fetchedPixelData = PsdPixelUtils::fetchChannels(io, m_header.colormode, channelSize, layerRect, channelInfoRecords);
     } catch (KisAslReaderUtils::ASLParseException &e) {
-        device->clear();
+        m_fetchedPixelData = PsdPixelUtils::RawPixelData();
         error = e.what();
         return false;
     }
@@ -676,6 +681,29 @@ bool PSDLayerRecord::readPixelData(QIODevice *io, KisPaintDeviceSP device)
     return true;
 }
 
+bool PSDLayerRecord::decodePixelData(KisPaintDeviceSP device)
+{
+    bool result = true;
+
+    try {
+        PsdPixelUtils::decodeChannels(m_fetchedPixelData, device);
+    } catch (KisAslReaderUtils::ASLParseException &e) {
+        device->clear();
+        error = e.what();
+        result = false;
+    }
+
+    // the raw data is not needed anymore
+    m_fetchedPixelData = PsdPixelUtils::RawPixelData();
+
+    return result;
+}
+
+qint64 PSDLayerRecord::fetchedPixelDataSize() const
+{
+    return m_fetchedPixelData.size();
+}
+
 QRect PSDLayerRecord::channelRect(ChannelInfo *channel) const
 {
     QRect result;
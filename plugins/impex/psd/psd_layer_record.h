@@ -33,6 +33,7 @@
 #include "compression.h"
 
 #include "psd_additional_layer_info_block.h"
+#include "psd_pixel_utils.h"
 
 #include <boost/function.hpp>
 
@@ -95,6 +96,21 @@ public:
 
     bool read(QIODevice* io);
     bool readPixelData(QIODevice* io, KisPaintDeviceSP device);
+
+    /**
+     * Reading of the pixel data can be split into two steps. Fetching
+     * the channel data needs the IO device, so it must be done for the
+     * layers one by one. Decoding of the fetched data can be done
+     * for several layers concurrently.
+     */
+    bool fetchPixelData(QIODevice* io);
+    bool decodePixelData(KisPaintDeviceSP device);
+
+    /**
+     * \return the size of the fetched, but not yet decoded pixel data
+     */
+    qint64 fetchedPixelDataSize() const;
+
     bool readMask(QIODevice* io, KisPaintDeviceSP dev, ChannelInfo *channel);
 
     void write(QIODevice* io, KisPaintDeviceSP layerContentDevice, KisNodeSP onlyTransparencyMask, const QRect &maskRect, psd_section_type sectionType, const QDomDocument &stylesXmlDoc);
@@ -162,6 +178,8 @@ private:
 
 private:
 
+    PsdPixelUtils::RawPixelData m_fetchedPixelData;
+
     KisPaintDeviceSP m_layerContentDevice;
     KisNodeSP m_onlyTransparencyMask;
     QRect m_onlyTransparencyMaskRect;
@@ -21,6 +21,7 @@
 
 #include <QFileInfo>
 #include <QStack>
+#include <QtConcurrent>
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
@@ -52,6 +53,49 @@
 #include "psd_resource_block.h"
 #include "psd_image_data.h"
 
+namespace {
+
+/**
+ * The fetched, but not yet decoded pixel data is kept in memory, so
+ * the layers are decoded in batches of limited size
+ */
+const qint64 MAX_PENDING_PIXEL_DATA_SIZE = 256 * 1024 * 1024;
+
+struct PendingLayer {
+    PendingLayer() : record(0), success(false) {}
+    PendingLayer(PSDLayerRecord *_record, KisPaintDeviceSP _device)
+        : record(_record), device(_device), success(false) {}
+
+    PSDLayerRecord *record;
+    KisPaintDeviceSP device;
+    bool success;
+};
+
+struct PendingLayerDecoder {
+    void operator() (PendingLayer &layer) {
+        layer.success = layer.record->decodePixelData(layer.device);
+    }
+};
+
+bool decodePendingLayers(QVector<PendingLayer> &layers)
+{
+    QtConcurrent::blockingMap(layers, PendingLayerDecoder());
+
+    bool result = true;
+
+    Q_FOREACH (const PendingLayer &layer, layers) {
+        if (!layer.success) {
+            dbgFile << "failed reading channels for layer: " << layer.record->layerName << layer.record->error;
+            result = false;
+        }
+    }
+
+    layers.clear();
+    return result;
+}
+
+}
+
 PSDLoader::PSDLoader(KisDocument *doc)
     : m_image(0)
     , m_doc(doc)
@@ -201,6 +245,9 @@ KisImageBuilder_Result PSDLoader::decode(const QString &filename)
     typedef QPair<QDomDocument, KisLayerSP> LayerStyleMapping;
     QVector<LayerStyleMapping> allStylesXml;
 
+    QVector<PendingLayer> pendingLayers;
+    qint64 pendingPixelDataSize = 0;
+
     // read the channels for the various layers
     for(int i = 0; i < layerSection.nLayers; ++i) {
 
@@ -277,10 +324,21 @@ KisImageBuilder_Result PSDLoader::decode(const QString &filename)
                 allStylesXml << LayerStyleMapping(styleXml, layer);
             }
 
-            if (!layerRecord->readPixelData(&f, layer->paintDevice())) {
+            if (!layerRecord->fetchPixelData(&f)) {
                 dbgFile << "failed reading channels for layer: " << layerRecord->layerName << layerRecord->error;
                 return KisImageBuilder_RESULT_FAILURE;
             }
+
+            pendingLayers << PendingLayer(layerRecord, layer->paintDevice());
+            pendingPixelDataSize += layerRecord->fetchedPixelDataSize();
+
+            if (pendingPixelDataSize > MAX_PENDING_PIXEL_DATA_SIZE) {
+                if (!decodePendingLayers(pendingLayers)) {
+                    return KisImageBuilder_RESULT_FAILURE;
+                }
+                pendingPixelDataSize = 0;
+            }
+
             if (!groupStack.isEmpty()) {
                 m_image->addNode(layer, groupStack.top());
             }
@@ -307,6 +365,10 @@ KisImageBuilder_Result PSDLoader::decode(const QString &filename)
         lastAddedLayer = newLayer;
     }
 
+    if (!decodePendingLayers(pendingLayers)) {
+        return KisImageBuilder_RESULT_FAILURE;
+    }
+
     const QVector<QDomDocument> &embeddedPatterns =
         layerSection.globalInfoSection.embeddedPatterns;
 
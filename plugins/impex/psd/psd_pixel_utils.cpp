@@ -19,9 +19,8 @@
 #include "psd_pixel_utils.h"
 
 #include <QtGlobal>
-#include <QMap>
 #include <QIODevice>
-
+#include <QtConcurrent>
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceMaths.h>
@@ -109,154 +108,167 @@ inline float convertByteOrder<KoLabF32Traits>(float value) {
     return qFromBigEndian((quint32)value);
 }
 
+/**
+ * Pointers to the beginning of the decoded rows of every PSD
+ * channel. The color channels are stored in the PSD order, \p alpha
+ * is null if the layer has no transparency channel.
+ */
+struct ChannelRows {
+    ChannelRows() : alpha(0) {
+        color[0] = color[1] = color[2] = color[3] = 0;
+    }
+
+    const quint8 *color[4];
+    const quint8 *alpha;
+};
+
 template <class Traits>
-void readGrayPixel(const QMap<quint16, QByteArray> &channelBytes,
-                  int col, quint8 *dstPtr)
+inline const typename Traits::channels_type* channelPtr(const quint8 *row)
+{
+    return reinterpret_cast<const typename Traits::channels_type*>(row);
+}
+
+template <class Traits>
+inline void readAlpha(const quint8 *alphaRow, int numPixels, quint8 *dstPtr)
 {
     typedef typename Traits::Pixel Pixel;
     typedef typename Traits::channels_type channels_type;
 
-    const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
-    channels_type opacity = unitValue;
-    if (channelBytes.contains(-1)) {
-        opacity = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[-1].constData())[col]);
-    }
-
     Pixel *pixelPtr = reinterpret_cast<Pixel*>(dstPtr);
 
-    channels_type gray = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[0].constData())[col]);
+    if (alphaRow) {
+        const channels_type *alpha = channelPtr<Traits>(alphaRow);
+
+        for (int i = 0; i < numPixels; i++) {
+            pixelPtr[i].alpha = convertByteOrder<Traits>(alpha[i]);
+        }
+    } else {
+        const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
 
-    pixelPtr->gray = gray;
-    pixelPtr->alpha = opacity;
+        for (int i = 0; i < numPixels; i++) {
+            pixelPtr[i].alpha = unitValue;
+        }
+    }
 }
 
+/**
+ * The planar-to-interleaved conversion is done for the whole row at
+ * once. Every loop touches only contiguous arrays and has no
+ * branches inside, so the compiler can vectorize it.
+ */
+
 template <class Traits>
-void readRgbPixel(const QMap<quint16, QByteArray> &channelBytes,
-                  int col, quint8 *dstPtr)
+void readGrayPixels(const ChannelRows &rows, int numPixels, quint8 *dstPtr)
 {
     typedef typename Traits::Pixel Pixel;
     typedef typename Traits::channels_type channels_type;
 
-    const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
-    channels_type opacity = unitValue;
-    if (channelBytes.contains(-1)) {
-        opacity = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[-1].constData())[col]);
-    }
-
     Pixel *pixelPtr = reinterpret_cast<Pixel*>(dstPtr);
+    const channels_type *gray = channelPtr<Traits>(rows.color[0]);
 
-    channels_type blue = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[2].constData())[col]);
-    channels_type green = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[1].constData())[col]);
-    channels_type red = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[0].constData())[col]);
+    for (int i = 0; i < numPixels; i++) {
+        pixelPtr[i].gray = convertByteOrder<Traits>(gray[i]);
+    }
 
-    pixelPtr->blue = blue;
-    pixelPtr->green = green;
-    pixelPtr->red = red;
-    pixelPtr->alpha = opacity;
+    readAlpha<Traits>(rows.alpha, numPixels, dstPtr);
 }
 
 template <class Traits>
-void readCmykPixel(const QMap<quint16, QByteArray> &channelBytes,
-                       int col, quint8 *dstPtr)
+void readRgbPixels(const ChannelRows &rows, int numPixels, quint8 *dstPtr)
 {
     typedef typename Traits::Pixel Pixel;
     typedef typename Traits::channels_type channels_type;
 
-    const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
-    channels_type opacity = unitValue;
-    if (channelBytes.contains(-1)) {
-        opacity = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[-1].constData())[col]);
-    }
-
     Pixel *pixelPtr = reinterpret_cast<Pixel*>(dstPtr);
+    const channels_type *red = channelPtr<Traits>(rows.color[0]);
+    const channels_type *green = channelPtr<Traits>(rows.color[1]);
+    const channels_type *blue = channelPtr<Traits>(rows.color[2]);
+
+    for (int i = 0; i < numPixels; i++) {
+        pixelPtr[i].blue = convertByteOrder<Traits>(blue[i]);
+        pixelPtr[i].green = convertByteOrder<Traits>(green[i]);
+        pixelPtr[i].red = convertByteOrder<Traits>(red[i]);
+    }
 
-    channels_type cyan = unitValue - convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[0].constData())[col]);
-    channels_type magenta = unitValue - convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[1].constData())[col]);
-    channels_type yellow = unitValue - convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[2].constData())[col]);
-    channels_type black = unitValue - convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[3].constData())[col]);
-
-    pixelPtr->cyan = cyan;
-    pixelPtr->magenta = magenta;
-    pixelPtr->yellow = yellow;
-    pixelPtr->black = black;
-    pixelPtr->alpha = opacity;
+    readAlpha<Traits>(rows.alpha, numPixels, dstPtr);
 }
 
 template <class Traits>
-void readLabPixel(const QMap<quint16, QByteArray> &channelBytes,
-                  int col, quint8 *dstPtr)
+void readCmykPixels(const ChannelRows &rows, int numPixels, quint8 *dstPtr)
 {
     typedef typename Traits::Pixel Pixel;
     typedef typename Traits::channels_type channels_type;
 
     const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
-    channels_type opacity = unitValue;
-    if (channelBytes.contains(-1)) {
-        opacity = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[-1].constData())[col]);
-    }
 
     Pixel *pixelPtr = reinterpret_cast<Pixel*>(dstPtr);
+    const channels_type *cyan = channelPtr<Traits>(rows.color[0]);
+    const channels_type *magenta = channelPtr<Traits>(rows.color[1]);
+    const channels_type *yellow = channelPtr<Traits>(rows.color[2]);
+    const channels_type *black = channelPtr<Traits>(rows.color[3]);
+
+    for (int i = 0; i < numPixels; i++) {
+        pixelPtr[i].cyan = unitValue - convertByteOrder<Traits>(cyan[i]);
+        pixelPtr[i].magenta = unitValue - convertByteOrder<Traits>(magenta[i]);
+        pixelPtr[i].yellow = unitValue - convertByteOrder<Traits>(yellow[i]);
+        pixelPtr[i].black = unitValue - convertByteOrder<Traits>(black[i]);
+    }
 
-    channels_type L = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[0].constData())[col]);
-    channels_type a = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[1].constData())[col]);
-    channels_type b = convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(channelBytes[2].constData())[col]);
-
-    pixelPtr->L = L;
-    pixelPtr->a = a;
-    pixelPtr->b = b;
-    pixelPtr->alpha = opacity;
+    readAlpha<Traits>(rows.alpha, numPixels, dstPtr);
 }
 
-void readRgbPixelCommon(int channelSize,
-                               const QMap<quint16, QByteArray> &channelBytes,
-                               int col, quint8 *dstPtr)
+template <class Traits>
+void readLabPixels(const ChannelRows &rows, int numPixels, quint8 *dstPtr)
 {
-    if (channelSize == 1) {
-        readRgbPixel<KoBgrU8Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 2) {
-        readRgbPixel<KoBgrU16Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 4) {
-        readRgbPixel<KoBgrU16Traits>(channelBytes, col, dstPtr);
-    }
-}
+    typedef typename Traits::Pixel Pixel;
+    typedef typename Traits::channels_type channels_type;
 
-void readGrayPixelCommon(int channelSize,
-                                const QMap<quint16, QByteArray> &channelBytes,
-                                int col, quint8 *dstPtr)
-{
-    if (channelSize == 1) {
-        readGrayPixel<KoGrayU8Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 2) {
-        readGrayPixel<KoGrayU16Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 4) {
-        readGrayPixel<KoGrayU32Traits>(channelBytes, col, dstPtr);
+    Pixel *pixelPtr = reinterpret_cast<Pixel*>(dstPtr);
+    const channels_type *L = channelPtr<Traits>(rows.color[0]);
+    const channels_type *a = channelPtr<Traits>(rows.color[1]);
+    const channels_type *b = channelPtr<Traits>(rows.color[2]);
+
+    for (int i = 0; i < numPixels; i++) {
+        pixelPtr[i].L = convertByteOrder<Traits>(L[i]);
+        pixelPtr[i].a = convertByteOrder<Traits>(a[i]);
+        pixelPtr[i].b = convertByteOrder<Traits>(b[i]);
     }
-}
 
-void readCmykPixelCommon(int channelSize,
-                                const QMap<quint16, QByteArray> &channelBytes,
-                                int col, quint8 *dstPtr)
-{
-    if (channelSize == 1) {
-        readCmykPixel<KoCmykU8Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 2) {
-        readCmykPixel<KoCmykU16Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 4) {
-        readCmykPixel<KoCmykF32Traits>(channelBytes, col, dstPtr);
-    }
+    readAlpha<Traits>(rows.alpha, numPixels, dstPtr);
 }
 
-void readLabPixelCommon(int channelSize,
-                                const QMap<quint16, QByteArray> &channelBytes,
-                                int col, quint8 *dstPtr)
+typedef void (*PixelsFunc)(const ChannelRows &rows, int numPixels, quint8 *dstPtr);
+
+PixelsFunc pixelsFuncForColorMode(psd_color_mode colorMode, int channelSize)
 {
-    if (channelSize == 1) {
-        readLabPixel<KoLabU8Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 2) {
-        readLabPixel<KoLabU16Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 4) {
-        readLabPixel<KoLabF32Traits>(channelBytes, col, dstPtr);
+    switch (colorMode) {
+    case Grayscale:
+        return channelSize == 1 ? &readGrayPixels<KoGrayU8Traits> :
+               channelSize == 2 ? &readGrayPixels<KoGrayU16Traits> :
+               channelSize == 4 ? &readGrayPixels<KoGrayU32Traits> : 0;
+    case RGB:
+        return channelSize == 1 ? &readRgbPixels<KoBgrU8Traits> :
+               channelSize == 2 ? &readRgbPixels<KoBgrU16Traits> :
+               channelSize == 4 ? &readRgbPixels<KoBgrU16Traits> : 0;
+    case CMYK:
+        return channelSize == 1 ? &readCmykPixels<KoCmykU8Traits> :
+               channelSize == 2 ? &readCmykPixels<KoCmykU16Traits> :
+               channelSize == 4 ? &readCmykPixels<KoCmykF32Traits> : 0;
+    case Lab:
+        return channelSize == 1 ? &readLabPixels<KoLabU8Traits> :
+               channelSize == 2 ? &readLabPixels<KoLabU16Traits> :
+               channelSize == 4 ? &readLabPixels<KoLabF32Traits> : 0;
+    case Bitmap:
+    case Indexed:
+    case MultiChannel:
+    case DuoTone:
+    case COLORMODE_UNKNOWN:
+    default:
+        QString error = QString("Unsupported color mode: %1").arg(colorMode);
+        throw KisAslReaderUtils::ASLParseException(error);
     }
+
+    return 0;
 }
 
 /**********************************************************************/
@@ -352,112 +364,281 @@ psd_status psd_unzip_with_prediction(psd_uchar *src_buf, psd_int src_len,
 /* End of third party block                                           */
 /**********************************************************************/
 
-QMap<quint16, QByteArray> fetchChannelsBytes(QIODevice *io, QVector<ChannelInfo*> channelInfoRecords,
-                                            int row, int width, int channelSize)
+/**
+ * The rows are decoded in stripes aligned to the tiles of the paint
+ * device, so that different threads never write into the same tile.
+ */
+const int DECODING_STRIPE_HEIGHT = 64;
+
+int colorChannelsCount(psd_color_mode colorMode)
+{
+    return colorMode == Grayscale ? 1 : colorMode == CMYK ? 4 : 3;
+}
+
+RawPixelData fetchChannels(QIODevice *io,
+                           psd_color_mode colorMode,
+                           int channelSize,
+                           const QRect &layerRect,
+                           QVector<ChannelInfo*> infoRecords)
 {
-    const int uncompressedLength = width * channelSize;
+    KisOffsetKeeper keeper(io);
+
+    RawPixelData data;
+    data.colorMode = colorMode;
+    data.channelSize = channelSize;
+    data.rect = layerRect;
+
+    if (layerRect.isEmpty()) {
+        dbgFile << "Empty layer!";
+        return data;
+    }
 
-    QMap<quint16, QByteArray> channelBytes;
+    const qint64 planeLength = qint64(layerRect.width()) * layerRect.height() * channelSize;
 
-    Q_FOREACH (ChannelInfo *channelInfo, channelInfoRecords) {
+    Q_FOREACH (ChannelInfo *channelInfo, infoRecords) {
         // user supplied masks are ignored here
         if (channelInfo->channelId < -1) continue;
 
-        io->seek(channelInfo->channelDataStart + channelInfo->channelOffset);
+        RawChannelData channel;
+        channel.channelId = channelInfo->channelId;
+        channel.compressionType = channelInfo->compressionType;
 
         if (channelInfo->compressionType == Compression::Uncompressed) {
-            channelBytes[channelInfo->channelId] = io->read(uncompressedLength);
-            channelInfo->channelOffset += uncompressedLength;
+            io->seek(channelInfo->channelDataStart + channelInfo->channelOffset);
+            channel.bytes = io->read(planeLength);
+            channelInfo->channelOffset += planeLength;
+
+            if (channel.bytes.size() < planeLength) {
+                dbgFile << "WARNING: fetchChannels: channel data is truncated" << ppVar(channel.channelId);
+                channel.bytes.append(QByteArray(planeLength - channel.bytes.size(), 0));
+            }
         }
         else if (channelInfo->compressionType == Compression::RLE) {
-            int rleLength = channelInfo->rleRowLengths[row];
-            QByteArray compressedBytes = io->read(rleLength);
-            QByteArray uncompressedBytes = Compression::uncompress(uncompressedLength, compressedBytes, channelInfo->compressionType);
-            channelBytes.insert(channelInfo->channelId, uncompressedBytes);
+            if (channelInfo->rleRowLengths.size() < layerRect.height()) {
+                QString error = QString("Not enough RLE row lengths for channel: id = %1").arg(channelInfo->channelId);
+                dbgFile << "ERROR: fetchChannels:" << error;
+                throw KisAslReaderUtils::ASLParseException(error);
+            }
+
+            channel.rleRowLengths = channelInfo->rleRowLengths.mid(0, layerRect.height());
+
+            qint64 rleLength = 0;
+            Q_FOREACH (quint32 rowLength, channel.rleRowLengths) {
+                rleLength += rowLength;
+            }
+
+            io->seek(channelInfo->channelDataStart + channelInfo->channelOffset);
+            channel.bytes = io->read(rleLength);
             channelInfo->channelOffset += rleLength;
+
+            if (channel.bytes.size() < rleLength) {
+                dbgFile << "WARNING: fetchChannels: RLE data is truncated" << ppVar(channel.channelId);
+                channel.bytes.append(QByteArray(rleLength - channel.bytes.size(), 0));
+            }
+        }
+        else if (channelInfo->compressionType == Compression::ZIP ||
+                 channelInfo->compressionType == Compression::ZIPWithPrediction) {
+
+            io->seek(channelInfo->channelDataStart);
+            channel.bytes = io->read(channelInfo->channelDataLength);
         }
         else {
             QString error = QString("Unsupported Compression mode: %1").arg(channelInfo->compressionType);
-            dbgFile << "ERROR: fetchChannelsBytes:" << error;
+            dbgFile << "ERROR: fetchChannels:" << error;
             throw KisAslReaderUtils::ASLParseException(error);
         }
+
+        data.channels << channel;
     }
 
-    return channelBytes;
+    return data;
 }
 
-typedef boost::function<void(int, const QMap<quint16, QByteArray>&, int, quint8*)> PixelFunc;
+qint64 RawPixelData::size() const
+{
+    qint64 result = 0;
+
+    Q_FOREACH (const RawChannelData &channel, channels) {
+        result += channel.bytes.size();
+    }
 
-void readCommon(KisPaintDeviceSP dev,
-                QIODevice *io,
-                const QRect &layerRect,
-                QVector<ChannelInfo*> infoRecords,
-                int channelSize,
-                PixelFunc pixelFunc)
+    return result;
+}
+
+QByteArray unzipChannel(const RawChannelData &channel, const QRect &layerRect, int channelSize)
 {
-    KisOffsetKeeper keeper(io);
+    QByteArray compressedBytes = channel.bytes;
+    QByteArray uncompressedBytes(layerRect.width() * layerRect.height() * channelSize, 0);
 
-    if (layerRect.isEmpty()) {
-        dbgFile << "Empty layer!";
-        return;
+    bool status = false;
+    if (channel.compressionType == Compression::ZIP) {
+        status = psd_unzip_without_prediction((quint8*)compressedBytes.data(), compressedBytes.size(),
+                                              (quint8*)uncompressedBytes.data(), uncompressedBytes.size());
+    } else {
+        status = psd_unzip_with_prediction((quint8*)compressedBytes.data(), compressedBytes.size(),
+                                           (quint8*)uncompressedBytes.data(), uncompressedBytes.size(),
+                                           layerRect.width(), channelSize * 8);
     }
 
-    if (infoRecords.first()->compressionType == Compression::ZIP ||
-        infoRecords.first()->compressionType == Compression::ZIPWithPrediction) {
+    if (!status) {
+        QString error = QString("Failed to unzip channel data: id = %1, compression = %2").arg(channel.channelId).arg(channel.compressionType);
+        dbgFile << "ERROR:" << error;
+        dbgFile << "      " << ppVar(channel.channelId);
+        dbgFile << "      " << ppVar(channel.bytes.size());
+        dbgFile << "      " << ppVar(channel.compressionType);
+        throw KisAslReaderUtils::ASLParseException(error);
+    }
 
-        const int numPixels = channelSize * layerRect.width() * layerRect.height();
+    return uncompressedBytes;
+}
 
-        QMap<quint16, QByteArray> channelBytes;
+struct DecodingContext {
+    const RawPixelData *data;
+    KisPaintDeviceSP device;
+    PixelsFunc pixelsFunc;
+    int rowLength;
 
-        Q_FOREACH (ChannelInfo *info, infoRecords) {
-            io->seek(info->channelDataStart);
-            QByteArray compressedBytes = io->read(info->channelDataLength);
-            QByteArray uncompressedBytes(numPixels, 0);
+    /// fully decoded planes of uncompressed and ZIP-compressed channels
+    QVector<QByteArray> planes;
 
-            bool status = false;
-            if (infoRecords.first()->compressionType == Compression::ZIP) {
-                status = psd_unzip_without_prediction((quint8*)compressedBytes.data(), compressedBytes.size(),
-                                                      (quint8*)uncompressedBytes.data(), uncompressedBytes.size());
-            } else {
-                status = psd_unzip_with_prediction((quint8*)compressedBytes.data(), compressedBytes.size(),
-                                                   (quint8*)uncompressedBytes.data(), uncompressedBytes.size(),
-                                                   layerRect.width(), channelSize * 8);
+    /// offsets of the first row of every stripe of RLE-compressed channels
+    QVector<QVector<int> > rleRowOffsets;
+
+    /// a plane of zeros, used for the channels missing in the file
+    QByteArray zeroRow;
+};
+
+struct StripeDecoder {
+    StripeDecoder(const DecodingContext *context) : m_context(context) {}
+
+    void operator() (const QRect &stripe) {
+        const RawPixelData &data = *m_context->data;
+        const int numChannels = data.channels.size();
+        const int rowLength = m_context->rowLength;
+        const int stripeOffset = stripe.y() - data.rect.y();
+
+        QVector<QByteArray> rleRows(numChannels);
+
+        for (int i = 0; i < numChannels; i++) {
+            const RawChannelData &channel = data.channels[i];
+            if (channel.compressionType != Compression::RLE) continue;
+
+            rleRows[i] = QByteArray(stripe.height() * rowLength, 0);
+            char *dstPtr = rleRows[i].data();
+
+            for (int row = 0; row < stripe.height(); row++) {
+                const int rowIndex = stripeOffset + row;
+
+                Compression::uncompressRLE(channel.bytes.constData() + m_context->rleRowOffsets[i][rowIndex],
+                                           channel.rleRowLengths[rowIndex],
+                                           dstPtr, rowLength);
+                dstPtr += rowLength;
             }
+        }
 
-            if (!status) {
-                QString error = QString("Failed to unzip channel data: id = %1, compression = %2").arg(info->channelId).arg(info->compressionType);
-                dbgFile << "ERROR:" << error;
-                dbgFile << "      " << ppVar(info->channelId);
-                dbgFile << "      " << ppVar(info->channelDataStart);
-                dbgFile << "      " << ppVar(info->channelDataLength);
-                dbgFile << "      " << ppVar(info->compressionType);
-                throw KisAslReaderUtils::ASLParseException(error);
+        const int pixelSize = m_context->device->pixelSize();
+        QByteArray pixels(stripe.width() * stripe.height() * pixelSize, 0);
+
+        for (int row = 0; row < stripe.height(); row++) {
+            ChannelRows rows;
+
+            for (int i = 0; i < 4; i++) {
+                rows.color[i] = reinterpret_cast<const quint8*>(m_context->zeroRow.constData());
             }
 
-            channelBytes.insert(info->channelId, uncompressedBytes);
+            for (int i = 0; i < numChannels; i++) {
+                const RawChannelData &channel = data.channels[i];
+
+                const quint8 *rowPtr =
+                    channel.compressionType == Compression::RLE ?
+                    reinterpret_cast<const quint8*>(rleRows[i].constData()) + row * rowLength :
+                    reinterpret_cast<const quint8*>(m_context->planes[i].constData()) + (stripeOffset + row) * rowLength;
+
+                if (channel.channelId == -1) {
+                    rows.alpha = rowPtr;
+                } else if (channel.channelId >= 0 && channel.channelId < 4) {
+                    rows.color[channel.channelId] = rowPtr;
+                }
+            }
+
+            m_context->pixelsFunc(rows, stripe.width(),
+                                  reinterpret_cast<quint8*>(pixels.data()) + row * stripe.width() * pixelSize);
         }
 
-        KisSequentialIterator it(dev, layerRect);
-        int col = 0;
-        do {
-            pixelFunc(channelSize, channelBytes, col, it.rawData());
-            col++;
-        } while(it.nextPixel());
+        m_context->device->writeBytes(reinterpret_cast<const quint8*>(pixels.constData()), stripe);
+    }
 
-    } else {
-        KisHLineIteratorSP it = dev->createHLineIteratorNG(layerRect.left(), layerRect.top(), layerRect.width());
-        for (int i = 0 ; i < layerRect.height(); i++) {
-            QMap<quint16, QByteArray> channelBytes;
+private:
+    const DecodingContext *m_context;
+};
+
+void decodeChannels(const RawPixelData &data, KisPaintDeviceSP device)
+{
+    const QRect &layerRect = data.rect;
+
+    if (layerRect.isEmpty()) {
+        dbgFile << "Empty layer!";
+        return;
+    }
+
+    DecodingContext context;
+    context.data = &data;
+    context.device = device;
+    context.pixelsFunc = pixelsFuncForColorMode(data.colorMode, data.channelSize);
+    context.rowLength = layerRect.width() * data.channelSize;
+    context.zeroRow = QByteArray(context.rowLength, 0);
+
+    if (!context.pixelsFunc) {
+        QString error = QString("Unsupported channel size: %1").arg(data.channelSize);
+        throw KisAslReaderUtils::ASLParseException(error);
+    }
+
+    Q_FOREACH (const RawChannelData &channel, data.channels) {
+        QByteArray plane;
+        QVector<int> rowOffsets;
 
-            channelBytes = fetchChannelsBytes(io, infoRecords,
-                                              i, layerRect.width(), channelSize);
+        if (channel.compressionType == Compression::RLE) {
+            rowOffsets.reserve(channel.rleRowLengths.size());
 
-            for (qint64 col = 0; col < layerRect.width(); col++){
-                pixelFunc(channelSize, channelBytes, col, it->rawData());
-                it->nextPixel();
+            int offset = 0;
+            Q_FOREACH (quint32 rowLength, channel.rleRowLengths) {
+                rowOffsets << offset;
+                offset += rowLength;
             }
-            it->nextRow();
+        } else if (channel.compressionType == Compression::Uncompressed) {
+            plane = channel.bytes;
+        } else {
+            // a ZIP stream cannot be split, so unpack the whole plane
+            plane = unzipChannel(channel, layerRect, data.channelSize);
         }
+
+        context.planes << plane;
+        context.rleRowOffsets << rowOffsets;
+    }
+
+    if (data.channels.size() < colorChannelsCount(data.colorMode)) {
+        dbgFile << "WARNING: some color channels are missing, they will be filled with zeros";
+    }
+
+    QVector<QRect> stripes;
+    for (int y = layerRect.top(); y <= layerRect.bottom();) {
+        const int stripeIndex = y >= 0 ?
+            y / DECODING_STRIPE_HEIGHT :
+            -((-y - 1) / DECODING_STRIPE_HEIGHT) - 1;
+
+        const int nextStripeY = (stripeIndex + 1) * DECODING_STRIPE_HEIGHT;
+        const int height = qMin(nextStripeY, layerRect.bottom() + 1) - y;
+
+        stripes << QRect(layerRect.x(), y, layerRect.width(), height);
+        y += height;
+    }
+
+    StripeDecoder decoder(&context);
+
+    if (stripes.size() > 1) {
+        QtConcurrent::blockingMap(stripes, decoder);
+    } else {
+        decoder(stripes.first());
     }
 }
 
@@ -468,31 +649,23 @@ void readChannels(QIODevice *io,
                   const QRect &layerRect,
                   QVector<ChannelInfo*> infoRecords)
 {
-    switch (colorMode) {
-    case Grayscale:
-        readCommon(device, io, layerRect, infoRecords, channelSize, &readGrayPixelCommon);
-        break;
-    case RGB:
-        readCommon(device, io, layerRect, infoRecords, channelSize, &readRgbPixelCommon);
-        break;
-    case CMYK:
-        readCommon(device, io, layerRect, infoRecords, channelSize, &readCmykPixelCommon);
-        break;
-    case Lab:
-        readCommon(device, io, layerRect, infoRecords, channelSize, &readLabPixelCommon);
-        break;
-    case Bitmap:
-    case Indexed:
-    case MultiChannel:
-    case DuoTone:
-    case COLORMODE_UNKNOWN:
-    default:
-        QString error = QString("Unsupported color mode: %1").arg(colorMode);
-        throw KisAslReaderUtils::ASLParseException(error);
+    decodeChannels(fetchChannels(io, colorMode, channelSize, layerRect, infoRecords), device);
+}
+
+QVector<QByteArray> compressRowsRLE(const quint8 *plane, const int channelSize, const QRect &rc)
+{
+    QVector<QByteArray> rows(rc.height());
+
+    const quint32 stride = channelSize * rc.width();
+    for (qint32 row = 0; row < rc.height(); ++row) {
+        QByteArray uncompressed = QByteArray::fromRawData((const char*)plane + row * stride, stride);
+        rows[row] = Compression::compress(uncompressed, Compression::RLE);
     }
+
+    return rows;
 }
 
-void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSize, const QRect &rc, const qint64 sizeFieldOffset, const qint64 rleBlockOffset, const bool writeCompressionType)
+void writeCompressedRowsRLE(QIODevice *io, const QVector<QByteArray> &rows, const qint64 sizeFieldOffset, const qint64 rleBlockOffset, const bool writeCompressionType)
 {
     typedef KisAslWriterUtils::OffsetStreamPusher<quint32> Pusher;
     QScopedPointer<Pusher> channelBlockSizeExternalTag;
@@ -518,18 +691,15 @@ void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSi
         }
 
         // write zero's for the channel lengths block
-        for(int i = 0; i < rc.height(); ++i) {
+        for(int i = 0; i < rows.size(); ++i) {
             // XXX: choose size for PSB!
             const quint16 fakeRLEBLockSize = 0;
             SAFE_WRITE_EX(io, fakeRLEBLockSize);
         }
     }
 
-    quint32 stride = channelSize * rc.width();
-    for (qint32 row = 0; row < rc.height(); ++row) {
-
-        QByteArray uncompressed = QByteArray::fromRawData((const char*)plane + row * stride, stride);
-        QByteArray compressed = Compression::compress(uncompressed, Compression::RLE);
+    for (qint32 row = 0; row < rows.size(); ++row) {
+        const QByteArray &compressed = rows[row];
 
         KisAslWriterUtils::OffsetStreamPusher<quint16> rleExternalTag(io, 0, channelRLESizePos + row * sizeof(quint16));
 
@@ -539,6 +709,11 @@ void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSi
     }
 }
 
+void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSize, const QRect &rc, const qint64 sizeFieldOffset, const qint64 rleBlockOffset, const bool writeCompressionType)
+{
+    writeCompressedRowsRLE(io, compressRowsRLE(plane, channelSize, rc), sizeFieldOffset, rleBlockOffset, writeCompressionType);
+}
+
 inline void preparePixelForWrite(quint8 *dataPlane,
                                  int numPixels,
                                  int channelSize,
@@ -582,17 +757,53 @@ inline void preparePixelForWrite(quint8 *dataPlane,
     }
 }
 
-void writePixelDataCommon(QIODevice *io,
-                          KisPaintDeviceSP dev,
-                          const QRect &rc,
-                          psd_color_mode colorMode,
-                          int channelSize,
-                          bool alphaFirst,
-                          const bool writeCompressionType,
-                          QVector<ChannelWritingInfo> &writingInfoList)
+/**
+ * A piece of work for encoding: a stripe of rows of a single channel
+ */
+struct EncodingJob {
+    quint8 *plane;
+    int firstRow;
+    int numRows;
+    qint16 channelId;
+    QByteArray *dstRows;
+};
+
+const int ENCODING_STRIPE_HEIGHT = 64;
+
+struct StripeEncoder {
+    StripeEncoder(const QRect &rc, int channelSize, psd_color_mode colorMode)
+        : m_rc(rc), m_channelSize(channelSize), m_colorMode(colorMode) {}
+
+    void operator() (const EncodingJob &job) {
+        const int stride = m_rc.width() * m_channelSize;
+        quint8 *stripePtr = job.plane + job.firstRow * stride;
+
+        preparePixelForWrite(stripePtr, job.numRows * m_rc.width(), m_channelSize, job.channelId, m_colorMode);
+
+        for (int row = 0; row < job.numRows; row++) {
+            QByteArray uncompressed = QByteArray::fromRawData((const char*)stripePtr + row * stride, stride);
+            job.dstRows[job.firstRow + row] = Compression::compress(uncompressed, Compression::RLE);
+        }
+    }
+
+private:
+    QRect m_rc;
+    int m_channelSize;
+    psd_color_mode m_colorMode;
+};
+
+PreparedPixelData preparePixelDataCommon(KisPaintDeviceSP dev,
+                                         const QRect &rc,
+                                         psd_color_mode colorMode,
+                                         int channelSize,
+                                         bool alphaFirst,
+                                         const QVector<ChannelWritingInfo> &writingInfoList)
 {
+    PreparedPixelData result;
+    result.rect = rc;
+
     // Empty rects must be processed separately on a higher level!
-    KIS_ASSERT_RECOVER_RETURN(!rc.isEmpty());
+    KIS_ASSERT_RECOVER_RETURN_VALUE(!rc.isEmpty(), result);
 
     QVector<quint8* > tmp = dev->readPlanarBytes(rc.x() - dev->x(), rc.y() - dev->y(), rc.width(), rc.height());
     const KoColorSpace *colorSpace = dev->colorSpace();
@@ -633,34 +844,85 @@ void writePixelDataCommon(QIODevice *io,
         tmp.clear();
     }
 
-    KIS_ASSERT_RECOVER_RETURN(planes.size() >= writingInfoList.size());
+    KIS_ASSERT_RECOVER(planes.size() >= writingInfoList.size()) {
+        qDeleteAll(planes);
+        return result;
+    }
+
+    // all the rows of all the channels are converted and compressed concurrently
+
+    result.channelRows.resize(writingInfoList.size());
+
+    QVector<EncodingJob> jobs;
+
+    for (int i = 0; i < writingInfoList.size(); i++) {
+        result.channelRows[i].resize(rc.height());
+        QByteArray *dstRows = result.channelRows[i].data();
+
+        for (int row = 0; row < rc.height(); row += ENCODING_STRIPE_HEIGHT) {
+            EncodingJob job;
+            job.plane = planes[i];
+            job.firstRow = row;
+            job.numRows = qMin(ENCODING_STRIPE_HEIGHT, rc.height() - row);
+            job.channelId = writingInfoList[i].channelId;
+            job.dstRows = dstRows;
+
+            jobs << job;
+        }
+    }
+
+    StripeEncoder encoder(rc, channelSize, colorMode);
+
+    if (jobs.size() > 1) {
+        QtConcurrent::blockingMap(jobs, encoder);
+    } else if (!jobs.isEmpty()) {
+        encoder(jobs.first());
+    }
 
-    const int numPixels = rc.width() * rc.height();
+    qDeleteAll(planes);
+    planes.clear();
+
+    return result;
+}
 
-    // write down the planes
+void writePreparedPixelData(QIODevice *io,
+                            const PreparedPixelData &data,
+                            const bool writeCompressionType,
+                            const QVector<ChannelWritingInfo> &writingInfoList)
+{
+    KIS_ASSERT_RECOVER_RETURN(data.channelRows.size() == writingInfoList.size());
 
     try {
         for (int i = 0; i < writingInfoList.size(); i++) {
             const ChannelWritingInfo &info = writingInfoList[i];
 
             dbgFile << "\tWriting channel" << i << "psd channel id" << info.channelId;
-
-            preparePixelForWrite(planes[i], numPixels, channelSize, info.channelId, colorMode);
-
             dbgFile << "\t\tchannel start" << ppVar(io->pos());
 
-            writeChannelDataRLE(io, planes[i], channelSize, rc, info.sizeFieldOffset, info.rleBlockOffset, writeCompressionType);
+            writeCompressedRowsRLE(io, data.channelRows[i], info.sizeFieldOffset, info.rleBlockOffset, writeCompressionType);
         }
 
     } catch (KisAslWriterUtils::ASLWriteException &e) {
-        qDeleteAll(planes);
-        planes.clear();
-
         throw KisAslWriterUtils::ASLWriteException(PREPEND_METHOD(e.what()));
     }
+}
 
-    qDeleteAll(planes);
-    planes.clear();
+void writePixelDataCommon(QIODevice *io,
+                          KisPaintDeviceSP dev,
+                          const QRect &rc,
+                          psd_color_mode colorMode,
+                          int channelSize,
+                          bool alphaFirst,
+                          const bool writeCompressionType,
+                          QVector<ChannelWritingInfo> &writingInfoList)
+{
+    // Empty rects must be processed separately on a higher level!
+    KIS_ASSERT_RECOVER_RETURN(!rc.isEmpty());
+
+    PreparedPixelData data =
+        preparePixelDataCommon(dev, rc, colorMode, channelSize, alphaFirst, writingInfoList);
+
+    writePreparedPixelData(io, data, writeCompressionType, writingInfoList);
 }
 
 }
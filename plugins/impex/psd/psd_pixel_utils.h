@@ -21,9 +21,11 @@
 
 #include <QVector>
 #include <QRect>
+#include <QByteArray>
 
 #include "psd.h"
 #include "kis_types.h"
+#include "compression.h"
 
 class QIODevice;
 struct ChannelInfo;
@@ -42,6 +44,55 @@ namespace PsdPixelUtils
         int rleBlockOffset;
     };
 
+    /**
+     * The data of a single channel exactly as it is stored in the file
+     */
+    struct RawChannelData {
+        RawChannelData() : channelId(0), compressionType(Compression::Unknown) {}
+
+        qint16 channelId;
+        Compression::CompressionType compressionType;
+        QVector<quint32> rleRowLengths;
+        QByteArray bytes;
+    };
+
+    /**
+     * The pixel data of a layer fetched from the file in one go. Decoding
+     * of this data doesn't access the IO device anymore, so several
+     * layers can be decoded concurrently.
+     */
+    struct RawPixelData {
+        RawPixelData() : colorMode(COLORMODE_UNKNOWN), channelSize(0) {}
+
+        /**
+         * \return the total size of the stored channel data in bytes
+         */
+        qint64 size() const;
+
+        psd_color_mode colorMode;
+        int channelSize;
+        QRect rect;
+        QVector<RawChannelData> channels;
+    };
+
+    /**
+     * Planes of a layer converted into the PSD byte order and compressed
+     * with RLE row by row. The rows are stored in the order of the
+     * writing info list they were prepared for.
+     */
+    struct PreparedPixelData {
+        QRect rect;
+        QVector<QVector<QByteArray> > channelRows;
+    };
+
+    RawPixelData fetchChannels(QIODevice *io,
+                               psd_color_mode colorMode,
+                               int channelSize,
+                               const QRect &layerRect,
+                               QVector<ChannelInfo*> infoRecords);
+
+    void decodeChannels(const RawPixelData &data, KisPaintDeviceSP device);
+
     void readChannels(QIODevice *io,
                       KisPaintDeviceSP device,
                       psd_color_mode colorMode,
@@ -57,6 +108,18 @@ namespace PsdPixelUtils
                              const qint64 rleBlockOffset,
                              const bool writeCompressionType);
 
+    PreparedPixelData preparePixelDataCommon(KisPaintDeviceSP dev,
+                                             const QRect &rc,
+                                             psd_color_mode colorMode,
+                                             int channelSize,
+                                             bool alphaFirst,
+                                             const QVector<ChannelWritingInfo> &writingInfoList);
+
+    void writePreparedPixelData(QIODevice *io,
+                                const PreparedPixelData &data,
+                                const bool writeCompressionType,
+                                const QVector<ChannelWritingInfo> &writingInfoList);
+
     void writePixelDataCommon(QIODevice *io,
                               KisPaintDeviceSP dev,
                               const QRect &rc,
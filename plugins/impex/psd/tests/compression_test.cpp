@@ -53,6 +53,25 @@ void CompressionTest::testCompressionRLE()
 
 }
 
+void CompressionTest::testCompressionRLELongRuns()
+{
+    // runs and literal blocks longer than a single PackBits packet
+    QByteArray ba(300, 'a');
+    for (int i = 0; i < 300; ++i) {
+        ba.append(char(i % 7 + i / 7));
+    }
+    ba.append(QByteArray(129, 'b'));
+    ba.append('c');
+
+    QByteArray compressed = Compression::compress(ba, Compression::RLE);
+    QVERIFY(compressed.size() < ba.size());
+
+    QByteArray uncompressed(ba.size(), 0);
+    Compression::uncompressRLE(compressed.constData(), compressed.size(),
+                               uncompressed.data(), uncompressed.size());
+    QCOMPARE(uncompressed, ba);
+}
+
 
 void CompressionTest::testCompressionZIP()
 {
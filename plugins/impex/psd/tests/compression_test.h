@@ -27,6 +27,7 @@ class CompressionTest : public QObject
 private Q_SLOTS:
 
     void testCompressionRLE();
+    void testCompressionRLELongRuns();
     void testCompressionZIP();
     void testCompressionUncompressed();
 
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_psd_benchmark.h"
+
+#include <QTest>
+#include <QDir>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <KisDocument.h>
+#include <KisPart.h>
+#include <kis_image.h>
+#include <kis_paint_layer.h>
+#include <kis_paint_device.h>
+#include <kis_sequential_iterator.h>
+
+#include "psd_loader.h"
+#include "psd_saver.h"
+
+const int IMAGE_WIDTH = 2048;
+const int IMAGE_HEIGHT = 2048;
+const int NUM_LAYERS = 100;
+
+
+void fillLayer(KisPaintDeviceSP dev, int layerIndex)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+
+    /**
+     * Every layer gets a flat area that compresses well with RLE and
+     * a noisy area that doesn't compress at all, just like the
+     * paintings usually have.
+     */
+    const QRect flatRect(layerIndex * 13 % (IMAGE_WIDTH / 2),
+                         layerIndex * 29 % (IMAGE_HEIGHT / 2),
+                         IMAGE_WIDTH / 2, IMAGE_HEIGHT / 2);
+
+    dev->fill(flatRect, KoColor(QColor::fromHsv(layerIndex * 37 % 360, 200, 200), cs));
+
+    const QRect noiseRect = flatRect.translated(IMAGE_WIDTH / 4, IMAGE_HEIGHT / 4) & QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT);
+
+    KisSequentialIterator it(dev, noiseRect);
+    do {
+        quint8 *pixel = it.rawData();
+        for (quint32 i = 0; i < cs->pixelSize(); i++) {
+            pixel[i] = qrand() & 0xff;
+        }
+    } while (it.nextPixel());
+}
+
+void KisPSDBenchmark::initTestCase()
+{
+    qsrand(1);
+
+    m_fileName = QDir::tempPath() + QDir::separator() + "kis_psd_benchmark.psd";
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, IMAGE_WIDTH, IMAGE_HEIGHT, cs, "psd benchmark");
+
+    for (int i = 0; i < NUM_LAYERS; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer %1").arg(i), OPACITY_OPAQUE_U8);
+        fillLayer(layer->paintDevice(), i);
+        image->addNode(layer, image->root());
+    }
+
+    image->initialRefreshGraph();
+
+    m_doc = KisPart::instance()->createDocument();
+    m_doc->setCurrentImage(image);
+}
+
+void KisPSDBenchmark::cleanupTestCase()
+{
+    delete m_doc;
+    QFile::remove(m_fileName);
+}
+
+void KisPSDBenchmark::benchmarkSave()
+{
+    QBENCHMARK {
+        PSDSaver saver(m_doc);
+        QCOMPARE(saver.buildFile(m_fileName), KisImageBuilder_RESULT_OK);
+    }
+}
+
+void KisPSDBenchmark::benchmarkLoad()
+{
+    {
+        PSDSaver saver(m_doc);
+        QCOMPARE(saver.buildFile(m_fileName), KisImageBuilder_RESULT_OK);
+    }
+
+    QBENCHMARK {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+        PSDLoader loader(doc.data());
+        QCOMPARE(loader.buildImage(m_fileName), KisImageBuilder_RESULT_OK);
+
+        doc->setCurrentImage(loader.image());
+        QCOMPARE(doc->image()->root()->childCount(), quint32(NUM_LAYERS));
+    }
+}
+
+QTEST_MAIN(KisPSDBenchmark)
@@ -64,6 +64,7 @@ void KisTIFFOptionsWidget::setConfiguration(const KisPropertiesConfigurationSP c
     kComboBoxFaxMode->setCurrentIndex(cfg->getInt("faxmode", 0));
     compressionLevelPixarLog->setValue(cfg->getInt("pixarlog", 6));
     chkSaveProfile->setChecked(cfg->getBool("saveProfile", true));
+    chkTiled->setChecked(cfg->getBool("tiled", false));
 
     if (cfg->getInt("type", -1) == KoChannelInfo::FLOAT16 || cfg->getInt("type", -1) == KoChannelInfo::FLOAT32) {
         kComboBoxPredictor->removeItem(1);
@@ -92,6 +93,7 @@ KisPropertiesConfigurationSP KisTIFFOptionsWidget::configuration() const
     cfg->setProperty("faxmode", opts.faxMode - 1);
     cfg->setProperty("pixarlog", opts.pixarLogCompress);
     cfg->setProperty("saveProfile", opts.saveProfile);
+    cfg->setProperty("tiled", opts.tiled);
 
     return cfg;
 }
@@ -166,6 +168,7 @@ KisTIFFOptions KisTIFFOptionsWidget::options() const
     options.faxMode = kComboBoxFaxMode->currentIndex() + 1;
     options.pixarLogCompress = compressionLevelPixarLog->value();
     options.saveProfile = chkSaveProfile->isChecked();
+    options.tiled = chkTiled->isChecked();
 
     return options;
 }
@@ -25,6 +25,8 @@
 #include <QApplication>
 
 #include <QFileInfo>
+#include <QThread>
+#include <QtConcurrent>
 
 #include <KoDocumentInfo.h>
 #include <KoUnit.h>
@@ -163,6 +165,244 @@ QPair<QString, QString> getColorSpaceForColorType(uint16 sampletype, uint16 colo
     }
     return QPair<QString, QString>();
 }
+
+/**
+ * Everything needed to decode the strips or tiles of the current
+ * directory
+ */
+struct TIFFDataLayout {
+    uint32 width;
+    uint32 height;
+    uint16 depth;
+    uint16 nbchannels;
+    uint16 planarconfig;
+    uint16 vsubsampling;
+    QVector<uint16> lineSizeCoeffs;
+};
+
+KisBufferStreamBase* createContigStream(uint8 *buf, uint16 depth, uint32 lineSize)
+{
+    if (depth < 16) {
+        return new KisBufferStreamContigBelow16(buf, depth, lineSize);
+    }
+    else if (depth < 32) {
+        return new KisBufferStreamContigBelow32(buf, depth, lineSize);
+    }
+    else {
+        return new KisBufferStreamContigAbove32(buf, depth, lineSize);
+    }
+}
+
+/**
+ * Decodes the rows [startY, endY) of the current directory of \p image.
+ * The range must start at the boundary of a strip or a row of tiles.
+ */
+void readRows(TIFF *image, const TIFFDataLayout &layout, KisTIFFReaderBase *tiffReader, uint32 startY, uint32 endY)
+{
+    tdata_t buf = 0;
+    tdata_t* ps_buf = 0; // used only for planar configuration separated
+    KisBufferStreamBase* tiffstream;
+
+    const uint16 nbchannels = layout.nbchannels;
+
+    if (TIFFIsTiled(image)) {
+        dbgFile << "tiled image";
+        uint32 tileWidth, tileHeight;
+        uint32 x, y;
+        TIFFGetField(image, TIFFTAG_TILEWIDTH, &tileWidth);
+        TIFFGetField(image, TIFFTAG_TILELENGTH, &tileHeight);
+        uint32 linewidth = (tileWidth * layout.depth * nbchannels) / 8;
+        if (layout.planarconfig == PLANARCONFIG_CONTIG) {
+            buf = _TIFFmalloc(TIFFTileSize(image));
+            tiffstream = createContigStream((uint8*)buf, layout.depth, linewidth);
+        }
+        else {
+            ps_buf = new tdata_t[nbchannels];
+            uint32 * lineSizes = new uint32[nbchannels];
+            tmsize_t baseSize = TIFFTileSize(image) / nbchannels;
+            for (uint i = 0; i < nbchannels; i++) {
+                ps_buf[i] = _TIFFmalloc(baseSize);
+                lineSizes[i] = tileWidth; // baseSize / lineSizeCoeffs[i];
+            }
+            tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, layout.depth, lineSizes);
+            delete [] lineSizes;
+        }
+        for (y = startY; y < endY; y += tileHeight) {
+            for (x = 0; x < layout.width; x += tileWidth) {
+                dbgFile << "Reading tile x =" << x << " y =" << y;
+                if (layout.planarconfig == PLANARCONFIG_CONTIG) {
+                    TIFFReadTile(image, buf, x, y, 0, (tsample_t) - 1);
+                }
+                else {
+                    for (uint i = 0; i < nbchannels; i++) {
+                        TIFFReadTile(image, ps_buf[i], x, y, 0, i);
+                    }
+                }
+                uint32 realTileWidth = (x + tileWidth) < layout.width ? tileWidth : layout.width - x;
+                for (uint yintile = 0; y + yintile < endY && yintile < tileHeight / layout.vsubsampling;) {
+                    tiffReader->copyDataToChannels(x, y + yintile , realTileWidth, tiffstream);
+                    yintile += 1;
+                    tiffstream->moveToLine(yintile);
+                }
+                tiffstream->restart();
+            }
+        }
+    }
+    else {
+        dbgFile << "striped image";
+        tsize_t stripsize = TIFFStripSize(image);
+        uint32 rowsPerStrip;
+        TIFFGetFieldDefaulted(image, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+        dbgFile << rowsPerStrip << "" << layout.height;
+        rowsPerStrip = qMin(rowsPerStrip, layout.height); // when TIFFNumberOfStrips(image) == 1 it might happen that rowsPerStrip is incorrectly set
+        if (layout.planarconfig == PLANARCONFIG_CONTIG) {
+            buf = _TIFFmalloc(stripsize);
+            tiffstream = createContigStream((uint8*)buf, layout.depth, stripsize / rowsPerStrip);
+        }
+        else {
+            ps_buf = new tdata_t[nbchannels];
+            uint32 scanLineSize = stripsize / rowsPerStrip;
+            dbgFile << " scanLineSize for each plan =" << scanLineSize;
+            uint32 * lineSizes = new uint32[nbchannels];
+            for (uint i = 0; i < nbchannels; i++) {
+                ps_buf[i] = _TIFFmalloc(stripsize);
+                lineSizes[i] = scanLineSize / layout.lineSizeCoeffs[i];
+            }
+            tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, layout.depth, lineSizes);
+            delete [] lineSizes;
+        }
+
+        dbgFile << "Scanline size =" << TIFFRasterScanlineSize(image) << " / strip size =" << TIFFStripSize(image) << " / rowsPerStrip =" << rowsPerStrip << " stripsize/rowsPerStrip =" << stripsize / rowsPerStrip;
+        uint32 y = startY;
+        dbgFile << " NbOfStrips =" << TIFFNumberOfStrips(image) << " rowsPerStrip =" << rowsPerStrip << " stripsize =" << stripsize;
+        while (y < endY) {
+            if (layout.planarconfig == PLANARCONFIG_CONTIG) {
+                TIFFReadEncodedStrip(image, TIFFComputeStrip(image, y, 0) , buf, (tsize_t) - 1);
+            }
+            else {
+                for (uint i = 0; i < nbchannels; i++) {
+                    TIFFReadEncodedStrip(image, TIFFComputeStrip(image, y, i), ps_buf[i], (tsize_t) - 1);
+                }
+            }
+            for (uint32 yinstrip = 0 ; yinstrip < rowsPerStrip && y < endY ;) {
+                uint linesread = tiffReader->copyDataToChannels(0, y, layout.width, tiffstream);
+                y += linesread;
+                yinstrip += linesread;
+                tiffstream->moveToLine(yinstrip);
+            }
+            tiffstream->restart();
+        }
+    }
+
+    delete tiffstream;
+    if (layout.planarconfig == PLANARCONFIG_CONTIG) {
+        _TIFFfree(buf);
+    } else {
+        for (uint i = 0; i < nbchannels; i++) {
+            _TIFFfree(ps_buf[i]);
+        }
+        delete[] ps_buf;
+    }
+}
+
+/**
+ * A group of rows decoded through a separate handle of the file
+ */
+struct RowsJob {
+    RowsJob() : startY(0), endY(0), success(false) {}
+
+    uint32 startY;
+    uint32 endY;
+    bool success;
+};
+
+/**
+ * libtiff handles cannot be shared between threads, so every job opens
+ * the file once more and decodes its own strips or tiles
+ */
+struct RowsJobRunner {
+    QByteArray filename;
+    tdir_t directory;
+    const TIFFDataLayout *layout;
+    KisTIFFReaderBase *tiffReader;
+
+    void operator()(RowsJob &job) const {
+        TIFF *image = TIFFOpen(filename.constData(), "r");
+        if (!image) return;
+
+        if (TIFFSetDirectory(image, directory)) {
+            readRows(image, *layout, tiffReader, job.startY, job.endY);
+            job.success = true;
+        }
+
+        TIFFClose(image);
+    }
+};
+
+uint32 greatestCommonDivisor(uint32 a, uint32 b)
+{
+    while (b) {
+        const uint32 t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * Decodes the current directory using all the cores. The rows are
+ * split into bands made of whole strips (or rows of tiles) that are
+ * also aligned to the tiles of the paint device, so no two threads
+ * ever write into the same tile.
+ */
+void readRowsInParallel(TIFF *image, const QString &filename, const TIFFDataLayout &layout, KisTIFFReaderBase *tiffReader)
+{
+    uint32 unitHeight = 0;
+    if (TIFFIsTiled(image)) {
+        TIFFGetField(image, TIFFTAG_TILELENGTH, &unitHeight);
+    } else {
+        TIFFGetFieldDefaulted(image, TIFFTAG_ROWSPERSTRIP, &unitHeight);
+    }
+    unitHeight = qBound(uint32(1), unitHeight, layout.height);
+
+    const quint64 deviceTileHeight = 64;
+    const quint64 bandHeight = unitHeight / greatestCommonDivisor(unitHeight, deviceTileHeight) * deviceTileHeight;
+    const quint64 numBands = (layout.height + bandHeight - 1) / bandHeight;
+    const quint64 numJobs = qMin(numBands, quint64(QThread::idealThreadCount()));
+
+    if (numJobs <= 1) {
+        readRows(image, layout, tiffReader, 0, layout.height);
+        return;
+    }
+
+    // keep the rows of every job contiguous, so that each handle reads its part of the file sequentially
+    const quint64 bandsPerJob = (numBands + numJobs - 1) / numJobs;
+
+    QVector<RowsJob> jobs;
+    for (quint64 y = 0; y < layout.height; y += bandsPerJob * bandHeight) {
+        RowsJob job;
+        job.startY = y;
+        job.endY = qMin(quint64(layout.height), y + bandsPerJob * bandHeight);
+        jobs.append(job);
+    }
+
+    RowsJobRunner runner;
+    runner.filename = QFile::encodeName(filename);
+    runner.directory = TIFFCurrentDirectory(image);
+    runner.layout = &layout;
+    runner.tiffReader = tiffReader;
+
+    QtConcurrent::blockingMap(jobs, runner);
+
+    // if the file could not be opened once more, use the main handle
+    Q_FOREACH (const RowsJob &job, jobs) {
+        if (!job.success) {
+            dbgFile << "Decoding rows" << job.startY << "to" << job.endY << "in the main thread";
+            readRows(image, layout, tiffReader, job.startY, job.endY);
+        }
+    }
+}
+
 }
 
 KisTIFFConverter::KisTIFFConverter(KisDocument *doc)
@@ -189,7 +429,7 @@ KisImageBuilder_Result KisTIFFConverter::decode(const QString &filename)
     }
     do {
         dbgFile << "Read new sub-image";
-        KisImageBuilder_Result result = readTIFFDirectory(image);
+        KisImageBuilder_Result result = readTIFFDirectory(image, filename);
         if (result != KisImageBuilder_RESULT_OK) {
             return result;
         }
@@ -199,7 +439,7 @@ KisImageBuilder_Result KisTIFFConverter::decode(const QString &filename)
     return KisImageBuilder_RESULT_OK;
 }
 
-KisImageBuilder_Result KisTIFFConverter::readTIFFDirectory(TIFF* image)
+KisImageBuilder_Result KisTIFFConverter::readTIFFDirectory(TIFF* image, const QString &filename)
 {
     // Read information about the tiff
     uint32 width, height;
@@ -373,9 +613,6 @@ KisImageBuilder_Result KisTIFFConverter::readTIFFDirectory(TIFF* image)
         }
     }
     KisPaintLayer* layer = new KisPaintLayer(m_image.data(), m_image -> nextLayerName(), quint8_MAX);
-    tdata_t buf = 0;
-    tdata_t* ps_buf = 0; // used only for planar configuration separated
-    KisBufferStreamBase* tiffstream;
 
     KisTIFFReaderBase* tiffReader = 0;
 
@@ -492,123 +729,31 @@ KisImageBuilder_Result KisTIFFConverter::readTIFFDirectory(TIFF* image)
         return KisImageBuilder_RESULT_INVALID_ARG;
     }
 
-    if (TIFFIsTiled(image)) {
-        dbgFile << "tiled image";
-        uint32 tileWidth, tileHeight;
-        uint32 x, y;
-        TIFFGetField(image, TIFFTAG_TILEWIDTH, &tileWidth);
-        TIFFGetField(image, TIFFTAG_TILELENGTH, &tileHeight);
-        uint32 linewidth = (tileWidth * depth * nbchannels) / 8;
-        if (planarconfig == PLANARCONFIG_CONTIG) {
-            buf = _TIFFmalloc(TIFFTileSize(image));
-            if (depth < 16) {
-                tiffstream = new KisBufferStreamContigBelow16((uint8*)buf, depth, linewidth);
-            }
-            else if (depth < 32) {
-                tiffstream = new KisBufferStreamContigBelow32((uint8*)buf, depth, linewidth);
-            }
-            else {
-                tiffstream = new KisBufferStreamContigAbove32((uint8*)buf, depth, linewidth);
-            }
-        }
-        else {
-            ps_buf = new tdata_t[nbchannels];
-            uint32 * lineSizes = new uint32[nbchannels];
-            tmsize_t baseSize = TIFFTileSize(image) / nbchannels;
-            for (uint i = 0; i < nbchannels; i++) {
-                ps_buf[i] = _TIFFmalloc(baseSize);
-                lineSizes[i] = tileWidth; // baseSize / lineSizeCoeffs[i];
-            }
-            tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, depth, lineSizes);
-            delete [] lineSizes;
-        }
-        dbgFile << linewidth << "" << nbchannels << "" << layer->paintDevice()->colorSpace()->colorChannelCount();
-        for (y = 0; y < height; y += tileHeight) {
-            for (x = 0; x < width; x += tileWidth) {
-                dbgFile << "Reading tile x =" << x << " y =" << y;
-                if (planarconfig == PLANARCONFIG_CONTIG) {
-                    TIFFReadTile(image, buf, x, y, 0, (tsample_t) - 1);
-                }
-                else {
-                    for (uint i = 0; i < nbchannels; i++) {
-                        TIFFReadTile(image, ps_buf[i], x, y, 0, i);
-                    }
-                }
-                uint32 realTileWidth = (x + tileWidth) < width ? tileWidth : width - x;
-                for (uint yintile = 0; y + yintile < height && yintile < tileHeight / vsubsampling;) {
-                    tiffReader->copyDataToChannels(x, y + yintile , realTileWidth, tiffstream);
-                    yintile += 1;
-                    tiffstream->moveToLine(yintile);
-                }
-                tiffstream->restart();
-            }
-        }
+    TIFFDataLayout layout;
+    layout.width = width;
+    layout.height = height;
+    layout.depth = depth;
+    layout.nbchannels = nbchannels;
+    layout.planarconfig = planarconfig;
+    layout.vsubsampling = vsubsampling;
+    for (uint i = 0; i < nbchannels; i++) {
+        layout.lineSizeCoeffs << lineSizeCoeffs[i];
     }
-    else {
-        dbgFile << "striped image";
-        tsize_t stripsize = TIFFStripSize(image);
-        uint32 rowsPerStrip;
-        TIFFGetFieldDefaulted(image, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
-        dbgFile << rowsPerStrip << "" << height;
-        rowsPerStrip = qMin(rowsPerStrip, height); // when TIFFNumberOfStrips(image) == 1 it might happen that rowsPerStrip is incorrectly set
-        if (planarconfig == PLANARCONFIG_CONTIG) {
-            buf = _TIFFmalloc(stripsize);
-            if (depth < 16) {
-                tiffstream = new KisBufferStreamContigBelow16((uint8*)buf, depth, stripsize / rowsPerStrip);
-            }
-            else if (depth < 32) {
-                tiffstream = new KisBufferStreamContigBelow32((uint8*)buf, depth, stripsize / rowsPerStrip);
-            }
-            else {
-                tiffstream = new KisBufferStreamContigAbove32((uint8*)buf, depth, stripsize / rowsPerStrip);
-            }
-        }
-        else {
-            ps_buf = new tdata_t[nbchannels];
-            uint32 scanLineSize = stripsize / rowsPerStrip;
-            dbgFile << " scanLineSize for each plan =" << scanLineSize;
-            uint32 * lineSizes = new uint32[nbchannels];
-            for (uint i = 0; i < nbchannels; i++) {
-                ps_buf[i] = _TIFFmalloc(stripsize);
-                lineSizes[i] = scanLineSize / lineSizeCoeffs[i];
-            }
-            tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, depth, lineSizes);
-            delete [] lineSizes;
-        }
 
-        dbgFile << "Scanline size =" << TIFFRasterScanlineSize(image) << " / strip size =" << TIFFStripSize(image) << " / rowsPerStrip =" << rowsPerStrip << " stripsize/rowsPerStrip =" << stripsize / rowsPerStrip;
-        uint32 y = 0;
-        dbgFile << " NbOfStrips =" << TIFFNumberOfStrips(image) << " rowsPerStrip =" << rowsPerStrip << " stripsize =" << stripsize;
-        for (uint32 strip = 0; y < height; strip++) {
-            if (planarconfig == PLANARCONFIG_CONTIG) {
-                TIFFReadEncodedStrip(image, TIFFComputeStrip(image, y, 0) , buf, (tsize_t) - 1);
-            }
-            else {
-                for (uint i = 0; i < nbchannels; i++) {
-                    TIFFReadEncodedStrip(image, TIFFComputeStrip(image, y, i), ps_buf[i], (tsize_t) - 1);
-                }
-            }
-            for (uint32 yinstrip = 0 ; yinstrip < rowsPerStrip && y < height ;) {
-                uint linesread = tiffReader->copyDataToChannels(0, y, width, tiffstream);
-                y += linesread;
-                yinstrip += linesread;
-                tiffstream->moveToLine(yinstrip);
-            }
-            tiffstream->restart();
-        }
+    /**
+     * The YCbCr readers collect the data and write it in finalize(),
+     * and the color transformations may keep a cache, so they can be
+     * used from one thread only
+     */
+    if (color_type != PHOTOMETRIC_YCBCR && !transform) {
+        readRowsInParallel(image, filename, layout, tiffReader);
+    } else {
+        readRows(image, layout, tiffReader, 0, height);
     }
+
     tiffReader->finalize();
     delete[] lineSizeCoeffs;
     delete tiffReader;
-    delete tiffstream;
-    if (planarconfig == PLANARCONFIG_CONTIG) {
-        _TIFFfree(buf);
-    } else {
-        for (uint i = 0; i < nbchannels; i++) {
-            _TIFFfree(ps_buf[i]);
-        }
-        delete[] ps_buf;
-    }
 
     m_image->addNode(KisNodeSP(layer), m_image->rootLayer().data());
     return KisImageBuilder_RESULT_OK;
@@ -41,6 +41,7 @@ struct KisTIFFOptions {
     quint16 faxMode;
     quint16 pixarLogCompress;
     bool saveProfile;
+    bool tiled;
 };
 
 class KisTIFFConverter : public QObject
@@ -59,7 +60,7 @@ public Q_SLOTS:
     virtual void cancel();
 private:
     KisImageBuilder_Result decode(const QString &filename);
-    KisImageBuilder_Result readTIFFDirectory(TIFF* image);
+    KisImageBuilder_Result readTIFFDirectory(TIFF* image, const QString &filename);
 private:
     KisImageWSP m_image;
     KisDocument *m_doc;
@@ -45,6 +45,49 @@
 
 K_PLUGIN_FACTORY_WITH_JSON(KisTIFFExportFactory, "krita_tiff_export.json", registerPlugin<KisTIFFExport>();)
 
+namespace {
+
+/**
+ * Fills the options the same way KisTIFFOptionsWidget does after
+ * loading @cfg. Used in batch mode, where no widget is created.
+ */
+KisTIFFOptions optionsFromConfiguration(KisPropertiesConfigurationSP cfg)
+{
+    static const quint16 compressionTypes[] = {
+        COMPRESSION_NONE,
+        COMPRESSION_JPEG,
+        COMPRESSION_DEFLATE,
+        COMPRESSION_LZW,
+        COMPRESSION_JP2000,
+        COMPRESSION_CCITTRLE,
+        COMPRESSION_CCITTFAX3,
+        COMPRESSION_CCITTFAX4,
+        COMPRESSION_PIXARLOG
+    };
+    const int numCompressionTypes = sizeof(compressionTypes) / sizeof(compressionTypes[0]);
+    const int compressionIndex = cfg->getInt("compressiontype", 0);
+
+    KisTIFFOptions options;
+    options.compressionType =
+        compressionIndex >= 0 && compressionIndex < numCompressionTypes ?
+        compressionTypes[compressionIndex] : COMPRESSION_NONE;
+
+    // the widget shows only "None" and the predictor suitable for the channel type
+    options.predictor = qBound(0, cfg->getInt("predictor", 0), 1) + 1;
+    options.flatten = cfg->getBool("flatten", true);
+    options.alpha = !options.flatten || (cfg->getBool("alpha", true) && !cfg->getBool("isCMYK"));
+    options.jpegQuality = cfg->getInt("quality", 80);
+    options.deflateCompress = cfg->getInt("deflate", 6);
+    options.faxMode = cfg->getInt("faxmode", 0) + 1;
+    options.pixarLogCompress = cfg->getInt("pixarlog", 6);
+    options.saveProfile = cfg->getBool("saveProfile", true);
+    options.tiled = cfg->getBool("tiled", false);
+
+    return options;
+}
+
+}
+
 KisTIFFExport::KisTIFFExport(QObject *parent, const QVariantList &) : KisImportExportFilter(parent)
 {
 }
@@ -65,13 +108,6 @@ KisImportExportFilter::ConversionStatus KisTIFFExport::convert(const QByteArray&
         return KisImportExportFilter::NoDocumentCreated;
     }
 
-    KoDialog kdb;
-    kdb.setWindowTitle(i18n("TIFF Export Options"));
-    kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
-    KisTIFFOptionsWidget *wdg = static_cast<KisTIFFOptionsWidget*>(createConfigurationWidget(&kdb, from, to));
-    kdb.setMainWidget(wdg);
-    kdb.resize(kdb.minimumSize());
-
     // If a configuration object was passed to the convert method, we use that, otherwise we load from the settings
     KisPropertiesConfigurationSP cfg(new KisPropertiesConfiguration());
     if (configuration) {
@@ -85,17 +121,29 @@ KisImportExportFilter::ConversionStatus KisTIFFExport::convert(const QByteArray&
     cfg->setProperty("type", (int)cs->channels()[0]->channelValueType());
     cfg->setProperty("isCMYK", (cs->colorModelId() == CMYKAColorModelID));
 
-    wdg->setConfiguration(cfg);
+    KisTIFFOptions options;
 
+    // batch exports may run on a pool thread, so no widgets are created there
     if (!getBatchMode()) {
+        KoDialog kdb;
+        kdb.setWindowTitle(i18n("TIFF Export Options"));
+        kdb.setButtons(KoDialog::Ok | KoDialog::Cancel);
+        KisTIFFOptionsWidget *wdg = static_cast<KisTIFFOptionsWidget*>(createConfigurationWidget(&kdb, from, to));
+        kdb.setMainWidget(wdg);
+        kdb.resize(kdb.minimumSize());
+
+        wdg->setConfiguration(cfg);
+
         if (kdb.exec() == QDialog::Rejected) {
             return KisImportExportFilter::UserCancelled;
         }
         cfg = wdg->configuration();
         KisConfig().setExportConfiguration("TIFF", *cfg.data());
-    }
 
-    KisTIFFOptions options = wdg->options();
+        options = wdg->options();
+    } else {
+        options = optionsFromConfiguration(cfg);
+    }
 
     if ((cs->channels()[0]->channelValueType() == KoChannelInfo::FLOAT16
          || cs->channels()[0]->channelValueType() == KoChannelInfo::FLOAT32) && options.predictor == 2) {
@@ -147,6 +195,7 @@ KisPropertiesConfigurationSP KisTIFFExport::defaultConfiguration(const QByteArra
     cfg->setProperty("faxmode", 0);
     cfg->setProperty("pixarlog", 6);
     cfg->setProperty("saveProfile", true);
+    cfg->setProperty("tiled", false);
 
     return cfg;
 }
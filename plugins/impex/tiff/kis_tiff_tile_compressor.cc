@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_tiff_tile_compressor.h"
+
+#include <kis_debug.h>
+
+namespace {
+
+/**
+ * A write-only TIFF "file" that keeps only the bytes written since the
+ * last call to startCapture()
+ */
+struct CapturingFile {
+    CapturingFile() : pos(0), size(0) {}
+
+    void startCapture() {
+        captured.clear();
+    }
+
+    QByteArray captured;
+    toff_t pos;
+    toff_t size;
+};
+
+tsize_t readProc(thandle_t, tdata_t, tsize_t)
+{
+    return 0;
+}
+
+tsize_t writeProc(thandle_t handle, tdata_t data, tsize_t size)
+{
+    CapturingFile *file = reinterpret_cast<CapturingFile*>(handle);
+    file->captured.append(reinterpret_cast<const char*>(data), size);
+    file->pos += size;
+    file->size = qMax(file->size, file->pos);
+    return size;
+}
+
+toff_t seekProc(thandle_t handle, toff_t offset, int whence)
+{
+    CapturingFile *file = reinterpret_cast<CapturingFile*>(handle);
+
+    switch (whence) {
+    case SEEK_SET:
+        file->pos = offset;
+        break;
+    case SEEK_CUR:
+        file->pos += offset;
+        break;
+    case SEEK_END:
+        file->pos = file->size + offset;
+        break;
+    }
+
+    return file->pos;
+}
+
+int closeProc(thandle_t)
+{
+    return 0;
+}
+
+toff_t sizeProc(thandle_t handle)
+{
+    return reinterpret_cast<CapturingFile*>(handle)->size;
+}
+
+int mapProc(thandle_t, tdata_t*, toff_t*)
+{
+    return 0;
+}
+
+void unmapProc(thandle_t, tdata_t, toff_t)
+{
+}
+
+}
+
+KisTIFFTileCompressor::KisTIFFTileCompressor(TIFF *destination)
+    : m_tileWidth(0),
+      m_tileHeight(0),
+      m_bitsPerSample(8),
+      m_samplesPerPixel(1),
+      m_sampleFormat(SAMPLEFORMAT_UINT),
+      m_photometric(PHOTOMETRIC_RGB),
+      m_planarConfig(PLANARCONFIG_CONTIG),
+      m_compression(COMPRESSION_NONE),
+      m_predictor(PREDICTOR_NONE),
+      m_zipQuality(-1)
+{
+    TIFFGetField(destination, TIFFTAG_TILEWIDTH, &m_tileWidth);
+    TIFFGetField(destination, TIFFTAG_TILELENGTH, &m_tileHeight);
+    TIFFGetFieldDefaulted(destination, TIFFTAG_BITSPERSAMPLE, &m_bitsPerSample);
+    TIFFGetFieldDefaulted(destination, TIFFTAG_SAMPLESPERPIXEL, &m_samplesPerPixel);
+    TIFFGetFieldDefaulted(destination, TIFFTAG_SAMPLEFORMAT, &m_sampleFormat);
+    TIFFGetField(destination, TIFFTAG_PHOTOMETRIC, &m_photometric);
+    TIFFGetFieldDefaulted(destination, TIFFTAG_PLANARCONFIG, &m_planarConfig);
+    TIFFGetFieldDefaulted(destination, TIFFTAG_COMPRESSION, &m_compression);
+
+    if (m_compression == COMPRESSION_LZW ||
+        m_compression == COMPRESSION_DEFLATE ||
+        m_compression == COMPRESSION_ADOBE_DEFLATE) {
+
+        TIFFGetFieldDefaulted(destination, TIFFTAG_PREDICTOR, &m_predictor);
+    }
+
+    if (m_compression == COMPRESSION_DEFLATE ||
+        m_compression == COMPRESSION_ADOBE_DEFLATE) {
+
+        TIFFGetField(destination, TIFFTAG_ZIPQUALITY, &m_zipQuality);
+    }
+
+    uint16 numExtraSamples = 0;
+    uint16 *extraSamples = 0;
+    if (TIFFGetField(destination, TIFFTAG_EXTRASAMPLES, &numExtraSamples, &extraSamples)) {
+        for (int i = 0; i < numExtraSamples; i++) {
+            m_extraSamples << extraSamples[i];
+        }
+    }
+}
+
+bool KisTIFFTileCompressor::isSupported(uint16 compression)
+{
+    return compression == COMPRESSION_NONE ||
+        compression == COMPRESSION_LZW ||
+        compression == COMPRESSION_DEFLATE ||
+        compression == COMPRESSION_ADOBE_DEFLATE ||
+        compression == COMPRESSION_PACKBITS;
+}
+
+bool KisTIFFTileCompressor::compress(const QByteArray &tile, QByteArray *result) const
+{
+    CapturingFile file;
+
+    TIFF *image = TIFFClientOpen("kis_tiff_tile_compressor", "w", reinterpret_cast<thandle_t>(&file),
+                                 readProc, writeProc, seekProc, closeProc,
+                                 sizeProc, mapProc, unmapProc);
+    if (!image) {
+        return false;
+    }
+
+    TIFFSetField(image, TIFFTAG_IMAGEWIDTH, m_tileWidth);
+    TIFFSetField(image, TIFFTAG_IMAGELENGTH, m_tileHeight);
+    TIFFSetField(image, TIFFTAG_TILEWIDTH, m_tileWidth);
+    TIFFSetField(image, TIFFTAG_TILELENGTH, m_tileHeight);
+    TIFFSetField(image, TIFFTAG_BITSPERSAMPLE, m_bitsPerSample);
+    TIFFSetField(image, TIFFTAG_SAMPLESPERPIXEL, m_samplesPerPixel);
+    TIFFSetField(image, TIFFTAG_SAMPLEFORMAT, m_sampleFormat);
+    TIFFSetField(image, TIFFTAG_PHOTOMETRIC, m_photometric);
+    TIFFSetField(image, TIFFTAG_PLANARCONFIG, m_planarConfig);
+    if (!m_extraSamples.isEmpty()) {
+        TIFFSetField(image, TIFFTAG_EXTRASAMPLES, m_extraSamples.size(), m_extraSamples.constData());
+    }
+    TIFFSetField(image, TIFFTAG_COMPRESSION, m_compression);
+    if (m_predictor != PREDICTOR_NONE) {
+        TIFFSetField(image, TIFFTAG_PREDICTOR, m_predictor);
+    }
+    if (m_zipQuality >= 0) {
+        TIFFSetField(image, TIFFTAG_ZIPQUALITY, m_zipQuality);
+    }
+
+    /**
+     * The header has already been written by TIFFClientOpen() and the
+     * directory is written only when closing, so everything written
+     * in between is the compressed tile
+     */
+    file.startCapture();
+
+    // libtiff encodes the tile in place, so it needs a copy anyway
+    QByteArray data(tile);
+    const bool success = TIFFWriteEncodedTile(image, 0, data.data(), data.size()) >= 0;
+
+    *result = file.captured;
+
+    TIFFClose(image);
+
+    if (!success) {
+        dbgFile << "Failed to compress a TIFF tile";
+    }
+
+    return success;
+}
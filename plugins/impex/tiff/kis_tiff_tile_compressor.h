@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef _KIS_TIFF_TILE_COMPRESSOR_H_
+#define _KIS_TIFF_TILE_COMPRESSOR_H_
+
+#include <stdio.h>
+#include <tiffio.h>
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * Compresses tiles for a tiled TIFF file without touching the file
+ * itself, so that several tiles can be compressed at the same time and
+ * then written in order with TIFFWriteRawTile().
+ *
+ * libtiff has no public API for running a codec on a memory buffer, so
+ * every tile is written into a private in-memory TIFF with the same
+ * layout and codec settings as the destination, and the bytes libtiff
+ * emits for the tile are captured. Only the codecs that keep no state
+ * shared between tiles (like the JPEG tables) can be used this way,
+ * see isSupported().
+ */
+class KisTIFFTileCompressor
+{
+public:
+    /**
+     * Copies the layout and the codec settings from \p destination.
+     * All the tags must already be set.
+     */
+    KisTIFFTileCompressor(TIFF *destination);
+
+    /**
+     * Returns true if the tiles compressed with \p compression can be
+     * copied into another file as they are
+     */
+    static bool isSupported(uint16 compression);
+
+    /**
+     * Compresses a single tile. \p tile must contain TIFFTileSize()
+     * bytes. Can be called from several threads at the same time.
+     */
+    bool compress(const QByteArray &tile, QByteArray *result) const;
+
+private:
+    uint32 m_tileWidth;
+    uint32 m_tileHeight;
+    uint16 m_bitsPerSample;
+    uint16 m_samplesPerPixel;
+    uint16 m_sampleFormat;
+    uint16 m_photometric;
+    uint16 m_planarConfig;
+    uint16 m_compression;
+    uint16 m_predictor;
+    int m_zipQuality;
+    QVector<uint16> m_extraSamples;
+};
+
+#endif
@@ -20,6 +20,9 @@
 #include "kis_tiff_writer_visitor.h"
 
 #include <QMessageBox>
+#include <QScopedPointer>
+#include <QThread>
+#include <QtConcurrent>
 #include <klocalizedstring.h>
 
 #include <KoColorProfile.h>
@@ -36,6 +39,7 @@
 #include "kis_tiff_converter.h"
 #include <kis_iterator_ng.h>
 #include <kis_shape_layer.h>
+#include "kis_tiff_tile_compressor.h"
 
 #include <KoConfig.h>
 #ifdef HAVE_OPENEXR
@@ -74,79 +78,149 @@ namespace
         return false;
 
     }
-}
-
-KisTIFFWriterVisitor::KisTIFFWriterVisitor(TIFF*image, KisTIFFOptions* options)
-    : m_image(image)
-    , m_options(options)
-{
-}
-
-KisTIFFWriterVisitor::~KisTIFFWriterVisitor()
-{
-}
 
-bool KisTIFFWriterVisitor::copyDataToStrips(KisHLineConstIteratorSP it, tdata_t buff, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, quint8* poses)
-{
-    if (depth == 32) {
-        Q_ASSERT(sample_format == SAMPLEFORMAT_IEEEFP);
-        float *dst = reinterpret_cast<float *>(buff);
-        do {
-            const float *d = reinterpret_cast<const float *>(it->oldRawData());
-            int i;
-            for (i = 0; i < nbcolorssamples; i++) {
-                *(dst++) = d[poses[i]];
-            }
-            if (m_options->alpha) *(dst++) = d[poses[i]];
-        } while (it->nextPixel());
-        return true;
-    }
-    else if (depth == 16 ) {
-        if (sample_format == SAMPLEFORMAT_IEEEFP) {
-#ifdef HAVE_OPENEXR
-            half *dst = reinterpret_cast<half *>(buff);
+    bool copyDataToStrips(KisHLineConstIteratorSP it, tdata_t buff, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, const quint8* poses, bool alpha)
+    {
+        if (depth == 32) {
+            Q_ASSERT(sample_format == SAMPLEFORMAT_IEEEFP);
+            float *dst = reinterpret_cast<float *>(buff);
             do {
-                const half *d = reinterpret_cast<const half *>(it->oldRawData());
+                const float *d = reinterpret_cast<const float *>(it->oldRawData());
                 int i;
                 for (i = 0; i < nbcolorssamples; i++) {
                     *(dst++) = d[poses[i]];
                 }
-                if (m_options->alpha) *(dst++) = d[poses[i]];
-
+                if (alpha) *(dst++) = d[poses[i]];
             } while (it->nextPixel());
             return true;
+        }
+        else if (depth == 16 ) {
+            if (sample_format == SAMPLEFORMAT_IEEEFP) {
+#ifdef HAVE_OPENEXR
+                half *dst = reinterpret_cast<half *>(buff);
+                do {
+                    const half *d = reinterpret_cast<const half *>(it->oldRawData());
+                    int i;
+                    for (i = 0; i < nbcolorssamples; i++) {
+                        *(dst++) = d[poses[i]];
+                    }
+                    if (alpha) *(dst++) = d[poses[i]];
+
+                } while (it->nextPixel());
+                return true;
 #endif
+            }
+            else {
+                quint16 *dst = reinterpret_cast<quint16 *>(buff);
+                do {
+                    const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
+                    int i;
+                    for (i = 0; i < nbcolorssamples; i++) {
+                        *(dst++) = d[poses[i]];
+                    }
+                    if (alpha) *(dst++) = d[poses[i]];
+
+                } while (it->nextPixel());
+                return true;
+            }
         }
-        else {
-            quint16 *dst = reinterpret_cast<quint16 *>(buff);
+        else if (depth == 8) {
+            quint8 *dst = reinterpret_cast<quint8 *>(buff);
             do {
-                const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
+                const quint8 *d = it->oldRawData();
                 int i;
                 for (i = 0; i < nbcolorssamples; i++) {
                     *(dst++) = d[poses[i]];
                 }
-                if (m_options->alpha) *(dst++) = d[poses[i]];
+                if (alpha) *(dst++) = d[poses[i]];
 
             } while (it->nextPixel());
             return true;
         }
+        return false;
     }
-    else if (depth == 8) {
-        quint8 *dst = reinterpret_cast<quint8 *>(buff);
-        do {
-            const quint8 *d = it->oldRawData();
-            int i;
-            for (i = 0; i < nbcolorssamples; i++) {
-                *(dst++) = d[poses[i]];
+
+    const int TILE_SIZE = 256;
+
+    struct TileJob {
+        TileJob() : index(0), success(false) {}
+
+        ttile_t index;
+        QRect rect;
+        QByteArray data;
+        bool success;
+    };
+
+    /**
+     * Fills a tile with the pixels of the device and compresses it
+     * if a compressor is given
+     */
+    struct TileEncoder {
+        KisPaintDeviceSP device;
+        uint8 depth;
+        uint16 sampleFormat;
+        uint8 nbColorsSamples;
+        const quint8 *poses;
+        bool alpha;
+        tsize_t tileSize;
+        tsize_t tileRowSize;
+        const KisTIFFTileCompressor *compressor;
+
+        void operator()(TileJob &job) const {
+            // the parts of the edge tiles outside the image stay zeroed
+            QByteArray tile(tileSize, 0);
+
+            for (int row = 0; row < job.rect.height(); row++) {
+                KisHLineConstIteratorSP it = device->createHLineConstIteratorNG(job.rect.x(), job.rect.y() + row, job.rect.width());
+                if (!copyDataToStrips(it, tile.data() + row * tileRowSize, depth, sampleFormat, nbColorsSamples, poses, alpha)) {
+                    job.success = false;
+                    return;
+                }
             }
-            if (m_options->alpha) *(dst++) = d[poses[i]];
-            
-        } while (it->nextPixel());
+
+            if (compressor) {
+                job.success = compressor->compress(tile, &job.data);
+            } else {
+                job.data = tile;
+                job.success = true;
+            }
+        }
+    };
+
+    /**
+     * Prepares the tiles in parallel and writes them in order. The raw
+     * tiles are written as they are, the other ones are compressed by
+     * libtiff.
+     */
+    bool writeTileBatch(TIFF *image, QVector<TileJob> &jobs, const TileEncoder &encoder)
+    {
+        QtConcurrent::blockingMap(jobs, encoder);
+
+        for (int i = 0; i < jobs.size(); i++) {
+            TileJob &job = jobs[i];
+            if (!job.success) return false;
+
+            // libtiff may apply the predictor in place
+            const tsize_t written = encoder.compressor ?
+                TIFFWriteRawTile(image, job.index, job.data.data(), job.data.size()) :
+                TIFFWriteEncodedTile(image, job.index, job.data.data(), job.data.size());
+
+            if (written < 0) return false;
+        }
+
         return true;
     }
-    return false;
 }
 
+KisTIFFWriterVisitor::KisTIFFWriterVisitor(TIFF*image, KisTIFFOptions* options)
+    : m_image(image)
+    , m_options(options)
+{
+}
+
+KisTIFFWriterVisitor::~KisTIFFWriterVisitor()
+{
+}
 
 bool KisTIFFWriterVisitor::visit(KisPaintLayer *layer)
 {
@@ -213,8 +287,13 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer * layer)
 
     // Use contiguous configuration
     TIFFSetField(image(), TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-    // Use 8 rows per strip
-    TIFFSetField(image(), TIFFTAG_ROWSPERSTRIP, 8);
+    if (m_options->tiled) {
+        TIFFSetField(image(), TIFFTAG_TILEWIDTH, TILE_SIZE);
+        TIFFSetField(image(), TIFFTAG_TILELENGTH, TILE_SIZE);
+    } else {
+        // Use 8 rows per strip
+        TIFFSetField(image(), TIFFTAG_ROWSPERSTRIP, 8);
+    }
 
     // Save profile
     if (m_options->saveProfile) {
@@ -224,45 +303,100 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer * layer)
             TIFFSetField(image(), TIFFTAG_ICCPROFILE, ba.size(), ba.constData());
         }
     }
+
+    quint8 poses[5];
+    uint8 nbcolorssamples;
+    switch (color_type) {
+    case PHOTOMETRIC_MINISBLACK:
+        poses[0] = 0; poses[1] = 1;
+        nbcolorssamples = 1;
+        break;
+    case PHOTOMETRIC_RGB:
+        if (sample_format == SAMPLEFORMAT_IEEEFP) {
+            poses[2] = 2; poses[1] = 1; poses[0] = 0; poses[3] = 3;
+        } else {
+            poses[0] = 2; poses[1] = 1; poses[2] = 0; poses[3] = 3;
+        }
+        nbcolorssamples = 3;
+        break;
+    case PHOTOMETRIC_SEPARATED:
+        poses[0] = 0; poses[1] = 1; poses[2] = 2; poses[3] = 3; poses[4] = 4;
+        nbcolorssamples = 4;
+        break;
+    case PHOTOMETRIC_ICCLAB:
+        poses[0] = 0; poses[1] = 1; poses[2] = 2; poses[3] = 3;
+        nbcolorssamples = 3;
+        break;
+    default:
+        return false;
+    }
+
+    const QRect bounds(0, 0, layer->image()->width(), layer->image()->height());
+    bool r = m_options->tiled ?
+        writeTiles(pd, bounds, depth, sample_format, nbcolorssamples, poses) :
+        writeScanlines(pd, bounds, depth, sample_format, nbcolorssamples, poses);
+
+    if (!r) return false;
+
+    TIFFWriteDirectory(image());
+    return true;
+}
+
+bool KisTIFFWriterVisitor::writeScanlines(KisPaintDeviceSP pd, const QRect &bounds, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, const quint8 *poses)
+{
     tsize_t stripsize = TIFFStripSize(image());
     tdata_t buff = _TIFFmalloc(stripsize);
-    qint32 height = layer->image()->height();
-    qint32 width = layer->image()->width();
     bool r = true;
-    for (int y = 0; y < height; y++) {
-        KisHLineConstIteratorSP it = pd->createHLineConstIteratorNG(0, y, width);
-        switch (color_type) {
-        case PHOTOMETRIC_MINISBLACK: {
-                quint8 poses[] = { 0, 1 };
-                r = copyDataToStrips(it, buff, depth, sample_format, 1, poses);
-            }
-            break;
-        case PHOTOMETRIC_RGB: {
-                quint8 poses[4];
-                if (sample_format == SAMPLEFORMAT_IEEEFP) {
-                    poses[2] = 2; poses[1] = 1; poses[0] = 0; poses[3] = 3;
-                } else {
-                    poses[0] = 2; poses[1] = 1; poses[2] = 0; poses[3] = 3;
-                }
-                r = copyDataToStrips(it, buff, depth, sample_format, 3, poses);
-            }
-            break;
-        case PHOTOMETRIC_SEPARATED: {
-                quint8 poses[] = { 0, 1, 2, 3, 4 };
-                r = copyDataToStrips(it, buff, depth, sample_format, 4, poses);
-            }
-            break;
-        case PHOTOMETRIC_ICCLAB: {
-                quint8 poses[] = { 0, 1, 2, 3 };
-                r = copyDataToStrips(it, buff, depth, sample_format, 3, poses);
-            }
-            break;
-            return false;
-        }
-        if (!r) return false;
+    for (int y = bounds.y(); y <= bounds.bottom(); y++) {
+        KisHLineConstIteratorSP it = pd->createHLineConstIteratorNG(bounds.x(), y, bounds.width());
+        r = copyDataToStrips(it, buff, depth, sample_format, nbcolorssamples, poses, m_options->alpha);
+        if (!r) break;
         TIFFWriteScanline(image(), buff, y, (tsample_t) - 1);
     }
     _TIFFfree(buff);
-    TIFFWriteDirectory(image());
-    return true;
+    return r;
+}
+
+bool KisTIFFWriterVisitor::writeTiles(KisPaintDeviceSP pd, const QRect &bounds, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, const quint8 *poses)
+{
+    /**
+     * When the codec allows that, the tiles are compressed in parallel
+     * and written raw, otherwise only the pixel data is prepared in
+     * parallel and libtiff compresses the tiles one by one.
+     */
+    QScopedPointer<KisTIFFTileCompressor> compressor;
+    if (KisTIFFTileCompressor::isSupported(m_options->compressionType)) {
+        compressor.reset(new KisTIFFTileCompressor(image()));
+    }
+
+    TileEncoder encoder;
+    encoder.device = pd;
+    encoder.depth = depth;
+    encoder.sampleFormat = sample_format;
+    encoder.nbColorsSamples = nbcolorssamples;
+    encoder.poses = poses;
+    encoder.alpha = m_options->alpha;
+    encoder.tileSize = TIFFTileSize(image());
+    encoder.tileRowSize = TIFFTileRowSize(image());
+    encoder.compressor = compressor.data();
+
+    // the batches keep the memory usage independent from the image size
+    const int batchSize = 4 * QThread::idealThreadCount();
+    QVector<TileJob> jobs;
+
+    for (int y = bounds.y(); y <= bounds.bottom(); y += TILE_SIZE) {
+        for (int x = bounds.x(); x <= bounds.right(); x += TILE_SIZE) {
+            TileJob job;
+            job.index = TIFFComputeTile(image(), x - bounds.x(), y - bounds.y(), 0, 0);
+            job.rect = QRect(x, y, TILE_SIZE, TILE_SIZE) & bounds;
+            jobs.append(job);
+
+            if (jobs.size() >= batchSize) {
+                if (!writeTileBatch(image(), jobs, encoder)) return false;
+                jobs.clear();
+            }
+        }
+    }
+
+    return jobs.isEmpty() || writeTileBatch(image(), jobs, encoder);
 }
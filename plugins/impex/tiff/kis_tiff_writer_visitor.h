@@ -76,8 +76,9 @@ private:
     inline TIFF* image() {
         return m_image;
     }
-    bool copyDataToStrips(KisHLineConstIteratorSP it, tdata_t buff, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, quint8* poses);
     bool saveLayerProjection(KisLayer *);
+    bool writeScanlines(KisPaintDeviceSP pd, const QRect &bounds, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, const quint8 *poses);
+    bool writeTiles(KisPaintDeviceSP pd, const QRect &bounds, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, const quint8 *poses);
 private:
     TIFF* m_image;
     KisTIFFOptions* m_options;
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_tiff_benchmark.h"
+
+#include <QTest>
+#include <QDir>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <KisDocument.h>
+#include <KisPart.h>
+#include <kis_image.h>
+#include <kis_paint_layer.h>
+#include <kis_paint_device.h>
+
+#include "kis_tiff_converter.h"
+
+const int IMAGE_SIZE = 20000;
+const int FILL_STRIPE_HEIGHT = 64;
+
+
+void fillDevice(KisPaintDeviceSP dev)
+{
+    const int pixelSize = dev->pixelSize();
+    QByteArray stripe(IMAGE_SIZE * FILL_STRIPE_HEIGHT * pixelSize, 0);
+
+    /**
+     * Smooth gradients with some noise, like in a scanned painting,
+     * so that the codecs have some real work to do
+     */
+    for (int y = 0; y < IMAGE_SIZE; y += FILL_STRIPE_HEIGHT) {
+        const int height = qMin(FILL_STRIPE_HEIGHT, IMAGE_SIZE - y);
+        quint8 *pixel = reinterpret_cast<quint8*>(stripe.data());
+
+        for (int row = y; row < y + height; row++) {
+            for (int x = 0; x < IMAGE_SIZE; x++) {
+                const int noise = qrand() & 0x7;
+                pixel[0] = (x / 80 + noise) & 0xff;
+                pixel[1] = (row / 80 + noise) & 0xff;
+                pixel[2] = ((x + row) / 160) & 0xff;
+                pixel[3] = 0xff;
+                pixel += pixelSize;
+            }
+        }
+
+        dev->writeBytes(reinterpret_cast<const quint8*>(stripe.constData()), 0, y, IMAGE_SIZE, height);
+    }
+}
+
+KisTIFFOptions createOptions(int compression, bool tiled)
+{
+    KisTIFFOptions options;
+    options.compressionType = compression;
+    options.predictor = 2;
+    options.alpha = true;
+    options.flatten = true;
+    options.jpegQuality = 80;
+    options.deflateCompress = 6;
+    options.faxMode = 1;
+    options.pixarLogCompress = 6;
+    options.saveProfile = true;
+    options.tiled = tiled;
+    return options;
+}
+
+void KisTIFFBenchmark::initTestCase()
+{
+    qsrand(1);
+
+    m_fileName = QDir::tempPath() + QDir::separator() + "kis_tiff_benchmark.tiff";
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, IMAGE_SIZE, IMAGE_SIZE, cs, "tiff benchmark");
+
+    KisPaintLayerSP layer = new KisPaintLayer(image, "scan", OPACITY_OPAQUE_U8);
+    fillDevice(layer->paintDevice());
+    image->addNode(layer, image->root());
+
+    m_doc = KisPart::instance()->createDocument();
+    m_doc->setCurrentImage(image);
+}
+
+void KisTIFFBenchmark::cleanupTestCase()
+{
+    delete m_doc;
+    QFile::remove(m_fileName);
+}
+
+void KisTIFFBenchmark::benchmarkSave_data()
+{
+    QTest::addColumn<int>("compression");
+    QTest::addColumn<bool>("tiled");
+
+    QTest::newRow("striped-deflate") << int(COMPRESSION_DEFLATE) << false;
+    QTest::newRow("tiled-deflate") << int(COMPRESSION_DEFLATE) << true;
+    QTest::newRow("striped-lzw") << int(COMPRESSION_LZW) << false;
+    QTest::newRow("tiled-lzw") << int(COMPRESSION_LZW) << true;
+    QTest::newRow("tiled-none") << int(COMPRESSION_NONE) << true;
+}
+
+void KisTIFFBenchmark::benchmarkSave()
+{
+    QFETCH(int, compression);
+    QFETCH(bool, tiled);
+
+    QBENCHMARK {
+        KisTIFFConverter converter(m_doc);
+        QCOMPARE(converter.buildFile(m_fileName, m_doc->image(), createOptions(compression, tiled)),
+                 KisImageBuilder_RESULT_OK);
+    }
+}
+
+void KisTIFFBenchmark::benchmarkLoad_data()
+{
+    benchmarkSave_data();
+}
+
+void KisTIFFBenchmark::benchmarkLoad()
+{
+    QFETCH(int, compression);
+    QFETCH(bool, tiled);
+
+    {
+        KisTIFFConverter converter(m_doc);
+        QCOMPARE(converter.buildFile(m_fileName, m_doc->image(), createOptions(compression, tiled)),
+                 KisImageBuilder_RESULT_OK);
+    }
+
+    QBENCHMARK {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+        KisTIFFConverter converter(doc.data());
+        QCOMPARE(converter.buildImage(m_fileName), KisImageBuilder_RESULT_OK);
+
+        doc->setCurrentImage(converter.image());
+        QCOMPARE(doc->image()->width(), IMAGE_SIZE);
+        QCOMPARE(doc->image()->height(), IMAGE_SIZE);
+    }
+}
+
+QTEST_MAIN(KisTIFFBenchmark)
@@ -41,12 +41,16 @@
 #include <kis_pressure_sharpness_option.h>
 #include <kis_fixed_paint_device.h>
 #include <kis_lod_transform.h>
+#include <kis_dab_pipeline.h>
+#include <kis_image_config.h>
 
 
 KisBrushOp::KisBrushOp(const KisPaintOpSettingsSP settings, KisPainter *painter, KisNodeSP node, KisImageSP image)
     : KisBrushBasedPaintOp(settings, painter)
     , m_opacityOption(node)
     , m_hsvTransformation(0)
+    , m_dabPipeline(0)
+    , m_queueDabs(false)
 {
     Q_UNUSED(image);
     Q_ASSERT(settings);
@@ -91,10 +95,15 @@ KisBrushOp::KisBrushOp(const KisPaintOpSettingsSP settings, KisPainter *painter,
 
     m_dabCache->setSharpnessPostprocessing(&m_sharpnessOption);
     m_rotationOption.applyFanCornersInfo(this);
+
+    if (KisImageConfig().parallelDabGeneration() && KisDabPipeline::isSupported(m_brush)) {
+        m_dabPipeline = new KisDabPipeline(m_dabCache, m_brush, painter);
+    }
 }
 
 KisBrushOp::~KisBrushOp()
 {
+    delete m_dabPipeline;
     qDeleteAll(m_hsvOptions);
     delete m_colorSource;
     delete m_hsvTransformation;
@@ -142,25 +151,39 @@ KisSpacingInformation KisBrushOp::paintAt(const KisPaintInformation& info)
         m_colorSource->applyColorTransformation(m_hsvTransformation);
     }
 
-    QRect dabRect;
-    KisFixedPaintDeviceSP dab = m_dabCache->fetchDab(device->compositionSourceColorSpace(),
-                                m_colorSource,
-                                cursorPos,
-                                shape,
-                                info,
-                                m_softnessOption.apply(info),
-                                &dabRect);
-
-    // sanity check for the size calculation code
-    if (dab->bounds().size() != dabRect.size()) {
-        warnKrita << "KisBrushOp: dab bounds is not dab rect. See bug 327156" << dab->bounds().size() << dabRect.size();
-    }
+    if (m_queueDabs && m_colorSource->isUniformColor()) {
+        m_dabPipeline->addDab(device->compositionSourceColorSpace(),
+                              m_colorSource->uniformColor(),
+                              cursorPos,
+                              shape,
+                              info,
+                              m_softnessOption.apply(info));
+    } else {
+        if (m_dabPipeline) {
+            m_dabPipeline->flush();
+        }
+
+        QRect dabRect;
+        KisFixedPaintDeviceSP dab = m_dabCache->fetchDab(device->compositionSourceColorSpace(),
+                                    m_colorSource,
+                                    cursorPos,
+                                    shape,
+                                    info,
+                                    m_softnessOption.apply(info),
+                                    &dabRect);
+
+        // sanity check for the size calculation code
+        if (dab->bounds().size() != dabRect.size()) {
+            warnKrita << "KisBrushOp: dab bounds is not dab rect. See bug 327156" << dab->bounds().size() << dabRect.size();
+        }
 
-    painter()->bltFixed(dabRect.topLeft(), dab, dab->bounds());
+        painter()->bltFixed(dabRect.topLeft(), dab, dab->bounds());
+
+        painter()->renderMirrorMaskSafe(dabRect,
+                                        dab,
+                                        !m_dabCache->needSeparateOriginal());
+    }
 
-    painter()->renderMirrorMaskSafe(dabRect,
-                                    dab,
-                                    !m_dabCache->needSeparateOriginal());
     painter()->setOpacity(origOpacity);
 
     return effectiveSpacing(scale, rotation,
@@ -187,6 +210,17 @@ void KisBrushOp::paintLine(const KisPaintInformation& pi1, const KisPaintInforma
     //fixes Bug 338011
     painter()->renderMirrorMask(rc, m_lineCacheDevice);
     }
+    else if (m_dabPipeline) {
+        /**
+         * All the dabs of the line are queued by paintAt() and
+         * generated in parallel when the line is finished
+         */
+        m_queueDabs = true;
+        KisPaintOp::paintLine(pi1, pi2, currentDistance);
+        m_queueDabs = false;
+
+        m_dabPipeline->flush();
+    }
     else {
         KisPaintOp::paintLine(pi1, pi2, currentDistance);
     }
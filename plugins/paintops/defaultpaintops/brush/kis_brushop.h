@@ -41,6 +41,7 @@
 
 class KisPainter;
 class KisColorSource;
+class KisDabPipeline;
 
 
 class KisBrushOp : public KisBrushBasedPaintOp
@@ -72,6 +73,9 @@ private:
     KoColorTransformation *m_hsvTransformation;
     KisPaintDeviceSP m_lineCacheDevice;
     KisPaintDeviceSP m_colorSourceDevice;
+
+    KisDabPipeline *m_dabPipeline;
+    bool m_queueDabs;
 };
 
 #endif // KIS_BRUSHOP_H_
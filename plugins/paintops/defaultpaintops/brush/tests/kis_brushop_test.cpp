@@ -27,6 +27,8 @@
 #include <brushengine/kis_paintop_settings.h>
 #include <kis_pressure_mirror_option.h>
 #include <kis_pressure_rotation_option.h>
+#include <kis_image_config.h>
+#include <KoCompositeOpRegistry.h>
 
 class TestBrushOp : public TestUtil::QImageBasedTest
 {
@@ -208,6 +210,82 @@ public:
     }
 };
 
+class TestBrushOpPipeline : public TestUtil::QImageBasedTest
+{
+public:
+    TestBrushOpPipeline()
+        : QImageBasedTest("brushop")
+    {
+    }
+
+    KisPaintDeviceSP paintStroke(bool useDabPipeline) {
+        KisImageConfig cfg;
+        const bool oldValue = cfg.parallelDabGeneration();
+        cfg.setParallelDabGeneration(useDabPipeline);
+
+        KisSurrogateUndoStore *undoStore = new KisSurrogateUndoStore();
+        KisImageSP image = createTrivialImage(undoStore);
+        image->initialRefreshGraph();
+
+        KisNodeSP paint1 = findNode(image->root(), "paint1");
+        KisPainter gc(paint1->paintDevice());
+
+        QScopedPointer<KoCanvasResourceManager> manager(
+            utils::createResourceManager(image, 0, "autobrush_300px.kpp"));
+
+        KisResourcesSnapshotSP resources =
+            new KisResourcesSnapshot(image,
+                                     paint1,
+                                     image->postExecutionUndoAdapter(),
+                                     manager.data());
+
+        resources->setupPainter(&gc);
+
+        /**
+         * Alpha darken uses the mean opacity of the stroke, so the
+         * pipeline must restore it for every dab
+         */
+        gc.setCompositeOp(COMPOSITE_ALPHA_DARKEN);
+
+        QVector<KisPaintInformation> vector;
+
+        vector << KisPaintInformation(QPointF(0, 0), 0.2);
+        vector << KisPaintInformation(QPointF(200, 50), 1.0);
+        vector << KisPaintInformation(QPointF(100, 250), 0.1);
+        vector << KisPaintInformation(QPointF(200, 150), 0.7);
+        vector << KisPaintInformation(QPointF(100, 350), 1.0);
+
+        KisDistanceInformation dist;
+
+        for (int i = 1; i < vector.size(); i++) {
+            gc.paintLine(vector[i - 1], vector[i], &dist);
+        }
+
+        cfg.setParallelDabGeneration(oldValue);
+
+        return paint1->paintDevice();
+    }
+};
+
+void KisBrushOpTest::testDabPipeline()
+{
+    TestBrushOpPipeline t;
+
+    KisPaintDeviceSP sequentialDevice = t.paintStroke(false);
+    KisPaintDeviceSP pipelineDevice = t.paintStroke(true);
+
+    const QRect rc = sequentialDevice->exactBounds();
+    QVERIFY(!rc.isEmpty());
+    QCOMPARE(pipelineDevice->exactBounds(), rc);
+
+    QPoint pt;
+    if (!TestUtil::compareQImages(pt,
+                                  sequentialDevice->convertToQImage(0, rc),
+                                  pipelineDevice->convertToQImage(0, rc))) {
+        QFAIL(QString("The stroke painted with the dab pipeline differs at %1,%2")
+              .arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
 
 void KisBrushOpTest::testRotationMirroring()
 {
@@ -30,6 +30,7 @@
 #include <brushengine/kis_paintop.h>
 
 #include <kundo2command.h>
+#include <kis_assert.h>
 
 struct PrecisionValues {
     qreal angle;
@@ -83,7 +84,8 @@ struct KisDabCache::Private {
           textureOption(0),
           precisionOption(0),
           subPixelPrecisionDisabled(false),
-          cachedDabParameters(new SavedDabParameters)
+          cachedDabParameters(new SavedDabParameters),
+          cachedParametersDescribeFetchedDab(false)
     {}
     KisFixedPaintDeviceSP dab;
     KisFixedPaintDeviceSP dabOriginal;
@@ -98,6 +100,10 @@ struct KisDabCache::Private {
     bool subPixelPrecisionDisabled;
 
     SavedDabParameters *cachedDabParameters;
+
+    /// the saved parameters came from fetchDabGenerationInfo(), not
+    /// from generation of the dab in fetchDab()
+    bool cachedParametersDescribeFetchedDab;
 };
 
 
@@ -213,7 +219,6 @@ struct KisDabCache::DabPosition {
     qreal realAngle;
 };
 
-inline
 QRect KisDabCache::correctDabRectWhenFetchedFromCache(const QRect &dabRect,
         const QSize &realDabSize)
 {
@@ -224,14 +229,17 @@ QRect KisDabCache::correctDabRectWhenFetchedFromCache(const QRect &dabRect,
                  realDabSize.width() , realDabSize.height());
 }
 
+inline int KisDabCache::precisionLevel() const
+{
+    return m_d->precisionOption ? m_d->precisionOption->precisionLevel() - 1 : 3;
+}
+
 inline
 KisFixedPaintDeviceSP KisDabCache::tryFetchFromCache(const SavedDabParameters &params,
         const KisPaintInformation& info,
         QRect *dstDabRect)
 {
-    int precisionLevel = m_d->precisionOption ? m_d->precisionOption->precisionLevel() - 1 : 3;
-
-    if (!params.compare(*m_d->cachedDabParameters, precisionLevel)) {
+    if (!params.compare(*m_d->cachedDabParameters, precisionLevel())) {
         return 0;
     }
 
@@ -366,6 +374,7 @@ KisFixedPaintDeviceSP KisDabCache::fetchDabCommon(const KoColorSpace *cs,
     }
     else if (cachingIsPossible) {
         *m_d->cachedDabParameters = newParams;
+        m_d->cachedParametersDescribeFetchedDab = false;
         m_d->brush->mask(m_d->dab, paintColor, shape,
                          info,
                          position.subPixel.x(), position.subPixel.y(),
@@ -407,6 +416,91 @@ KisFixedPaintDeviceSP KisDabCache::fetchDabCommon(const KoColorSpace *cs,
     return m_d->dab;
 }
 
+KisDabCache::DabGenerationInfo
+KisDabCache::fetchDabGenerationInfo(const KoColor& color,
+                                    const QPointF &cursorPoint,
+                                    KisDabShape const& shape,
+                                    const KisPaintInformation& info,
+                                    qreal softnessFactor)
+{
+    DabGenerationInfo di;
+
+    if (m_d->mirrorOption) {
+        di.mirrorProperties = m_d->mirrorOption->apply(info);
+    }
+
+    DabPosition position = calculateDabRect(cursorPoint,
+                                            shape,
+                                            info,
+                                            di.mirrorProperties);
+
+    di.shape = KisDabShape(shape.scale(), shape.ratio(), position.realAngle);
+    di.dstDabRect = position.rect;
+    di.subPixel = position.subPixel;
+    di.paintColor = color;
+    di.info = info;
+    di.softnessFactor = softnessFactor;
+
+    if (m_d->textureOption && m_d->textureOption->m_enabled) {
+        di.textureStrength = m_d->textureOption->strength(info);
+    }
+
+    SavedDabParameters newParams = getDabParameters(color,
+                                   di.shape, info,
+                                   position.subPixel.x(),
+                                   position.subPixel.y(),
+                                   softnessFactor,
+                                   di.mirrorProperties);
+
+    di.cacheHit = m_d->cachedParametersDescribeFetchedDab &&
+        newParams.compare(*m_d->cachedDabParameters, precisionLevel());
+
+    if (di.cacheHit) {
+        m_d->brush->notifyCachedDabPainted(info);
+    } else {
+        *m_d->cachedDabParameters = newParams;
+        m_d->cachedParametersDescribeFetchedDab = true;
+    }
+
+    m_d->dab = 0;
+
+    return di;
+}
+
+KisFixedPaintDeviceSP KisDabCache::generateDab(const KoColorSpace *cs,
+                                               const DabGenerationInfo &di,
+                                               KisBrushSP brush) const
+{
+    KIS_ASSERT_RECOVER_NOOP(brush->brushType() == MASK);
+
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs);
+
+    brush->mask(dab, di.paintColor, di.shape,
+                di.info,
+                di.subPixel.x(), di.subPixel.y(),
+                di.softnessFactor);
+
+    if (!di.mirrorProperties.isEmpty()) {
+        dab->mirror(di.mirrorProperties.horizontalMirror,
+                    di.mirrorProperties.verticalMirror);
+    }
+
+    return dab;
+}
+
+void KisDabCache::postProcessDab(KisFixedPaintDeviceSP dab,
+                                 const QPoint &dabTopLeft,
+                                 const DabGenerationInfo &di) const
+{
+    if (m_d->sharpnessOption) {
+        m_d->sharpnessOption->applyThreshold(dab);
+    }
+
+    if (m_d->textureOption) {
+        m_d->textureOption->apply(dab, dabTopLeft, di.textureStrength);
+    }
+}
+
 void KisDabCache::postProcessDab(KisFixedPaintDeviceSP dab,
                                  const QPoint &dabTopLeft,
                                  const KisPaintInformation& info)
@@ -21,13 +21,16 @@
 
 #include "kritapaintop_export.h"
 #include "kis_brush.h"
+#include "kis_pressure_mirror_option.h"
+
+#include <KoColor.h>
+#include <brushengine/kis_paint_information.h>
 
 class KisColorSource;
 class KisPressureSharpnessOption;
 class KisTextureProperties;
 class KisPressureMirrorOption;
 class KisPrecisionOption;
-struct MirrorProperties;
 
 
 /**
@@ -86,6 +89,75 @@ public:
                                    qreal softnessFactor,
                                    QRect *dstDabRect);
 
+    /**
+     * Everything needed to generate a dab of a uniform color without
+     * touching the state of the paintop, see fetchDabGenerationInfo()
+     */
+    struct DabGenerationInfo {
+        DabGenerationInfo()
+            : softnessFactor(1.0),
+              textureStrength(1.0),
+              cacheHit(false)
+        {
+        }
+
+        MirrorProperties mirrorProperties;
+        KisDabShape shape;
+        QRect dstDabRect;
+        QPointF subPixel;
+        KoColor paintColor;
+        KisPaintInformation info;
+        qreal softnessFactor;
+        qreal textureStrength;
+
+        /// the dab is equal to the previous one within the precision
+        /// level, so it can be reused instead of generating
+        bool cacheHit;
+    };
+
+    /**
+     * Does the sequential part of fetchDab(): evaluates the sensors of
+     * the postprocessing options, places the dab and checks whether it
+     * is equal to the previous one. The dab itself can be generated
+     * later by generateDab() and postProcessDab(), possibly in another
+     * thread.
+     *
+     * After this call the dab cached by fetchDab() is dropped, because
+     * the saved parameters describe the fetched dab now.
+     */
+    DabGenerationInfo fetchDabGenerationInfo(const KoColor& color,
+                                             const QPointF &cursorPoint,
+                                             KisDabShape const&,
+                                             const KisPaintInformation& info,
+                                             qreal softnessFactor);
+
+    /**
+     * Generates the (mirrored, but not postprocessed) dab described by
+     * \p di. Only mask-based brushes are supported.
+     *
+     * The method is reentrant as long as every thread passes its own
+     * copy of the brush.
+     */
+    KisFixedPaintDeviceSP generateDab(const KoColorSpace *cs,
+                                      const DabGenerationInfo &di,
+                                      KisBrushSP brush) const;
+
+    /**
+     * Applies sharpness and texture postprocessing to a dab
+     * generated by generateDab(). Can be called from any thread.
+     */
+    void postProcessDab(KisFixedPaintDeviceSP dab,
+                        const QPoint &dabTopLeft,
+                        const DabGenerationInfo &di) const;
+
+    /**
+     * When a dab is reused its size can differ from the calculated
+     * one within the precision level, so the rect is centered
+     * around the calculated one.
+     */
+    static QRect correctDabRectWhenFetchedFromCache(const QRect &dabRect,
+                                                    const QSize &realDabSize);
+
 
 private:
     struct SavedDabParameters;
@@ -103,9 +175,7 @@ private:
                      const KisPaintInformation& info,
                      const MirrorProperties &mirrorProperties);
 
-    inline
-    QRect correctDabRectWhenFetchedFromCache(const QRect &dabRect,
-            const QSize &realDabSize);
+    inline int precisionLevel() const;
 
     inline KisFixedPaintDeviceSP tryFetchFromCache(const SavedDabParameters &params,
             const KisPaintInformation& info,
@@ -0,0 +1,274 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_dab_pipeline.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QtConcurrent>
+
+#include <KoColorSpace.h>
+
+#include <kis_painter.h>
+#include <kis_fixed_paint_device.h>
+
+#include "kis_dab_cache.h"
+
+/**
+ * The number of queued dabs that triggers a flush. It limits the memory
+ * taken by the generated dabs and the latency of the stroke.
+ */
+static const int MAX_QUEUED_DABS = 32;
+
+/**
+ * Smaller dabs are generated faster than the jobs can be scheduled
+ */
+static const int MIN_PARALLEL_DAB_AREA = 64 * 64;
+
+struct KisDabPipeline::Private
+{
+    struct Request {
+        Request()
+            : cs(0),
+              sourceIndex(-1),
+              ready(false)
+        {
+        }
+
+        KisDabCache::DabGenerationInfo di;
+        const KoColorSpace *cs;
+        KisPainter::OpacityState opacityState;
+
+        /**
+         * The index of the request whose dab is reused, -1 if the
+         * dab is generated and -2 if the last dab of the previous
+         * flush is reused
+         */
+        int sourceIndex;
+
+        KisFixedPaintDeviceSP dab;
+        KisFixedPaintDeviceSP original;
+        QRect dabRect;
+
+        bool ready;
+    };
+
+    struct GenerateDab {
+        GenerateDab(Private *_d) : d(_d), requests(_d->requests.data()) {}
+
+        void operator() (int index) {
+            Request &request = requests[index];
+
+            KisBrushSP brush = d->acquireBrush();
+            KisFixedPaintDeviceSP dab = d->dabCache->generateDab(request.cs, request.di, brush);
+            d->releaseBrush(brush);
+
+            if (d->dabCache->needSeparateOriginal()) {
+                request.original = new KisFixedPaintDevice(*dab);
+            }
+
+            d->dabCache->postProcessDab(dab, request.di.dstDabRect.topLeft(), request.di);
+
+            request.dab = dab;
+            request.dabRect = request.di.dstDabRect;
+
+            QMutexLocker l(&d->readyLock);
+            request.ready = true;
+            d->readyCondition.wakeAll();
+        }
+
+        Private *d;
+        Request *requests;
+    };
+
+    Private(KisDabCache *_dabCache, KisBrushSP _brush, KisPainter *_painter)
+        : dabCache(_dabCache),
+          brush(_brush),
+          painter(_painter),
+          lastGeneratedCS(0)
+    {
+    }
+
+    KisDabCache *dabCache;
+    KisBrushSP brush;
+    KisPainter *painter;
+
+    QVector<Request> requests;
+
+    QMutex readyLock;
+    QWaitCondition readyCondition;
+
+    QMutex brushesLock;
+    QList<KisBrushSP> freeBrushes;
+
+    KisFixedPaintDeviceSP lastGeneratedDab;
+    KisFixedPaintDeviceSP lastGeneratedOriginal;
+    const KoColorSpace *lastGeneratedCS;
+
+    KisBrushSP acquireBrush() {
+        QMutexLocker l(&brushesLock);
+        return !freeBrushes.isEmpty() ? freeBrushes.takeLast() : KisBrushSP(brush->clone());
+    }
+
+    void releaseBrush(KisBrushSP brush) {
+        QMutexLocker l(&brushesLock);
+        freeBrushes.append(brush);
+    }
+
+    void waitForRequest(const Request &request) {
+        QMutexLocker l(&readyLock);
+        while (!request.ready) {
+            readyCondition.wait(&readyLock);
+        }
+    }
+
+    void fetchFromSource(Request &request,
+                         KisFixedPaintDeviceSP sourceDab,
+                         KisFixedPaintDeviceSP sourceOriginal);
+};
+
+void KisDabPipeline::Private::fetchFromSource(Request &request,
+                                              KisFixedPaintDeviceSP sourceDab,
+                                              KisFixedPaintDeviceSP sourceOriginal)
+{
+    // the same as KisDabCache::tryFetchFromCache() does
+    if (dabCache->needSeparateOriginal()) {
+        request.original = sourceOriginal;
+        request.dab = new KisFixedPaintDevice(*sourceOriginal);
+        request.dabRect = KisDabCache::correctDabRectWhenFetchedFromCache(request.di.dstDabRect, request.dab->bounds().size());
+        dabCache->postProcessDab(request.dab, request.dabRect.topLeft(), request.di);
+    } else {
+        request.dab = sourceDab;
+        request.dabRect = KisDabCache::correctDabRectWhenFetchedFromCache(request.di.dstDabRect, request.dab->bounds().size());
+    }
+}
+
+
+KisDabPipeline::KisDabPipeline(KisDabCache *dabCache, KisBrushSP brush, KisPainter *painter)
+    : m_d(new Private(dabCache, brush, painter))
+{
+}
+
+KisDabPipeline::~KisDabPipeline()
+{
+    KIS_ASSERT_RECOVER_NOOP(isEmpty());
+    delete m_d;
+}
+
+bool KisDabPipeline::isSupported(KisBrushSP brush)
+{
+    return brush &&
+        brush->brushType() == MASK &&
+        brush->width() * brush->height() >= MIN_PARALLEL_DAB_AREA;
+}
+
+void KisDabPipeline::addDab(const KoColorSpace *cs,
+                            const KoColor &color,
+                            const QPointF &cursorPoint,
+                            KisDabShape const &shape,
+                            const KisPaintInformation &info,
+                            qreal softnessFactor)
+{
+    Private::Request request;
+    request.di = m_d->dabCache->fetchDabGenerationInfo(color, cursorPoint, shape, info, softnessFactor);
+    request.cs = cs;
+    request.opacityState = m_d->painter->opacityState();
+
+    if (request.di.cacheHit) {
+        for (int i = m_d->requests.size() - 1; i >= 0; i--) {
+            if (m_d->requests[i].sourceIndex == -1) {
+                request.sourceIndex = i;
+                break;
+            }
+        }
+
+        if (request.sourceIndex == -1 && m_d->lastGeneratedDab) {
+            request.sourceIndex = -2;
+        }
+
+        const KoColorSpace *sourceCS =
+            request.sourceIndex >= 0 ? m_d->requests[request.sourceIndex].cs :
+            request.sourceIndex == -2 ? m_d->lastGeneratedCS : 0;
+
+        if (!sourceCS || *sourceCS != *cs) {
+            request.sourceIndex = -1;
+        }
+    }
+
+    m_d->requests.append(request);
+
+    if (m_d->requests.size() >= MAX_QUEUED_DABS) {
+        flush();
+    }
+}
+
+void KisDabPipeline::flush()
+{
+    if (m_d->requests.isEmpty()) return;
+
+    QVector<int> generatedDabs;
+    for (int i = 0; i < m_d->requests.size(); i++) {
+        if (m_d->requests[i].sourceIndex == -1) {
+            generatedDabs << i;
+        }
+    }
+
+    QFuture<void> future = QtConcurrent::map(generatedDabs, Private::GenerateDab(m_d));
+
+    const KisPainter::OpacityState origOpacityState = m_d->painter->opacityState();
+    const bool preserveDab = !m_d->dabCache->needSeparateOriginal();
+
+    for (int i = 0; i < m_d->requests.size(); i++) {
+        Private::Request &request = m_d->requests[i];
+
+        if (request.sourceIndex == -1) {
+            m_d->waitForRequest(request);
+        } else if (request.sourceIndex == -2) {
+            m_d->fetchFromSource(request, m_d->lastGeneratedDab, m_d->lastGeneratedOriginal);
+        } else {
+            const Private::Request &source = m_d->requests[request.sourceIndex];
+            m_d->fetchFromSource(request, source.dab, source.original);
+        }
+
+        m_d->painter->setOpacityState(request.opacityState);
+        m_d->painter->bltFixed(request.dabRect.topLeft(), request.dab, request.dab->bounds());
+        m_d->painter->renderMirrorMaskSafe(request.dabRect, request.dab, preserveDab);
+    }
+
+    future.waitForFinished();
+
+    m_d->painter->setOpacityState(origOpacityState);
+
+    /**
+     * The next flush may reuse the dab generated last
+     */
+    if (!generatedDabs.isEmpty()) {
+        const Private::Request &lastGenerated = m_d->requests[generatedDabs.last()];
+        m_d->lastGeneratedDab = lastGenerated.dab;
+        m_d->lastGeneratedOriginal = lastGenerated.original;
+        m_d->lastGeneratedCS = lastGenerated.cs;
+    }
+
+    m_d->requests.clear();
+}
+
+bool KisDabPipeline::isEmpty() const
+{
+    return m_d->requests.isEmpty();
+}
@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_DAB_PIPELINE_H
+#define __KIS_DAB_PIPELINE_H
+
+#include "kritapaintop_export.h"
+#include "kis_brush.h"
+
+class KisDabCache;
+class KisPainter;
+class KoColor;
+class KoColorSpace;
+class KisPaintInformation;
+
+
+/**
+ * KisDabPipeline generates the dabs of a brush based paintop in
+ * parallel and composites them in the order they were requested.
+ *
+ * The paintop does everything that depends on its state (sensors,
+ * random sources, color selection, placement of the dab) in paintAt()
+ * as usual, but instead of painting the dab it passes it to addDab().
+ * On flush() the masks of all the queued dabs are generated and
+ * postprocessed concurrently, every worker using its own clone of the
+ * brush, while the calling thread composites the ready dabs one by
+ * one through the painter. The dabs the dab cache considers equal are
+ * generated only once.
+ *
+ * Only brushes generating a mask (not images or pipes) and uniform
+ * color sources are supported.
+ */
+class PAINTOP_EXPORT KisDabPipeline
+{
+public:
+    KisDabPipeline(KisDabCache *dabCache, KisBrushSP brush, KisPainter *painter);
+    ~KisDabPipeline();
+
+    /**
+     * @return true if the pipeline can paint with \p brush and the
+     * dabs of the brush are big enough to be worth generating in
+     * parallel
+     */
+    static bool isSupported(KisBrushSP brush);
+
+    /**
+     * Queues a dab. The current opacity state of the painter (the
+     * opacity, the flow and the mean opacity of the stroke) is saved
+     * with it. If too many dabs are waiting, the queue is flushed.
+     */
+    void addDab(const KoColorSpace *cs,
+                const KoColor &color,
+                const QPointF &cursorPoint,
+                KisDabShape const &shape,
+                const KisPaintInformation &info,
+                qreal softnessFactor);
+
+    /**
+     * Generates and composites all the queued dabs. Blocks until
+     * everything is painted.
+     */
+    void flush();
+
+    bool isEmpty() const;
+
+private:
+    struct Private;
+    Private * const m_d;
+};
+
+#endif /* __KIS_DAB_PIPELINE_H */
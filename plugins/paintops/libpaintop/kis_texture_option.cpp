@@ -378,6 +378,18 @@ void KisTextureProperties::apply(KisFixedPaintDeviceSP dab, const QPoint &offset
 {
     if (!m_enabled) return;
 
+    apply(dab, offset, strength(info));
+}
+
+qreal KisTextureProperties::strength(const KisPaintInformation & info)
+{
+    return m_strengthOption.apply(info);
+}
+
+void KisTextureProperties::apply(KisFixedPaintDeviceSP dab, const QPoint &offset, qreal strength)
+{
+    if (!m_enabled) return;
+
     KisPaintDeviceSP fillDevice = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
     QRect rect = dab->bounds();
 
@@ -388,7 +400,7 @@ void KisTextureProperties::apply(KisFixedPaintDeviceSP dab, const QPoint &offset
     fillPainter.fillRect(x - 1, y - 1, rect.width() + 2, rect.height() + 2, m_mask, m_maskBounds);
     fillPainter.end();
 
-    qreal pressure = m_strengthOption.apply(info);
+    const qreal pressure = strength;
     quint8 *dabData = dab->data();
 
     KisHLineIteratorSP iter = fillDevice->createHLineIteratorNG(x, y, rect.width());
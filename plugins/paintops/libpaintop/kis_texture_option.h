@@ -77,6 +77,19 @@ public:
      * @param offset the position of the dab on the image. used to calculate the position of the mask pattern
      */
     void apply(KisFixedPaintDeviceSP dab, const QPoint& offset, const KisPaintInformation & info);
+
+    /**
+     * The same as above, but with the strength of the texture already
+     * calculated with strength(). The sensors are evaluated only by
+     * strength(), so this version can be called from any thread.
+     */
+    void apply(KisFixedPaintDeviceSP dab, const QPoint& offset, qreal strength);
+
+    /**
+     * @return the strength of the texture for the dab painted with \p info
+     */
+    qreal strength(const KisPaintInformation & info);
+
     void fillProperties(const KisPropertiesConfigurationSP setting);
 
 private:
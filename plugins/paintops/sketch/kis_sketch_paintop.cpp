@@ -193,10 +193,30 @@ void KisSketchPaintOp::paintLine(const KisPaintInformation &pi1, const KisPaintI
     QPoint  positionInMask;
     QPointF diff;
 
-    int size = m_points.size();
+    /**
+     * Only the points lying close enough to the current position
+     * can be connected to, so fetch just them from the grid instead
+     * of scanning the whole stroke history. The candidates come in
+     * the order they were painted in, so the random source is used
+     * exactly as before.
+     */
+    const qreal searchRadius = std::sqrt(thresholdDistance);
+    QRectF searchRect = m_brushBoundingBox;
+
+    if (m_sketchProperties.simpleMode) {
+        searchRect = QRectF(mousePosition.x() - searchRadius,
+                            mousePosition.y() - searchRadius,
+                            2.0 * searchRadius, 2.0 * searchRadius);
+        searchRect.adjust(-1.0, -1.0, 1.0, 1.0);
+    }
+
+    m_points.query(searchRect, searchRadius, &m_candidates);
+
+    int size = m_candidates.size();
     // MAIN LOOP
-    for (int i = 0; i < size; i++) {
-        diff = m_points.at(i) - mousePosition;
+    for (int k = 0; k < size; k++) {
+        const QPointF &point = m_points.at(m_candidates[k]);
+        diff = point - mousePosition;
         distance = diff.x() * diff.x() + diff.y() * diff.y();
 
         // circle test
@@ -208,7 +228,7 @@ void KisSketchPaintOp::paintLine(const KisPaintInformation &pi1, const KisPaintI
             // mask test
         }
         else {
-            if (m_brushBoundingBox.contains(m_points.at(i))) {
+            if (m_brushBoundingBox.contains(point)) {
                 positionInMask = (diff + m_hotSpot).toPoint();
                 uint pos = ((positionInMask.y() * w + positionInMask.x()) * m_maskDab->pixelSize());
                 if (pos < m_maskDab->allocatedPixels() * m_maskDab->pixelSize()) {
@@ -269,7 +289,7 @@ void KisSketchPaintOp::paintLine(const KisPaintInformation &pi1, const KisPaintI
             m_painter->setOpacity(opacity);
 
             if (m_sketchProperties.magnetify) {
-                drawConnection(mousePosition + offsetPt, m_points.at(i) - offsetPt, currentLineWidth);
+                drawConnection(mousePosition + offsetPt, point - offsetPt, currentLineWidth);
             }
             else {
                 drawConnection(mousePosition + offsetPt, mousePosition - offsetPt, currentLineWidth);
@@ -32,6 +32,7 @@
 #include <kis_pressure_rotation_option.h>
 #include "kis_linewidth_option.h"
 #include "kis_offset_scale_option.h"
+#include "kis_sketch_points_grid.h"
 
 class KisDabCache;
 
@@ -69,7 +70,8 @@ private:
     KisBrushOption m_brushOption;
     SketchProperties m_sketchProperties;
 
-    QVector<QPointF> m_points;
+    KisSketchPointsGrid m_points;
+    QVector<int> m_candidates;
     int m_count;
     KisPainter * m_painter;
     KisBrushSP m_brush;
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_sketch_points_grid.h"
+
+#include <algorithm>
+
+#include <QtMath>
+
+
+/**
+ * Don't let a tiny brush split the stroke into too many cells
+ */
+static const qreal minCellSize = 4.0;
+
+KisSketchPointsGrid::KisSketchPointsGrid()
+    : m_cellSize(0.0)
+{
+}
+
+void KisSketchPointsGrid::append(const QPointF &pt)
+{
+    m_points.append(pt);
+
+    if (m_cellSize > 0.0) {
+        addToCell(m_points.size() - 1);
+    }
+}
+
+void KisSketchPointsGrid::query(const QRectF &rect, qreal cellSizeHint, QVector<int> *indices)
+{
+    indices->clear();
+
+    if (m_cellSize <= 0.0) {
+        setCellSize(cellSizeHint);
+    }
+
+    const int left = cellCoord(rect.left());
+    const int right = cellCoord(rect.right());
+    const int top = cellCoord(rect.top());
+    const int bottom = cellCoord(rect.bottom());
+
+    const qint64 numCells = qint64(right - left + 1) * (bottom - top + 1);
+
+    /**
+     * When the rect covers more cells than there are points,
+     * walking the cells is slower than returning everything
+     */
+    if (numCells > m_points.size()) {
+        indices->resize(m_points.size());
+        for (int i = 0; i < m_points.size(); i++) {
+            (*indices)[i] = i;
+        }
+        return;
+    }
+
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            QHash<quint64, QVector<int> >::const_iterator it =
+                m_cells.constFind(cellKey(x, y));
+
+            if (it != m_cells.constEnd()) {
+                *indices += it.value();
+            }
+        }
+    }
+
+    std::sort(indices->begin(), indices->end());
+}
+
+void KisSketchPointsGrid::setCellSize(qreal cellSize)
+{
+    m_cellSize = qMax(minCellSize, cellSize);
+    m_cells.clear();
+
+    for (int i = 0; i < m_points.size(); i++) {
+        addToCell(i);
+    }
+}
+
+void KisSketchPointsGrid::addToCell(int index)
+{
+    const QPointF &pt = m_points.at(index);
+    m_cells[cellKey(cellCoord(pt.x()), cellCoord(pt.y()))].append(index);
+}
+
+inline int KisSketchPointsGrid::cellCoord(qreal value) const
+{
+    return qFloor(value / m_cellSize);
+}
+
+inline quint64 KisSketchPointsGrid::cellKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef KIS_SKETCH_POINTS_GRID_H_
+#define KIS_SKETCH_POINTS_GRID_H_
+
+#include <QHash>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+
+/**
+ * Stores the history of the sketch stroke and buckets its points
+ * into a uniform grid, so that the points around the current dab
+ * can be found without scanning the whole stroke.
+ *
+ * The cell size is chosen on the first query, when the connection
+ * radius of the brush is already known.
+ */
+class KisSketchPointsGrid
+{
+public:
+    KisSketchPointsGrid();
+
+    void append(const QPointF &pt);
+
+    int size() const {
+        return m_points.size();
+    }
+
+    const QPointF& at(int index) const {
+        return m_points.at(index);
+    }
+
+    /**
+     * Fills \p indices with the indices of all the points that may
+     * lie inside \p rect, sorted in ascending order. The result is a
+     * superset of the points really lying in \p rect (the whole cells
+     * are returned), so the caller should still check every point. The
+     * order is the same the points have been appended in, which keeps
+     * the random sequence of the paintop the same as if the whole
+     * history was scanned.
+     *
+     * \p cellSizeHint is used for initializing the grid on the first
+     * call, it should be about the size of the queried rects
+     */
+    void query(const QRectF &rect, qreal cellSizeHint, QVector<int> *indices);
+
+private:
+    void setCellSize(qreal cellSize);
+    void addToCell(int index);
+
+    inline int cellCoord(qreal value) const;
+    inline static quint64 cellKey(int x, int y);
+
+private:
+    QVector<QPointF> m_points;
+    QHash<quint64, QVector<int> > m_cells;
+    qreal m_cellSize;
+};
+
+#endif // KIS_SKETCH_POINTS_GRID_H_
@@ -0,0 +1,192 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_sketch_points_grid_test.h"
+
+#include <QTest>
+#include <QtMath>
+
+#include "kis_sketch_points_grid.h"
+
+
+/**
+ * A deterministic scribble going back and forth over the same area,
+ * the way a sketch stroke usually does
+ */
+static QVector<QPointF> generateStroke(int numPoints)
+{
+    QVector<QPointF> points;
+    points.reserve(numPoints);
+
+    for (int i = 0; i < numPoints; i++) {
+        const qreal t = 0.05 * i;
+        points << QPointF(500.0 + 400.0 * std::sin(0.37 * t) + 30.0 * std::cos(3.1 * t),
+                          500.0 + 300.0 * std::sin(0.53 * t + 1.0) - 20.0 * std::sin(2.7 * t));
+    }
+
+    return points;
+}
+
+static QVector<int> connectedPoints(const QVector<QPointF> &points,
+                                    const QVector<int> &candidates,
+                                    const QPointF &pos, qreal radius)
+{
+    QVector<int> result;
+
+    Q_FOREACH (int i, candidates) {
+        const QPointF diff = points[i] - pos;
+        if (diff.x() * diff.x() + diff.y() * diff.y() < radius * radius) {
+            result << i;
+        }
+    }
+
+    return result;
+}
+
+static QRectF searchRect(const QPointF &pos, qreal radius)
+{
+    return QRectF(pos.x() - radius, pos.y() - radius,
+                  2.0 * radius, 2.0 * radius).adjusted(-1.0, -1.0, 1.0, 1.0);
+}
+
+static QVector<int> allIndices(int size)
+{
+    QVector<int> result(size);
+    for (int i = 0; i < size; i++) {
+        result[i] = i;
+    }
+    return result;
+}
+
+void KisSketchPointsGridTest::testQuery()
+{
+    const QVector<QPointF> stroke = generateStroke(3000);
+    const qreal radius = 25.0;
+
+    KisSketchPointsGrid grid;
+    QVector<QPointF> points;
+    QVector<int> candidates;
+
+    Q_FOREACH (const QPointF &pt, stroke) {
+        grid.append(pt);
+        points << pt;
+
+        grid.query(searchRect(pt, radius), radius, &candidates);
+
+        for (int i = 1; i < candidates.size(); i++) {
+            QVERIFY(candidates[i - 1] < candidates[i]);
+        }
+
+        QCOMPARE(connectedPoints(points, candidates, pt, radius),
+                 connectedPoints(points, allIndices(points.size()), pt, radius));
+    }
+
+    QCOMPARE(grid.size(), stroke.size());
+}
+
+void KisSketchPointsGridTest::testPointsBeforeFirstQuery()
+{
+    const QVector<QPointF> stroke = generateStroke(500);
+    const qreal radius = 40.0;
+
+    KisSketchPointsGrid grid;
+    Q_FOREACH (const QPointF &pt, stroke) {
+        grid.append(pt);
+    }
+
+    QVector<int> candidates;
+    const QPointF pos = stroke[250];
+    grid.query(searchRect(pos, radius), radius, &candidates);
+
+    QCOMPARE(connectedPoints(stroke, candidates, pos, radius),
+             connectedPoints(stroke, allIndices(stroke.size()), pos, radius));
+}
+
+void KisSketchPointsGridTest::testHugeRect()
+{
+    const QVector<QPointF> stroke = generateStroke(100);
+
+    KisSketchPointsGrid grid;
+    Q_FOREACH (const QPointF &pt, stroke) {
+        grid.append(pt);
+    }
+
+    QVector<int> candidates;
+    grid.query(QRectF(-10000, -10000, 20000, 20000), 5.0, &candidates);
+
+    QCOMPARE(candidates, allIndices(stroke.size()));
+}
+
+void KisSketchPointsGridTest::benchmarkLongStroke_data()
+{
+    QTest::addColumn<int>("numPoints");
+    QTest::addColumn<bool>("useGrid");
+
+    QTest::newRow("1000, scan") << 1000 << false;
+    QTest::newRow("1000, grid") << 1000 << true;
+    QTest::newRow("10000, scan") << 10000 << false;
+    QTest::newRow("10000, grid") << 10000 << true;
+    QTest::newRow("30000, scan") << 30000 << false;
+    QTest::newRow("30000, grid") << 30000 << true;
+}
+
+void KisSketchPointsGridTest::benchmarkLongStroke()
+{
+    QFETCH(int, numPoints);
+    QFETCH(bool, useGrid);
+
+    const QVector<QPointF> stroke = generateStroke(numPoints);
+    const qreal radius = 25.0;
+
+    /**
+     * Measures the time of processing the last hundred dabs of a
+     * stroke, which is what the user feels when the stroke gets long
+     */
+    const int numMeasuredDabs = 100;
+
+    KisSketchPointsGrid grid;
+    QVector<QPointF> points;
+    for (int i = 0; i < numPoints - numMeasuredDabs; i++) {
+        grid.append(stroke[i]);
+        points << stroke[i];
+    }
+
+    QVector<int> candidates;
+    int numConnections = 0;
+
+    QBENCHMARK_ONCE {
+        for (int i = numPoints - numMeasuredDabs; i < numPoints; i++) {
+            const QPointF &pt = stroke[i];
+            grid.append(pt);
+            points << pt;
+
+            if (useGrid) {
+                grid.query(searchRect(pt, radius), radius, &candidates);
+            } else {
+                candidates = allIndices(points.size());
+            }
+
+            numConnections += connectedPoints(points, candidates, pt, radius).size();
+        }
+    }
+
+    QVERIFY(numConnections > 0);
+}
+
+QTEST_MAIN(KisSketchPointsGridTest)
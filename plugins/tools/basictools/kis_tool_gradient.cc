@@ -24,13 +24,11 @@
 
 #include <cfloat>
 
-#include <QApplication>
 #include <QPainter>
 #include <QLabel>
 #include <QLayout>
 #include <QCheckBox>
 
-#include <kis_transaction.h>
 #include <kis_debug.h>
 #include <klocalizedstring.h>
 #include <kcombobox.h>
@@ -39,8 +37,6 @@
 #include <KoPointerEvent.h>
 #include <KoCanvasBase.h>
 #include <KoViewConverter.h>
-#include <KoUpdater.h>
-#include <KoProgressUpdater.h>
 
 #include <kis_gradient_painter.h>
 #include <kis_painter.h>
@@ -48,7 +44,6 @@
 #include <kis_layer.h>
 #include <kis_selection.h>
 #include <kis_paint_layer.h>
-#include <kis_system_locker.h>
 
 #include <canvas/kis_canvas2.h>
 #include <KisViewManager.h>
@@ -58,10 +53,13 @@
 #include <kis_cursor.h>
 #include <kis_config.h>
 #include "kis_resources_snapshot.h"
+#include "strokes/gradient_stroke_strategy.h"
 
 
 KisToolGradient::KisToolGradient(KoCanvasBase * canvas)
-        : KisToolPaint(canvas, KisCursor::load("tool_gradient_cursor.png", 6, 6))
+        : KisToolPaint(canvas, KisCursor::load("tool_gradient_cursor.png", 6, 6)),
+          m_strokeIsRunning(false),
+          m_previewCompressor(100, KisSignalCompressor::FIRST_ACTIVE)
 {
     setObjectName("tool_gradient");
 
@@ -72,6 +70,8 @@ KisToolGradient::KisToolGradient(KoCanvasBase * canvas)
     m_shape = KisGradientPainter::GradientShapeLinear;
     m_repeat = KisGradientPainter::GradientRepeatNone;
     m_antiAliasThreshold = 0.2;
+
+    connect(&m_previewCompressor, SIGNAL(timeout()), SLOT(slotUpdatePreview()));
 }
 
 KisToolGradient::~KisToolGradient()
@@ -91,6 +91,42 @@ void KisToolGradient::activate(ToolActivation toolActivation, const QSet<KoShape
     m_configGroup =  KSharedConfig::openConfig()->group(toolId());
 }
 
+void KisToolGradient::deactivate()
+{
+    KisToolPaint::deactivate();
+    requestStrokeCancellation();
+}
+
+void KisToolGradient::requestStrokeCancellation()
+{
+    m_previewCompressor.stop();
+    cancelGradientStroke();
+
+    m_strokeIsRunning = false;
+    m_endPos = m_startPos;
+}
+
+void KisToolGradient::requestStrokeEnd()
+{
+    m_previewCompressor.stop();
+
+    if (!m_strokeIsRunning) return;
+
+    /**
+     * The user has dragged back to the starting point, so there is
+     * no gradient to apply. The preview stroke may still be running
+     * with an older vector, so it must be reverted, not committed.
+     */
+    if (m_startPos == m_endPos) {
+        cancelGradientStroke();
+        m_strokeIsRunning = false;
+        return;
+    }
+
+    startGradientStroke();
+    endGradientStroke();
+}
+
 void KisToolGradient::paint(QPainter &painter, const KoViewConverter &converter)
 {
     if (mode() == KisTool::PAINT_MODE && m_startPos != m_endPos) {
@@ -112,17 +148,13 @@ void KisToolGradient::beginPrimaryAction(KoPointerEvent *event)
 
     m_startPos = convertToPixelCoordAndSnap(event, QPointF(), false);
     m_endPos = m_startPos;
+    m_strokeIsRunning = true;
 }
 
 void KisToolGradient::continuePrimaryAction(KoPointerEvent *event)
 {
-    /**
-     * TODO: The gradient tool is still not in strokes, so the end of
-     *       its action can call processEvent(), which would result in
-     *       nested event hadler calls. Please uncomment this line
-     *       when the tool is ported to strokes.
-     */
-    //CHECK_MODE_SANITY_OR_RETURN(KisTool::PAINT_MODE);
+    CHECK_MODE_SANITY_OR_RETURN(KisTool::PAINT_MODE);
+    if (!m_strokeIsRunning) return;
 
     QPointF pos = convertToPixelCoordAndSnap(event, QPointF(), false);
 
@@ -138,6 +170,8 @@ void KisToolGradient::continuePrimaryAction(KoPointerEvent *event)
     bound.setTopLeft(m_startPos);
     bound.setBottomRight(m_endPos);
     canvas()->updateCanvas(convertToPt(bound.normalized()));
+
+    m_previewCompressor.start();
 }
 
 void KisToolGradient::endPrimaryAction(KoPointerEvent *event)
@@ -146,50 +180,79 @@ void KisToolGradient::endPrimaryAction(KoPointerEvent *event)
     CHECK_MODE_SANITY_OR_RETURN(KisTool::PAINT_MODE);
     setMode(KisTool::HOVER_MODE);
 
-    if (!currentNode() || currentNode()->systemLocked())
-        return;
+    requestStrokeEnd();
+    canvas()->updateCanvas(convertToPt(currentImage()->bounds()));
+}
 
-    if (m_startPos == m_endPos) {
-        return;
-    }
+void KisToolGradient::slotUpdatePreview()
+{
+    if (!m_strokeIsRunning || m_startPos == m_endPos) return;
 
-    KisSystemLocker locker(currentNode());
+    startGradientStroke();
+}
 
-    KisPaintDeviceSP device;
+void KisToolGradient::startGradientStroke()
+{
     KisImageSP image = this->image();
+    if (!image || !currentNode() || !currentNode()->paintDevice()) return;
+
+    if (m_strokeId) {
+        if (m_strokeStartPos == m_startPos && m_strokeEndPos == m_endPos) return;
+
+        /**
+         * The stroke is restarted with the new gradient vector. When
+         * the level of detail is active, only the preview has been
+         * rendered so far, so restarting is cheap.
+         */
+        image->addJob(m_strokeId, new GradientStrokeStrategy::CancelSilentlyMarker);
+        image->cancelStroke(m_strokeId);
+        m_strokeId.clear();
+    }
 
     KisResourcesSnapshotSP resources =
-        new KisResourcesSnapshot(image, currentNode(), 0,  this->canvas()->resourceManager());
-
-    if (image && (device = resources->currentNode()->paintDevice())) {
-        QApplication::setOverrideCursor(Qt::BusyCursor);
+        new KisResourcesSnapshot(image,
+                                 currentNode(),
+                                 image->postExecutionUndoAdapter(),
+                                 canvas()->resourceManager());
+
+    const QRect applyRect = image->bounds();
+
+    m_strokeId =
+        image->startStroke(new GradientStrokeStrategy(m_startPos,
+                                                      m_endPos,
+                                                      m_shape,
+                                                      m_repeat,
+                                                      m_antiAliasThreshold,
+                                                      m_reverse,
+                                                      applyRect,
+                                                      resources));
+
+    Q_FOREACH (const QRect &rc, GradientStrokeStrategy::splitIntoPatches(applyRect)) {
+        image->addJob(m_strokeId, new GradientStrokeStrategy::Data(rc));
+    }
 
-        KUndo2MagicString actionName = kundo2_i18n("Gradient");
-        KisUndoAdapter *undoAdapter = image->undoAdapter();
-        undoAdapter->beginMacro(actionName);
+    m_strokeStartPos = m_startPos;
+    m_strokeEndPos = m_endPos;
+}
 
-        KisGradientPainter painter(device, resources->activeSelection());
-        resources->setupPainter(&painter);
+void KisToolGradient::endGradientStroke()
+{
+    m_strokeIsRunning = false;
 
-        painter.beginTransaction();
+    if (!m_strokeId) return;
 
-        KisCanvas2 * canvas = dynamic_cast<KisCanvas2 *>(this->canvas());
-        KoProgressUpdater * updater = canvas->viewManager()->createProgressUpdater(KoProgressUpdater::Unthreaded);
+    image()->endStroke(m_strokeId);
+    m_strokeId.clear();
 
-        updater->start(100, i18nc("@info:progress", "Gradient..."));
-        painter.setProgress(updater->startSubtask());
+    notifyModified();
+}
 
-        painter.setGradientShape(m_shape);
-        painter.paintGradient(m_startPos, m_endPos, m_repeat, m_antiAliasThreshold, m_reverse, 0, 0, image->width(), image->height());
-        painter.endTransaction(undoAdapter);
-        undoAdapter->endMacro();
+void KisToolGradient::cancelGradientStroke()
+{
+    if (!m_strokeId) return;
 
-        QApplication::restoreOverrideCursor();
-        currentNode()->setDirty();
-        notifyModified();
-        delete updater;
-    }
-    canvas()->updateCanvas(convertToPt(currentImage()->bounds()));
+    image()->cancelStroke(m_strokeId);
+    m_strokeId.clear();
 }
 
 QPointF KisToolGradient::straightLine(QPointF point)
@@ -32,6 +32,7 @@
 #include <kis_global.h>
 #include <kis_types.h>
 #include <kis_gradient_painter.h>
+#include <kis_signal_compressor.h>
 #include <flake/kis_node_shape.h>
 #include <kis_icon.h>
 #include <kconfig.h>
@@ -62,8 +63,12 @@ public:
 
     QWidget* createOptionWidget();
 
+    void requestStrokeCancellation();
+    void requestStrokeEnd();
+
 public Q_SLOTS:
     virtual void activate(ToolActivation toolActivation, const QSet<KoShape*> &shapes);
+    virtual void deactivate();
     void slotSetShape(int);
     void slotSetRepeat(int);
     void slotSetReverse(bool);
@@ -79,8 +84,14 @@ private Q_SLOTS:
 
     }
 
+    void slotUpdatePreview();
+
 private:
 
+    void startGradientStroke();
+    void endGradientStroke();
+    void cancelGradientStroke();
+
     void paintLine(QPainter& gc);
 
     QPointF straightLine(QPointF point);
@@ -103,6 +114,11 @@ private:
     KisDoubleSliderSpinBox *m_slAntiAliasThreshold;
     KConfigGroup m_configGroup;
 
+    bool m_strokeIsRunning;
+    KisStrokeId m_strokeId;
+    QPointF m_strokeStartPos;
+    QPointF m_strokeEndPos;
+    KisSignalCompressor m_previewCompressor;
 };
 
 class KisToolGradientFactory : public KoToolFactoryBase
@@ -0,0 +1,209 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "gradient_stroke_strategy.h"
+
+#include <klocalizedstring.h>
+#include <kis_image.h>
+#include <kis_node.h>
+#include <kis_paint_device.h>
+#include <krita_utils.h>
+
+
+struct GradientStrokeStrategy::Private
+{
+    Private()
+        : shape(KisGradientPainter::GradientShapeLinear),
+          repeat(KisGradientPainter::GradientRepeatNone),
+          antiAliasThreshold(0.0),
+          reverseGradient(false),
+          updatesFacade(0),
+          cancelSilently(false)
+    {
+    }
+
+    Private(const Private &rhs, int levelOfDetail)
+        : shape(rhs.shape),
+          repeat(rhs.repeat),
+          antiAliasThreshold(rhs.antiAliasThreshold),
+          reverseGradient(rhs.reverseGradient),
+          resources(rhs.resources),
+          node(rhs.node),
+          updatesFacade(rhs.updatesFacade),
+          cancelSilently(rhs.cancelSilently)
+    {
+        KIS_ASSERT_RECOVER_NOOP(!rhs.prepared);
+
+        KisLodTransform t(levelOfDetail);
+        gradientVectorStart = t.map(rhs.gradientVectorStart);
+        gradientVectorEnd = t.map(rhs.gradientVectorEnd);
+        applyRect = t.map(rhs.applyRect);
+    }
+
+    QPointF gradientVectorStart;
+    QPointF gradientVectorEnd;
+    KisGradientPainter::enumGradientShape shape;
+    KisGradientPainter::enumGradientRepeat repeat;
+    qreal antiAliasThreshold;
+    bool reverseGradient;
+    QRect applyRect;
+
+    KisResourcesSnapshotSP resources;
+    KisNodeSP node;
+    KisUpdatesFacade *updatesFacade;
+    bool cancelSilently;
+
+    KisGradientPainter::PreparedGradientSP prepared;
+};
+
+GradientStrokeStrategy::GradientStrokeStrategy(const QPointF &gradientVectorStart,
+                                               const QPointF &gradientVectorEnd,
+                                               KisGradientPainter::enumGradientShape shape,
+                                               KisGradientPainter::enumGradientRepeat repeat,
+                                               qreal antiAliasThreshold,
+                                               bool reverseGradient,
+                                               const QRect &applyRect,
+                                               KisResourcesSnapshotSP resources)
+    : KisPainterBasedStrokeStrategy("GRADIENT_STROKE",
+                                    kundo2_i18n("Gradient"),
+                                    resources,
+                                    QVector<PainterInfo*>()),
+      m_d(new Private())
+{
+    m_d->gradientVectorStart = gradientVectorStart;
+    m_d->gradientVectorEnd = gradientVectorEnd;
+    m_d->shape = shape;
+    m_d->repeat = repeat;
+    m_d->antiAliasThreshold = antiAliasThreshold;
+    m_d->reverseGradient = reverseGradient;
+    m_d->applyRect = applyRect;
+    m_d->resources = resources;
+    m_d->node = resources->currentNode();
+    m_d->updatesFacade = resources->image().data();
+
+    enableJob(KisSimpleStrokeStrategy::JOB_DOSTROKE);
+}
+
+GradientStrokeStrategy::GradientStrokeStrategy(const GradientStrokeStrategy &rhs, int levelOfDetail)
+    : KisPainterBasedStrokeStrategy(rhs, levelOfDetail),
+      m_d(new Private(*rhs.m_d, levelOfDetail))
+{
+}
+
+GradientStrokeStrategy::~GradientStrokeStrategy()
+{
+}
+
+void GradientStrokeStrategy::initStrokeCallback()
+{
+    KisPainterBasedStrokeStrategy::initStrokeCallback();
+
+    /**
+     * The shape strategies and the lookup table are calculated
+     * once here, so that the concurrent patch jobs only read them
+     */
+    KisGradientPainter painter(targetDevice(), activeSelection());
+    painter.setGradient(m_d->resources->currentGradient());
+    painter.setGradientShape(m_d->shape);
+
+    m_d->prepared = painter.prepareGradient(m_d->gradientVectorStart,
+                                            m_d->gradientVectorEnd,
+                                            m_d->repeat,
+                                            m_d->antiAliasThreshold,
+                                            m_d->reverseGradient,
+                                            m_d->applyRect);
+}
+
+void GradientStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
+{
+    Data *d = dynamic_cast<Data*>(data);
+    CancelSilentlyMarker *cancelJob =
+        dynamic_cast<CancelSilentlyMarker*>(data);
+
+    if (d) {
+        if (!m_d->prepared) return;
+
+        const QRect rc = d->processRect;
+
+        KisGradientPainter painter(targetDevice(), activeSelection());
+        painter.setOpacity(m_d->resources->opacity());
+        painter.setCompositeOp(m_d->resources->compositeOp());
+
+        QBitArray lockFlags = m_d->resources->channelLockFlags();
+        if (lockFlags.size() > 0) {
+            painter.setChannelFlags(lockFlags);
+        }
+
+        painter.paintGradientPatch(m_d->prepared, rc);
+        m_d->node->setDirty(rc);
+    } else if (cancelJob) {
+        m_d->cancelSilently = true;
+    } else {
+        qFatal("GradientStrokeStrategy: job type is not known");
+    }
+}
+
+void GradientStrokeStrategy::cancelStrokeCallback()
+{
+    m_d->prepared.clear();
+
+    KisProjectionUpdatesFilterSP prevUpdatesFilter;
+
+    if (m_d->cancelSilently) {
+        /**
+         * The stroke is going to be restarted with a new gradient
+         * vector that covers the same area, so there is no need to
+         * update the projection for the reverted pixels
+         */
+        prevUpdatesFilter = m_d->updatesFacade->projectionUpdatesFilter();
+        if (prevUpdatesFilter) {
+            m_d->updatesFacade->setProjectionUpdatesFilter(KisProjectionUpdatesFilterSP());
+        }
+        m_d->updatesFacade->disableDirtyRequests();
+    }
+
+    KisPainterBasedStrokeStrategy::cancelStrokeCallback();
+
+    if (m_d->cancelSilently) {
+        m_d->updatesFacade->enableDirtyRequests();
+        if (prevUpdatesFilter) {
+            m_d->updatesFacade->setProjectionUpdatesFilter(prevUpdatesFilter);
+            prevUpdatesFilter.clear();
+        }
+    }
+}
+
+void GradientStrokeStrategy::finishStrokeCallback()
+{
+    m_d->prepared.clear();
+
+    KisPainterBasedStrokeStrategy::finishStrokeCallback();
+}
+
+KisStrokeStrategy* GradientStrokeStrategy::createLodClone(int levelOfDetail)
+{
+    GradientStrokeStrategy *clone = new GradientStrokeStrategy(*this, levelOfDetail);
+    clone->setUndoEnabled(false);
+    return clone;
+}
+
+QVector<QRect> GradientStrokeStrategy::splitIntoPatches(const QRect &applyRect)
+{
+    return KritaUtils::splitRectIntoPatches(applyRect, KritaUtils::optimalPatchSize());
+}
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2016 The Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __GRADIENT_STROKE_STRATEGY_H
+#define __GRADIENT_STROKE_STRATEGY_H
+
+#include "kis_types.h"
+#include "kis_gradient_painter.h"
+#include "kis_painter_based_stroke_strategy.h"
+#include "kis_lod_transform.h"
+
+
+/**
+ * Paints a gradient over the apply rect of the stroke. The work is
+ * split into patches (see Data) that are rendered concurrently
+ * using the shape strategies and the color lookup table precalculated
+ * once in initStrokeCallback().
+ *
+ * The stroke supports level of detail, so the tool can restart it
+ * while the user drags the gradient vector and get a low-resolution
+ * preview of the result.
+ */
+class GradientStrokeStrategy : public KisPainterBasedStrokeStrategy
+{
+public:
+    class Data : public KisStrokeJobData {
+    public:
+        Data(const QRect &_processRect)
+            : KisStrokeJobData(CONCURRENT),
+              processRect(_processRect) {}
+
+        KisStrokeJobData* createLodClone(int levelOfDetail) {
+            return new Data(*this, levelOfDetail);
+        }
+
+        QRect processRect;
+
+    private:
+        Data(const Data &rhs, int levelOfDetail)
+            : KisStrokeJobData(rhs)
+        {
+            KisLodTransform t(levelOfDetail);
+            processRect = t.map(rhs.processRect);
+        }
+    };
+
+    class CancelSilentlyMarker : public KisStrokeJobData {
+    public:
+        CancelSilentlyMarker()
+            : KisStrokeJobData(SEQUENTIAL)
+        {}
+
+        KisStrokeJobData* createLodClone(int /*levelOfDetail*/) {
+            return new CancelSilentlyMarker(*this);
+        }
+    };
+
+public:
+    GradientStrokeStrategy(const QPointF &gradientVectorStart,
+                           const QPointF &gradientVectorEnd,
+                           KisGradientPainter::enumGradientShape shape,
+                           KisGradientPainter::enumGradientRepeat repeat,
+                           qreal antiAliasThreshold,
+                           bool reverseGradient,
+                           const QRect &applyRect,
+                           KisResourcesSnapshotSP resources);
+    ~GradientStrokeStrategy();
+
+    void initStrokeCallback();
+    void doStrokeCallback(KisStrokeJobData *data);
+    void cancelStrokeCallback();
+    void finishStrokeCallback();
+
+    KisStrokeStrategy* createLodClone(int levelOfDetail);
+
+    /**
+     * Splits \p applyRect into the patches the stroke is expected
+     * to be fed with
+     */
+    static QVector<QRect> splitIntoPatches(const QRect &applyRect);
+
+private:
+    GradientStrokeStrategy(const GradientStrokeStrategy &rhs, int levelOfDetail);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __GRADIENT_STROKE_STRATEGY_H */